@@ -0,0 +1,41 @@
+#include "backoff_policy.h"
+
+ExponentialBackoff::ExponentialBackoff(uint32_t base_ms, uint32_t cap_ms, uint32_t seed, uint32_t min_ms)
+    : base_ms_(base_ms)
+    , cap_ms_(cap_ms)
+    , min_ms_(min_ms)
+    , state_(seed != 0 ? seed : 0x9e3779b9u) {
+}
+
+uint32_t ExponentialBackoff::NextDelayMs() {
+    // 上限按 base * 2^attempt 增长，移位前先判断避免溢出
+    uint32_t ceiling = cap_ms_;
+    if (attempt_ < 31 && base_ms_ <= (cap_ms_ >> attempt_)) {
+        ceiling = base_ms_ << attempt_;
+    }
+    if (attempt_ < 31) {
+        attempt_++;
+    }
+    if (ceiling <= min_ms_) {
+        return min_ms_;
+    }
+    return min_ms_ + NextRandom() % (ceiling - min_ms_ + 1);
+}
+
+uint32_t ExponentialBackoff::SeedFromMac(const uint8_t* mac) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < 6; i++) {
+        hash ^= mac[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// xorshift32
+uint32_t ExponentialBackoff::NextRandom() {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 17;
+    state_ ^= state_ << 5;
+    return state_;
+}
@@ -17,6 +17,8 @@
  * under the License.
  */
  #include "ssid_manager_c.h"
+#include "connection_timeline_c.h"
+#include "connect_report_c.h"
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -273,6 +275,8 @@ gatt_svr_chr_access_custom_service(uint16_t conn_handle, uint16_t attr_handle,
                     switch (result.cmd) {
                         case CMD_GET_WIFI_LIST: {
                             ESP_LOGI(TAG, "CMD_GET_WIFI_LIST");
+                            // 先回复缓存中的列表，同时按需刷新，客户端下次轮询时拿到新结果
+                            WifiConnectionManager_RequestScan();
                             // 使用新的带RSSI的函数
                             const char* ssid_list_json = ssid_manager_get_scan_ssid_rssi_list_json();
                             // ESP_LOGI(TAG, "ssid_list_json with RSSI: %s", ssid_list_json);
@@ -286,6 +290,32 @@ gatt_svr_chr_access_custom_service(uint16_t conn_handle, uint16_t attr_handle,
                             );
                             break;
                         }
+                        case CMD_GET_CONN_TIMELINE: {
+                            ESP_LOGI(TAG, "CMD_GET_CONN_TIMELINE");
+                            // 最近 8 次连接尝试，格式见 connection_timeline_c.h
+                            static uint8_t timeline[1 + 8 * 30];
+                            size_t timeline_len = connection_timeline_get_binary(timeline, sizeof(timeline));
+                            pack_and_send_wifi_list_response(
+                                result.msg_id,
+                                CMD_CONN_TIMELINE_RESP,
+                                timeline, timeline_len,
+                                ble_send_frame_cb, NULL
+                            );
+                            break;
+                        }
+                        case CMD_GET_CONNECT_REPORT: {
+                            ESP_LOGI(TAG, "CMD_GET_CONNECT_REPORT");
+                            // 最近的配网连接诊断记录，格式见 connect_report_c.h
+                            static uint8_t report[512];
+                            size_t report_len = connect_report_get_binary(report, sizeof(report));
+                            pack_and_send_wifi_list_response(
+                                result.msg_id,
+                                CMD_CONNECT_REPORT_RESP,
+                                report, report_len,
+                                ble_send_frame_cb, NULL
+                            );
+                            break;
+                        }
                         case CMD_WIFI_CONFIG: {
                             // 二次解析：解析WiFi配置数据
                             wifi_config_t wifi_config;
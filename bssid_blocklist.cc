@@ -0,0 +1,137 @@
+#include "bssid_blocklist.h"
+
+#include <algorithm>
+
+static uint64_t BssidKey(const uint8_t* bssid) {
+    uint64_t key = 0;
+    for (int i = 0; i < 6; i++) {
+        key = (key << 8) | bssid[i];
+    }
+    return key;
+}
+
+// now 是否已经到达 deadline（按回绕比较）
+static bool Reached(uint32_t now_ms, uint32_t deadline_ms) {
+    return (int32_t)(now_ms - deadline_ms) >= 0;
+}
+
+uint32_t BssidBlocklist::BaseBlockMs(DisconnectClass cls) {
+    switch (cls) {
+    case DisconnectClass::kOverloaded:
+        return 60 * 1000;           // 等其他设备离开
+    case DisconnectClass::kCredential:
+        return 30 * 1000;           // 握手超时也可能是 AP 一时繁忙
+    case DisconnectClass::kIncompatible:
+        return kMaxBlockMs;         // 配置不改就不会好
+    case DisconnectClass::kTransient:
+        return 15 * 1000;
+    case DisconnectClass::kNotFound:
+    case DisconnectClass::kLocal:
+        break;
+    }
+    return 0;
+}
+
+BssidBlocklist::Entry* BssidBlocklist::Find(uint64_t bssid) {
+    for (auto& entry : entries_) {
+        if (entry.used && entry.bssid == bssid) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+const BssidBlocklist::Entry* BssidBlocklist::Find(uint64_t bssid) const {
+    return const_cast<BssidBlocklist*>(this)->Find(bssid);
+}
+
+void BssidBlocklist::OnFailure(const uint8_t* bssid, DisconnectClass cls, uint32_t now_ms) {
+    uint32_t base_ms = BaseBlockMs(cls);
+    if (base_ms == 0) {
+        return;
+    }
+    uint64_t key = BssidKey(bssid);
+    Entry* entry = Find(key);
+    if (entry == nullptr) {
+        // 优先空槽，否则替换最早失败的记录
+        for (auto& candidate : entries_) {
+            if (entry == nullptr || (entry->used &&
+                (!candidate.used || (int32_t)(candidate.last_failure_ms - entry->last_failure_ms) < 0))) {
+                entry = &candidate;
+            }
+        }
+        *entry = {};
+        entry->bssid = key;
+        entry->used = true;
+    }
+    if (entry->strikes < UINT8_MAX) {
+        entry->strikes++;
+    }
+    entry->last_class = cls;
+    entry->last_failure_ms = now_ms;
+
+    uint8_t threshold = cls == DisconnectClass::kTransient ? kTransientStrikes : 1;
+    if (entry->strikes < threshold) {
+        return;
+    }
+    // 达到阈值后每多失败一次屏蔽时间翻倍
+    uint32_t shift = std::min<uint32_t>(entry->strikes - threshold, 8);
+    uint32_t block_ms = std::min<uint64_t>((uint64_t)base_ms << shift, kMaxBlockMs);
+    entry->blocked_until_ms = now_ms + block_ms;
+}
+
+void BssidBlocklist::OnSuccess(const uint8_t* bssid) {
+    Entry* entry = Find(BssidKey(bssid));
+    if (entry != nullptr) {
+        entry->used = false;
+    }
+}
+
+bool BssidBlocklist::IsBlocked(const uint8_t* bssid, uint32_t now_ms) const {
+    const Entry* entry = Find(BssidKey(bssid));
+    return entry != nullptr && entry->blocked_until_ms != 0 && !Reached(now_ms, entry->blocked_until_ms);
+}
+
+void BssidBlocklist::Expire(uint32_t now_ms) {
+    for (auto& entry : entries_) {
+        if (!entry.used) {
+            continue;
+        }
+        if (entry.blocked_until_ms != 0 && Reached(now_ms, entry.blocked_until_ms)) {
+            entry.blocked_until_ms = 0;
+        }
+        // 每过 kDecayMs 没有新的失败，失败次数减一
+        while (entry.strikes > 0 && Reached(now_ms, entry.last_failure_ms + kDecayMs)) {
+            entry.strikes--;
+            entry.last_failure_ms += kDecayMs;
+        }
+        if (entry.strikes == 0 && entry.blocked_until_ms == 0) {
+            entry.used = false;
+        }
+    }
+}
+
+size_t BssidBlocklist::GetEntries(BlocklistEntry* out, size_t max_count, uint32_t now_ms) const {
+    size_t count = 0;
+    for (const auto& entry : entries_) {
+        if (!entry.used || count >= max_count) {
+            continue;
+        }
+        auto& item = out[count++];
+        for (int i = 0; i < 6; i++) {
+            item.bssid[i] = (entry.bssid >> (8 * (5 - i))) & 0xFF;
+        }
+        item.last_class = entry.last_class;
+        item.strikes = entry.strikes;
+        item.blocked_ms = entry.blocked_until_ms != 0 && !Reached(now_ms, entry.blocked_until_ms) ?
+            entry.blocked_until_ms - now_ms : 0;
+        item.since_failure_ms = now_ms - entry.last_failure_ms;
+    }
+    return count;
+}
+
+void BssidBlocklist::Clear() {
+    for (auto& entry : entries_) {
+        entry.used = false;
+    }
+}
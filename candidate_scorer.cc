@@ -0,0 +1,106 @@
+#include "candidate_scorer.h"
+
+#include <cstring>
+
+static uint64_t BssidKey(const uint8_t* bssid) {
+    uint64_t key = 0;
+    for (int i = 0; i < 6; i++) {
+        key = (key << 8) | bssid[i];
+    }
+    return key;
+}
+
+CandidateScorer::History* CandidateScorer::FindOrCreate(uint64_t bssid, int64_t now_us) {
+    History* victim = nullptr;
+    for (auto& entry : history_) {
+        if (entry.used && entry.bssid == bssid) {
+            entry.last_used_us = now_us;
+            return &entry;
+        }
+        // 优先使用空槽，否则淘汰最久未使用的记录
+        if (victim == nullptr || (victim->used && (!entry.used || entry.last_used_us < victim->last_used_us))) {
+            victim = &entry;
+        }
+    }
+    *victim = {};
+    victim->bssid = bssid;
+    victim->used = true;
+    victim->last_used_us = now_us;
+    return victim;
+}
+
+int32_t CandidateScorer::Score(const uint8_t* bssid, int8_t rssi, wifi_auth_mode_t authmode, uint8_t channel, int64_t now_us) {
+    History* history = FindOrCreate(BssidKey(bssid), now_us);
+
+    // 首次出现直接取当前值，之后按 EWMA 平滑，避免单次扫描的抖动改变排序
+    if (history->smoothed_rssi_x16 == 0) {
+        history->smoothed_rssi_x16 = rssi * 16;
+    } else {
+        history->smoothed_rssi_x16 += (rssi * 16 - history->smoothed_rssi_x16) * weights_.rssi_alpha_percent / 100;
+    }
+    int smoothed_rssi = history->smoothed_rssi_x16 / 16;
+
+    // 5 GHz 干扰少、速率高，同样的 RSSI 下吞吐更好，按 dB 加成而不是固定加分
+    int effective_rssi = smoothed_rssi;
+    if (channel > 14 && smoothed_rssi >= weights_.band_5g_min_rssi) {
+        effective_rssi += weights_.band_5g_rssi_offset;
+    }
+    int32_t score = weights_.rssi * (effective_rssi + 100);
+    score += weights_.success * std::min<int>(history->successes, weights_.max_history_count);
+    score -= weights_.failure * std::min<int>(history->failures, weights_.max_history_count);
+    if (authmode >= WIFI_AUTH_WPA2_PSK && authmode != WIFI_AUTH_WAPI_PSK) {
+        score += weights_.secure_auth;
+    }
+
+    int32_t since_success_s = -1;
+    if (history->last_success_us != 0) {
+        since_success_s = (now_us - history->last_success_us) / 1000000;
+        if (since_success_s < weights_.recency_window_s) {
+            score += weights_.recency * (weights_.recency_window_s - since_success_s) / weights_.recency_window_s;
+        }
+    }
+
+    if (score_count_ < kMaxScores) {
+        auto& breakdown = scores_[score_count_++];
+        memcpy(breakdown.bssid, bssid, 6);
+        breakdown.channel = channel;
+        breakdown.authmode = authmode;
+        breakdown.rssi = rssi;
+        breakdown.smoothed_rssi = smoothed_rssi;
+        breakdown.successes = history->successes;
+        breakdown.failures = history->failures;
+        breakdown.since_success_s = since_success_s;
+        breakdown.score = score;
+    }
+    return score;
+}
+
+void CandidateScorer::RecordSuccess(const uint8_t* bssid, int64_t now_us) {
+    History* history = FindOrCreate(BssidKey(bssid), now_us);
+    if (history->successes < UINT8_MAX) {
+        history->successes++;
+    }
+    // 成功后失败计数减半，让偶发故障的 AP 逐步恢复排名
+    history->failures /= 2;
+    history->last_success_us = now_us;
+}
+
+void CandidateScorer::RecordFailure(const uint8_t* bssid, int64_t now_us) {
+    History* history = FindOrCreate(BssidKey(bssid), now_us);
+    if (history->failures < UINT8_MAX) {
+        history->failures++;
+    }
+}
+
+void CandidateScorer::Clear() {
+    for (auto& entry : history_) {
+        entry = {};
+    }
+    score_count_ = 0;
+}
+
+size_t CandidateScorer::GetLastScores(ScoreBreakdown* out, size_t max_count) const {
+    size_t count = std::min(score_count_, max_count);
+    memcpy(out, scores_, count * sizeof(ScoreBreakdown));
+    return count;
+}
@@ -0,0 +1,94 @@
+#include "connect_attempt_loop.h"
+#include "connect_report.h"
+
+#include <algorithm>
+
+#include <esp_log.h>
+#include <esp_wifi.h>
+
+#define TAG "ConnectAttemptLoop"
+
+RetryDecision ConnectAttemptLoop::Begin(const RetryPolicyConfig& policy, uint32_t attempt_timeout_ms, bool psk_ap,
+                                        int8_t rssi, uint8_t channel, int64_t now_ms) {
+    policy_.SetConfig(policy);
+    policy_.Begin(now_ms, psk_ap);
+    attempt_timeout_ms_ = attempt_timeout_ms;
+    target_rssi_ = rssi;
+    target_channel_ = channel;
+    return StartAttempt(now_ms);
+}
+
+RetryDecision ConnectAttemptLoop::StartAttempt(int64_t now_ms) {
+    ConnectReport::GetInstance().AttemptStarted(now_ms);
+    esp_err_t ret = driver_.StartConnect();
+    if (ret != ESP_OK) {
+        ConnectReport::GetInstance().AttemptEnded(AttemptOutcome::kConnectError, 0, target_rssi_, target_channel_,
+                                                  ret, now_ms);
+        return Apply(policy_.OnConnectError(now_ms), now_ms);
+    }
+    phase_ = Phase::kWaiting;
+    // 单次等待不超过总截止时间
+    Arm(std::min(attempt_timeout_ms_, policy_.RemainingMs(now_ms)), now_ms);
+    return {RetryVerdict::kRetry, 0};
+}
+
+RetryDecision ConnectAttemptLoop::Apply(const RetryDecision& decision, int64_t now_ms) {
+    if (decision.verdict == RetryVerdict::kRetry) {
+        phase_ = Phase::kRetryDelay;
+        Arm(decision.delay_ms, now_ms);
+    } else {
+        Stop();
+    }
+    return decision;
+}
+
+void ConnectAttemptLoop::Arm(uint32_t ms, int64_t now_ms) {
+    timer_deadline_ms_ = now_ms + ms;
+    driver_.ArmTimer(ms);
+}
+
+void ConnectAttemptLoop::Stop() {
+    if (phase_ != Phase::kIdle) {
+        driver_.StopTimer();
+        phase_ = Phase::kIdle;
+    }
+}
+
+RetryDecision ConnectAttemptLoop::OnTimer(int64_t now_ms) {
+    if (phase_ == Phase::kIdle || now_ms < timer_deadline_ms_) {
+        return {RetryVerdict::kRetry, 0};
+    }
+    if (phase_ == Phase::kRetryDelay) {
+        return StartAttempt(now_ms);
+    }
+    ESP_LOGE(TAG, "Attempt %d timed out", policy_.GetAttempts() + 1);
+    ConnectReport::GetInstance().AttemptEnded(AttemptOutcome::kTimeout, 0, target_rssi_, target_channel_,
+                                              ESP_ERR_TIMEOUT, now_ms);
+    return Apply(policy_.OnTimeout(now_ms), now_ms);
+}
+
+RetryDecision ConnectAttemptLoop::OnDisconnect(uint16_t reason, int8_t rssi, int64_t now_ms) {
+    if (rssi == 0) {
+        rssi = target_rssi_;
+    }
+    if (phase_ == Phase::kRetryDelay) {
+        // 超时之后才到达的断开原因
+        ConnectReport::GetInstance().AmendReason(reason, rssi);
+        return {RetryVerdict::kRetry, 0};
+    }
+    if (phase_ != Phase::kWaiting) {
+        return {RetryVerdict::kRetry, 0};
+    }
+    ConnectReport::GetInstance().AttemptEnded(AttemptOutcome::kDisconnected, reason, rssi, target_channel_,
+                                              ESP_ERR_WIFI_CONN, now_ms);
+    return Apply(policy_.OnDisconnect(reason, now_ms), now_ms);
+}
+
+bool ConnectAttemptLoop::OnConnected(int8_t rssi, uint8_t channel, int64_t now_ms) {
+    if (phase_ != Phase::kWaiting) {
+        return false;
+    }
+    ConnectReport::GetInstance().AttemptEnded(AttemptOutcome::kConnected, 0, rssi, channel, ESP_OK, now_ms);
+    Stop();
+    return true;
+}
@@ -0,0 +1,101 @@
+#include "connect_budget.h"
+
+void ConnectBudget::BeginCycle(uint32_t now_ms) {
+    for (auto& entry : entries_) {
+        entry = {};
+    }
+    cycle_start_ms_ = now_ms;
+    cycle_attempts_ = 0;
+    in_cycle_ = true;
+}
+
+const ConnectBudget::Entry* ConnectBudget::Find(uint32_t hash) const {
+    for (const auto& entry : entries_) {
+        if (entry.used && entry.hash == hash) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+ConnectBudget::Entry* ConnectBudget::Find(uint32_t hash) {
+    return const_cast<Entry*>(static_cast<const ConnectBudget*>(this)->Find(hash));
+}
+
+bool ConnectBudget::DeadlineExpired(uint32_t now_ms) const {
+    return in_cycle_ && now_ms - cycle_start_ms_ >= config_.cycle_deadline_ms;
+}
+
+bool ConnectBudget::CanAttempt(uint32_t ssid_hash, uint32_t now_ms) const {
+    if (DeadlineExpired(now_ms)) {
+        return false;
+    }
+    const Entry* entry = Find(ssid_hash);
+    if (entry == nullptr) {
+        return true;
+    }
+    if (entry->blocked || entry->attempts >= config_.max_attempts_per_ssid) {
+        return false;
+    }
+    return now_ms - entry->first_attempt_ms < config_.ssid_budget_ms;
+}
+
+void ConnectBudget::OnAttempt(uint32_t ssid_hash, uint32_t now_ms) {
+    if (!in_cycle_) {
+        BeginCycle(now_ms);
+    }
+    cycle_attempts_++;
+    Entry* entry = Find(ssid_hash);
+    if (entry == nullptr) {
+        for (auto& candidate : entries_) {
+            if (!candidate.used) {
+                entry = &candidate;
+                break;
+            }
+        }
+        if (entry == nullptr) {
+            return;     // 超过 kMaxSsids 个网络时只受总时限约束
+        }
+        *entry = {};
+        entry->hash = ssid_hash;
+        entry->first_attempt_ms = now_ms;
+        entry->used = true;
+    }
+    if (entry->attempts < UINT8_MAX) {
+        entry->attempts++;
+    }
+}
+
+void ConnectBudget::OnFailure(uint32_t ssid_hash, bool definitive) {
+    Entry* entry = Find(ssid_hash);
+    if (entry != nullptr && definitive) {
+        entry->blocked = true;
+    }
+}
+
+void ConnectBudget::EndCycle(bool success, bool deadline, uint32_t now_ms) {
+    if (!in_cycle_) {
+        return;
+    }
+    in_cycle_ = false;
+    if (!success && cycle_attempts_ == 0) {
+        return;     // 扫描没有找到任何候选，不算一轮连接
+    }
+    uint32_t duration = now_ms - cycle_start_ms_;
+    report_.cycles++;
+    report_.last_duration_ms = duration;
+    report_.last_attempts = cycle_attempts_;
+    if (success) {
+        report_.successes++;
+        if (duration > report_.worst_duration_ms) {
+            report_.worst_duration_ms = duration;
+        }
+        if (cycle_attempts_ > report_.worst_attempts) {
+            report_.worst_attempts = cycle_attempts_;
+        }
+    } else if (deadline) {
+        report_.deadline_hits++;
+    } else {
+        report_.exhausted++;
+    }
+}
@@ -0,0 +1,265 @@
+#include "connect_report.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cJSON.h>
+
+#include "disconnect_reason.h"
+
+const char* ConnectOutcomeName(ConnectOutcome outcome) {
+    switch (outcome) {
+        case ConnectOutcome::kPending:
+            return "pending";
+        case ConnectOutcome::kConnected:
+            return "connected";
+        case ConnectOutcome::kWrongPassword:
+            return "wrong_password";
+        case ConnectOutcome::kIncompatible:
+            return "incompatible";
+        case ConnectOutcome::kDeadline:
+            return "deadline";
+        case ConnectOutcome::kExhausted:
+            return "exhausted";
+        case ConnectOutcome::kCancelled:
+            return "cancelled";
+        case ConnectOutcome::kInvalid:
+            return "invalid";
+    }
+    return "unknown";
+}
+
+const char* AttemptOutcomeName(AttemptOutcome outcome) {
+    switch (outcome) {
+        case AttemptOutcome::kPending:
+            return "pending";
+        case AttemptOutcome::kConnected:
+            return "connected";
+        case AttemptOutcome::kDisconnected:
+            return "disconnected";
+        case AttemptOutcome::kTimeout:
+            return "timeout";
+        case AttemptOutcome::kConnectError:
+            return "connect_error";
+        case AttemptOutcome::kCancelled:
+            return "cancelled";
+    }
+    return "unknown";
+}
+
+static uint16_t ClampMs(uint32_t ms) {
+    return ms > UINT16_MAX ? UINT16_MAX : ms;
+}
+
+ConnectRecord* ConnectReport::CurrentLocked() {
+    if (count_ == 0) {
+        return nullptr;
+    }
+    return &records_[(head_ + kHistory - 1) % kHistory];
+}
+
+void ConnectReport::Begin(const char* ssid, bool psk_ap, uint32_t now_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ConnectRecord& record = records_[head_];
+    head_ = (head_ + 1) % kHistory;
+    count_ = std::min(count_ + 1, kHistory);
+
+    memset(&record, 0, sizeof(record));
+    record.seq = next_seq_++;
+    record.start_ms = now_ms;
+    record.psk_ap = psk_ap;
+    strncpy(record.ssid, ssid, sizeof(record.ssid) - 1);
+    last_end_ms_ = now_ms;
+}
+
+void ConnectReport::AttemptStarted(uint32_t now_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ConnectRecord* record = CurrentLocked();
+    if (record == nullptr || record->outcome != ConnectOutcome::kPending) {
+        return;
+    }
+    attempt_start_ms_ = now_ms;
+    // 超出容量的尝试只计数，保留前 kMaxAttempts 次的细节
+    if (record->attempt_count < ConnectRecord::kMaxAttempts) {
+        AttemptRecord& attempt = record->attempts[record->attempt_count];
+        memset(&attempt, 0, sizeof(attempt));
+        attempt.wait_ms = ClampMs(now_ms - last_end_ms_);
+    }
+    if (record->attempt_count < UINT8_MAX) {
+        record->attempt_count++;
+    }
+}
+
+void ConnectReport::AttemptEnded(AttemptOutcome outcome, uint8_t reason, int8_t rssi, uint8_t channel,
+                                 int32_t error, uint32_t now_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ConnectRecord* record = CurrentLocked();
+    if (record == nullptr || record->attempt_count == 0 || record->attempt_count > ConnectRecord::kMaxAttempts) {
+        last_end_ms_ = now_ms;
+        return;
+    }
+    AttemptRecord& attempt = record->attempts[record->attempt_count - 1];
+    attempt.outcome = outcome;
+    attempt.reason = reason;
+    attempt.rssi = rssi;
+    attempt.channel = channel;
+    attempt.error = (uint16_t)error;
+    attempt.duration_ms = ClampMs(now_ms - attempt_start_ms_);
+    last_end_ms_ = now_ms;
+}
+
+void ConnectReport::AmendReason(uint8_t reason, int8_t rssi) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ConnectRecord* record = CurrentLocked();
+    if (record == nullptr || record->attempt_count == 0 || record->attempt_count > ConnectRecord::kMaxAttempts) {
+        return;
+    }
+    AttemptRecord& attempt = record->attempts[record->attempt_count - 1];
+    if (attempt.outcome != AttemptOutcome::kPending && attempt.reason == 0) {
+        attempt.reason = reason;
+        if (attempt.rssi == 0) {
+            attempt.rssi = rssi;
+        }
+    }
+}
+
+void ConnectReport::Finish(ConnectOutcome outcome, int32_t result, uint32_t now_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ConnectRecord* record = CurrentLocked();
+    if (record == nullptr || record->outcome != ConnectOutcome::kPending) {
+        return;
+    }
+    // 取消时正在进行的尝试也一并结束
+    if (record->attempt_count > 0 && record->attempt_count <= ConnectRecord::kMaxAttempts) {
+        AttemptRecord& attempt = record->attempts[record->attempt_count - 1];
+        if (attempt.outcome == AttemptOutcome::kPending) {
+            attempt.outcome = AttemptOutcome::kCancelled;
+            attempt.duration_ms = ClampMs(now_ms - attempt_start_ms_);
+        }
+    }
+    record->outcome = outcome;
+    record->result = result;
+    record->total_ms = now_ms - record->start_ms;
+}
+
+bool ConnectReport::GetCurrent(ConnectRecord* out) const {
+    return GetRecords(out, 1) == 1;
+}
+
+size_t ConnectReport::GetRecords(ConnectRecord* out, size_t max_count) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = std::min(count_, max_count);
+    for (size_t i = 0; i < count; i++) {
+        out[i] = records_[(head_ + kHistory - 1 - i) % kHistory];
+    }
+    return count;
+}
+
+std::string ConnectReport::GetJson() const {
+    ConnectRecord records[kHistory];
+    size_t count = GetRecords(records, kHistory);
+
+    cJSON* root = cJSON_CreateArray();
+    for (size_t i = 0; i < count; i++) {
+        const ConnectRecord& record = records[i];
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddNumberToObject(item, "seq", record.seq);
+        cJSON_AddStringToObject(item, "ssid", record.ssid);
+        cJSON_AddStringToObject(item, "outcome", ConnectOutcomeName(record.outcome));
+        cJSON_AddNumberToObject(item, "result", record.result);
+        cJSON_AddBoolToObject(item, "psk_ap", record.psk_ap);
+        cJSON_AddNumberToObject(item, "start_ms", record.start_ms);
+        cJSON_AddNumberToObject(item, "total_ms", record.total_ms);
+        cJSON_AddNumberToObject(item, "attempt_count", record.attempt_count);
+        cJSON* attempts = cJSON_AddArrayToObject(item, "attempts");
+        size_t attempt_count = std::min<size_t>(record.attempt_count, ConnectRecord::kMaxAttempts);
+        for (size_t j = 0; j < attempt_count; j++) {
+            const AttemptRecord& attempt = record.attempts[j];
+            cJSON* entry = cJSON_CreateObject();
+            cJSON_AddStringToObject(entry, "outcome", AttemptOutcomeName(attempt.outcome));
+            if (attempt.reason != 0) {
+                cJSON_AddNumberToObject(entry, "reason", attempt.reason);
+                cJSON_AddStringToObject(entry, "reason_name", DisconnectReasonString(attempt.reason));
+            }
+            if (attempt.error != 0) {
+                cJSON_AddNumberToObject(entry, "error", attempt.error);
+            }
+            cJSON_AddNumberToObject(entry, "rssi", attempt.rssi);
+            cJSON_AddNumberToObject(entry, "channel", attempt.channel);
+            cJSON_AddNumberToObject(entry, "wait_ms", attempt.wait_ms);
+            cJSON_AddNumberToObject(entry, "duration_ms", attempt.duration_ms);
+            cJSON_AddItemToArray(attempts, entry);
+        }
+        cJSON_AddItemToArray(root, item);
+    }
+    char* printed = cJSON_PrintUnformatted(root);
+    std::string json = printed != nullptr ? printed : "[]";
+    cJSON_free(printed);
+    cJSON_Delete(root);
+    return json;
+}
+
+static uint8_t* PutU16(uint8_t* p, uint16_t value) {
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+    return p + 2;
+}
+
+static uint8_t* PutU32(uint8_t* p, uint32_t value) {
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+    p[2] = (value >> 16) & 0xFF;
+    p[3] = (value >> 24) & 0xFF;
+    return p + 4;
+}
+
+size_t ConnectReport::GetBinary(uint8_t* out, size_t out_size) const {
+    if (out_size < 2) {
+        return 0;
+    }
+    ConnectRecord records[kHistory];
+    size_t count = GetRecords(records, kHistory);
+
+    uint8_t* p = out;
+    *p++ = kBinaryVersion;
+    uint8_t* count_pos = p++;
+    uint8_t written = 0;
+    for (size_t i = 0; i < count; i++) {
+        const ConnectRecord& record = records[i];
+        size_t ssid_len = strnlen(record.ssid, sizeof(record.ssid) - 1);
+        size_t attempt_count = std::min<size_t>(record.attempt_count, ConnectRecord::kMaxAttempts);
+        size_t size = kBinaryRecordHeaderSize + ssid_len + attempt_count * kBinaryAttemptSize;
+        if ((size_t)(p - out) + size > out_size) {
+            break;
+        }
+        p = PutU32(p, record.seq);
+        p = PutU32(p, record.start_ms);
+        p = PutU32(p, record.total_ms);
+        p = PutU32(p, (uint32_t)record.result);
+        *p++ = (uint8_t)record.outcome;
+        *p++ = record.psk_ap ? 1 : 0;
+        *p++ = (uint8_t)ssid_len;
+        memcpy(p, record.ssid, ssid_len);
+        p += ssid_len;
+        *p++ = (uint8_t)attempt_count;
+        for (size_t j = 0; j < attempt_count; j++) {
+            const AttemptRecord& attempt = record.attempts[j];
+            *p++ = (uint8_t)attempt.outcome;
+            *p++ = attempt.reason;
+            *p++ = (uint8_t)attempt.rssi;
+            *p++ = attempt.channel;
+            p = PutU16(p, attempt.error);
+            p = PutU16(p, attempt.wait_ms);
+            p = PutU16(p, attempt.duration_ms);
+        }
+        written++;
+    }
+    *count_pos = written;
+    return p - out;
+}
+
+void ConnectReport::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    memset(records_, 0, sizeof(records_));
+    count_ = 0;
+    head_ = 0;
+}
@@ -0,0 +1,10 @@
+#include "connect_report.h"
+#include "connect_report_c.h"
+
+extern "C" {
+
+size_t connect_report_get_binary(uint8_t* out, size_t out_size) {
+    return ConnectReport::GetInstance().GetBinary(out, out_size);
+}
+
+}
@@ -0,0 +1,83 @@
+#include "connect_retry_policy.h"
+#include "disconnect_reason.h"
+
+#include <esp_wifi_types_generic.h>
+
+const char* RetryVerdictName(RetryVerdict verdict) {
+    switch (verdict) {
+        case RetryVerdict::kRetry:
+            return "retry";
+        case RetryVerdict::kWrongPassword:
+            return "wrong_password";
+        case RetryVerdict::kIncompatible:
+            return "incompatible";
+        case RetryVerdict::kDeadline:
+            return "deadline";
+        case RetryVerdict::kExhausted:
+            return "exhausted";
+    }
+    return "unknown";
+}
+
+void ConnectRetryPolicy::Begin(int64_t now_ms, bool psk_ap) {
+    deadline_ms_ = now_ms + config_.deadline_ms;
+    attempts_ = 0;
+    handshake_timeouts_ = 0;
+    psk_ap_ = psk_ap;
+}
+
+RetryDecision ConnectRetryPolicy::OnDisconnect(uint16_t reason, int64_t now_ms) {
+    attempts_++;
+    switch (reason) {
+        // AP 明确拒绝了认证
+        case WIFI_REASON_AUTH_FAIL:
+        case WIFI_REASON_MIC_FAILURE:
+            return {RetryVerdict::kWrongPassword, 0};
+        // WPA2-PSK 密码错误时 AP 不回应 M2，表现为握手超时；单次超时也可能是丢包
+        case WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT:
+        case WIFI_REASON_HANDSHAKE_TIMEOUT:
+            handshake_timeouts_++;
+            if (psk_ap_ && handshake_timeouts_ >= config_.handshake_timeout_limit) {
+                return {RetryVerdict::kWrongPassword, 0};
+            }
+            return Next(config_.retry_delay_ms, now_ms);
+        case WIFI_REASON_BEACON_TIMEOUT:
+            return Next(config_.transient_delay_ms, now_ms);
+        default:
+            break;
+    }
+
+    switch (ClassifyDisconnect(reason)) {
+        case DisconnectClass::kIncompatible:
+            return {RetryVerdict::kIncompatible, 0};
+        case DisconnectClass::kOverloaded:
+            return Next(config_.transient_delay_ms, now_ms);
+        default:
+            return Next(config_.retry_delay_ms, now_ms);
+    }
+}
+
+RetryDecision ConnectRetryPolicy::OnTimeout(int64_t now_ms) {
+    attempts_++;
+    return Next(config_.retry_delay_ms, now_ms);
+}
+
+RetryDecision ConnectRetryPolicy::OnConnectError(int64_t now_ms) {
+    attempts_++;
+    return Next(config_.retry_delay_ms, now_ms);
+}
+
+uint32_t ConnectRetryPolicy::RemainingMs(int64_t now_ms) const {
+    return now_ms >= deadline_ms_ ? 0 : (uint32_t)(deadline_ms_ - now_ms);
+}
+
+RetryDecision ConnectRetryPolicy::Next(uint32_t delay_ms, int64_t now_ms) {
+    if (attempts_ >= config_.max_attempts) {
+        return {RetryVerdict::kExhausted, 0};
+    }
+    // 等待结束时已经没有时间做一次尝试
+    if (now_ms + delay_ms >= deadline_ms_) {
+        return {RetryVerdict::kDeadline, 0};
+    }
+    return {RetryVerdict::kRetry, delay_ms};
+}
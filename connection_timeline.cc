@@ -0,0 +1,285 @@
+#include "connection_timeline.h"
+
+#include <cJSON.h>
+#include <esp_timer.h>
+
+static uint32_t NowMs() {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+void ConnectionTimeline::Record(TimelineSource source, TimelinePhase phase, uint16_t arg) {
+    Record(source, phase, arg, NowMs());
+}
+
+void ConnectionTimeline::Record(TimelineSource source, TimelinePhase phase, uint16_t arg, uint32_t time_ms) {
+    uint32_t index = head_.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots_[index & (kCapacity - 1)];
+    // 先把序号清零，读取端看到 0 或前后不一致的序号就会跳过这个槽位
+    slot.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.time_ms.store(time_ms, std::memory_order_relaxed);
+    slot.packed.store((uint32_t)phase | ((uint32_t)source << 8) | ((uint32_t)arg << 16), std::memory_order_relaxed);
+    slot.seq.store(index + 1, std::memory_order_release);
+}
+
+template <typename F>
+void ConnectionTimeline::ForEachEvent(size_t max_count, F&& fn) const {
+    uint32_t head = head_.load(std::memory_order_acquire);
+    uint32_t count = head < kCapacity ? head : kCapacity;
+    if (count > max_count) {
+        count = max_count;
+    }
+    for (uint32_t index = head - count; index != head; index++) {
+        const Slot& slot = slots_[index & (kCapacity - 1)];
+        uint32_t seq = slot.seq.load(std::memory_order_acquire);
+        if (seq != index + 1) {
+            continue;
+        }
+        TimelineEvent event;
+        event.time_ms = slot.time_ms.load(std::memory_order_relaxed);
+        uint32_t packed = slot.packed.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != seq) {
+            continue;   // 读取过程中被覆盖
+        }
+        event.phase = (TimelinePhase)(packed & 0xFF);
+        event.source = (TimelineSource)((packed >> 8) & 0xFF);
+        event.arg = (uint16_t)(packed >> 16);
+        fn(event);
+    }
+}
+
+size_t ConnectionTimeline::GetEvents(TimelineEvent* out, size_t max_count) const {
+    size_t count = 0;
+    ForEachEvent(max_count, [&](const TimelineEvent& event) {
+        out[count++] = event;
+    });
+    return count;
+}
+
+size_t ConnectionTimeline::GetAttempts(ConnectionAttempt* out, size_t max_count) const {
+    if (max_count == 0) {
+        return 0;
+    }
+
+    // 每个来源一条进行中的周期：从发起（或上次结束后的第一个事件）开始，到拿到 IP 或断开结束
+    struct Cycle {
+        bool active;
+        bool has_attempt;
+        bool scanning;
+        bool connected;
+        uint32_t scan_start_ms;
+        uint32_t last_scan_done_ms;
+        uint32_t connect_start_ms;
+        uint32_t connected_ms;
+        ConnectionAttempt attempt;
+    };
+    Cycle cycles[2] = {};
+    uint8_t pending_trigger[2] = {};
+
+    // 输出保留最近 max_count 条，满了覆盖最旧的
+    size_t written = 0;
+    auto emit = [&](const ConnectionAttempt& attempt) {
+        if (written < max_count) {
+            out[written++] = attempt;
+            return;
+        }
+        for (size_t i = 1; i < max_count; i++) {
+            out[i - 1] = out[i];
+        }
+        out[max_count - 1] = attempt;
+    };
+
+    ForEachEvent(kCapacity, [&](const TimelineEvent& event) {
+        size_t source = (size_t)event.source;
+        if (source >= 2) {
+            return;
+        }
+        Cycle& cycle = cycles[source];
+        uint32_t t = event.time_ms;
+
+        auto begin = [&]() {
+            cycle = {};
+            cycle.active = true;
+            cycle.attempt.source = event.source;
+            cycle.attempt.start_ms = t;
+            cycle.attempt.trigger = pending_trigger[source];
+            pending_trigger[source] = 0;
+        };
+
+        if (event.phase == TimelinePhase::kDisconnected && !(cycle.active && cycle.has_attempt)) {
+            // 已连接状态下掉线：不是一次尝试，记下原因作为下一次尝试的触发原因
+            cycle.active = false;
+            pending_trigger[source] = (uint8_t)event.arg;
+            return;
+        }
+        if (event.phase == TimelinePhase::kRequest) {
+            if (cycle.active && cycle.has_attempt) {
+                // 被新的连接请求打断
+                cycle.attempt.result = ConnectionAttempt::kFailed;
+                cycle.attempt.total_ms = t - cycle.attempt.start_ms;
+                emit(cycle.attempt);
+            }
+            begin();
+            return;
+        }
+        if (!cycle.active) {
+            begin();
+        }
+
+        switch (event.phase) {
+        case TimelinePhase::kScanStart:
+            cycle.scanning = true;
+            cycle.scan_start_ms = t;
+            if (cycle.attempt.scans < UINT8_MAX) {
+                cycle.attempt.scans++;
+            }
+            break;
+        case TimelinePhase::kScanDone:
+            if (cycle.scanning) {
+                cycle.attempt.scan_ms += t - cycle.scan_start_ms;
+                cycle.scanning = false;
+            }
+            cycle.last_scan_done_ms = t;
+            break;
+        case TimelinePhase::kCandidate:
+            cycle.has_attempt = true;
+            cycle.attempt.channel = (uint8_t)event.arg;
+            if (cycle.last_scan_done_ms != 0) {
+                cycle.attempt.select_ms = t - cycle.last_scan_done_ms;
+            }
+            break;
+        case TimelinePhase::kConnectStart:
+            cycle.has_attempt = true;
+            cycle.connect_start_ms = t;
+            break;
+        case TimelinePhase::kConnected:
+            cycle.has_attempt = true;
+            if (cycle.connect_start_ms != 0) {
+                cycle.attempt.connect_ms = t - cycle.connect_start_ms;
+            }
+            if (event.arg != 0) {
+                cycle.attempt.channel = (uint8_t)event.arg;
+            }
+            cycle.connected = true;
+            cycle.connected_ms = t;
+            break;
+        case TimelinePhase::kGotIp:
+            if (cycle.has_attempt) {
+                if (cycle.connected) {
+                    cycle.attempt.dhcp_ms = t - cycle.connected_ms;
+                }
+                cycle.attempt.result = ConnectionAttempt::kSuccess;
+                cycle.attempt.total_ms = t - cycle.attempt.start_ms;
+                emit(cycle.attempt);
+            }
+            cycle.active = false;
+            break;
+        case TimelinePhase::kDisconnected:
+            if (cycle.connect_start_ms != 0 && !cycle.connected) {
+                cycle.attempt.connect_ms = t - cycle.connect_start_ms;
+            }
+            cycle.attempt.result = ConnectionAttempt::kFailed;
+            cycle.attempt.reason = (uint8_t)event.arg;
+            cycle.attempt.total_ms = t - cycle.attempt.start_ms;
+            emit(cycle.attempt);
+            cycle.active = false;
+            break;
+        default:
+            break;
+        }
+    });
+
+    // 进行中的尝试计算到当前时间
+    uint32_t now = NowMs();
+    for (auto& cycle : cycles) {
+        if (cycle.active && cycle.has_attempt) {
+            cycle.attempt.result = ConnectionAttempt::kPending;
+            cycle.attempt.total_ms = now - cycle.attempt.start_ms;
+            emit(cycle.attempt);
+        }
+    }
+    return written;
+}
+
+std::string ConnectionTimeline::GetAttemptsJson(size_t max_count) const {
+    ConnectionAttempt attempts[kMaxAttempts];
+    if (max_count > kMaxAttempts) {
+        max_count = kMaxAttempts;
+    }
+    size_t count = GetAttempts(attempts, max_count);
+
+    static const char* kResults[] = {"pending", "success", "failed"};
+    cJSON* root = cJSON_CreateObject();
+    cJSON* array = cJSON_AddArrayToObject(root, "attempts");
+    for (size_t i = 0; i < count; i++) {
+        const auto& attempt = attempts[i];
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "source", attempt.source == TimelineSource::kStation ? "station" : "manager");
+        cJSON_AddStringToObject(item, "result", kResults[attempt.result]);
+        cJSON_AddNumberToObject(item, "reason", attempt.reason);
+        cJSON_AddNumberToObject(item, "trigger", attempt.trigger);
+        cJSON_AddNumberToObject(item, "channel", attempt.channel);
+        cJSON_AddNumberToObject(item, "scans", attempt.scans);
+        cJSON_AddNumberToObject(item, "start_ms", attempt.start_ms);
+        cJSON_AddNumberToObject(item, "scan_ms", attempt.scan_ms);
+        cJSON_AddNumberToObject(item, "select_ms", attempt.select_ms);
+        cJSON_AddNumberToObject(item, "connect_ms", attempt.connect_ms);
+        cJSON_AddNumberToObject(item, "dhcp_ms", attempt.dhcp_ms);
+        cJSON_AddNumberToObject(item, "total_ms", attempt.total_ms);
+        cJSON_AddItemToArray(array, item);
+    }
+    char* printed = cJSON_PrintUnformatted(root);
+    std::string json = printed != nullptr ? printed : "{}";
+    cJSON_free(printed);
+    cJSON_Delete(root);
+    return json;
+}
+
+static uint8_t* PutU32(uint8_t* p, uint32_t value) {
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+    p[2] = (value >> 16) & 0xFF;
+    p[3] = (value >> 24) & 0xFF;
+    return p + 4;
+}
+
+size_t ConnectionTimeline::GetAttemptsBinary(uint8_t* out, size_t out_size, size_t max_count) const {
+    if (out_size < 1) {
+        return 0;
+    }
+    ConnectionAttempt attempts[kMaxAttempts];
+    if (max_count > kMaxAttempts) {
+        max_count = kMaxAttempts;
+    }
+    if (max_count > (out_size - 1) / kBinaryAttemptSize) {
+        max_count = (out_size - 1) / kBinaryAttemptSize;
+    }
+    size_t count = GetAttempts(attempts, max_count);
+
+    uint8_t* p = out;
+    *p++ = (uint8_t)count;
+    for (size_t i = 0; i < count; i++) {
+        const auto& attempt = attempts[i];
+        *p++ = (uint8_t)attempt.source;
+        *p++ = attempt.result;
+        *p++ = attempt.reason;
+        *p++ = attempt.trigger;
+        *p++ = attempt.channel;
+        *p++ = attempt.scans;
+        p = PutU32(p, attempt.start_ms);
+        p = PutU32(p, attempt.scan_ms);
+        p = PutU32(p, attempt.select_ms);
+        p = PutU32(p, attempt.connect_ms);
+        p = PutU32(p, attempt.dhcp_ms);
+        p = PutU32(p, attempt.total_ms);
+    }
+    return p - out;
+}
+
+void ConnectionTimeline::Clear() {
+    // 把所有槽位标记为空，读取端会跳过它们
+    for (auto& slot : slots_) {
+        slot.seq.store(0, std::memory_order_relaxed);
+    }
+}
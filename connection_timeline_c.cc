@@ -0,0 +1,10 @@
+#include "connection_timeline.h"
+#include "connection_timeline_c.h"
+
+extern "C" {
+
+size_t connection_timeline_get_binary(uint8_t* out, size_t out_size) {
+    return ConnectionTimeline::GetInstance().GetAttemptsBinary(out, out_size);
+}
+
+}
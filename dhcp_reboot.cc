@@ -0,0 +1,25 @@
+#include "dhcp_reboot.h"
+
+#include <lwip/init.h>
+#include <lwip/dhcp.h>
+#include <lwip/prot/dhcp.h>
+
+bool DhcpRequestCachedAddress(struct netif* netif, uint32_t ip) {
+    struct dhcp* dhcp = netif_dhcp_data(netif);
+    if (dhcp == nullptr || ip == 0) {
+        return false;
+    }
+    // 已经收到 OFFER（REQUESTING）或已绑定时不打断正常流程
+    if (dhcp->state != DHCP_STATE_SELECTING) {
+        return false;
+    }
+    ip4_addr_set_u32(&dhcp->offered_ip_addr, ip);
+    // 链路变化的处理对 REBOOTING 状态执行 dhcp_reboot()，这是 lwIP 里唯一公开的入口
+    dhcp->state = DHCP_STATE_REBOOTING;
+#if LWIP_VERSION_MAJOR > 2 || (LWIP_VERSION_MAJOR == 2 && LWIP_VERSION_MINOR >= 2)
+    dhcp_network_changed_link_up(netif);
+#else
+    dhcp_network_changed(netif);
+#endif
+    return true;
+}
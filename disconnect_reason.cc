@@ -0,0 +1,161 @@
+#include "disconnect_reason.h"
+
+#include <esp_wifi_types_generic.h>
+
+const char* DisconnectReasonString(uint16_t reason) {
+    switch (reason) {
+        case WIFI_REASON_UNSPECIFIED:
+            return "Unspecified reason";
+        case WIFI_REASON_AUTH_EXPIRE:
+            return "Authentication expired";
+        case WIFI_REASON_AUTH_LEAVE:
+            return "Authentication left";
+        case WIFI_REASON_ASSOC_EXPIRE:
+            return "Association expired";
+        case WIFI_REASON_ASSOC_TOOMANY:
+            return "Too many associations";
+        case WIFI_REASON_NOT_AUTHED:
+            return "Not authenticated";
+        case WIFI_REASON_NOT_ASSOCED:
+            return "Not associated";
+        case WIFI_REASON_ASSOC_LEAVE:
+            return "Association left";
+        case WIFI_REASON_ASSOC_NOT_AUTHED:
+            return "Associated but not authenticated";
+        case WIFI_REASON_DISASSOC_PWRCAP_BAD:
+            return "Power capability mismatch";
+        case WIFI_REASON_DISASSOC_SUPCHAN_BAD:
+            return "Supported channel mismatch";
+        case WIFI_REASON_BSS_TRANSITION_DISASSOC:
+            return "BSS transition disassociation";
+        case WIFI_REASON_IE_INVALID:
+            return "Invalid IE";
+        case WIFI_REASON_MIC_FAILURE:
+            return "MIC failure";
+        case WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT:
+            return "4-way handshake timeout";
+        case WIFI_REASON_GROUP_KEY_UPDATE_TIMEOUT:
+            return "Group key update timeout";
+        case WIFI_REASON_IE_IN_4WAY_DIFFERS:
+            return "4-way handshake IE differs";
+        case WIFI_REASON_GROUP_CIPHER_INVALID:
+            return "Group cipher invalid";
+        case WIFI_REASON_PAIRWISE_CIPHER_INVALID:
+            return "Pairwise cipher invalid";
+        case WIFI_REASON_AKMP_INVALID:
+            return "AKMP invalid";
+        case WIFI_REASON_UNSUPP_RSN_IE_VERSION:
+            return "Unsupported RSN IE version";
+        case WIFI_REASON_INVALID_RSN_IE_CAP:
+            return "Invalid RSN IE capability";
+        case WIFI_REASON_802_1X_AUTH_FAILED:
+            return "802.1x authentication failed";
+        case WIFI_REASON_CIPHER_SUITE_REJECTED:
+            return "Cipher suite rejected";
+        case WIFI_REASON_TDLS_PEER_UNREACHABLE:
+            return "TDLS peer unreachable";
+        case WIFI_REASON_TDLS_UNSPECIFIED:
+            return "TDLS unspecified";
+        case WIFI_REASON_SSP_REQUESTED_DISASSOC:
+            return "SSP requested disassociation";
+        case WIFI_REASON_NO_SSP_ROAMING_AGREEMENT:
+            return "No SSP roaming agreement";
+        case WIFI_REASON_BAD_CIPHER_OR_AKM:
+            return "Bad cipher or AKM";
+        case WIFI_REASON_NOT_AUTHORIZED_THIS_LOCATION:
+            return "Not authorized for this location";
+        case WIFI_REASON_SERVICE_CHANGE_PERCLUDES_TS:
+            return "Service change precludes TS";
+        case WIFI_REASON_UNSPECIFIED_QOS:
+            return "Unspecified QoS";
+        case WIFI_REASON_NOT_ENOUGH_BANDWIDTH:
+            return "Not enough bandwidth";
+        case WIFI_REASON_MISSING_ACKS:
+            return "Missing ACKs";
+        case WIFI_REASON_EXCEEDED_TXOP:
+            return "Exceeded TXOP";
+        case WIFI_REASON_STA_LEAVING:
+            return "Station leaving";
+        case WIFI_REASON_END_BA:
+            return "End BA";
+        case WIFI_REASON_UNKNOWN_BA:
+            return "Unknown BA";
+        case WIFI_REASON_TIMEOUT:
+            return "Timeout";
+        case WIFI_REASON_PEER_INITIATED:
+            return "Peer initiated";
+        case WIFI_REASON_AP_INITIATED:
+            return "AP initiated";
+        case WIFI_REASON_INVALID_FT_ACTION_FRAME_COUNT:
+            return "Invalid FT action frame count";
+        case WIFI_REASON_INVALID_PMKID:
+            return "Invalid PMKID";
+        case WIFI_REASON_INVALID_MDE:
+            return "Invalid MDE";
+        case WIFI_REASON_INVALID_FTE:
+            return "Invalid FTE";
+        case WIFI_REASON_TRANSMISSION_LINK_ESTABLISH_FAILED:
+            return "Transmission link establish failed";
+        case WIFI_REASON_ALTERATIVE_CHANNEL_OCCUPIED:
+            return "Alternative channel occupied";
+        case WIFI_REASON_BEACON_TIMEOUT:
+            return "Beacon timeout";
+        case WIFI_REASON_NO_AP_FOUND:
+            return "No AP found";
+        case WIFI_REASON_AUTH_FAIL:
+            return "Authentication failed";
+        case WIFI_REASON_ASSOC_FAIL:
+            return "Association failed";
+        case WIFI_REASON_HANDSHAKE_TIMEOUT:
+            return "Handshake timeout";
+        case WIFI_REASON_CONNECTION_FAIL:
+            return "Connection failed";
+        case WIFI_REASON_AP_TSF_RESET:
+            return "AP TSF reset";
+        case WIFI_REASON_ROAMING:
+            return "Roaming";
+        case WIFI_REASON_ASSOC_COMEBACK_TIME_TOO_LONG:
+            return "Association comeback time too long";
+        case WIFI_REASON_SA_QUERY_TIMEOUT:
+            return "SA query timeout";
+        case WIFI_REASON_NO_AP_FOUND_W_COMPATIBLE_SECURITY:
+            return "No AP found with compatible security";
+        case WIFI_REASON_NO_AP_FOUND_IN_AUTHMODE_THRESHOLD:
+            return "No AP found in authmode threshold";
+        case WIFI_REASON_NO_AP_FOUND_IN_RSSI_THRESHOLD:
+            return "No AP found in RSSI threshold";
+        default:
+            return "Unknown reason";
+    }
+}
+
+DisconnectClass ClassifyDisconnect(uint16_t reason) {
+    switch (reason) {
+        // 密码错误在 IDF 中通常表现为四次握手超时
+        case WIFI_REASON_AUTH_FAIL:
+        case WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT:
+        case WIFI_REASON_HANDSHAKE_TIMEOUT:
+        case WIFI_REASON_MIC_FAILURE:
+        case WIFI_REASON_802_1X_AUTH_FAILED:
+            return DisconnectClass::kCredential;
+        case WIFI_REASON_CIPHER_SUITE_REJECTED:
+        case WIFI_REASON_GROUP_CIPHER_INVALID:
+        case WIFI_REASON_PAIRWISE_CIPHER_INVALID:
+        case WIFI_REASON_AKMP_INVALID:
+        case WIFI_REASON_UNSUPP_RSN_IE_VERSION:
+        case WIFI_REASON_INVALID_RSN_IE_CAP:
+        case WIFI_REASON_BAD_CIPHER_OR_AKM:
+        case WIFI_REASON_NO_AP_FOUND_W_COMPATIBLE_SECURITY:
+        case WIFI_REASON_NO_AP_FOUND_IN_AUTHMODE_THRESHOLD:
+            return DisconnectClass::kIncompatible;
+        case WIFI_REASON_NO_AP_FOUND:
+        case WIFI_REASON_NO_AP_FOUND_IN_RSSI_THRESHOLD:
+            return DisconnectClass::kNotFound;
+        case WIFI_REASON_ASSOC_LEAVE:
+            return DisconnectClass::kLocal;
+        case WIFI_REASON_ASSOC_TOOMANY:
+            return DisconnectClass::kOverloaded;
+        default:
+            return DisconnectClass::kTransient;
+    }
+}
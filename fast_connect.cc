@@ -0,0 +1,104 @@
+#include "fast_connect.h"
+
+#include <algorithm>
+#include <cstring>
+
+wifi_auth_mode_t AuthThresholdFor(wifi_auth_mode_t authmode) {
+    switch (authmode) {
+    case WIFI_AUTH_WEP:
+    case WIFI_AUTH_WPA_PSK:
+    case WIFI_AUTH_WPA2_PSK:
+    case WIFI_AUTH_WPA3_PSK:
+        return authmode;
+    case WIFI_AUTH_WPA_WPA2_PSK:
+        return WIFI_AUTH_WPA_PSK;
+    case WIFI_AUTH_WPA2_WPA3_PSK:
+        return WIFI_AUTH_WPA2_PSK;
+    default:
+        // 企业认证、OWE、WAPI 等不按门限的强弱排列，不设门限
+        return WIFI_AUTH_OPEN;
+    }
+}
+
+void LockStaConfig(wifi_sta_config_t* sta, const uint8_t bssid[6], uint8_t channel, wifi_auth_mode_t authmode) {
+    sta->channel = channel;
+    memcpy(sta->bssid, bssid, 6);
+    sta->bssid_set = true;
+    sta->threshold.authmode = AuthThresholdFor(authmode);
+}
+
+void FastConnect::Load(const LastApRecord& record, uint8_t failures) {
+    record_ = record;
+    record_.ssid[sizeof(record_.ssid) - 1] = '\0';
+    valid_ = true;
+    failures_ = failures;
+}
+
+void FastConnect::Clear() {
+    record_ = {};
+    valid_ = false;
+    failures_ = 0;
+}
+
+int FastConnect::FindSaved(const std::vector<SsidItem>& ssid_list) const {
+    if (!valid_) {
+        return -1;
+    }
+    if (record_.ssid_index < ssid_list.size() && ssid_list[record_.ssid_index].ssid == record_.ssid) {
+        return record_.ssid_index;
+    }
+    for (size_t i = 0; i < ssid_list.size(); i++) {
+        if (ssid_list[i].ssid == record_.ssid) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int FastConnect::Begin(const std::vector<SsidItem>& ssid_list, uint32_t now_ms, wifi_sta_config_t* sta) {
+    int index = FindSaved(ssid_list);
+    if (index < 0) {
+        return -1;
+    }
+    if (sta != nullptr) {
+        const auto& item = ssid_list[index];
+        *sta = {};
+        // sta.ssid / sta.password 为定长字段，满长时不带结尾的 0
+        memcpy(sta->ssid, item.ssid.data(), std::min(item.ssid.size(), sizeof(sta->ssid)));
+        memcpy(sta->password, item.password.data(), std::min(item.password.size(), sizeof(sta->password)));
+        LockStaConfig(sta, record_.bssid, record_.channel, static_cast<wifi_auth_mode_t>(record_.authmode));
+    }
+    state_ = State::kActive;
+    started_ms_ = now_ms;
+    return index;
+}
+
+bool FastConnect::OnTimeout() {
+    if (state_ != State::kActive) {
+        return false;
+    }
+    state_ = State::kAborting;
+    return true;
+}
+
+bool FastConnect::OnAssociated() {
+    if (state_ == State::kNone) {
+        return false;
+    }
+    // 时限只覆盖关联，DHCP 的耗时不算快速重连失败；之后的失败按正常流程处理
+    state_ = State::kNone;
+    bool had_failures = failures_ != 0;
+    failures_ = 0;
+    return had_failures;
+}
+
+bool FastConnect::OnFailed() {
+    state_ = State::kNone;
+    failures_++;
+    // 连续多次失败，记录多半已失效（AP 更换信道、关机或密码变更），避免每次开机都付出超时代价
+    if (failures_ >= kMaxFailures) {
+        Clear();
+        return true;
+    }
+    return false;
+}
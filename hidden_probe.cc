@@ -0,0 +1,103 @@
+#include "hidden_probe.h"
+
+HiddenProbeScheduler::Entry* HiddenProbeScheduler::FindOrCreate(uint32_t hash) {
+    Entry* empty = nullptr;
+    for (auto& entry : entries_) {
+        if (entry.used && entry.hash == hash) {
+            return &entry;
+        }
+        if (!entry.used && empty == nullptr) {
+            empty = &entry;
+        }
+    }
+    if (empty == nullptr) {
+        // 表满时复用一个可见网络的槽位，它们丢失记录的代价最小（最多多探测一次）
+        for (auto& entry : entries_) {
+            if (entry.visibility != Visibility::kHidden) {
+                empty = &entry;
+                break;
+            }
+        }
+        if (empty == nullptr) {
+            empty = &entries_[0];
+        }
+    }
+    *empty = {};
+    empty->hash = hash;
+    empty->used = true;
+    return empty;
+}
+
+void HiddenProbeScheduler::MarkVisible(uint32_t ssid_hash) {
+    Entry* entry = FindOrCreate(ssid_hash);
+    entry->visibility = Visibility::kVisible;
+    entry->seen = true;
+    entry->missed_scans = 0;
+}
+
+void HiddenProbeScheduler::MarkHidden(uint32_t ssid_hash) {
+    FindOrCreate(ssid_hash)->visibility = Visibility::kHidden;
+}
+
+void HiddenProbeScheduler::HintHidden(uint32_t ssid_hash) {
+    if (GetVisibility(ssid_hash) == Visibility::kUnknown) {
+        MarkHidden(ssid_hash);
+    }
+}
+
+void HiddenProbeScheduler::EndBroadcastScan() {
+    for (auto& entry : entries_) {
+        if (!entry.used || entry.visibility != Visibility::kVisible) {
+            continue;
+        }
+        // AP 可能改成了隐藏 SSID，也可能只是不在附近；回到未知后由定向探测重新确认
+        if (!entry.seen && ++entry.missed_scans >= kMaxMissedScans) {
+            entry.visibility = Visibility::kUnknown;
+            entry.missed_scans = 0;
+        }
+        entry.seen = false;
+    }
+}
+
+HiddenProbeScheduler::Visibility HiddenProbeScheduler::GetVisibility(uint32_t ssid_hash) const {
+    for (const auto& entry : entries_) {
+        if (entry.used && entry.hash == ssid_hash) {
+            return entry.visibility;
+        }
+    }
+    return Visibility::kUnknown;
+}
+
+void HiddenProbeScheduler::Clear() {
+    for (auto& entry : entries_) {
+        entry = {};
+    }
+    cursor_ = 0;
+}
+
+size_t HiddenProbeScheduler::BuildBatch(const uint32_t* saved_hashes, size_t count, uint8_t* out_indexes) {
+    if (count == 0) {
+        return 0;
+    }
+    if (cursor_ >= count) {
+        cursor_ = 0;
+    }
+
+    // 第一遍取已确认隐藏的网络，第二遍取状态未知的网络，都从轮换游标开始
+    size_t batch = 0;
+    size_t last = cursor_;
+    for (int pass = 0; pass < 2 && batch < kBatchSize; pass++) {
+        Visibility wanted = pass == 0 ? Visibility::kHidden : Visibility::kUnknown;
+        for (size_t i = 0; i < count && batch < kBatchSize; i++) {
+            size_t index = (cursor_ + i) % count;
+            if (GetVisibility(saved_hashes[index]) == wanted) {
+                out_indexes[batch++] = index;
+                last = index;
+            }
+        }
+    }
+    if (batch > 0) {
+        cursor_ = (last + 1) % count;
+    }
+    return batch;
+}
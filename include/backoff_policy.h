@@ -0,0 +1,42 @@
+#ifndef BACKOFF_POLICY_H
+#define BACKOFF_POLICY_H
+
+#include <cstdint>
+
+// 重连/重新扫描的退避策略接口，WifiStation 通过它决定下一次尝试前的等待时间
+class BackoffPolicy {
+public:
+    virtual ~BackoffPolicy() = default;
+
+    // 返回下一次尝试前需要等待的毫秒数，并推进内部的尝试计数
+    virtual uint32_t NextDelayMs() = 0;
+    // 连接成功后调用，回到初始状态
+    virtual void Reset() = 0;
+    // 自上次 Reset 以来已经退避的次数
+    virtual int GetAttempt() const = 0;
+};
+
+// 带完全抖动（full jitter）的指数退避：delay = random(min, min(cap, base * 2^attempt))
+// 随机数种子来自设备 MAC，同一栋楼里的设备在路由器重启后不会同步重连
+class ExponentialBackoff : public BackoffPolicy {
+public:
+    ExponentialBackoff(uint32_t base_ms, uint32_t cap_ms, uint32_t seed, uint32_t min_ms = 100);
+
+    uint32_t NextDelayMs() override;
+    void Reset() override { attempt_ = 0; }
+    int GetAttempt() const override { return attempt_; }
+
+    // 由 6 字节 MAC 生成随机数种子
+    static uint32_t SeedFromMac(const uint8_t* mac);
+
+private:
+    uint32_t NextRandom();
+
+    uint32_t base_ms_;
+    uint32_t cap_ms_;
+    uint32_t min_ms_;
+    uint32_t state_;
+    int attempt_ = 0;
+};
+
+#endif // BACKOFF_POLICY_H
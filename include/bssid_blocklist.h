@@ -0,0 +1,57 @@
+#ifndef BSSID_BLOCKLIST_H
+#define BSSID_BLOCKLIST_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "disconnect_reason.h"
+
+// 黑名单中的一条记录，供诊断查看
+struct BlocklistEntry {
+    uint8_t bssid[6];
+    DisconnectClass last_class;     // 最近一次失败的分类
+    uint8_t strikes;                // 未衰减的失败次数
+    uint32_t blocked_ms;            // 剩余屏蔽时间，0 表示只记录失败、没有屏蔽
+    uint32_t since_failure_ms;      // 距最近一次失败的时间
+};
+
+// 按 BSSID 记录连接失败，按失败分类屏蔽一段时间，避免在过载或配置错误的 AP 上反复尝试
+// 屏蔽时间随连续失败次数翻倍，失败次数每 kDecayMs 衰减一次，成功连接后清除
+// 所有存储都是定长的，不依赖 ESP-IDF 运行时，可以在主机上单独测试
+class BssidBlocklist {
+public:
+    static constexpr size_t kCapacity = 16;
+    static constexpr uint32_t kMaxBlockMs = 10 * 60 * 1000;
+    static constexpr uint32_t kDecayMs = 5 * 60 * 1000;
+    // 偶发失败连续这么多次才屏蔽
+    static constexpr uint8_t kTransientStrikes = 2;
+
+    void OnFailure(const uint8_t* bssid, DisconnectClass cls, uint32_t now_ms);
+    void OnSuccess(const uint8_t* bssid);
+    bool IsBlocked(const uint8_t* bssid, uint32_t now_ms) const;
+
+    // 衰减失败次数并删除过期记录，每次处理扫描结果前调用
+    void Expire(uint32_t now_ms);
+    size_t GetEntries(BlocklistEntry* out, size_t max_count, uint32_t now_ms) const;
+    void Clear();
+
+    // 各分类第一次屏蔽的时长，0 表示该分类不屏蔽
+    static uint32_t BaseBlockMs(DisconnectClass cls);
+
+private:
+    struct Entry {
+        uint64_t bssid;
+        uint32_t blocked_until_ms;
+        uint32_t last_failure_ms;
+        DisconnectClass last_class;
+        uint8_t strikes;
+        bool used;
+    };
+
+    Entry* Find(uint64_t bssid);
+    const Entry* Find(uint64_t bssid) const;
+
+    Entry entries_[kCapacity] = {};
+};
+
+#endif // BSSID_BLOCKLIST_H
@@ -0,0 +1,113 @@
+#ifndef CANDIDATE_SCORER_H
+#define CANDIDATE_SCORER_H
+
+#include <array>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include <esp_wifi_types_generic.h>
+
+// 候选 AP 评分权重，可在运行时调整
+struct ScoreWeights {
+    int rssi = 2;                   // 平滑 RSSI 每 dBm 的分值（以 -100 dBm 为 0 分）
+    int rssi_alpha_percent = 30;    // RSSI EWMA 平滑系数，越大越跟随最新值
+    int success = 8;                // 每次历史成功的加分
+    int failure = 25;               // 每次历史失败的扣分
+    int max_history_count = 8;      // 成功/失败计数参与评分的上限
+    int secure_auth = 5;            // WPA2 及以上加密方式的加分
+    int band_5g_rssi_offset = 10;   // 5 GHz 在 RSSI 上的加成（dB），可用的 5 GHz AP 优先于更响的 2.4 GHz AP
+    int band_5g_min_rssi = -72;     // 5 GHz 平滑 RSSI 低于该值视为不可用，不享受加成
+    int recency = 20;               // 刚成功连接过的满额加分，随时间线性衰减
+    int recency_window_s = 3600;    // 最近成功加分的衰减窗口
+};
+
+// 单个候选的评分明细，用于诊断
+struct ScoreBreakdown {
+    uint8_t bssid[6];
+    uint8_t channel;
+    wifi_auth_mode_t authmode;
+    int8_t rssi;                    // 本次扫描的 RSSI
+    int8_t smoothed_rssi;           // 平滑后的 RSSI
+    uint8_t successes;
+    uint8_t failures;
+    int32_t since_success_s;        // 距上次成功连接的秒数，-1 表示从未成功
+    int32_t score;
+};
+
+// 基于历史表现的候选 AP 评分器，按 BSSID 记录平滑 RSSI 与成功/失败次数
+// 所有存储都是定长的，不依赖 ESP-IDF 运行时，可以在主机上单独测试
+class CandidateScorer {
+public:
+    static constexpr size_t kHistorySize = 16;
+    static constexpr size_t kMaxScores = 16;
+
+    void SetWeights(const ScoreWeights& weights) { weights_ = weights; }
+    const ScoreWeights& GetWeights() const { return weights_; }
+
+    // 开始新一轮评分（一次扫描结果），清空上一轮的诊断明细
+    void BeginRound() { score_count_ = 0; }
+    int32_t Score(const uint8_t* bssid, int8_t rssi, wifi_auth_mode_t authmode, uint8_t channel, int64_t now_us);
+
+    void RecordSuccess(const uint8_t* bssid, int64_t now_us);
+    void RecordFailure(const uint8_t* bssid, int64_t now_us);
+    void Clear();
+
+    // 拷贝最近一轮的评分明细，返回条数
+    size_t GetLastScores(ScoreBreakdown* out, size_t max_count) const;
+
+private:
+    struct History {
+        uint64_t bssid;
+        int16_t smoothed_rssi_x16;  // 定点数，放大 16 倍
+        uint8_t successes;
+        uint8_t failures;
+        int64_t last_success_us;    // 0 表示从未成功
+        int64_t last_used_us;
+        bool used;
+    };
+
+    History* FindOrCreate(uint64_t bssid, int64_t now_us);
+
+    ScoreWeights weights_;
+    History history_[kHistorySize] = {};
+    ScoreBreakdown scores_[kMaxScores] = {};
+    size_t score_count_ = 0;
+};
+
+// 定长候选堆：按 score 取最大值，满时淘汰得分最低的候选，不做动态分配
+template <typename T, size_t Capacity>
+class CandidateQueue {
+public:
+    bool empty() const { return count_ == 0; }
+    size_t size() const { return count_; }
+    void clear() { count_ = 0; }
+    const T& top() const { return items_[0]; }
+
+    void push(const T& item) {
+        if (count_ < Capacity) {
+            items_[count_++] = item;
+            std::push_heap(items_.begin(), items_.begin() + count_, Less);
+            return;
+        }
+        // 已满：最小值一定在叶子节点，替换后重新建堆
+        auto min_it = std::min_element(items_.begin() + count_ / 2, items_.begin() + count_, Less);
+        if (Less(*min_it, item)) {
+            *min_it = item;
+            std::make_heap(items_.begin(), items_.begin() + count_, Less);
+        }
+    }
+
+    T pop() {
+        std::pop_heap(items_.begin(), items_.begin() + count_, Less);
+        return items_[--count_];
+    }
+
+private:
+    static bool Less(const T& a, const T& b) { return a.score < b.score; }
+
+    std::array<T, Capacity> items_;
+    size_t count_ = 0;
+};
+
+#endif // CANDIDATE_SCORER_H
@@ -0,0 +1,64 @@
+#ifndef CONNECT_ATTEMPT_LOOP_H
+#define CONNECT_ATTEMPT_LOOP_H
+
+#include <cstdint>
+
+#include <esp_err.h>
+
+#include "connect_retry_policy.h"
+
+// 尝试循环用到的驱动接口：WifiConnectionManager 用 esp_wifi_connect 和 esp_timer 实现，
+// 主机测试用虚拟时钟实现。所有调用都在调用者持有的锁内发生
+class ConnectAttemptDriver {
+public:
+    virtual ~ConnectAttemptDriver() = default;
+    // 发起一次关联，失败时返回错误码，结果之后以连接/断开事件送回
+    virtual esp_err_t StartConnect() = 0;
+    // 单次定时器，重新装填会取消上一次；到期后调用 ConnectAttemptLoop::OnTimer
+    virtual void ArmTimer(uint32_t ms) = 0;
+    virtual void StopTimer() = 0;
+};
+
+// 一次配网连接请求的尝试循环：发起连接，等待连接/断开事件或单次超时，按 ConnectRetryPolicy
+// 在间隔后重试或结束。每次尝试写入 ConnectReport 的当前记录，请求的开始和结束由调用者记录
+// 返回 kRetry 表示请求仍在进行（或事件与当前阶段无关被忽略），其他判定表示请求已结束
+class ConnectAttemptLoop {
+public:
+    enum class Phase : uint8_t { kIdle, kWaiting, kRetryDelay };
+
+    explicit ConnectAttemptLoop(ConnectAttemptDriver& driver) : driver_(driver) {}
+
+    // 单次等待不超过 min(attempt_timeout_ms, 距总截止时间的剩余)
+    // rssi、channel 为扫描结果中的目标 AP，事件不带这些信息时写入诊断记录
+    RetryDecision Begin(const RetryPolicyConfig& policy, uint32_t attempt_timeout_ms, bool psk_ap,
+                        int8_t rssi, uint8_t channel, int64_t now_ms);
+    // 定时器到期：等待中为超时，重试间隔中为发起下一次尝试。
+    // 定时器被重新装填前已在排队的旧回调按截止时间丢弃
+    RetryDecision OnTimer(int64_t now_ms);
+    // rssi 为 0 时使用目标 AP 的 RSSI；重试间隔中到达的断开原因补充到上一次（超时的）尝试
+    RetryDecision OnDisconnect(uint16_t reason, int8_t rssi, int64_t now_ms);
+    // 等待中收到连接事件时记录并结束循环，返回 true
+    bool OnConnected(int8_t rssi, uint8_t channel, int64_t now_ms);
+    // 请求被取消或已结束
+    void Stop();
+
+    Phase phase() const { return phase_; }
+    bool Active() const { return phase_ != Phase::kIdle; }
+    // 已结束的尝试次数
+    int attempts() const { return policy_.GetAttempts(); }
+
+private:
+    RetryDecision StartAttempt(int64_t now_ms);
+    RetryDecision Apply(const RetryDecision& decision, int64_t now_ms);
+    void Arm(uint32_t ms, int64_t now_ms);
+
+    ConnectAttemptDriver& driver_;
+    ConnectRetryPolicy policy_;
+    Phase phase_ = Phase::kIdle;
+    uint32_t attempt_timeout_ms_ = 0;
+    int64_t timer_deadline_ms_ = 0;
+    int8_t target_rssi_ = 0;
+    uint8_t target_channel_ = 0;
+};
+
+#endif // CONNECT_ATTEMPT_LOOP_H
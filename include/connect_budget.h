@@ -0,0 +1,71 @@
+#ifndef CONNECT_BUDGET_H
+#define CONNECT_BUDGET_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 连接预算：同一个 SSID 的所有 BSSID 共用次数与时间预算，一轮连接有总时限
+struct ConnectBudgetConfig {
+    uint8_t max_attempts_per_ssid = 4;      // 每个 SSID 本轮最多发起的连接次数（含重连）
+    uint32_t ssid_budget_ms = 20 * 1000;    // 每个 SSID 从第一次尝试算起的时间预算
+    uint32_t cycle_deadline_ms = 60 * 1000; // 一轮连接的总时限，超时后停止尝试，等待下一次扫描
+};
+
+// 连接耗时统计
+struct ConnectCycleReport {
+    uint32_t cycles;            // 结束的轮数
+    uint32_t successes;
+    uint32_t exhausted;         // 候选或预算用完仍未连上
+    uint32_t deadline_hits;     // 因总时限结束
+    uint32_t last_duration_ms;  // 最近一轮从开始到结束的耗时
+    uint32_t worst_duration_ms; // 成功连接的最坏耗时
+    uint16_t last_attempts;     // 最近一轮的连接次数
+    uint16_t worst_attempts;
+};
+
+// 一轮连接从第一次发起连接开始，到拿到 IP 或放弃为止
+// 所有存储都是定长的，不依赖 ESP-IDF 运行时，可以在主机上单独测试
+class ConnectBudget {
+public:
+    static constexpr size_t kMaxSsids = 16;
+
+    void SetConfig(const ConnectBudgetConfig& config) { config_ = config; }
+    const ConnectBudgetConfig& GetConfig() const { return config_; }
+    const ConnectCycleReport& GetReport() const { return report_; }
+
+    bool InCycle() const { return in_cycle_; }
+    void BeginCycle(uint32_t now_ms);
+    // 放弃当前一轮且不计入统计（例如被新的连接请求打断）
+    void AbortCycle() { in_cycle_ = false; }
+
+    // 该 SSID 是否还能发起连接（次数、时间预算，以及整轮时限）
+    bool CanAttempt(uint32_t ssid_hash, uint32_t now_ms) const;
+    bool DeadlineExpired(uint32_t now_ms) const;
+    void OnAttempt(uint32_t ssid_hash, uint32_t now_ms);
+    // 连接失败，definitive 为 true 时本轮不再尝试该 SSID
+    void OnFailure(uint32_t ssid_hash, bool definitive);
+
+    // 结束本轮：success 为 false 时 deadline 表示是否因总时限结束
+    void EndCycle(bool success, bool deadline, uint32_t now_ms);
+
+private:
+    struct Entry {
+        uint32_t hash;
+        uint32_t first_attempt_ms;
+        uint8_t attempts;
+        bool blocked;
+        bool used;
+    };
+
+    Entry* Find(uint32_t hash);
+    const Entry* Find(uint32_t hash) const;
+
+    ConnectBudgetConfig config_;
+    ConnectCycleReport report_ = {};
+    Entry entries_[kMaxSsids] = {};
+    uint32_t cycle_start_ms_ = 0;
+    uint16_t cycle_attempts_ = 0;
+    bool in_cycle_ = false;
+};
+
+#endif // CONNECT_BUDGET_H
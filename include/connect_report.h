@@ -0,0 +1,111 @@
+#ifndef CONNECT_REPORT_H
+#define CONNECT_REPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// 单次尝试的结束方式
+enum class AttemptOutcome : uint8_t {
+    kPending = 0,
+    kConnected,
+    kDisconnected,      // 收到断开事件
+    kTimeout,           // 等待超时
+    kConnectError,      // esp_wifi_connect 调用失败
+    kCancelled,
+};
+
+// 一次连接请求的最终分类
+enum class ConnectOutcome : uint8_t {
+    kPending = 0,
+    kConnected,
+    kWrongPassword,
+    kIncompatible,
+    kDeadline,
+    kExhausted,
+    kCancelled,
+    kInvalid,           // 参数非法或 set_config 失败
+};
+
+struct AttemptRecord {
+    AttemptOutcome outcome;
+    uint8_t reason;         // 断开原因，没有时为 0
+    int8_t rssi;            // 断开事件或扫描结果中的 RSSI，未知为 0
+    uint8_t channel;        // 未知为 0
+    uint16_t error;         // esp_err_t 低 16 位（WiFi 错误码都在 0x3000 段）
+    uint16_t wait_ms;       // 上一次尝试结束（或请求开始）到本次发起的等待
+    uint16_t duration_ms;   // 发起到结束
+};
+
+// 一次 WifiConnectionManager 连接请求的诊断记录
+struct ConnectRecord {
+    static constexpr size_t kMaxAttempts = 8;
+
+    uint32_t seq;
+    uint32_t start_ms;      // 自启动以来的毫秒数
+    uint32_t total_ms;
+    int32_t result;         // 回调收到的 esp_err_t
+    ConnectOutcome outcome;
+    bool psk_ap;            // 扫描结果中该 SSID 是 WPA/WPA2-PSK
+    uint8_t attempt_count;
+    char ssid[33];
+    AttemptRecord attempts[kMaxAttempts];
+};
+
+const char* ConnectOutcomeName(ConnectOutcome outcome);
+const char* AttemptOutcomeName(AttemptOutcome outcome);
+
+// 配网连接诊断：每次请求一条记录，保留最近 kHistory 条
+// 记录写入预先分配的环形缓冲区，不分配内存；内部加锁，可以在 HTTP/BLE 任务中导出
+class ConnectReport {
+public:
+    static constexpr size_t kHistory = 8;
+    static constexpr uint8_t kBinaryVersion = 1;
+    // 二进制格式中每条记录除 SSID 和尝试明细以外的字节数，以及每次尝试的字节数
+    static constexpr size_t kBinaryRecordHeaderSize = 20;
+    static constexpr size_t kBinaryAttemptSize = 10;
+
+    static ConnectReport& GetInstance() {
+        static ConnectReport instance;
+        return instance;
+    }
+
+    void Begin(const char* ssid, bool psk_ap, uint32_t now_ms);
+    void AttemptStarted(uint32_t now_ms);
+    void AttemptEnded(AttemptOutcome outcome, uint8_t reason, int8_t rssi, uint8_t channel,
+                      int32_t error, uint32_t now_ms);
+    // 尝试以超时结束后才到达的断开事件，补充到最后一次尝试上
+    void AmendReason(uint8_t reason, int8_t rssi);
+    void Finish(ConnectOutcome outcome, int32_t result, uint32_t now_ms);
+
+    // 当前（或最近一次）请求的记录
+    bool GetCurrent(ConnectRecord* out) const;
+    // 最近的 max_count 条记录，最新的在前，返回条数
+    size_t GetRecords(ConnectRecord* out, size_t max_count) const;
+
+    // 供 HTTP 诊断接口使用
+    std::string GetJson() const;
+    // 供 BLE 使用：[版本][条数 n] 之后 n 条记录，最新的在前，只写入放得下的完整记录
+    // 每条：[seq u32][开始 u32][总耗时 u32][结果 i32][分类][psk][SSID 长度 L][L 字节 SSID]
+    //       [尝试数 m][m × (结束方式, 原因, RSSI, 信道, 错误 u16, 等待 u16, 耗时 u16)]
+    // 整数均为小端，返回写入的字节数
+    size_t GetBinary(uint8_t* out, size_t out_size) const;
+
+    void Clear();
+
+private:
+    ConnectReport() = default;
+
+    ConnectRecord* CurrentLocked();
+
+    mutable std::mutex mutex_;
+    ConnectRecord records_[kHistory] = {};
+    size_t count_ = 0;          // 已写入的记录数，最多 kHistory
+    size_t head_ = 0;           // 下一条记录的位置
+    uint32_t next_seq_ = 1;
+    uint32_t attempt_start_ms_ = 0;
+    uint32_t last_end_ms_ = 0;
+};
+
+#endif // CONNECT_REPORT_H
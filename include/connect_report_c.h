@@ -0,0 +1,20 @@
+#ifndef CONNECT_REPORT_C_H
+#define CONNECT_REPORT_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 获取最近的配网连接诊断记录（二进制格式，格式见 ConnectReport::GetBinary），返回写入的字节数
+// 分类 0=进行中 1=成功 2=密码错误 3=加密不兼容 4=超过截止时间 5=次数用完 6=取消 7=参数非法
+// 尝试结束方式 0=进行中 1=成功 2=断开 3=超时 4=连接调用失败 5=取消
+size_t connect_report_get_binary(uint8_t* out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CONNECT_REPORT_C_H
@@ -0,0 +1,61 @@
+#ifndef CONNECT_RETRY_POLICY_H
+#define CONNECT_RETRY_POLICY_H
+
+#include <cstdint>
+
+// 配网连接的重试策略：每个断开原因到达时立即分类，确定性的认证失败马上结束，
+// 偶发原因快速重试，整个过程受总截止时间约束
+// 所有存储都是定长的，不依赖 ESP-IDF 运行时，可以在主机上单独测试
+
+struct RetryPolicyConfig {
+    int max_attempts = 4;
+    uint32_t deadline_ms = 44000;           // 与原先 4 × (10 s + 1 s) 的最坏情况一致
+    uint32_t retry_delay_ms = 1000;         // 一般失败后的重试间隔
+    uint32_t transient_delay_ms = 200;      // 关联数满、信标超时等偶发原因的重试间隔
+    int handshake_timeout_limit = 2;        // PSK 网络上一次请求内累计几次握手超时判定为密码错误，不要求连续
+};
+
+enum class RetryVerdict : uint8_t {
+    kRetry,
+    kWrongPassword,     // 认证失败，重试没有意义
+    kIncompatible,      // 加密方式不兼容
+    kDeadline,          // 总截止时间已到
+    kExhausted,         // 尝试次数用完
+};
+
+struct RetryDecision {
+    RetryVerdict verdict;
+    uint32_t delay_ms;  // 仅 kRetry 时有效
+};
+
+const char* RetryVerdictName(RetryVerdict verdict);
+
+class ConnectRetryPolicy {
+public:
+    explicit ConnectRetryPolicy(const RetryPolicyConfig& config = RetryPolicyConfig()) : config_(config) {}
+
+    // psk_ap：扫描结果中该 SSID 以 WPA/WPA2-PSK 出现。只有这种情况下握手超时才能说明密码错误，
+    // 否则可能只是信号差或 AP 繁忙
+    void Begin(int64_t now_ms, bool psk_ap);
+    void SetConfig(const RetryPolicyConfig& config) { config_ = config; }
+
+    // 一次尝试以断开事件、等待超时或 esp_wifi_connect 失败结束，返回下一步
+    RetryDecision OnDisconnect(uint16_t reason, int64_t now_ms);
+    RetryDecision OnTimeout(int64_t now_ms);
+    RetryDecision OnConnectError(int64_t now_ms);
+
+    // 距离总截止时间的剩余毫秒数，用于限制单次尝试的等待时间
+    uint32_t RemainingMs(int64_t now_ms) const;
+    int GetAttempts() const { return attempts_; }
+
+private:
+    RetryDecision Next(uint32_t delay_ms, int64_t now_ms);
+
+    RetryPolicyConfig config_;
+    int64_t deadline_ms_ = 0;
+    int attempts_ = 0;
+    int handshake_timeouts_ = 0;
+    bool psk_ap_ = false;
+};
+
+#endif // CONNECT_RETRY_POLICY_H
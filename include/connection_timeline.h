@@ -0,0 +1,98 @@
+#ifndef CONNECTION_TIMELINE_H
+#define CONNECTION_TIMELINE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 连接过程的阶段事件
+enum class TimelinePhase : uint8_t {
+    kRequest = 0,       // 发起连接（启动、临时连接、配网提交），重新开始计时
+    kScanStart,
+    kScanDone,          // arg: 扫描到的 AP 数量
+    kCandidate,         // 选定候选 AP，arg: 信道
+    kConnectStart,      // 调用 esp_wifi_connect，开始认证/关联/四次握手
+    kConnected,         // WIFI_EVENT_STA_CONNECTED，arg: 信道
+    kGotIp,             // IP_EVENT_STA_GOT_IP
+    kDisconnected,      // arg: 断开原因
+};
+
+// 事件来源
+enum class TimelineSource : uint8_t {
+    kStation = 0,       // WifiStation
+    kManager,           // WifiConnectionManager（配网）
+};
+
+struct TimelineEvent {
+    uint32_t time_ms;   // 自启动以来的毫秒数
+    TimelinePhase phase;
+    TimelineSource source;
+    uint16_t arg;
+};
+
+// 一次连接尝试的分阶段耗时
+struct ConnectionAttempt {
+    enum Result : uint8_t { kPending = 0, kSuccess, kFailed };
+
+    TimelineSource source;
+    Result result;
+    uint8_t reason;         // 失败时的断开原因
+    uint8_t trigger;        // 由掉线触发时的断开原因，0 表示主动发起
+    uint8_t channel;
+    uint8_t scans;          // 本次尝试前的扫描次数
+    uint32_t start_ms;
+    uint32_t scan_ms;       // 扫描耗时之和
+    uint32_t select_ms;     // 最后一次扫描完成到选定候选
+    uint32_t connect_ms;    // 发起连接到 STA_CONNECTED（认证 + 关联 + 握手，IDF 没有分别上报）
+    uint32_t dhcp_ms;       // STA_CONNECTED 到拿到 IP
+    uint32_t total_ms;      // 从开始到结束（进行中的尝试计算到当前时间）
+};
+
+// 连接阶段时间线，写入端无锁，可以在事件循环、定时器等多个任务中同时记录，常开不影响性能
+// 每个槽位带序号，读取时序号前后一致才认为数据有效（seqlock），写入端从不等待
+class ConnectionTimeline {
+public:
+    static constexpr size_t kCapacity = 128;     // 必须是 2 的幂
+    static constexpr size_t kMaxAttempts = 16;
+    // 二进制格式中每条尝试的字节数
+    static constexpr size_t kBinaryAttemptSize = 30;
+
+    static ConnectionTimeline& GetInstance() {
+        static ConnectionTimeline instance;
+        return instance;
+    }
+
+    void Record(TimelineSource source, TimelinePhase phase, uint16_t arg = 0);
+    void Record(TimelineSource source, TimelinePhase phase, uint16_t arg, uint32_t time_ms);
+
+    // 按时间顺序拷贝最近的事件，返回条数
+    size_t GetEvents(TimelineEvent* out, size_t max_count) const;
+    // 最近的 max_count 次连接尝试（按时间顺序），包含正在进行的尝试
+    size_t GetAttempts(ConnectionAttempt* out, size_t max_count) const;
+
+    // 供 HTTP 诊断接口使用
+    std::string GetAttemptsJson(size_t max_count = kMaxAttempts) const;
+    // 供 BLE 使用：[条数][每条 kBinaryAttemptSize 字节]，整数均为小端，返回写入的字节数
+    size_t GetAttemptsBinary(uint8_t* out, size_t out_size, size_t max_count = kMaxAttempts) const;
+
+    void Clear();
+
+private:
+    ConnectionTimeline() = default;
+
+    // 按时间顺序遍历最近 max_count 条有效事件
+    template <typename F>
+    void ForEachEvent(size_t max_count, F&& fn) const;
+
+    struct Slot {
+        std::atomic<uint32_t> seq{0};    // 写入序号 + 1，0 表示空或正在写入
+        std::atomic<uint32_t> time_ms{0};
+        std::atomic<uint32_t> packed{0};  // phase | source << 8 | arg << 16
+    };
+
+    Slot slots_[kCapacity];
+    std::atomic<uint32_t> head_{0};
+};
+
+#endif // CONNECTION_TIMELINE_H
@@ -0,0 +1,21 @@
+#ifndef CONNECTION_TIMELINE_C_H
+#define CONNECTION_TIMELINE_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 获取最近的连接尝试（二进制格式），返回写入的字节数
+// 数据格式：[条数] 之后每条 30 字节：
+// [来源][结果][失败原因][触发原因][信道][扫描次数][开始][扫描][选择][连接][DHCP][总耗时]
+// 来源 0=WifiStation 1=配网；结果 0=进行中 1=成功 2=失败；时间均为 uint32 小端毫秒
+size_t connection_timeline_get_binary(uint8_t* out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CONNECTION_TIMELINE_C_H
@@ -0,0 +1,14 @@
+#ifndef DHCP_REBOOT_H
+#define DHCP_REBOOT_H
+
+#include <cstdint>
+
+struct netif;
+
+// 让 lwIP 的 DHCP 客户端以 INIT-REBOOT 方式请求缓存的地址：广播携带 requested IP 的 DHCPREQUEST，
+// 省去 DISCOVER/OFFER 一个来回。服务器回 ACK 即绑定；回 NAK 时 lwIP 清掉地址重新 DISCOVER；
+// 两次请求都没有应答时（约 3 秒）同样回到 DISCOVER。地址为网络字节序
+// 只在客户端刚发出 DISCOVER、还没收到 OFFER 时接管，返回是否已发起；必须在 tcpip 线程中调用
+bool DhcpRequestCachedAddress(struct netif* netif, uint32_t ip);
+
+#endif // DHCP_REBOOT_H
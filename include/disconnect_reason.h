@@ -0,0 +1,25 @@
+#ifndef DISCONNECT_REASON_H
+#define DISCONNECT_REASON_H
+
+#include <cstdint>
+
+// 断开原因的分类，决定是否值得对同一网络重试
+enum class DisconnectClass : uint8_t {
+    kTransient = 0,     // 信号、超时等偶发原因，可以按退避重试
+    kCredential,        // 密码或认证错误，重试同一网络没有意义
+    kIncompatible,      // 加密方式不兼容，重试同一网络没有意义
+    kNotFound,          // 该 BSSID 不在附近，换下一个候选
+    kLocal,             // 本机主动断开（切换、停止）
+    kOverloaded,        // AP 关联数已满，换同一网络的其它 BSSID
+};
+
+// 断开原因码（wifi_err_reason_t）的可读描述
+const char* DisconnectReasonString(uint16_t reason);
+DisconnectClass ClassifyDisconnect(uint16_t reason);
+
+// 对整个 SSID 都是确定性的失败，本轮不再尝试该 SSID 的其它 BSSID
+inline bool IsDefinitiveFailure(DisconnectClass cls) {
+    return cls == DisconnectClass::kCredential || cls == DisconnectClass::kIncompatible;
+}
+
+#endif // DISCONNECT_REASON_H
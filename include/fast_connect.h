@@ -0,0 +1,72 @@
+#ifndef FAST_CONNECT_H
+#define FAST_CONNECT_H
+
+#include <cstdint>
+#include <vector>
+
+#include <esp_wifi_types_generic.h>
+
+#include "ssid_manager.h"
+
+// 最近一次成功连接的 AP（持久化到 NVS），开机时跳过全信道扫描直接连接
+struct LastApRecord {
+    uint8_t version;
+    uint8_t ssid_index;     // 在 SsidManager 列表中的位置，列表变化后会按 ssid 重新查找
+    uint8_t channel;
+    uint8_t authmode;       // 记录时 AP 的加密方式，直连时作为门限，AP 降级加密方式时不连接
+    uint8_t bssid[6];
+    char ssid[33];
+};
+
+// 连接时允许的最低加密方式：混合模式取其中较弱的一种，AP 在两种之间切换时仍然可以连接
+wifi_auth_mode_t AuthThresholdFor(wifi_auth_mode_t authmode);
+
+// 把连接锁定到指定的 BSSID：驱动只在该信道上探测，并要求不低于 authmode 对应的门限
+void LockStaConfig(wifi_sta_config_t* sta, const uint8_t bssid[6], uint8_t channel, wifi_auth_mode_t authmode);
+
+// 快速重连：开机时按上次成功连接的记录直接连接，在时限内没有关联成功就回退到扫描
+// 只负责决策与计时，NVS 读写、定时器和驱动调用由 WifiStation 完成，可以在主机上单独测试
+class FastConnect {
+public:
+    // 只等待关联完成（STA_CONNECTED），不含 DHCP
+    static constexpr uint32_t kTimeoutMs = 5000;
+    // 连续失败这么多次才丢弃记录，一次偶发的超时不影响下次开机
+    static constexpr uint8_t kMaxFailures = 3;
+
+    // kActive 表示正在按记录直连，kAborting 表示超时后等待断开事件再回退到扫描
+    enum class State : uint8_t { kNone, kActive, kAborting };
+
+    void Load(const LastApRecord& record, uint8_t failures);
+    void Clear();
+    bool valid() const { return valid_; }
+    const LastApRecord& record() const { return record_; }
+    uint8_t failures() const { return failures_; }
+    State state() const { return state_; }
+    bool InProgress() const { return state_ != State::kNone; }
+    uint32_t deadline_ms() const { return started_ms_ + kTimeoutMs; }
+
+    // 在保存列表中查找记录对应的网络：优先按记录的下标，列表顺序变化时再按 SSID，已不再保存时返回 -1
+    int FindSaved(const std::vector<SsidItem>& ssid_list) const;
+
+    // 开始按记录直连，返回保存列表中的下标；没有记录或网络已不再保存时返回 -1，不开始
+    // sta 不为空时填写 SSID、密码以及锁定的 BSSID、信道和加密门限
+    int Begin(const std::vector<SsidItem>& ssid_list, uint32_t now_ms, wifi_sta_config_t* sta = nullptr);
+    bool Expired(uint32_t now_ms) const { return state_ == State::kActive && now_ms - started_ms_ >= kTimeoutMs; }
+    // 超过时限：返回 true 表示调用方应主动断开，断开事件到来后再按失败处理
+    bool OnTimeout();
+    // 关联成功，返回 true 表示持久化的失败计数需要清零
+    bool OnAssociated();
+    // 直连失败：返回 true 表示连续失败已达上限，记录应丢弃；否则调用方保存新的失败计数
+    bool OnFailed();
+    // 被停止或新的连接请求打断，不计失败
+    void Cancel() { state_ = State::kNone; }
+
+private:
+    LastApRecord record_ = {};
+    bool valid_ = false;
+    uint8_t failures_ = 0;
+    State state_ = State::kNone;
+    uint32_t started_ms_ = 0;
+};
+
+#endif // FAST_CONNECT_H
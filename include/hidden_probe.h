@@ -0,0 +1,52 @@
+#ifndef HIDDEN_PROBE_H
+#define HIDDEN_PROBE_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 隐藏网络的定向探测调度
+// 普通扫描不再显示隐藏 SSID，没有在广播扫描中出现过的保存网络通过定向扫描（携带 SSID 的探测请求）查找
+// 每个扫描周期最多探测 kBatchSize 个网络，已确认隐藏的网络优先，其余按周期轮换
+// 可见状态不是永久的：连续 kMaxMissedScans 次普通扫描没有出现的网络回到未知，重新参与探测
+class HiddenProbeScheduler {
+public:
+    static constexpr size_t kMaxNetworks = 16;
+    static constexpr size_t kBatchSize = 2;
+    static constexpr uint8_t kMaxMissedScans = 3;
+
+    enum class Visibility : uint8_t {
+        kUnknown,   // 还没有在任何扫描中见过
+        kVisible,   // 在普通扫描中见过 SSID，不需要探测
+        kHidden,    // 只能通过定向扫描找到
+    };
+
+    // 普通扫描中见到了 SSID
+    void MarkVisible(uint32_t ssid_hash);
+    // 定向扫描找到了网络，而普通扫描没有
+    void MarkHidden(uint32_t ssid_hash);
+    // 保存时配置了 BSSID 的网络多半是隐藏网络：状态未知时先按隐藏处理，普通扫描见到后改为可见
+    void HintHidden(uint32_t ssid_hash);
+    // 每次普通扫描处理完后调用，本次没有见到的可见网络累计一次漏扫
+    void EndBroadcastScan();
+    Visibility GetVisibility(uint32_t ssid_hash) const;
+    void Clear();
+
+    // 生成本周期的探测批次，返回保存列表下标个数（最多 kBatchSize）
+    size_t BuildBatch(const uint32_t* saved_hashes, size_t count, uint8_t* out_indexes);
+
+private:
+    struct Entry {
+        uint32_t hash;
+        Visibility visibility;
+        bool used;
+        bool seen;              // 本次普通扫描中见到
+        uint8_t missed_scans;   // 可见网络连续没有出现的普通扫描次数
+    };
+
+    Entry* FindOrCreate(uint32_t hash);
+
+    Entry entries_[kMaxNetworks] = {};
+    size_t cursor_ = 0;
+};
+
+#endif // HIDDEN_PROBE_H
@@ -0,0 +1,84 @@
+#ifndef LINK_METRICS_H
+#define LINK_METRICS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// 链路质量汇总
+struct LinkMetricsSummary {
+    int8_t rssi_avg;                // EWMA 平滑后的 RSSI，没有样本时为 0
+    int8_t rssi_min;
+    int8_t rssi_max;
+    uint32_t rssi_samples;
+    uint32_t associations;          // 拿到 IP 的次数
+    uint32_t disconnects;           // 所有断开事件（包括连接失败）
+    uint32_t reconnects;            // 已连接后掉线又重新连上的次数
+    uint32_t uptime_last_ms;        // 最近一次结束的连接持续时间
+    uint32_t uptime_max_ms;
+    uint32_t uptime_avg_ms;
+    uint32_t uptime_current_ms;     // 当前连接已持续的时间，未连接为 0
+    uint32_t reconnect_p50_ms;      // 掉线到重新拿到 IP 的耗时分位数（最近 kReconnectSamples 次）
+    uint32_t reconnect_p90_ms;
+    uint32_t reconnect_max_ms;
+};
+
+// 链路质量指标：RSSI 平滑值、断开原因直方图、每次连接的持续时间和重连耗时分布
+// 由 WifiStation 的事件处理更新，存储都是定长的；内部加锁，可以在其他任务中导出
+class LinkMetrics {
+public:
+    static constexpr size_t kReconnectSamples = 32;
+    static constexpr int kRssiAlphaShift = 3;       // alpha = 1/8
+    static constexpr uint8_t kBinaryVersion = 1;
+    // 二进制格式中直方图之前的固定部分字节数
+    static constexpr size_t kBinaryHeaderSize = 48;
+
+    static LinkMetrics& GetInstance() {
+        static LinkMetrics instance;
+        return instance;
+    }
+
+    void OnRssi(int8_t rssi);
+    void OnConnected(uint32_t now_ms);
+    void OnDisconnected(uint8_t reason, uint32_t now_ms);
+
+    LinkMetricsSummary GetSummary(uint32_t now_ms) const;
+    // 按次数从多到少拷贝断开原因，返回条数
+    size_t GetReasons(uint8_t* reasons, uint16_t* counts, size_t max_count) const;
+
+    // 供 HTTP 诊断接口使用
+    std::string GetJson(uint32_t now_ms) const;
+    // 供看板上报：[版本][汇总][原因数 n][n × (原因 1 字节, 次数 2 字节)]，整数均为小端，返回写入的字节数
+    size_t GetBinary(uint8_t* out, size_t out_size, uint32_t now_ms) const;
+
+    void Clear();
+
+private:
+    LinkMetrics() = default;
+
+    LinkMetricsSummary SummaryLocked(uint32_t now_ms) const;
+
+    mutable std::mutex mutex_;
+    int16_t rssi_avg_x16_ = 0;
+    int8_t rssi_min_ = 0;
+    int8_t rssi_max_ = 0;
+    uint32_t rssi_samples_ = 0;
+    uint16_t reason_counts_[256] = {};
+    uint32_t disconnects_ = 0;
+    uint32_t associations_ = 0;
+    uint32_t reconnects_ = 0;
+    bool connected_ = false;
+    uint32_t connected_since_ms_ = 0;
+    bool lost_ = false;                 // 已连接后掉线，等待重新连上
+    uint32_t lost_at_ms_ = 0;
+    uint32_t uptime_last_ms_ = 0;
+    uint32_t uptime_max_ms_ = 0;
+    uint64_t uptime_total_ms_ = 0;
+    uint32_t uptime_count_ = 0;
+    uint32_t reconnect_ms_[kReconnectSamples] = {};
+    size_t reconnect_head_ = 0;
+    size_t reconnect_count_ = 0;
+};
+
+#endif // LINK_METRICS_H
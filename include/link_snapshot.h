@@ -0,0 +1,36 @@
+#ifndef LINK_SNAPSHOT_H
+#define LINK_SNAPSHOT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// 当前链路状态，未连接时除 connected 外的字段保持最后一次的值
+struct LinkState {
+    bool connected;
+    int8_t rssi;
+    uint8_t channel;
+    uint8_t phy_mode;           // wifi_phy_mode_t
+    uint8_t bssid[6];
+    uint32_t ip;                // 网络字节序，0 表示还没有地址
+    uint32_t connected_since_ms; // 拿到 IP 的时间（自启动以来的毫秒数）
+    uint32_t updated_ms;        // 最后一次更新的时间
+};
+
+// 单写者、多读者的链路状态快照（seqlock）
+// 写入端只在站点任务中调用；读取端不加锁、不调用驱动，可以在任意任务（不能在中断）中读取一致的副本，
+// 写入端被抢占在中途时读取端会睡眠等待
+// 数据按 32 位原子字保存，读取时序号前后一致且为偶数才认为有效
+class LinkSnapshot {
+public:
+    void Write(const LinkState& state);
+    LinkState Read() const;
+
+private:
+    static constexpr size_t kWords = (sizeof(LinkState) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> seq_{0};      // 奇数表示正在写入
+    std::atomic<uint32_t> words_[kWords] = {};
+};
+
+#endif // LINK_SNAPSHOT_H
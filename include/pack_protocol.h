@@ -12,6 +12,8 @@
 #define CMD_WIFI_CONFIG_RESP      0x41
 #define CMD_NOTI_WIFI_CONFIG_STATE      0x42
 #define CMD_WIFI_LIST_RESP        0x46
+#define CMD_CONN_TIMELINE_RESP    0x48
+#define CMD_CONNECT_REPORT_RESP   0x4A
 
 // 响应状态码
 #define RESP_STATUS_OK       0x00
@@ -13,6 +13,8 @@
 // CMD 指令定义
 #define CMD_WIFI_CONFIG 0x40        // WiFi配置指令
 #define CMD_GET_WIFI_LIST 0x45        // WiFi配置指令
+#define CMD_GET_CONN_TIMELINE 0x47    // 获取连接阶段耗时
+#define CMD_GET_CONNECT_REPORT 0x49   // 获取配网连接诊断记录
 
 // WiFi配置结构体
 typedef struct {
@@ -0,0 +1,65 @@
+#ifndef POWER_SAVE_POLICY_H
+#define POWER_SAVE_POLICY_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 与 wifi_ps_type_t 顺序一致
+enum class PowerSaveMode : uint8_t {
+    kNone = 0,      // 不省电，延迟最低
+    kMinModem,      // 每个 DTIM 唤醒
+    kMaxModem,      // 按 listen interval 唤醒，最省电
+};
+
+struct PowerSaveConfig {
+    uint16_t busy_pps = 20;                 // 收发包速率达到该值视为突发流量，立即关闭省电
+    uint16_t idle_pps = 2;                  // 低于该值视为空闲
+    uint32_t none_hold_ms = 2 * 1000;       // 突发结束后继续保持 NONE 的时间
+    uint32_t max_modem_idle_ms = 30 * 1000; // 持续空闲这么久后进入 MAX_MODEM
+    uint8_t listen_interval = 10;           // MAX_MODEM 下的 listen interval（信标间隔数），连接时生效
+};
+
+struct PowerSaveStats {
+    uint32_t residency_ms[3];   // 按 PowerSaveMode 下标，各模式累计停留时间
+    uint32_t switches;          // 模式切换次数
+    uint32_t latency_windows;   // 应用声明的低延迟窗口次数
+};
+
+// 按收发流量自动选择省电模式
+// 变得更积极（少省电）是立即的，变得更省电要分阶段并持续满足条件，避免在突发流量间来回切换
+// 所有存储都是定长的，不依赖 ESP-IDF 运行时，可以在主机上单独测试
+class PowerSavePolicy {
+public:
+    void SetConfig(const PowerSaveConfig& config) { config_ = config; }
+    const PowerSaveConfig& GetConfig() const { return config_; }
+
+    // 从指定模式开始计时
+    void Reset(PowerSaveMode mode, uint32_t now_ms);
+    // 每个采样周期调用，packets 为本周期的收发包数，返回应使用的模式
+    PowerSaveMode Update(uint32_t now_ms, uint32_t packets);
+    PowerSaveMode GetMode() const { return mode_; }
+
+    // 低延迟窗口：可以嵌套，期间保持 NONE；Hold 在 duration_ms 后自动结束
+    PowerSaveMode BeginLatencyCritical(uint32_t now_ms);
+    PowerSaveMode EndLatencyCritical(uint32_t now_ms);
+    PowerSaveMode HoldLatency(uint32_t now_ms, uint32_t duration_ms);
+
+    // 包含当前模式截至 now_ms 的停留时间
+    PowerSaveStats GetStats(uint32_t now_ms) const;
+
+private:
+    void SwitchTo(PowerSaveMode mode, uint32_t now_ms);
+    bool LatencyCritical(uint32_t now_ms) const;
+
+    PowerSaveConfig config_;
+    PowerSaveStats stats_ = {};
+    PowerSaveMode mode_ = PowerSaveMode::kMinModem;
+    uint32_t mode_since_ms_ = 0;
+    uint32_t last_update_ms_ = 0;
+    uint32_t last_busy_ms_ = 0;
+    uint32_t last_active_ms_ = 0;
+    uint32_t hold_until_ms_ = 0;
+    uint8_t latency_depth_ = 0;
+};
+
+#endif // POWER_SAVE_POLICY_H
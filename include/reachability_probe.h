@@ -0,0 +1,78 @@
+#ifndef REACHABILITY_PROBE_H
+#define REACHABILITY_PROBE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// 连上 AP 并拿到 IP 之后，检查是否真的能访问外网
+struct ReachabilityConfig {
+    char host[64] = "connectivitycheck.gstatic.com";
+    char path[64] = "/generate_204";    // 为空时只做 TCP 连接检查
+    uint16_t port = 80;
+    uint16_t expect_status = 204;       // 0 表示接受任意 2xx
+    uint32_t timeout_ms = 5000;         // DNS、TCP、HTTP 三步共用的总时限
+    uint32_t demote_ms = 10 * 60 * 1000; // 检查失败的网络在这段时间内降低排名
+    int32_t demote_penalty = 60;        // 降级期间候选评分的扣分
+    uint32_t recheck_ms = 60 * 1000;    // 没有其他网络可切换时，隔多久重新检查
+};
+
+enum class Reachability : uint8_t {
+    kUnknown = 0,       // 未检查（未连接或未开启）
+    kProbing,
+    kReachable,
+    kDnsFailed,
+    kConnectFailed,     // TCP 连接失败
+    kHttpFailed,        // 状态码不符合预期，通常是强制门户或上游拦截
+    kTimeout,
+};
+
+const char* ReachabilityName(Reachability state);
+
+// 在单独的短生命周期任务中执行阻塞的检查，结果通过回调返回，不阻塞调用者
+// 同一时间只有一个检查在进行，generation 用于调用方丢弃过期的结果
+class ReachabilityProbe {
+public:
+    using Callback = void (*)(void* arg, uint32_t generation, Reachability result, uint32_t elapsed_ms);
+
+    // 上一次检查还没结束时返回 false
+    bool Start(const ReachabilityConfig& config, uint32_t generation, Callback callback, void* arg);
+    bool Busy() const { return busy_.load(); }
+
+    // 阻塞执行一次检查，可以在任意任务中直接调用
+    static Reachability Check(const ReachabilityConfig& config);
+    // 解析 HTTP 响应的状态行，格式不对返回 -1
+    static int ParseHttpStatus(const char* data, size_t length);
+
+private:
+    static void TaskEntry(void* arg);
+
+    ReachabilityConfig config_;
+    uint32_t generation_ = 0;
+    Callback callback_ = nullptr;
+    void* arg_ = nullptr;
+    std::atomic<bool> busy_{false};
+};
+
+// 检查失败的网络在一段时间内降低排名，按 SSID 哈希记录
+// 所有存储都是定长的，不依赖 ESP-IDF 运行时，可以在主机上单独测试
+class DemotionList {
+public:
+    static constexpr size_t kCapacity = 8;
+
+    // 已满时替换最早到期的记录
+    void Demote(uint32_t ssid_hash, uint32_t until_ms);
+    bool IsDemoted(uint32_t ssid_hash, uint32_t now_ms) const;
+    void Clear();
+
+private:
+    struct Entry {
+        uint32_t hash;
+        uint32_t until_ms;
+        bool used;
+    };
+
+    Entry entries_[kCapacity] = {};
+};
+
+#endif // REACHABILITY_PROBE_H
@@ -0,0 +1,47 @@
+#ifndef SCAN_ARENA_H
+#define SCAN_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include <esp_wifi_types_generic.h>
+
+// 预分配的扫描结果缓冲区，所有扫描共用，稳态下处理扫描结果不再申请堆内存
+// 记录本身不移动，按 RSSI 排序的是下标数组；SSID 以 string_view 的形式指向记录中的 ssid 字段
+// 视图在下一次 Load / Commit 之前有效
+class ScanArena {
+public:
+    // 与 ScanTopK::kMaxRecords 一致；超过容量的扫描结果由驱动丢弃，计入 dropped()
+    static constexpr size_t kCapacity = 64;
+    // wifi_ap_record_t::ssid 有 33 字节，但 SSID 最长 32 字节，满长时第 33 字节不保证为 0
+    static constexpr size_t kMaxSsidLength = 32;
+
+    // 从驱动取回扫描结果并排序，返回条数
+    size_t Load();
+
+    // 由调用者直接写入 Records() 后提交 count 条，建立排序下标与 SSID 视图
+    wifi_ap_record_t* Records() { return records_; }
+    void Commit(size_t count);
+
+    size_t size() const { return count_; }
+    // 最近一次 Load 因容量不足丢弃的条数，以及累计丢弃的条数
+    size_t dropped() const { return dropped_; }
+    uint32_t dropped_total() const { return dropped_total_; }
+    bool empty() const { return count_ == 0; }
+    // 按 RSSI 从高到低的第 i 条
+    const wifi_ap_record_t& operator[](size_t i) const { return records_[order_[i]]; }
+    // 与 operator[] 同序的 SSID，隐藏网络为空
+    std::span<const std::string_view> Ssids() const { return {ssids_, count_}; }
+
+private:
+    wifi_ap_record_t records_[kCapacity];
+    uint8_t order_[kCapacity] = {};
+    std::string_view ssids_[kCapacity];
+    size_t count_ = 0;
+    size_t dropped_ = 0;
+    uint32_t dropped_total_ = 0;
+};
+
+#endif // SCAN_ARENA_H
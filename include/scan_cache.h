@@ -0,0 +1,66 @@
+#ifndef SCAN_CACHE_H
+#define SCAN_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <esp_wifi_types_generic.h>
+
+// 缓存项的时间信息，下标与 ScanCache::Records() 一致
+struct ScanCacheInfo {
+    uint32_t first_seen_ms;
+    uint32_t last_seen_ms;
+    uint8_t missed_scans;   // 连续没有扫描到的次数
+};
+
+// 跨扫描保存的 AP 列表，按 BSSID 合并每次扫描的结果：RSSI 做 EWMA 平滑，
+// 连续 kMaxMissedScans 次没扫到即删除（第 kMaxMissedScans 次漏扫时），避免列表随每次扫描重排或因丢一个 beacon 而消失
+// BSSID 通过开放寻址表定位，每条记录的更新是 O(1)；删除只在每次扫描结束时统一进行
+// 所有存储都是定长的，不依赖 ESP-IDF 运行时，可以在主机上单独测试
+class ScanCache {
+public:
+    static constexpr size_t kCapacity = 64;
+    static constexpr uint8_t kMaxMissedScans = 3;
+    static constexpr int kRssiAlphaShift = 2;       // alpha = 1/4
+
+    ScanCache() { Clear(); }
+
+    // 合并一次成功扫描的结果，然后老化本次没有扫到的记录
+    void Merge(const wifi_ap_record_t* records, size_t count, uint32_t now_ms);
+
+    // 缓存中的记录，rssi 为平滑后的值；顺序按首次加入排列，删除不打乱其余记录的相对顺序
+    std::span<const wifi_ap_record_t> Records() const { return {records_, count_}; }
+    const ScanCacheInfo& Info(size_t index) const { return info_[index]; }
+    size_t size() const { return count_; }
+    void Clear();
+
+private:
+    // 2 的幂，为容量的两倍，保证探测链很短
+    static constexpr int kTableSize = 128;
+    static constexpr int8_t kEmpty = -1;
+    static constexpr int8_t kDeleted = -2;
+
+    void Update(const wifi_ap_record_t& record, uint32_t now_ms);
+    int Find(uint64_t bssid) const;
+    void Insert(uint64_t bssid, int index);
+    void Remove(uint64_t bssid);
+    // 缓存已满时挑一条记录让位给新 BSSID，没有可替换的返回 -1
+    int PickVictim(int8_t rssi) const;
+    void Expire();
+    void RebuildTable();
+
+    struct State {
+        uint64_t bssid;
+        int16_t rssi_x16;
+        bool seen;          // 本次扫描是否扫到
+    };
+
+    wifi_ap_record_t records_[kCapacity];
+    ScanCacheInfo info_[kCapacity];
+    State states_[kCapacity];
+    int8_t table_[kTableSize];
+    size_t count_ = 0;
+};
+
+#endif // SCAN_CACHE_H
@@ -0,0 +1,33 @@
+#ifndef SCAN_DEMAND_H
+#define SCAN_DEMAND_H
+
+#include <cstdint>
+
+// 按需扫描的节流：同一时间只有一次扫描，距上次完整扫描不足 min_interval_ms 时合并到已有结果
+// 只记录自己发起的扫描，其他模块（定向探测、漫游）的 SCAN_DONE 由 OnDone 的返回值区分
+// 不依赖 ESP-IDF 运行时，可以在主机上单独测试
+class ScanDemand {
+public:
+    explicit ScanDemand(uint32_t min_interval_ms) : min_interval_ms_(min_interval_ms) {}
+
+    // 是否需要发起新扫描；返回 false 时计一次合并
+    bool Request(uint32_t now_ms);
+    // Request 返回 true 且驱动已开始扫描后调用
+    void OnStarted();
+    // 收到 SCAN_DONE，返回是否是自己发起的扫描；complete 为 false 的扫描不算新鲜，下一次请求会重新扫描
+    bool OnDone(bool complete, uint32_t now_ms);
+
+    bool InFlight() const { return in_flight_; }
+    uint32_t started() const { return started_; }
+    uint32_t coalesced() const { return coalesced_; }
+
+private:
+    uint32_t min_interval_ms_;
+    bool in_flight_ = false;
+    bool has_scan_ = false;         // 是否完成过完整扫描
+    uint32_t last_done_ms_ = 0;
+    uint32_t started_ = 0;
+    uint32_t coalesced_ = 0;
+};
+
+#endif // SCAN_DEMAND_H
@@ -0,0 +1,105 @@
+#ifndef SCAN_PLANNER_H
+#define SCAN_PLANNER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 扫描覆盖的频段，可按位组合
+enum ScanBand : uint8_t {
+    kScanBand2g = 1 << 0,
+    kScanBand5g = 1 << 1,
+    kScanBandBoth = kScanBand2g | kScanBand5g,
+};
+
+// 按扫描覆盖的频段统计耗时
+struct BandScanStats {
+    uint32_t scans;
+    uint32_t last_ms;
+    uint32_t avg_ms;            // EWMA，alpha = 1/4
+    uint32_t max_ms;
+    uint16_t last_aps;          // 最近一次扫描到的 AP 数量
+};
+
+// 一次扫描的计划：定向扫描只扫描保存网络最近出现过的信道，否则全信道扫描
+// 位图都为 0 表示驱动支持的全部信道；全信道扫描也可能只给出 2.4 GHz 的位图
+struct ScanPlan {
+    bool full;
+    uint8_t bands;              // ScanBand 组合
+    uint16_t channels_2g;       // 2.4 GHz 信道位图，bit N 对应信道 N（与 wifi_2g_channel_bit_t 一致）
+    uint32_t channels_5g;       // 5 GHz 信道位图，与 wifi_5g_channel_bit_t 一致
+    uint8_t channel_count;
+    uint16_t active_min_ms;     // 每个信道的主动扫描驻留时间，0 表示使用驱动默认值
+    uint16_t active_max_ms;
+};
+
+// 按保存网络的信道历史规划扫描
+// 重连时大多数网络仍在原来的一两个信道上，先定向扫描这些信道，未命中再升级为全信道扫描
+// 所有存储都是定长的，不依赖 ESP-IDF 运行时，可以在主机上单独测试
+class ScanPlanner {
+public:
+    static constexpr size_t kMaxNetworks = 16;
+    static constexpr size_t kChannelsPerNetwork = 2;
+    // 连续定向扫描命中这么多次后做一次全信道扫描，发现换了信道或新出现的更优 AP
+    static constexpr int kFullSweepInterval = 8;
+    static constexpr uint16_t kTargetedActiveMinMs = 30;
+    static constexpr uint16_t kTargetedActiveMaxMs = 100;
+    // 双频时，每这么多次全信道扫描中有一次同时扫描 5 GHz，其余只扫 2.4 GHz
+    // 保存网络在 5 GHz 出现过时，定向扫描本来就会包含对应的 5 GHz 信道
+    static constexpr int kDualBandInterval = 4;
+
+    // 芯片支持且站点开启了 5 GHz
+    void SetDualBand(bool enabled) { dual_band_ = enabled; }
+    bool IsDualBand() const { return dual_band_; }
+
+    // 国家码允许的 2.4 GHz 信道范围（wifi_country_t 的 schan / nchan）
+    void SetCountry(uint8_t schan, uint8_t nchan);
+
+    // 每次处理扫描结果前调用；同一轮内同一网络出现在多个信道时保留最先记录（RSSI 最强）的信道
+    void BeginRound() { round_++; }
+    void RecordSeen(uint32_t ssid_hash, uint8_t channel);
+    void Clear();
+
+    // 生成下一次扫描计划，saved_hashes 为当前保存网络的 SSID 哈希
+    ScanPlan Next(const uint32_t* saved_hashes, size_t count);
+    // 只收集指定网络的历史信道（不改变规划状态），channel_count 为 0 表示没有历史
+    ScanPlan PlanFor(const uint32_t* hashes, size_t count) const;
+    // 扫描完成后调用，返回 true 表示定向扫描未命中，应立即升级为全信道扫描
+    bool OnScanDone(bool matched);
+
+    // 每次普通扫描完成后记录耗时，按计划覆盖的频段分别统计
+    void RecordScanTime(uint8_t bands, uint32_t duration_ms, size_t ap_count);
+    const BandScanStats& GetBandStats(ScanBand band) const;
+
+    static bool IsChannel5g(uint8_t channel) { return channel > 14; }
+    // 5 GHz 信道在位图中的位置，不支持的信道返回 -1
+    static int Channel5gBit(uint8_t channel);
+
+private:
+    struct Entry {
+        uint32_t hash;
+        uint32_t last_used;     // LRU 时钟
+        uint32_t round;
+        uint8_t channels[kChannelsPerNetwork];  // [0] 为最近一次出现的信道，0 表示空
+        uint8_t round_count;    // 本轮已记录的信道数
+        bool used;
+    };
+
+    Entry* Find(uint32_t hash);
+    const Entry* Find(uint32_t hash) const;
+    bool IsAllowed(uint8_t channel) const;
+    ScanPlan FullPlan();
+
+    Entry entries_[kMaxNetworks] = {};
+    uint32_t clock_ = 0;
+    uint32_t round_ = 0;
+    uint8_t schan_ = 1;
+    uint8_t nchan_ = 13;
+    bool last_full_ = true;
+    bool escalate_ = false;
+    int targeted_streak_ = 0;
+    bool dual_band_ = false;
+    int full_count_ = 0;
+    BandScanStats band_stats_[3] = {};  // 下标为 bands - 1
+};
+
+#endif // SCAN_PLANNER_H
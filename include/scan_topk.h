@@ -0,0 +1,48 @@
+#ifndef SCAN_TOPK_H
+#define SCAN_TOPK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <esp_wifi_types_generic.h>
+
+// 扫描结果按 SSID 去重后的一项
+struct SsidGroup {
+    uint16_t index;         // 该 SSID 信号最强的 BSSID 在输入记录中的下标
+    int8_t rssi;
+    uint8_t bssid_count;    // 同一 SSID 下扫描到的 BSSID 数（mesh 节点、多频段）
+};
+
+// 面向用户的扫描列表：同一 SSID 只保留最强的 BSSID，隐藏网络不列出，
+// 再用部分选择（nth_element）取信号最强的 k 个。排序和选择都在 8 字节的紧凑键上进行，
+// 不移动 wifi_ap_record_t 本身
+// 所有存储都是定长的，不依赖 ESP-IDF 运行时，可以在主机上单独测试
+class ScanTopK {
+public:
+    // 超过容量的扫描结果会被忽略
+    static constexpr size_t kMaxRecords = 64;
+
+    // 返回去重后的 SSID 总数；Groups() 的前 min(k, 总数) 项按 RSSI 从高到低排列，其余无序
+    size_t Select(const wifi_ap_record_t* records, size_t count, size_t k);
+
+    std::span<const SsidGroup> Groups() const { return {groups_, group_count_}; }
+    std::span<const SsidGroup> Top() const { return {groups_, top_count_}; }
+    // 本次扫描中 SSID 为空的记录数
+    size_t hidden_count() const { return hidden_count_; }
+
+private:
+    struct Key {
+        uint32_t hash;
+        int8_t rssi;
+        uint16_t index;
+    };
+
+    Key keys_[kMaxRecords];
+    SsidGroup groups_[kMaxRecords];
+    size_t group_count_ = 0;
+    size_t top_count_ = 0;
+    size_t hidden_count_ = 0;
+};
+
+#endif // SCAN_TOPK_H
@@ -0,0 +1,49 @@
+#ifndef SSID_INDEX_H
+#define SSID_INDEX_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct SsidItem;
+
+// 已保存网络的匹配索引，由 SsidManager 在列表变化时重建
+// SSID 哈希与 48 位 BSSID 分别放在小型开放寻址表中，匹配过程不分配内存
+class SsidIndex {
+public:
+    static constexpr int kNotFound = -1;
+
+    void Build(const std::vector<SsidItem>& items);
+
+    // 按扫描结果匹配保存项：SSID 非空时按 SSID 匹配，隐藏网络（SSID 为空）按 BSSID 匹配
+    // 返回保存项在列表中的下标，未匹配返回 kNotFound
+    int Match(const uint8_t* ssid, const uint8_t* bssid) const;
+    int FindSsid(const uint8_t* ssid, size_t ssid_len) const;
+    int FindBssid(const uint8_t* bssid) const;
+
+    static uint32_t HashSsid(const uint8_t* ssid, size_t ssid_len);
+    static uint64_t BssidToU64(const uint8_t* bssid);
+    // 解析 "xx:xx:xx:xx:xx:xx" 格式的 BSSID
+    static bool ParseBssid(const std::string& bssid, uint64_t* out);
+
+private:
+    // 2 的幂，至少为保存上限（10 条）的两倍，保证探测链很短
+    static constexpr int kTableSize = 32;
+
+    struct SsidSlot {
+        uint32_t hash;
+        uint8_t length;
+        int8_t index;   // < 0 表示空槽
+    };
+    struct BssidSlot {
+        uint64_t bssid;
+        int8_t index;   // < 0 表示空槽
+    };
+
+    SsidSlot ssid_table_[kTableSize] = {};
+    BssidSlot bssid_table_[kTableSize] = {};
+    const std::vector<SsidItem>* items_ = nullptr;
+};
+
+#endif // SSID_INDEX_H
@@ -3,6 +3,9 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
+
+#include "ssid_index.h"
 
 struct SsidItem {
     std::string ssid;
@@ -10,12 +13,26 @@ struct SsidItem {
     std::string bssid;  // 新增 BSSID 字段，格式 "xx:xx:xx:xx:xx:xx"，空字符串表示无 BSSID
 };
 
+// 保存网络最近一次的 DHCP 租约，重连时以 INIT-REBOOT 请求原地址，省去 DISCOVER/OFFER 一个来回
+struct DhcpLease {
+    uint8_t version;
+    uint32_t ip;                // 地址均为网络字节序，与 esp_ip4_addr_t::addr 一致
+    uint32_t netmask;
+    uint32_t gateway;
+    uint32_t dns[2];
+    uint32_t lease_s;           // 租期（秒）
+    int64_t obtained_epoch;     // 获取时的系统时间（秒），时间未同步时为 0
+    int64_t obtained_us;        // 获取时的 esp_timer 时间，只在同一次启动内有效
+    uint32_t boot_id;           // 获取时的启动标识，用来判断 obtained_us 是否可用
+};
+
 // 新增：包含RSSI信息的SSID结构体
 struct SsidRssiItem {
     std::string ssid;
-    int8_t rssi;
+    int8_t rssi;            // 该 SSID 最强 BSSID 的 RSSI
+    uint8_t bssid_count;    // 扫描到的 BSSID 数
     
-    SsidRssiItem(const std::string& s, int8_t r) : ssid(s), rssi(r) {}
+    SsidRssiItem(const std::string& s, int8_t r, uint8_t count = 1) : ssid(s), rssi(r), bssid_count(count) {}
 };
 
 class SsidManager {
@@ -31,6 +48,15 @@ public:
     void Clear();
     const std::vector<SsidItem>& GetSsidList() const { return ssid_list_; }
 
+    // 按扫描到的 SSID / BSSID 查找保存项下标，未找到返回 -1（不分配内存）
+    int MatchAp(const uint8_t* ssid, const uint8_t* bssid) const { return index_.Match(ssid, bssid); }
+
+    // DHCP 租约缓存，按 SSID 存放在 NVS
+    // GetLease 只返回还没到 T1（租期一半）的租约，renew_in_s 返回距 T1 的秒数
+    bool GetLease(const std::string& ssid, DhcpLease* lease, uint32_t* renew_in_s = nullptr) const;
+    void SaveLease(const std::string& ssid, DhcpLease lease);
+    void EraseLease(const std::string& ssid);
+
     // 新增：保存带RSSI的扫描结果
     void ScanSsidRssiList(const std::vector<SsidRssiItem>& ssid_rssi_list);
 
@@ -43,8 +69,14 @@ private:
 
     void LoadFromNvs();
     void SaveToNvs();
+    void RebuildIndex();
+    bool LoadLease(const std::string& ssid, DhcpLease* lease) const;
+    // 租约获取至今的秒数，无法判断时返回 -1
+    int64_t LeaseAge(const DhcpLease& lease) const;
 
     std::vector<SsidItem> ssid_list_;
+    SsidIndex index_;
+    uint32_t boot_id_;
     // 新增：保存带RSSI的扫描结果
     std::vector<SsidRssiItem> scan_ssid_rssi_list_;
 };
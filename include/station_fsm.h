@@ -0,0 +1,40 @@
+#ifndef STATION_FSM_H
+#define STATION_FSM_H
+
+#include <cstdint>
+
+// WifiStation 的连接状态
+enum class StationState : uint8_t {
+    kIdle = 0,      // 未启动或已停止
+    kStarting,      // 已启动 WiFi，等待 STA_START
+    kScanning,      // 扫描中（包括隐藏网络的定向探测）
+    kConnecting,    // 正在连接（认证、关联、握手、DHCP）
+    kConnected,     // 已拿到 IP（漫游在该状态内进行）
+    kBackoff,       // 等待退避定时器后重连或重新扫描
+};
+
+// 驱动状态机的输入：外部事件，以及站点自身发起的动作
+enum class StationInput : uint8_t {
+    kStart = 0,
+    kStop,
+    kScan,          // 发起扫描
+    kScanDone,
+    kConnect,       // 发起连接
+    kLinkUp,        // STA_CONNECTED
+    kGotIp,
+    kDisconnected,
+    kBackoff,       // 启动退避定时器
+    kTimer,         // 退避定时器到期
+};
+
+// 状态转移表，不依赖 ESP-IDF 运行时，可以在主机上单独测试
+class StationFsm {
+public:
+    // 返回 false 表示当前状态不接受该输入（例如过期的定时器或扫描结果），调用者应丢弃
+    static bool Next(StationState from, StationInput input, StationState* to);
+
+    static const char* StateName(StationState state);
+    static const char* InputName(StationInput input);
+};
+
+#endif // STATION_FSM_H
@@ -0,0 +1,70 @@
+#ifndef TX_POWER_CONTROLLER_H
+#define TX_POWER_CONTROLLER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 发射功率单位与 esp_wifi_set_max_tx_power 一致：0.25 dBm，有效范围 [8, 84]
+struct TxPowerConfig {
+    int8_t min_power = 34;          // 8.5 dBm
+    int8_t max_power = 80;          // 20 dBm，上限；NVS 中配置了 max_tx_power 时以它为准
+    int8_t step = 4;                // 每次下调 1 dBm
+    int8_t rssi_high = -55;         // 平滑后的 RSSI 高于该值说明余量充足，可以下调
+    int8_t rssi_low = -67;          // 连续两次采样低于该值，或平滑后低于该值时上调
+    uint8_t failure_threshold = 3;  // 一个采样周期内的发送失败次数达到该值立即上调
+    // 驱动不报告上行发送失败，只有应用通过 WifiStation::NotifyTxFailures 上报时才能发现上行余量不足；
+    // 没有失败来源时只上调不下调，功率保持在上限
+    bool failure_feedback = false;
+    uint32_t hold_ms = 10 * 1000;   // 两次下调之间的最短间隔，上调不受限制
+};
+
+struct TxPowerStats {
+    int8_t current;
+    int8_t average;         // 本次连接按时间加权的平均功率
+    int8_t lowest;          // 本次连接的最低功率
+    uint32_t steps_up;
+    uint32_t steps_down;
+    uint32_t link_losses;
+};
+
+// 按链路余量闭环调整发射功率：余量充足时逐级下调，信号变差、发送失败或掉线时上调
+// RSSI 是 AP 下行帧的接收强度，AP 功率不变时反映路径损耗，用来估计上行余量；
+// 上下行不对称时只有发送失败能暴露问题，所以下调需要 failure_feedback
+// 所有存储都是定长的，不依赖 ESP-IDF 运行时，可以在主机上单独测试
+class TxPowerController {
+public:
+    static constexpr int8_t kMinPower = 8;
+    static constexpr int8_t kMaxPower = 84;
+
+    void SetConfig(const TxPowerConfig& config);
+    const TxPowerConfig& GetConfig() const { return config_; }
+
+    // 以上限功率开始新的连接
+    void Reset(uint32_t now_ms);
+    // 每个采样周期调用，返回应设置的功率
+    int8_t Update(uint32_t now_ms, int8_t rssi, uint32_t tx_failures);
+    // 已连接后掉线，回到上限功率重连
+    int8_t OnLinkLoss(uint32_t now_ms);
+    int8_t GetPower() const { return power_; }
+
+    TxPowerStats GetStats(uint32_t now_ms) const;
+
+private:
+    void SetPower(int8_t power, uint32_t now_ms);
+
+    TxPowerConfig config_;
+    int8_t power_ = 80;
+    int16_t rssi_avg_x4_ = 0;       // RSSI 的指数平均，放大 4 倍保留小数
+    bool rssi_valid_ = false;
+    uint8_t low_samples_ = 0;       // 连续低于 rssi_low 的采样次数
+    uint32_t last_change_ms_ = 0;
+    uint32_t since_ms_ = 0;         // 当前功率开始的时间
+    uint32_t start_ms_ = 0;
+    int64_t power_time_sum_ = 0;    // 功率 × 毫秒，用于计算平均值
+    int8_t lowest_ = 80;
+    uint32_t steps_up_ = 0;
+    uint32_t steps_down_ = 0;
+    uint32_t link_losses_ = 0;
+};
+
+#endif // TX_POWER_CONTROLLER_H
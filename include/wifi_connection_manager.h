@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <mutex>
 #include <freertos/FreeRTOS.h>
 #include <freertos/event_groups.h>
 #include <esp_wifi.h>
@@ -10,6 +11,13 @@
 #include <esp_log.h>
 #include <esp_timer.h>
 
+#include "connect_attempt_loop.h"
+#include "connect_retry_policy.h"
+#include "connect_report.h"
+#include "scan_cache.h"
+#include "scan_demand.h"
+#include "scan_topk.h"
+
 // 定义事件位
 #define WIFI_CONNECTED_BIT BIT0
 #define WIFI_FAIL_BIT      BIT1
@@ -27,12 +35,45 @@ void WifiConnectionManager_SaveCredentialsWithBssid(const char* ssid, const char
 }
 #endif
 
-class WifiConnectionManager {
+// 异步连接参数，默认值与原阻塞版本一致（4 次尝试，每次等 10 秒，间隔 1 秒）
+// 密码错误等确定性失败会提前结束，见 ConnectRetryPolicy
+struct ConnectOptions {
+    int max_retries = 4;
+    uint32_t attempt_timeout_ms = 10000;
+    uint32_t retry_delay_ms = 1000;
+    uint32_t transient_delay_ms = 200;
+    uint32_t deadline_ms = 44000;
+};
+
+enum class ConnectStatus {
+    kInvalid,    // 未知句柄或记录已被覆盖
+    kPending,
+    kConnected,
+    kFailed,
+    kCancelled,
+};
+
+typedef uint32_t ConnectHandle;
+
+// 完成回调：result 为 ESP_OK 时 bssid 为 "xx:xx:xx:xx:xx:xx"，否则为空串。
+// 取消或被新请求顶替时 result 为 ESP_ERR_INVALID_STATE。
+// 回调在 WiFi 事件任务或 esp_timer 任务中执行，不能阻塞，也不能调用阻塞版 Connect
+typedef std::function<void(esp_err_t result, const char* bssid)> ConnectCallback;
+
+class WifiConnectionManager : private ConnectAttemptDriver {
 public:
     static WifiConnectionManager& GetInstance();
 
     static esp_err_t InitializeWiFi();
 
+    // 非阻塞连接：立即返回句柄，重试由 WiFi 事件和定时器推进，结束时回调恰好调用一次。
+    // 参数非法或 set_config 失败时回调会在本函数返回前被调用。
+    // 同一时刻只有一个连接请求，新请求会取消尚未完成的旧请求
+    ConnectHandle ConnectAsync(const std::string& ssid, const std::string& password,
+                               const ConnectOptions& options, ConnectCallback callback);
+    bool Cancel(ConnectHandle handle);
+    ConnectStatus GetStatus(ConnectHandle handle);
+    // 阻塞版本：ConnectAsync 的薄封装，不能在事件循环或 esp_timer 任务中调用
     esp_err_t Connect(const std::string& ssid, const std::string& password, char* bssid_out = nullptr);
     void Disconnect();
     void SaveUid(const std::string& uid);
@@ -42,34 +83,98 @@ public:
     // 扫描结果回调：返回扫描到的 SSID 列表（按 RSSI 降序，最多30个）
     void OnScanResults(std::function<void(const std::vector<std::string>& ssids)> cb) { on_scan_results_ = std::move(cb); }
 
+    // 按需扫描：配网客户端要列表时调用，立即返回，结果通过扫描列表和 OnScanResults 送出。
+    // 已有扫描进行中，或距上次完整扫描不足 kScanMinIntervalMs 时合并到已有结果，不再发起新扫描；
+    // 连接进行中不扫描
+    void RequestScan();
+    // 后台刷新间隔，从上次扫描完成算起；0 表示只在有请求时扫描
+    void SetBackgroundScanInterval(uint32_t ms);
+
+    struct ScanInfo {
+        std::string ssid;
+        wifi_auth_mode_t authmode;
+        int8_t rssi;
+        uint8_t channel;
+    };
+    // 每个 SSID 一项，按 RSSI 降序，最多 MAX_WIFI_SCAN_SSID_COUNT 项
+    std::vector<ScanInfo> GetScanList();
+
+    static constexpr uint32_t kScanMinIntervalMs = 10 * 1000;
+    static constexpr uint32_t kDefaultBackgroundScanMs = 5 * 60 * 1000;
+
 private:
     WifiConnectionManager();
     ~WifiConnectionManager();
 
     static void WifiEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data);
     static void IpEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data);
-    void StartScanTimer();
-    void StopScanTimer();
     static void ScanTimerCallback(void* arg);
-    static const char* GetDisconnectReasonString(wifi_err_reason_t reason);
+    void ArmBackgroundScanLocked();
+
+    // 请求结束时从锁内取出回调，在锁外执行
+    struct Completion {
+        ConnectCallback callback;
+        esp_err_t result = ESP_OK;
+        char bssid[18] = {};
+        void Run();
+    };
+
+    // ConnectAttemptDriver，在 mutex_ 内由 attempt_loop_ 调用
+    esp_err_t StartConnect() override;
+    void ArmTimer(uint32_t ms) override;
+    void StopTimer() override;
+
+    // 尝试循环给出结束判定时完成请求
+    void ApplyDecisionLocked(const RetryDecision& decision, Completion& done);
+    void FinishLocked(ConnectOutcome outcome, esp_err_t result, Completion& done);
+    void OnAttemptTimer();
+    // 按当前请求的 ConnectReport 记录推断返回给调用者的错误码
+    esp_err_t ResolveError() const;
+    void RememberStatus(ConnectHandle handle, ConnectStatus status);
 
     EventGroupHandle_t event_group_;
     bool is_connecting_;
     esp_event_handler_instance_t instance_any_id_;
     esp_event_handler_instance_t instance_got_ip_;
+    // 后台刷新用的单次定时器，每次扫描结束后重新装填
     esp_timer_handle_t scan_timer_ = nullptr;
-    bool first_scan_done_ = false;  // 标记是否已完成首次扫描
-    
-    // 错误统计相关
+
+    // 异步连接状态，mutex_ 保护（事件任务、esp_timer 任务和调用者都会访问）
+    std::mutex mutex_;
+    esp_timer_handle_t attempt_timer_ = nullptr;
+    // 发起、等待、重试间隔与判定，每次尝试的详细结果记录在 ConnectReport 中
+    ConnectAttemptLoop attempt_loop_{*this};
+    ConnectHandle active_handle_ = 0;
+    ConnectHandle next_handle_ = 1;
+    ConnectOptions options_;
+    ConnectCallback callback_;
+    std::string ssid_;
+    char bssid_[18] = {};
+
+    // 最近结束的请求，供 GetStatus 查询
+    static constexpr int kStatusHistory = 4;
     struct {
-        esp_err_t error;
-        wifi_err_reason_t disconnect_reason;
-        int count;
-        int last_occurrence;
-        bool is_disconnect_error;
-    } error_stats_[10];
-    int error_stats_count_;
-    int current_retry_count_;
+        ConnectHandle handle;
+        ConnectStatus status;
+    } history_[kStatusHistory] = {};
+    int history_next_ = 0;
+
+    // 扫描缓存中的 AP，每个 SSID 一项，前 scan_top_count_ 项按 RSSI 降序。加密方式供重试策略判断
+    // 握手超时是否意味着密码错误，RSSI 和信道在断开事件不带这些信息时写入诊断记录
+    const ScanInfo* FindScanLocked(const std::string& ssid) const;
+    bool IsPskApLocked(const std::string& ssid) const;
+    std::vector<ScanInfo> scan_info_;
+    size_t scan_top_count_ = 0;
+    int8_t target_rssi_ = 0;
+
+    // 按需扫描状态，mutex_ 保护
+    ScanDemand scan_demand_{kScanMinIntervalMs};
+    uint32_t background_scan_ms_ = kDefaultBackgroundScanMs;
+
+    // SCAN_DONE 处理使用，只在事件任务中访问
+    std::vector<wifi_ap_record_t> scan_records_;
+    ScanCache scan_cache_;
+    ScanTopK scan_topk_;
     
     static const char* TAG;
     std::function<void(const std::vector<std::string>& ssids)> on_scan_results_;
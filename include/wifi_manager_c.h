@@ -53,6 +53,12 @@ void WifiConnectionManager_SaveUid(const char* uid);
  */
 void WifiConnectionManager_SaveServerUrl(const char* server_url);
 
+/**
+ * @brief 按需请求扫描，立即返回
+ * 已有扫描进行中或结果足够新时不会重复扫描，结果在下一次读取扫描列表时可见
+ */
+void WifiConnectionManager_RequestScan(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,79 @@
+#ifndef WIFI_ROAMING_H
+#define WIFI_ROAMING_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 漫游参数
+struct RoamConfig {
+    int8_t rssi_threshold = -75;        // 低于该信号强度时开始寻找更好的 AP
+    uint8_t hysteresis_db = 8;          // 候选 AP 至少要强这么多才切换，避免来回切换
+    uint32_t min_dwell_ms = 60 * 1000;  // 两次漫游之间的最短间隔
+    uint32_t rescan_interval_ms = 30 * 1000;  // 没有找到更好的 AP 时，隔多久再评估
+    uint32_t neighbor_timeout_ms = 500; // 等待 802.11k 邻居报告的时间
+};
+
+// 漫游统计
+struct RoamStats {
+    uint32_t triggers;          // 低信号事件次数
+    uint32_t scans;             // 漫游扫描次数
+    uint32_t neighbor_reports;  // 收到的 802.11k 邻居报告
+    uint32_t roams;             // 成功切换次数
+    uint32_t failures;          // 切换失败次数
+    uint32_t last_latency_ms;   // 最近一次切换耗时（发起切换到拿到 IP）
+    uint32_t avg_latency_ms;
+    uint32_t max_latency_ms;
+};
+
+// 漫游决策：迟滞、驻留时间与统计，不依赖 ESP-IDF 运行时，可以在主机上单独测试
+class RoamingPolicy {
+public:
+    void SetConfig(const RoamConfig& config) { config_ = config; }
+    const RoamConfig& GetConfig() const { return config_; }
+    const RoamStats& GetStats() const { return stats_; }
+
+    // 距上次漫游已超过驻留时间
+    bool CanRoam(uint32_t now_ms) const;
+    // 候选是否值得切换
+    bool IsBetter(int8_t current_rssi, int8_t candidate_rssi) const {
+        return candidate_rssi >= current_rssi + config_.hysteresis_db;
+    }
+
+    void OnTrigger() { stats_.triggers++; }
+    void OnScan() { stats_.scans++; }
+    void OnNeighborReport() { stats_.neighbor_reports++; }
+    void OnRoamStart(uint32_t now_ms);
+    void OnRoamDone(bool success, uint32_t now_ms);
+    bool IsRoaming() const { return roaming_; }
+
+    // 从 802.11k 邻居报告（若干个 Neighbor Report 元素）中取出信道，去重后返回个数
+    static size_t ParseNeighborChannels(const uint8_t* report, size_t report_len, uint8_t* channels, size_t max_channels);
+
+private:
+    RoamConfig config_;
+    RoamStats stats_ = {};
+    bool roaming_ = false;
+    bool has_roamed_ = false;
+    uint32_t roam_start_ms_ = 0;
+    uint32_t last_roam_ms_ = 0;
+};
+
+// 漫游扫描的候选选择：按扫描结果的顺序（RSSI 从强到弱）逐条提交同 SSID 的 AP，不需要额外的缓冲
+// 当前 AP 出现在同一次扫描中时用它的 RSSI 比较，与候选更有可比性
+class RoamSelection {
+public:
+    RoamSelection(const uint8_t* current_bssid, int8_t current_rssi);
+
+    void Offer(size_t index, const uint8_t* bssid, int8_t rssi, bool blocked);
+    // 返回值得切换（超过迟滞）的候选下标，没有时返回 -1
+    int Best(const RoamingPolicy& policy) const;
+    int8_t current_rssi() const { return current_rssi_; }
+
+private:
+    uint8_t current_bssid_[6];
+    int8_t current_rssi_;
+    int best_ = -1;
+    int8_t best_rssi_ = 0;
+};
+
+#endif // WIFI_ROAMING_H
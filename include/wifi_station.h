@@ -4,19 +4,50 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <memory>
+#include <atomic>
+#include <span>
+#include <string_view>
+#include <type_traits>
 
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
 #include <esp_event.h>
 #include <esp_timer.h>
 #include <esp_wifi_types_generic.h>
+#include <esp_netif.h>
 
+#include "candidate_scorer.h"
+#include "backoff_policy.h"
+#include "scan_planner.h"
+#include "hidden_probe.h"
+#include "wifi_roaming.h"
+#include "scan_arena.h"
+#include "station_fsm.h"
+#include "connect_budget.h"
+#include "power_save_policy.h"
+#include "tx_power_controller.h"
+#include "reachability_probe.h"
+#include "link_snapshot.h"
+#include "bssid_blocklist.h"
+#include "fast_connect.h"
+
+// 候选 AP，定长存储，放入连接队列时不申请堆内存
 struct WifiApRecord {
-    std::string ssid;
-    std::string password;
+    char ssid[33];
+    char password[65];
     int channel;
     wifi_auth_mode_t authmode;
     uint8_t bssid[6];
+    int32_t score;
 };
 
+// 所有状态只在站点自己的任务中修改：WiFi/IP 事件、定时器和下面的公开接口都只向一个定长队列投递消息
+// 设置类接口与 ConnectToWifi 不阻塞调用者；Start / Stop / AddAuth / ClearAuth 和读取内部状态的 Get 接口
+// 在站点任务中执行并等待其完成，返回的都是副本。回调在站点任务中执行，回调里调用这些接口会直接执行
+// Start / Stop 会注册/注销事件处理函数，不要在默认事件循环的回调中调用（事件循环持有自己的锁）
 class WifiStation {
 public:
     static WifiStation& GetInstance();
@@ -25,15 +56,68 @@ public:
     void Start();
     void Stop();
     bool IsConnected();
+    StationState GetState() const { return state_.load(); }
     bool WaitForConnected(int timeout_ms = 10000);
-    int8_t GetRssi();
-    std::string GetSsid() const { return ssid_; }
-    std::string GetIpAddress() const { return ip_address_; }
-    uint8_t GetChannel();
+    // 以下读取链路快照，不调用驱动，未连接时返回 0
+    int8_t GetRssi() const;
+    uint8_t GetChannel() const;
+    std::string GetSsid() const;
+    std::string GetIpAddress() const;
+    // RSSI、信道、BSSID、IP、连接时间与 PHY 模式的一致副本，可在任意任务中调用
+    LinkState GetLinkState() const { return link_.Read(); }
+    // 手动设置省电模式，同时关闭自动省电
     void SetPowerSaveMode(bool enabled);
 
+    // 自动省电：按收发流量在 NONE / MIN_MODEM / MAX_MODEM 之间切换，默认关闭
+    void SetAutoPowerSave(bool enabled, const PowerSaveConfig& config = PowerSaveConfig());
+    // 没有开启 CONFIG_ESP_NETIF_REPORT_DATA_TRAFFIC 时，由应用上报收发包数
+    void NotifyTraffic(uint32_t packets) { traffic_packets_.fetch_add(packets, std::memory_order_relaxed); }
+    // 低延迟窗口（可嵌套），期间保持 WIFI_PS_NONE；HoldLowLatency 在 duration_ms 后自动结束
+    void BeginLowLatency();
+    void EndLowLatency();
+    void HoldLowLatency(uint32_t duration_ms);
+    // 各模式的停留时间，自动省电开启时每个采样周期更新
+    PowerSaveStats GetPowerSaveStats() const;
+
+    // 发射功率闭环控制（默认关闭）：NVS 中的 max_tx_power 作为上限，已连接时按链路余量逐级调整
+    void SetTxPowerControl(bool enabled, const TxPowerConfig& config = TxPowerConfig());
+    // 应用层发送失败（例如 socket 发送超时）作为上调功率的信号；config.failure_feedback 为 true 时才会下调功率
+    void NotifyTxFailures(uint32_t count) { tx_failures_.fetch_add(count, std::memory_order_relaxed); }
+    // 当前与平均发射功率（0.25 dBm），控制开启时每个采样周期更新
+    TxPowerStats GetTxPowerStats() const;
+
+    // 拿到 IP 后检查外网可达性（默认关闭），失败时降低该网络的排名并切换到其他保存的网络
+    void SetReachabilityCheck(bool enabled, const ReachabilityConfig& config = ReachabilityConfig());
+    Reachability GetReachability() const { return reachability_.load(); }
+
+    // 重连与重新扫描的退避策略，max_reconnect_count 为同一 AP 断开后的重连次数上限
+    void SetReconnectPolicy(std::unique_ptr<BackoffPolicy> policy, int max_reconnect_count);
+    void SetRescanPolicy(std::unique_ptr<BackoffPolicy> policy);
+
+    // 每个 SSID 的连接次数/时间预算与一轮连接的总时限，以及连接耗时统计
+    void SetConnectBudget(const ConnectBudgetConfig& config);
+    ConnectCycleReport GetConnectReport() const;
+
+    // 重连时用该网络上次的 DHCP 租约发起 INIT-REBOOT（默认开启），服务器拒绝（NAK）或不应答时由 lwIP 回到完整 DHCP
+    void SetDhcpLeaseCache(bool enabled);
+
+    // 候选 AP 评分权重与诊断信息
+    void SetScoreWeights(const ScoreWeights& weights);
+    ScoreWeights GetScoreWeights() const;
+    size_t GetCandidateScores(ScoreBreakdown* out, size_t max_count) const;
+    // 因连续失败被暂时屏蔽的 BSSID
+    size_t GetBlocklist(BlocklistEntry* out, size_t max_count) const;
+
+    // 按频段统计的扫描耗时（kScanBand2g / kScanBand5g / kScanBandBoth）
+    BandScanStats GetScanStats(ScanBand band) const;
+
+    // 后台漫游：信号低于阈值时在同一 SSID 内寻找更好的 AP
+    void SetRoamConfig(const RoamConfig& config);
+    RoamConfig GetRoamConfig() const;
+    RoamStats GetRoamStats() const;
+
     
-    // 临时连接指定WiFi（不保存到NVS）
+    // 临时连接指定WiFi（不保存到NVS），返回请求是否已提交
     bool ConnectToWifi(const std::string& ssid, const std::string& password);
     
     // 临时连接指定WiFi并等待连接结果
@@ -42,7 +126,11 @@ public:
     void OnConnect(std::function<void(const std::string& ssid)> on_connect);
     void OnConnected(std::function<void(const std::string& ssid)> on_connected);
     void OnScanBegin(std::function<void()> on_scan_begin);
-    void OnScanResults(std::function<void(const std::vector<std::string>& ssids)> on_scan_results);
+    // 扫描结果回调，在站点任务中执行。ssids 按 RSSI 从高到低排列
+    // 注意：span 和其中的每个 string_view 都指向内部扫描缓冲区，下一次扫描（回调返回后随时可能开始）会覆盖它们，
+    // 所以只在回调期间有效，需要保留的内容请在回调内复制成 std::string。
+    // 旧接口的参数是 std::vector<std::string>，按值持有结果的调用方需要改为在回调中复制
+    void OnScanResults(std::function<void(std::span<const std::string_view> ssids)> on_scan_results);
 
 private:
     WifiStation();
@@ -50,9 +138,76 @@ private:
     WifiStation(const WifiStation&) = delete;
     WifiStation& operator=(const WifiStation&) = delete;
 
+    static constexpr size_t kMaxRoamChannels = 8;
+
+    enum class MessageType : uint8_t {
+        // 公开接口；kCall 在站点任务中执行调用方的函数并通知其完成
+        kCall, kConnectTo,
+        kSetReconnectPolicy, kSetRescanPolicy, kSetLeaseCache, kSetScoreWeights, kSetRoamConfig, kSetConnectBudget,
+        kSetPowerSave, kSetAutoPowerSave, kLatencyBegin, kLatencyEnd, kLatencyHold, kSetTxPowerControl,
+        kSetReachability,
+        // WiFi / IP 事件与网关确认
+        kStaStart, kScanDone, kLinkUp, kDisconnected, kGotIp, kRssiLow, kNeighborReport, kProbeDone,
+        // 定时器合并为一条 kTimers 唤醒消息，到期的定时器记在 pending_timers_ 中
+        kTimers,
+        kScanTimer, kFastConnectTimer, kReconnectTimer, kRoamTimer, kPowerSaveTimer, kTxPowerTimer, kProbeTimer,
+        kLinkTimer,
+    };
+    struct Credentials {
+        char ssid[33];
+        char password[65];
+    };
+    // 队列按值拷贝，不做任何堆分配
+    struct Message {
+        MessageType type;
+        union {
+            int32_t value = 0;          // 断开原因、信道、RSSI、开关
+            Credentials credentials;
+            esp_netif_ip_info_t ip_info;
+            struct {
+                void (*fn)(void* context);
+                void* context;          // 指向调用方栈上的数据，调用方等待 done 之前一直有效
+                SemaphoreHandle_t done;
+            } call;
+            struct {
+                uint8_t channels[kMaxRoamChannels];
+                uint8_t count;
+            } neighbor;
+            struct {
+                BackoffPolicy* policy;  // 所有权随消息转移
+                int max_count;
+            } backoff;
+            ScoreWeights weights;
+            RoamConfig roam_config;
+            ConnectBudgetConfig budget_config;
+            struct {
+                PowerSaveConfig config;
+                bool enabled;
+            } power_save;
+            struct {
+                TxPowerConfig config;
+                bool enabled;
+            } tx_power;
+            struct {
+                ReachabilityConfig config;
+                bool enabled;
+            } reachability;
+            struct {
+                uint32_t generation;
+                uint32_t elapsed_ms;
+                Reachability result;
+            } probe;
+        };
+    };
+
     EventGroupHandle_t event_group_;
+    QueueHandle_t message_queue_ = nullptr;
+    TaskHandle_t task_ = nullptr;
+    std::atomic<StationState> state_{StationState::kIdle};
     static bool netif_initialized_;
     esp_timer_handle_t timer_handle_ = nullptr;
+    esp_timer_handle_t fast_connect_timer_ = nullptr;
+    esp_timer_handle_t reconnect_timer_ = nullptr;
     esp_event_handler_instance_t instance_any_id_ = nullptr;
     esp_event_handler_instance_t instance_got_ip_ = nullptr;
     std::string ssid_;
@@ -61,16 +216,154 @@ private:
     int8_t max_tx_power_;
     uint8_t remember_bssid_;
     int reconnect_count_ = 0;
+    int max_reconnect_count_;
+    std::unique_ptr<BackoffPolicy> reconnect_backoff_;
+    std::unique_ptr<BackoffPolicy> rescan_backoff_;
+    FastConnect fast_connect_;      // 上次连接的记录与连续失败次数，均持久化到 NVS
+    int64_t start_time_us_ = 0;
     std::function<void(const std::string& ssid)> on_connect_;
     std::function<void(const std::string& ssid)> on_connected_;
     std::function<void()> on_scan_begin_;
-    std::function<void(const std::vector<std::string>& ssids)> on_scan_results_;
-    std::vector<WifiApRecord> connect_queue_;
+    std::function<void(std::span<const std::string_view> ssids)> on_scan_results_;
+    ScanArena scan_arena_;
+    CandidateQueue<WifiApRecord, 16> connect_queue_;
+    CandidateScorer scorer_;
+    BssidBlocklist blocklist_;
+    ConnectBudget connect_budget_;
+    ScanPlanner scan_planner_;
+    int64_t scan_start_us_ = 0;     // 当前普通扫描的开始时间，0 表示没有需要计时的扫描
+    uint8_t scan_bands_ = 0;
+    HiddenProbeScheduler hidden_probe_;
+    // 当前扫描周期的阶段：普通扫描之后，对未见过的保存网络逐个发起定向扫描
+    enum class ScanPhase { kNormal, kHiddenProbe };
+    ScanPhase scan_phase_ = ScanPhase::kNormal;
+    uint8_t probe_batch_[HiddenProbeScheduler::kBatchSize] = {};
+    size_t probe_count_ = 0;
+    size_t probe_pos_ = 0;
+    uint8_t probe_ssid_[33] = {};
+    uint8_t current_bssid_[6] = {};
+    // DHCP 租约缓存：发起连接时取出目标网络缓存的地址，关联成功后作为 INIT-REBOOT 的请求地址
+    bool dhcp_lease_cache_ = true;
+    uint32_t lease_hint_ip_ = 0;
+    // 漫游状态：kWaitNeighbor 等待 802.11k 邻居报告，kScanning 扫描同一 SSID，kSwitching 已断开当前 AP 正在连接新的 BSSID
+    enum class RoamState { kIdle, kWaitNeighbor, kScanning, kSwitching };
+    RoamState roam_state_ = RoamState::kIdle;
+    RoamingPolicy roaming_;
+    esp_timer_handle_t roam_timer_ = nullptr;
+    int8_t roam_trigger_rssi_ = 0;
+    bool roam_reconnecting_ = false;
+    uint8_t roam_channels_[kMaxRoamChannels] = {};
+    size_t roam_channel_count_ = 0;
+    uint8_t roam_ssid_[33] = {};
+    wifi_config_t roam_prev_config_ = {};
+    uint8_t roam_prev_bssid_[6] = {};
+    // 自动省电：收发包计数由事件循环累加，站点任务每个采样周期取走
+    PowerSavePolicy power_save_;
+    bool auto_power_save_ = false;
+    wifi_ps_type_t power_save_mode_ = WIFI_PS_MIN_MODEM;
+    esp_timer_handle_t power_save_timer_ = nullptr;
+    std::atomic<uint32_t> traffic_packets_{0};
+    // 到期未处理的定时器，按 MessageType 相对 kScanTimer 的偏移置位
+    std::atomic<uint32_t> pending_timers_{0};
+    // 唤醒消息因队列满而没有投递出去，站点任务处理完当前消息后检查
+    std::atomic<bool> timers_wake_lost_{false};
+    esp_event_handler_instance_t instance_tx_rx_ = nullptr;
+    PowerSaveStats power_save_stats_ = {};     // 每个采样周期更新的快照
+    // 发射功率控制：发送失败计数由应用在其他任务中累加
+    TxPowerController tx_power_;
+    bool tx_power_control_ = false;
+    esp_timer_handle_t tx_power_timer_ = nullptr;
+    std::atomic<uint32_t> tx_failures_{0};
+    TxPowerStats tx_power_stats_ = {};
+    // 外网可达性检查：probe_generation_ 在每次连接变化时递增，丢弃过期的结果
+    ReachabilityProbe probe_;
+    ReachabilityConfig reachability_config_;
+    bool reachability_check_ = false;
+    std::atomic<Reachability> reachability_{Reachability::kUnknown};
+    uint32_t probe_generation_ = 0;
+    bool probe_failover_ = false;
+    esp_timer_handle_t probe_timer_ = nullptr;
+    DemotionList demoted_;
+    // 最近一次普通扫描中出现的保存网络，外网检查失败时据此判断是否有别的网络可以切换
+    uint32_t seen_saved_[HiddenProbeScheduler::kMaxNetworks] = {};
+    size_t seen_saved_count_ = 0;
+    // 链路快照：link_state_ 只在站点任务中修改，修改后发布到 link_
+    LinkSnapshot link_;
+    LinkState link_state_ = {};
+    esp_timer_handle_t link_timer_ = nullptr;
 
+    // 公开接口的投递：队列满时最多等待 STATION_POST_TIMEOUT_MS，且不占用为事件保留的位置
+    bool Post(const Message& message) const;
+    bool Post(MessageType type) const;
+    // 事件处理函数与回调的投递：默认不等待，可以使用保留的位置
+    bool PostEvent(const Message& message, TickType_t wait = 0) const;
+    // 定时器回调：只置位，队列中最多一条 kTimers 唤醒消息
+    void PostTimer(MessageType type);
+    void DispatchTimers();
+    // 在站点任务中执行 fn 并等待完成，在站点任务中调用时直接执行；消息投递失败时返回 false，fn 不会执行
+    bool Call(void (*fn)(void* context), void* context) const;
+    template <typename F>
+    bool Call(F&& fn) const {
+        return Call([](void* context) { (*static_cast<std::remove_reference_t<F>*>(context))(); }, &fn);
+    }
+    void Run();
+    void Dispatch(const Message& message);
+    bool Transition(StationInput input);
+    void DoStart();
+    void DoStop();
+    void DoConnectTo(const Credentials& credentials);
+    void OnStaStart();
+    void OnLinkUp(uint8_t channel);
+    void OnDisconnected(uint8_t reason);
+    void OnGotIp(const esp_netif_ip_info_t& ip_info);
+    void OnFastConnectTimeout();
+    void OnNeighborReport(const uint8_t* channels, size_t count);
+    void OnRoamTimer();
+    void OnReconnectTimer();
+    void Reconnect();
     void HandleScanResult();
-    void StartConnect();
+    bool StartConnect();
+    void StartScan();
+    void ScheduleRescan();
+    bool StartHiddenProbe();
+    void ConnectToRecord(const WifiApRecord& ap_record, bool lock_bssid);
+    bool TryFastConnect();
+    void AbortFastConnect();
+    void LoadLastAp();
+    void SaveLastAp();
+    void ClearLastAp();
+    void SaveLastApFailures(uint8_t failures);
+    void ApplyCachedLease(const std::string& ssid);
+    void RequestCachedLease();
+    void SaveDhcpLease(const esp_netif_ip_info_t& ip_info);
+    void ArmRoaming();
+    void OnRssiLow(int8_t rssi);
+    void StartRoamScan();
+    void HandleRoamScan();
+    void SwitchToAp(const wifi_ap_record_t& ap_record);
+    void FinishRoam(bool success);
+    void AbortRoam();
+    void ApplyPowerSave(wifi_ps_type_t mode);
+    void ApplyPowerSaveMode(PowerSaveMode mode);
+    void StartPowerSave();
+    void StopPowerSave();
+    void EnableTrafficEvents();
+    void DisableTrafficEvents();
+    void OnPowerSaveTimer();
+    void ApplyListenInterval(wifi_config_t& wifi_config) const;
+    void ApplyTxPower(int8_t power);
+    void StartTxPowerControl();
+    void OnTxPowerTimer();
+    void StartReachabilityProbe();
+    void RecordSeenSaved(uint32_t ssid_hash);
+    bool HasFailoverCandidate(uint32_t current_hash, uint32_t now_ms) const;
+    void OnProbeDone(uint32_t generation, Reachability result, uint32_t elapsed_ms);
+    void ResetReachability();
+    void PublishLink();
+    bool SampleLink();
     static void WifiEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data);
     static void IpEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data);
+    static void TrafficEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data);
 };
 
 #endif // _WIFI_STATION_H_
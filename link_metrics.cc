@@ -0,0 +1,225 @@
+#include "link_metrics.h"
+
+#include <algorithm>
+#include <cJSON.h>
+
+#include "disconnect_reason.h"
+
+void LinkMetrics::OnRssi(int8_t rssi) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (rssi_samples_ == 0) {
+        rssi_avg_x16_ = rssi * 16;
+        rssi_min_ = rssi;
+        rssi_max_ = rssi;
+    } else {
+        rssi_avg_x16_ += (rssi * 16 - rssi_avg_x16_) >> kRssiAlphaShift;
+        rssi_min_ = std::min(rssi_min_, rssi);
+        rssi_max_ = std::max(rssi_max_, rssi);
+    }
+    rssi_samples_++;
+}
+
+void LinkMetrics::OnConnected(uint32_t now_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (connected_) {
+        return;     // 漫游或续约后的重复 GOT_IP
+    }
+    associations_++;
+    connected_ = true;
+    connected_since_ms_ = now_ms;
+    if (lost_) {
+        lost_ = false;
+        reconnects_++;
+        reconnect_ms_[reconnect_head_] = now_ms - lost_at_ms_;
+        reconnect_head_ = (reconnect_head_ + 1) % kReconnectSamples;
+        reconnect_count_ = std::min(reconnect_count_ + 1, kReconnectSamples);
+    }
+}
+
+void LinkMetrics::OnDisconnected(uint8_t reason, uint32_t now_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    disconnects_++;
+    if (reason_counts_[reason] < UINT16_MAX) {
+        reason_counts_[reason]++;
+    }
+    if (!connected_) {
+        return;     // 连接尝试失败，只计入直方图
+    }
+    connected_ = false;
+    uint32_t uptime_ms = now_ms - connected_since_ms_;
+    uptime_last_ms_ = uptime_ms;
+    uptime_max_ms_ = std::max(uptime_max_ms_, uptime_ms);
+    uptime_total_ms_ += uptime_ms;
+    uptime_count_++;
+    lost_ = true;
+    lost_at_ms_ = now_ms;
+}
+
+LinkMetricsSummary LinkMetrics::SummaryLocked(uint32_t now_ms) const {
+    LinkMetricsSummary summary = {};
+    if (rssi_samples_ > 0) {
+        summary.rssi_avg = rssi_avg_x16_ / 16;
+        summary.rssi_min = rssi_min_;
+        summary.rssi_max = rssi_max_;
+    }
+    summary.rssi_samples = rssi_samples_;
+    summary.associations = associations_;
+    summary.disconnects = disconnects_;
+    summary.reconnects = reconnects_;
+    summary.uptime_last_ms = uptime_last_ms_;
+    summary.uptime_max_ms = uptime_max_ms_;
+    summary.uptime_avg_ms = uptime_count_ > 0 ? uptime_total_ms_ / uptime_count_ : 0;
+    summary.uptime_current_ms = connected_ ? now_ms - connected_since_ms_ : 0;
+
+    if (reconnect_count_ > 0) {
+        uint32_t samples[kReconnectSamples];
+        std::copy(reconnect_ms_, reconnect_ms_ + reconnect_count_, samples);
+        uint32_t* end = samples + reconnect_count_;
+        auto percentile = [&](size_t percent) {
+            uint32_t* nth = samples + (reconnect_count_ - 1) * percent / 100;
+            std::nth_element(samples, nth, end);
+            return *nth;
+        };
+        summary.reconnect_p50_ms = percentile(50);
+        summary.reconnect_p90_ms = percentile(90);
+        summary.reconnect_max_ms = *std::max_element(samples, end);
+    }
+    return summary;
+}
+
+LinkMetricsSummary LinkMetrics::GetSummary(uint32_t now_ms) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return SummaryLocked(now_ms);
+}
+
+size_t LinkMetrics::GetReasons(uint8_t* reasons, uint16_t* counts, size_t max_count) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (size_t reason = 0; reason < 256; reason++) {
+        uint16_t value = reason_counts_[reason];
+        if (value == 0) {
+            continue;
+        }
+        // 插入排序，保留次数最多的 max_count 个
+        size_t pos = count < max_count ? count++ : max_count;
+        while (pos > 0 && counts[pos - 1] < value) {
+            if (pos < max_count) {
+                reasons[pos] = reasons[pos - 1];
+                counts[pos] = counts[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < max_count) {
+            reasons[pos] = reason;
+            counts[pos] = value;
+        }
+    }
+    return count;
+}
+
+std::string LinkMetrics::GetJson(uint32_t now_ms) const {
+    LinkMetricsSummary summary = GetSummary(now_ms);
+    uint8_t reasons[32];
+    uint16_t counts[32];
+    size_t reason_count = GetReasons(reasons, counts, 32);
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON* rssi = cJSON_AddObjectToObject(root, "rssi");
+    cJSON_AddNumberToObject(rssi, "avg", summary.rssi_avg);
+    cJSON_AddNumberToObject(rssi, "min", summary.rssi_min);
+    cJSON_AddNumberToObject(rssi, "max", summary.rssi_max);
+    cJSON_AddNumberToObject(rssi, "samples", summary.rssi_samples);
+    cJSON_AddNumberToObject(root, "associations", summary.associations);
+    cJSON_AddNumberToObject(root, "disconnects", summary.disconnects);
+    cJSON_AddNumberToObject(root, "reconnects", summary.reconnects);
+    cJSON* uptime = cJSON_AddObjectToObject(root, "uptime_ms");
+    cJSON_AddNumberToObject(uptime, "current", summary.uptime_current_ms);
+    cJSON_AddNumberToObject(uptime, "last", summary.uptime_last_ms);
+    cJSON_AddNumberToObject(uptime, "avg", summary.uptime_avg_ms);
+    cJSON_AddNumberToObject(uptime, "max", summary.uptime_max_ms);
+    cJSON* reconnect = cJSON_AddObjectToObject(root, "reconnect_ms");
+    cJSON_AddNumberToObject(reconnect, "p50", summary.reconnect_p50_ms);
+    cJSON_AddNumberToObject(reconnect, "p90", summary.reconnect_p90_ms);
+    cJSON_AddNumberToObject(reconnect, "max", summary.reconnect_max_ms);
+    cJSON* array = cJSON_AddArrayToObject(root, "reasons");
+    for (size_t i = 0; i < reason_count; i++) {
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddNumberToObject(item, "reason", reasons[i]);
+        cJSON_AddStringToObject(item, "name", DisconnectReasonString(reasons[i]));
+        cJSON_AddNumberToObject(item, "count", counts[i]);
+        cJSON_AddItemToArray(array, item);
+    }
+    char* printed = cJSON_PrintUnformatted(root);
+    std::string json = printed != nullptr ? printed : "{}";
+    cJSON_free(printed);
+    cJSON_Delete(root);
+    return json;
+}
+
+static uint8_t* PutU16(uint8_t* p, uint16_t value) {
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+    return p + 2;
+}
+
+static uint8_t* PutU32(uint8_t* p, uint32_t value) {
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+    p[2] = (value >> 16) & 0xFF;
+    p[3] = (value >> 24) & 0xFF;
+    return p + 4;
+}
+
+size_t LinkMetrics::GetBinary(uint8_t* out, size_t out_size, uint32_t now_ms) const {
+    if (out_size < kBinaryHeaderSize + 1) {
+        return 0;
+    }
+    LinkMetricsSummary summary = GetSummary(now_ms);
+    uint8_t reasons[32];
+    uint16_t counts[32];
+    size_t max_reasons = std::min<size_t>(32, (out_size - kBinaryHeaderSize - 1) / 3);
+    size_t reason_count = GetReasons(reasons, counts, max_reasons);
+
+    uint8_t* p = out;
+    *p++ = kBinaryVersion;
+    *p++ = (uint8_t)summary.rssi_avg;
+    *p++ = (uint8_t)summary.rssi_min;
+    *p++ = (uint8_t)summary.rssi_max;
+    p = PutU32(p, summary.rssi_samples);
+    p = PutU32(p, summary.associations);
+    p = PutU32(p, summary.disconnects);
+    p = PutU32(p, summary.reconnects);
+    p = PutU32(p, summary.uptime_current_ms);
+    p = PutU32(p, summary.uptime_last_ms);
+    p = PutU32(p, summary.uptime_avg_ms);
+    p = PutU32(p, summary.uptime_max_ms);
+    p = PutU32(p, summary.reconnect_p50_ms);
+    p = PutU32(p, summary.reconnect_p90_ms);
+    p = PutU32(p, summary.reconnect_max_ms);
+    *p++ = (uint8_t)reason_count;
+    for (size_t i = 0; i < reason_count; i++) {
+        *p++ = reasons[i];
+        p = PutU16(p, counts[i]);
+    }
+    return p - out;
+}
+
+void LinkMetrics::Clear() {
+    // 保留当前连接的状态，之后的掉线仍能正确计算持续时间
+    std::lock_guard<std::mutex> lock(mutex_);
+    rssi_avg_x16_ = 0;
+    rssi_min_ = 0;
+    rssi_max_ = 0;
+    rssi_samples_ = 0;
+    std::fill(std::begin(reason_counts_), std::end(reason_counts_), 0);
+    disconnects_ = 0;
+    associations_ = 0;
+    reconnects_ = 0;
+    lost_ = false;
+    uptime_last_ms_ = 0;
+    uptime_max_ms_ = 0;
+    uptime_total_ms_ = 0;
+    uptime_count_ = 0;
+    reconnect_head_ = 0;
+    reconnect_count_ = 0;
+}
@@ -0,0 +1,48 @@
+#include "link_snapshot.h"
+
+#include <cstring>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// 连续这么多次读到写入中途后让出 CPU
+#define LINK_SNAPSHOT_SPIN_RETRIES 16
+
+void LinkSnapshot::Write(const LinkState& state) {
+    uint32_t words[kWords] = {};
+    memcpy(words, &state, sizeof(state));
+
+    uint32_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; i++) {
+        words_[i].store(words[i], std::memory_order_relaxed);
+    }
+    seq_.store(seq + 2, std::memory_order_release);
+}
+
+LinkState LinkSnapshot::Read() const {
+    uint32_t words[kWords];
+    int retries = 0;
+    while (true) {
+        uint32_t before = seq_.load(std::memory_order_acquire);
+        if ((before & 1) == 0) {
+            for (size_t i = 0; i < kWords; i++) {
+                words[i] = words_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+        // 写入只有几条存储指令，通常重试一两次即可；但读者优先级高于站点任务且在同一核上时，
+        // 写入端被抢占在中途，自旋（包括 taskYIELD）都不会让它继续，只能睡一个 tick
+        if (++retries >= LINK_SNAPSHOT_SPIN_RETRIES) {
+            vTaskDelay(1);
+            retries = 0;
+        }
+    }
+    LinkState state;
+    memcpy(&state, words, sizeof(state));
+    return state;
+}
@@ -0,0 +1,86 @@
+#include "power_save_policy.h"
+
+void PowerSavePolicy::Reset(PowerSaveMode mode, uint32_t now_ms) {
+    mode_ = mode;
+    mode_since_ms_ = now_ms;
+    last_update_ms_ = now_ms;
+    // 只有从 NONE 开始才保持 none_hold_ms；否则没有流量时第一次采样不应切到 NONE 再回落
+    last_busy_ms_ = mode == PowerSaveMode::kNone ? now_ms : now_ms - config_.none_hold_ms;
+    last_active_ms_ = now_ms;
+}
+
+void PowerSavePolicy::SwitchTo(PowerSaveMode mode, uint32_t now_ms) {
+    if (mode == mode_) {
+        return;
+    }
+    stats_.residency_ms[static_cast<size_t>(mode_)] += now_ms - mode_since_ms_;
+    stats_.switches++;
+    mode_ = mode;
+    mode_since_ms_ = now_ms;
+}
+
+bool PowerSavePolicy::LatencyCritical(uint32_t now_ms) const {
+    return latency_depth_ > 0 || (int32_t)(hold_until_ms_ - now_ms) > 0;
+}
+
+PowerSaveMode PowerSavePolicy::Update(uint32_t now_ms, uint32_t packets) {
+    uint32_t elapsed_ms = now_ms - last_update_ms_;
+    last_update_ms_ = now_ms;
+    uint32_t pps = elapsed_ms > 0 ? (uint64_t)packets * 1000 / elapsed_ms : 0;
+
+    if (pps >= config_.busy_pps) {
+        last_busy_ms_ = now_ms;
+    }
+    if (pps > config_.idle_pps) {
+        last_active_ms_ = now_ms;
+    }
+
+    PowerSaveMode target;
+    if (LatencyCritical(now_ms) || now_ms - last_busy_ms_ < config_.none_hold_ms) {
+        target = PowerSaveMode::kNone;
+    } else if (now_ms - last_active_ms_ >= config_.max_modem_idle_ms) {
+        target = PowerSaveMode::kMaxModem;
+    } else {
+        target = PowerSaveMode::kMinModem;
+    }
+    SwitchTo(target, now_ms);
+    return mode_;
+}
+
+PowerSaveMode PowerSavePolicy::BeginLatencyCritical(uint32_t now_ms) {
+    if (latency_depth_ < UINT8_MAX) {
+        latency_depth_++;
+    }
+    stats_.latency_windows++;
+    SwitchTo(PowerSaveMode::kNone, now_ms);
+    return mode_;
+}
+
+PowerSaveMode PowerSavePolicy::EndLatencyCritical(uint32_t now_ms) {
+    if (latency_depth_ > 0) {
+        latency_depth_--;
+    }
+    // 窗口结束视为一次突发，之后按 none_hold_ms 正常回落
+    if (latency_depth_ == 0) {
+        last_busy_ms_ = now_ms;
+        last_active_ms_ = now_ms;
+    }
+    return mode_;
+}
+
+PowerSaveMode PowerSavePolicy::HoldLatency(uint32_t now_ms, uint32_t duration_ms) {
+    uint32_t until = now_ms + duration_ms;
+    if (!LatencyCritical(now_ms) || (int32_t)(until - hold_until_ms_) > 0) {
+        hold_until_ms_ = until;
+    }
+    last_active_ms_ = now_ms;
+    stats_.latency_windows++;
+    SwitchTo(PowerSaveMode::kNone, now_ms);
+    return mode_;
+}
+
+PowerSaveStats PowerSavePolicy::GetStats(uint32_t now_ms) const {
+    PowerSaveStats stats = stats_;
+    stats.residency_ms[static_cast<size_t>(mode_)] += now_ms - mode_since_ms_;
+    return stats;
+}
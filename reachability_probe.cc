@@ -0,0 +1,221 @@
+#include "reachability_probe.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <lwip/sockets.h>
+#include <lwip/netdb.h>
+
+#define TAG "Reachability"
+#define PROBE_TASK_STACK_SIZE 4096
+#define PROBE_TASK_PRIORITY 3
+
+const char* ReachabilityName(Reachability state) {
+    switch (state) {
+    case Reachability::kUnknown: return "unknown";
+    case Reachability::kProbing: return "probing";
+    case Reachability::kReachable: return "reachable";
+    case Reachability::kDnsFailed: return "dns_failed";
+    case Reachability::kConnectFailed: return "connect_failed";
+    case Reachability::kHttpFailed: return "http_failed";
+    case Reachability::kTimeout: return "timeout";
+    }
+    return "unknown";
+}
+
+bool ReachabilityProbe::Start(const ReachabilityConfig& config, uint32_t generation, Callback callback, void* arg) {
+    bool expected = false;
+    if (!busy_.compare_exchange_strong(expected, true)) {
+        return false;
+    }
+    config_ = config;
+    generation_ = generation;
+    callback_ = callback;
+    arg_ = arg;
+    if (xTaskCreate(&ReachabilityProbe::TaskEntry, "wifi_probe", PROBE_TASK_STACK_SIZE, this,
+        PROBE_TASK_PRIORITY, nullptr) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create probe task");
+        busy_ = false;
+        return false;
+    }
+    return true;
+}
+
+void ReachabilityProbe::TaskEntry(void* arg) {
+    auto* this_ = static_cast<ReachabilityProbe*>(arg);
+    int64_t start_us = esp_timer_get_time();
+    Reachability result = Check(this_->config_);
+    uint32_t elapsed_ms = (esp_timer_get_time() - start_us) / 1000;
+    // 先取出回调参数再释放，回调中可以立即发起下一次检查
+    Callback callback = this_->callback_;
+    void* callback_arg = this_->arg_;
+    uint32_t generation = this_->generation_;
+    this_->busy_ = false;
+    if (callback != nullptr) {
+        callback(callback_arg, generation, result, elapsed_ms);
+    }
+    vTaskDelete(nullptr);
+}
+
+// 距离截止时间的剩余毫秒数，已超时返回 0
+static uint32_t RemainingMs(int64_t deadline_us) {
+    int64_t remaining_us = deadline_us - esp_timer_get_time();
+    return remaining_us > 0 ? (uint32_t)(remaining_us / 1000) : 0;
+}
+
+static void SetSocketTimeout(int sock, uint32_t timeout_ms) {
+    struct timeval tv = {
+        .tv_sec = (time_t)(timeout_ms / 1000),
+        .tv_usec = (suseconds_t)((timeout_ms % 1000) * 1000),
+    };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+Reachability ReachabilityProbe::Check(const ReachabilityConfig& config) {
+    int64_t deadline_us = esp_timer_get_time() + (int64_t)config.timeout_ms * 1000;
+
+    struct addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    char port[8];
+    snprintf(port, sizeof(port), "%u", config.port);
+    struct addrinfo* addr = nullptr;
+    if (getaddrinfo(config.host, port, &hints, &addr) != 0 || addr == nullptr) {
+        ESP_LOGW(TAG, "DNS lookup of %s failed", config.host);
+        return Reachability::kDnsFailed;
+    }
+
+    int sock = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+    if (sock < 0) {
+        freeaddrinfo(addr);
+        return Reachability::kConnectFailed;
+    }
+    // 非阻塞连接，按剩余时间等待
+    int flags = fcntl(sock, F_GETFL, 0);
+    fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+    int ret = connect(sock, addr->ai_addr, addr->ai_addrlen);
+    freeaddrinfo(addr);
+    if (ret != 0 && errno != EINPROGRESS) {
+        close(sock);
+        return Reachability::kConnectFailed;
+    }
+    if (ret != 0) {
+        uint32_t remaining_ms = RemainingMs(deadline_us);
+        fd_set write_fds;
+        FD_ZERO(&write_fds);
+        FD_SET(sock, &write_fds);
+        struct timeval tv = {
+            .tv_sec = (time_t)(remaining_ms / 1000),
+            .tv_usec = (suseconds_t)((remaining_ms % 1000) * 1000),
+        };
+        ret = select(sock + 1, nullptr, &write_fds, nullptr, &tv);
+        if (ret == 0) {
+            close(sock);
+            return Reachability::kTimeout;
+        }
+        int error = 0;
+        socklen_t length = sizeof(error);
+        if (ret < 0 || getsockopt(sock, SOL_SOCKET, SO_ERROR, &error, &length) != 0 || error != 0) {
+            close(sock);
+            return Reachability::kConnectFailed;
+        }
+    }
+    fcntl(sock, F_SETFL, flags);
+
+    if (config.path[0] == '\0') {
+        close(sock);
+        return Reachability::kReachable;
+    }
+
+    char buffer[192];
+    int length = snprintf(buffer, sizeof(buffer), "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n",
+        config.path, config.host);
+    if (length <= 0 || length >= (int)sizeof(buffer)) {
+        close(sock);
+        return Reachability::kHttpFailed;
+    }
+    uint32_t remaining_ms = RemainingMs(deadline_us);
+    if (remaining_ms == 0) {
+        close(sock);
+        return Reachability::kTimeout;
+    }
+    SetSocketTimeout(sock, remaining_ms);
+    if (send(sock, buffer, length, 0) != length) {
+        close(sock);
+        return Reachability::kHttpFailed;
+    }
+    // 只需要状态行
+    size_t received = 0;
+    while (received < sizeof(buffer) - 1 && memchr(buffer, '\n', received) == nullptr) {
+        int n = recv(sock, buffer + received, sizeof(buffer) - 1 - received, 0);
+        if (n <= 0) {
+            break;
+        }
+        received += n;
+    }
+    close(sock);
+    if (received == 0) {
+        return RemainingMs(deadline_us) == 0 ? Reachability::kTimeout : Reachability::kHttpFailed;
+    }
+
+    int status = ParseHttpStatus(buffer, received);
+    bool ok = config.expect_status == 0 ? (status >= 200 && status < 300) : status == config.expect_status;
+    if (!ok) {
+        ESP_LOGW(TAG, "Unexpected HTTP status %d from %s%s", status, config.host, config.path);
+        return Reachability::kHttpFailed;
+    }
+    return Reachability::kReachable;
+}
+
+int ReachabilityProbe::ParseHttpStatus(const char* data, size_t length) {
+    // HTTP/1.x SP 3 位状态码
+    static constexpr size_t kPrefix = 9;
+    if (length < kPrefix + 3 || memcmp(data, "HTTP/1.", 7) != 0 || data[8] != ' ') {
+        return -1;
+    }
+    int status = 0;
+    for (size_t i = kPrefix; i < kPrefix + 3; i++) {
+        if (data[i] < '0' || data[i] > '9') {
+            return -1;
+        }
+        status = status * 10 + (data[i] - '0');
+    }
+    return status;
+}
+
+void DemotionList::Demote(uint32_t ssid_hash, uint32_t until_ms) {
+    Entry* slot = nullptr;
+    for (auto& entry : entries_) {
+        if (entry.used && entry.hash == ssid_hash) {
+            slot = &entry;
+            break;
+        }
+        // 优先空位，其次最早到期的记录
+        if (slot == nullptr || (slot->used && (!entry.used || (int32_t)(entry.until_ms - slot->until_ms) < 0))) {
+            slot = &entry;
+        }
+    }
+    slot->hash = ssid_hash;
+    slot->until_ms = until_ms;
+    slot->used = true;
+}
+
+bool DemotionList::IsDemoted(uint32_t ssid_hash, uint32_t now_ms) const {
+    for (const auto& entry : entries_) {
+        if (entry.used && entry.hash == ssid_hash) {
+            return (int32_t)(entry.until_ms - now_ms) > 0;
+        }
+    }
+    return false;
+}
+
+void DemotionList::Clear() {
+    for (auto& entry : entries_) {
+        entry.used = false;
+    }
+}
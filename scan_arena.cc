@@ -0,0 +1,43 @@
+#include "scan_arena.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <esp_log.h>
+#include <esp_wifi.h>
+
+#define TAG "ScanArena"
+
+size_t ScanArena::Load() {
+    uint16_t total = 0;
+    if (esp_wifi_scan_get_ap_num(&total) != ESP_OK) {
+        total = 0;
+    }
+    // 直接取到预分配的缓冲区，驱动会释放剩余的结果
+    uint16_t ap_num = kCapacity;
+    if (esp_wifi_scan_get_ap_records(&ap_num, records_) != ESP_OK) {
+        ap_num = 0;
+    }
+    dropped_ = total > ap_num ? total - ap_num : 0;
+    if (dropped_ > 0) {
+        dropped_total_ += dropped_;
+        ESP_LOGW(TAG, "Scan found %u APs, dropped %u beyond capacity", total, (unsigned)dropped_);
+    }
+    Commit(ap_num);
+    return count_;
+}
+
+void ScanArena::Commit(size_t count) {
+    count_ = std::min(count, kCapacity);
+    for (size_t i = 0; i < count_; i++) {
+        order_[i] = i;
+    }
+    // 只移动 1 字节的下标，不移动记录
+    std::sort(order_, order_ + count_, [this](uint8_t a, uint8_t b) {
+        return records_[a].rssi > records_[b].rssi;
+    });
+    for (size_t i = 0; i < count_; i++) {
+        const auto& record = records_[order_[i]];
+        ssids_[i] = std::string_view((const char*)record.ssid, strnlen((const char*)record.ssid, kMaxSsidLength));
+    }
+}
@@ -0,0 +1,145 @@
+#include "scan_cache.h"
+#include "ssid_index.h"
+
+static uint32_t TableHash(uint64_t bssid) {
+    return static_cast<uint32_t>(bssid ^ (bssid >> 24));
+}
+
+void ScanCache::Clear() {
+    count_ = 0;
+    for (auto& slot : table_) {
+        slot = kEmpty;
+    }
+}
+
+int ScanCache::Find(uint64_t bssid) const {
+    uint32_t hash = TableHash(bssid);
+    for (int probe = 0; probe < kTableSize; probe++) {
+        int8_t index = table_[(hash + probe) & (kTableSize - 1)];
+        if (index == kEmpty) {
+            return -1;
+        }
+        if (index >= 0 && states_[index].bssid == bssid) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+void ScanCache::Insert(uint64_t bssid, int index) {
+    uint32_t hash = TableHash(bssid);
+    for (int probe = 0; probe < kTableSize; probe++) {
+        auto& slot = table_[(hash + probe) & (kTableSize - 1)];
+        if (slot < 0) {
+            slot = index;
+            return;
+        }
+    }
+}
+
+void ScanCache::Remove(uint64_t bssid) {
+    uint32_t hash = TableHash(bssid);
+    for (int probe = 0; probe < kTableSize; probe++) {
+        auto& slot = table_[(hash + probe) & (kTableSize - 1)];
+        if (slot == kEmpty) {
+            return;
+        }
+        // 留下删除标记，保持后面探测链的连续；扫描结束重建表时清掉
+        if (slot >= 0 && states_[slot].bssid == bssid) {
+            slot = kDeleted;
+            return;
+        }
+    }
+}
+
+int ScanCache::PickVictim(int8_t rssi) const {
+    // 优先替换本次没扫到的，其中漏扫次数最多的；再按信号从弱到强
+    auto worse = [this](size_t a, size_t b) {
+        if (states_[a].seen != states_[b].seen) {
+            return !states_[a].seen;
+        }
+        if (info_[a].missed_scans != info_[b].missed_scans) {
+            return info_[a].missed_scans > info_[b].missed_scans;
+        }
+        return records_[a].rssi < records_[b].rssi;
+    };
+    int victim = -1;
+    for (size_t i = 0; i < count_; i++) {
+        if (victim < 0 || worse(i, victim)) {
+            victim = i;
+        }
+    }
+    // 本次扫到且不比新记录弱的不替换，保证满载时留下的是最强的那些
+    if (victim >= 0 && states_[victim].seen && records_[victim].rssi >= rssi) {
+        return -1;
+    }
+    return victim;
+}
+
+void ScanCache::Update(const wifi_ap_record_t& record, uint32_t now_ms) {
+    uint64_t bssid = SsidIndex::BssidToU64(record.bssid);
+    int index = Find(bssid);
+    if (index >= 0) {
+        auto& state = states_[index];
+        state.rssi_x16 += (record.rssi * 16 - state.rssi_x16) >> kRssiAlphaShift;
+        state.seen = true;
+        // SSID、信道、加密方式等都取最新的一次
+        records_[index] = record;
+        records_[index].rssi = state.rssi_x16 / 16;
+        info_[index].last_seen_ms = now_ms;
+        info_[index].missed_scans = 0;
+        return;
+    }
+
+    if (count_ < kCapacity) {
+        index = count_++;
+    } else {
+        // 满载时的替换需要遍历，只在 AP 数超过容量的环境中发生
+        index = PickVictim(record.rssi);
+        if (index < 0) {
+            return;
+        }
+        Remove(states_[index].bssid);
+    }
+    records_[index] = record;
+    states_[index] = {bssid, static_cast<int16_t>(record.rssi * 16), true};
+    info_[index] = {now_ms, now_ms, 0};
+    Insert(bssid, index);
+}
+
+void ScanCache::Merge(const wifi_ap_record_t* records, size_t count, uint32_t now_ms) {
+    for (size_t i = 0; i < count_; i++) {
+        states_[i].seen = false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        Update(records[i], now_ms);
+    }
+    Expire();
+}
+
+void ScanCache::Expire() {
+    // 保序压缩，留下的记录相对顺序不变，排序结果相同时名次也不变
+    size_t kept = 0;
+    for (size_t i = 0; i < count_; i++) {
+        if (!states_[i].seen && ++info_[i].missed_scans >= kMaxMissedScans) {
+            continue;
+        }
+        if (kept != i) {
+            records_[kept] = records_[i];
+            info_[kept] = info_[i];
+            states_[kept] = states_[i];
+        }
+        kept++;
+    }
+    count_ = kept;
+    RebuildTable();
+}
+
+void ScanCache::RebuildTable() {
+    for (auto& slot : table_) {
+        slot = kEmpty;
+    }
+    for (size_t i = 0; i < count_; i++) {
+        Insert(states_[i].bssid, i);
+    }
+}
@@ -0,0 +1,26 @@
+#include "scan_demand.h"
+
+bool ScanDemand::Request(uint32_t now_ms) {
+    if (in_flight_ || (has_scan_ && now_ms - last_done_ms_ < min_interval_ms_)) {
+        coalesced_++;
+        return false;
+    }
+    return true;
+}
+
+void ScanDemand::OnStarted() {
+    in_flight_ = true;
+    started_++;
+}
+
+bool ScanDemand::OnDone(bool complete, uint32_t now_ms) {
+    if (!in_flight_) {
+        return false;
+    }
+    in_flight_ = false;
+    if (complete) {
+        has_scan_ = true;
+        last_done_ms_ = now_ms;
+    }
+    return true;
+}
@@ -0,0 +1,221 @@
+#include "scan_planner.h"
+
+#include <algorithm>
+
+// 与 ESP-IDF wifi_5g_channel_bit_t 的顺序一致，下标 + 1 即位图中的位置
+static const uint8_t kChannels5g[] = {
+    36, 40, 44, 48, 52, 56, 60, 64,
+    100, 104, 108, 112, 116, 120, 124, 128, 132, 136, 140, 144,
+    149, 153, 157, 161, 165, 169, 173, 177,
+};
+
+int ScanPlanner::Channel5gBit(uint8_t channel) {
+    for (size_t i = 0; i < sizeof(kChannels5g); i++) {
+        if (kChannels5g[i] == channel) {
+            return i + 1;
+        }
+    }
+    return -1;
+}
+
+void ScanPlanner::SetCountry(uint8_t schan, uint8_t nchan) {
+    if (schan == 0 || nchan == 0) {
+        return;
+    }
+    schan_ = schan;
+    nchan_ = nchan;
+}
+
+bool ScanPlanner::IsAllowed(uint8_t channel) const {
+    if (channel == 0) {
+        return false;
+    }
+    if (IsChannel5g(channel)) {
+        return Channel5gBit(channel) > 0;
+    }
+    return channel >= schan_ && channel < schan_ + nchan_;
+}
+
+const ScanPlanner::Entry* ScanPlanner::Find(uint32_t hash) const {
+    for (const auto& entry : entries_) {
+        if (entry.used && entry.hash == hash) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+ScanPlanner::Entry* ScanPlanner::Find(uint32_t hash) {
+    return const_cast<Entry*>(static_cast<const ScanPlanner*>(this)->Find(hash));
+}
+
+void ScanPlanner::RecordSeen(uint32_t ssid_hash, uint8_t channel) {
+    if (channel == 0) {
+        return;
+    }
+    clock_++;
+    Entry* entry = Find(ssid_hash);
+    if (entry == nullptr) {
+        // 优先使用空槽，否则淘汰最久未出现的网络
+        entry = &entries_[0];
+        for (auto& candidate : entries_) {
+            if (!candidate.used) {
+                entry = &candidate;
+                break;
+            }
+            if (candidate.last_used < entry->last_used) {
+                entry = &candidate;
+            }
+        }
+        *entry = {};
+        entry->hash = ssid_hash;
+        entry->used = true;
+    }
+    entry->last_used = clock_;
+
+    if (entry->round != round_) {
+        // 本轮第一次出现：放到最前面，上一次的信道退到后面作为备选
+        entry->round = round_;
+        entry->round_count = 1;
+        if (entry->channels[0] != channel) {
+            for (size_t i = kChannelsPerNetwork - 1; i > 0; i--) {
+                entry->channels[i] = entry->channels[i - 1];
+            }
+            entry->channels[0] = channel;
+        }
+        return;
+    }
+
+    // 同一轮内多个 AP（Mesh / 多 AP 组网）：按出现顺序填充剩余位置
+    for (size_t i = 0; i < entry->round_count; i++) {
+        if (entry->channels[i] == channel) {
+            return;
+        }
+    }
+    if (entry->round_count < kChannelsPerNetwork) {
+        entry->channels[entry->round_count++] = channel;
+    }
+}
+
+void ScanPlanner::Clear() {
+    for (auto& entry : entries_) {
+        entry = {};
+    }
+    last_full_ = true;
+    escalate_ = false;
+    targeted_streak_ = 0;
+    full_count_ = 0;
+}
+
+ScanPlan ScanPlanner::PlanFor(const uint32_t* hashes, size_t count) const {
+    ScanPlan plan = {};
+    plan.full = true;
+    for (size_t i = 0; i < count; i++) {
+        const Entry* entry = Find(hashes[i]);
+        if (entry == nullptr) {
+            continue;
+        }
+        for (uint8_t channel : entry->channels) {
+            if (!IsAllowed(channel)) {
+                continue;
+            }
+            if (IsChannel5g(channel)) {
+                uint32_t bit = 1u << Channel5gBit(channel);
+                if (!(plan.channels_5g & bit)) {
+                    plan.channels_5g |= bit;
+                    plan.channel_count++;
+                }
+            } else {
+                uint16_t bit = 1u << channel;
+                if (!(plan.channels_2g & bit)) {
+                    plan.channels_2g |= bit;
+                    plan.channel_count++;
+                }
+            }
+        }
+    }
+
+    if (plan.channel_count > 0) {
+        plan.full = false;
+        plan.bands = (plan.channels_2g ? kScanBand2g : 0) | (plan.channels_5g ? kScanBand5g : 0);
+        plan.active_min_ms = kTargetedActiveMinMs;
+        plan.active_max_ms = kTargetedActiveMaxMs;
+    } else {
+        plan.bands = dual_band_ ? kScanBandBoth : kScanBand2g;
+    }
+    return plan;
+}
+
+ScanPlan ScanPlanner::FullPlan() {
+    ScanPlan plan = {};
+    plan.full = true;
+    plan.bands = kScanBand2g;
+    last_full_ = true;
+    if (!dual_band_) {
+        return plan;
+    }
+    // 第一次以及每 kDualBandInterval 次全信道扫描覆盖两个频段
+    if (full_count_++ % kDualBandInterval == 0) {
+        plan.bands = kScanBandBoth;
+        return plan;
+    }
+    // 只扫 2.4 GHz 时未命中也会升级为双频全信道扫描
+    last_full_ = false;
+    for (uint8_t channel = schan_; channel < schan_ + nchan_ && channel <= 14; channel++) {
+        plan.channels_2g |= 1u << channel;
+        plan.channel_count++;
+    }
+    return plan;
+}
+
+ScanPlan ScanPlanner::Next(const uint32_t* saved_hashes, size_t count) {
+    ScanPlan plan = {};
+    plan.full = true;
+
+    if (escalate_) {
+        // 定向扫描未命中，网络可能换到了另一个频段，两个频段都扫
+        escalate_ = false;
+        targeted_streak_ = 0;
+        full_count_ = 0;
+        return FullPlan();
+    }
+    if (targeted_streak_ >= kFullSweepInterval) {
+        targeted_streak_ = 0;
+        return FullPlan();
+    }
+
+    plan = PlanFor(saved_hashes, count);
+    if (plan.channel_count == 0) {
+        // 没有任何保存网络的信道历史，只能全信道扫描
+        targeted_streak_ = 0;
+        return FullPlan();
+    }
+
+    targeted_streak_++;
+    last_full_ = false;
+    return plan;
+}
+
+void ScanPlanner::RecordScanTime(uint8_t bands, uint32_t duration_ms, size_t ap_count) {
+    if (bands == 0 || bands > kScanBandBoth) {
+        return;
+    }
+    auto& stats = band_stats_[bands - 1];
+    stats.avg_ms = stats.scans == 0 ? duration_ms : stats.avg_ms + ((int32_t)duration_ms - (int32_t)stats.avg_ms) / 4;
+    stats.scans++;
+    stats.last_ms = duration_ms;
+    stats.max_ms = std::max(stats.max_ms, duration_ms);
+    stats.last_aps = ap_count > UINT16_MAX ? UINT16_MAX : ap_count;
+}
+
+const BandScanStats& ScanPlanner::GetBandStats(ScanBand band) const {
+    return band_stats_[band - 1];
+}
+
+bool ScanPlanner::OnScanDone(bool matched) {
+    if (last_full_ || matched) {
+        return false;
+    }
+    escalate_ = true;
+    return true;
+}
@@ -0,0 +1,67 @@
+#include "scan_topk.h"
+#include "ssid_index.h"
+
+#include <algorithm>
+#include <cstring>
+
+static size_t SsidLength(const wifi_ap_record_t& record) {
+    return strnlen(reinterpret_cast<const char*>(record.ssid), sizeof(record.ssid));
+}
+
+size_t ScanTopK::Select(const wifi_ap_record_t* records, size_t count, size_t k) {
+    count = std::min(count, kMaxRecords);
+    size_t key_count = 0;
+    hidden_count_ = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t length = SsidLength(records[i]);
+        if (length == 0) {
+            hidden_count_++;
+            continue;
+        }
+        keys_[key_count++] = {SsidIndex::HashSsid(records[i].ssid, length), records[i].rssi, (uint16_t)i};
+    }
+
+    // 同一 SSID 的记录相邻，且最强的在前
+    std::sort(keys_, keys_ + key_count, [](const Key& a, const Key& b) {
+        return a.hash != b.hash ? a.hash < b.hash : a.rssi > b.rssi;
+    });
+
+    group_count_ = 0;
+    for (size_t run = 0; run < key_count;) {
+        size_t run_end = run;
+        while (run_end < key_count && keys_[run_end].hash == keys_[run].hash) {
+            run_end++;
+        }
+        // 哈希相同的一段里逐个比较 SSID，处理哈希冲突
+        size_t first_group = group_count_;
+        for (size_t i = run; i < run_end; i++) {
+            const wifi_ap_record_t& record = records[keys_[i].index];
+            size_t length = SsidLength(record);
+            size_t g = first_group;
+            for (; g < group_count_; g++) {
+                const wifi_ap_record_t& leader = records[groups_[g].index];
+                if (SsidLength(leader) == length && memcmp(leader.ssid, record.ssid, length) == 0) {
+                    break;
+                }
+            }
+            if (g < group_count_) {
+                if (groups_[g].bssid_count < UINT8_MAX) {
+                    groups_[g].bssid_count++;
+                }
+            } else {
+                groups_[group_count_++] = {keys_[i].index, keys_[i].rssi, 1};
+            }
+        }
+        run = run_end;
+    }
+
+    auto stronger = [](const SsidGroup& a, const SsidGroup& b) {
+        return a.rssi != b.rssi ? a.rssi > b.rssi : a.index < b.index;
+    };
+    top_count_ = std::min(k, group_count_);
+    if (top_count_ < group_count_) {
+        std::nth_element(groups_, groups_ + top_count_, groups_ + group_count_, stronger);
+    }
+    std::sort(groups_, groups_ + top_count_, stronger);
+    return group_count_;
+}
@@ -0,0 +1,122 @@
+#include "ssid_index.h"
+#include "ssid_manager.h"
+
+#include <cstring>
+#include <cstdio>
+
+void SsidIndex::Build(const std::vector<SsidItem>& items) {
+    items_ = &items;
+    for (int i = 0; i < kTableSize; i++) {
+        ssid_table_[i].index = -1;
+        bssid_table_[i].index = -1;
+    }
+
+    for (int i = 0; i < items.size() && i < kTableSize / 2; i++) {
+        const auto& item = items[i];
+        auto* ssid = reinterpret_cast<const uint8_t*>(item.ssid.data());
+        uint32_t hash = HashSsid(ssid, item.ssid.size());
+        for (int probe = 0; probe < kTableSize; probe++) {
+            auto& slot = ssid_table_[(hash + probe) & (kTableSize - 1)];
+            if (slot.index < 0) {
+                slot.hash = hash;
+                slot.length = item.ssid.size();
+                slot.index = i;
+                break;
+            }
+        }
+
+        uint64_t bssid;
+        if (item.bssid.empty() || !ParseBssid(item.bssid, &bssid)) {
+            continue;
+        }
+        uint32_t bssid_hash = static_cast<uint32_t>(bssid ^ (bssid >> 24));
+        for (int probe = 0; probe < kTableSize; probe++) {
+            auto& slot = bssid_table_[(bssid_hash + probe) & (kTableSize - 1)];
+            if (slot.index < 0) {
+                slot.bssid = bssid;
+                slot.index = i;
+                break;
+            }
+        }
+    }
+}
+
+int SsidIndex::Match(const uint8_t* ssid, const uint8_t* bssid) const {
+    size_t ssid_len = strnlen(reinterpret_cast<const char*>(ssid), 32);
+    if (ssid_len > 0) {
+        return FindSsid(ssid, ssid_len);
+    }
+    return FindBssid(bssid);
+}
+
+int SsidIndex::FindSsid(const uint8_t* ssid, size_t ssid_len) const {
+    if (items_ == nullptr) {
+        return kNotFound;
+    }
+    uint32_t hash = HashSsid(ssid, ssid_len);
+    for (int probe = 0; probe < kTableSize; probe++) {
+        const auto& slot = ssid_table_[(hash + probe) & (kTableSize - 1)];
+        if (slot.index < 0) {
+            return kNotFound;
+        }
+        // 哈希相同再比较原始字节，排除冲突
+        if (slot.hash == hash && slot.length == ssid_len &&
+            memcmp((*items_)[slot.index].ssid.data(), ssid, ssid_len) == 0) {
+            return slot.index;
+        }
+    }
+    return kNotFound;
+}
+
+int SsidIndex::FindBssid(const uint8_t* bssid) const {
+    if (items_ == nullptr) {
+        return kNotFound;
+    }
+    uint64_t key = BssidToU64(bssid);
+    uint32_t bssid_hash = static_cast<uint32_t>(key ^ (key >> 24));
+    for (int probe = 0; probe < kTableSize; probe++) {
+        const auto& slot = bssid_table_[(bssid_hash + probe) & (kTableSize - 1)];
+        if (slot.index < 0) {
+            return kNotFound;
+        }
+        if (slot.bssid == key) {
+            return slot.index;
+        }
+    }
+    return kNotFound;
+}
+
+// FNV-1a
+uint32_t SsidIndex::HashSsid(const uint8_t* ssid, size_t ssid_len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < ssid_len; i++) {
+        hash ^= ssid[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint64_t SsidIndex::BssidToU64(const uint8_t* bssid) {
+    uint64_t value = 0;
+    for (int i = 0; i < 6; i++) {
+        value = (value << 8) | bssid[i];
+    }
+    return value;
+}
+
+bool SsidIndex::ParseBssid(const std::string& bssid, uint64_t* out) {
+    unsigned int bytes[6];
+    if (sscanf(bssid.c_str(), "%x:%x:%x:%x:%x:%x",
+            &bytes[0], &bytes[1], &bytes[2], &bytes[3], &bytes[4], &bytes[5]) != 6) {
+        return false;
+    }
+    uint64_t value = 0;
+    for (int i = 0; i < 6; i++) {
+        if (bytes[i] > 0xff) {
+            return false;
+        }
+        value = (value << 8) | bytes[i];
+    }
+    *out = value;
+    return true;
+}
@@ -1,14 +1,22 @@
 #include "ssid_manager.h"
 
 #include <algorithm>
+#include <cstdio>
+#include <ctime>
 #include <esp_log.h>
+#include <esp_random.h>
+#include <esp_timer.h>
 #include <nvs_flash.h>
 
 #define TAG "SsidManager"
 #define NVS_NAMESPACE "wifi"
 #define MAX_WIFI_SSID_COUNT 10
+#define DHCP_LEASE_VERSION 1
+// 早于这个时间说明系统时间还没有同步（2023-11）
+#define VALID_EPOCH_S 1700000000
 
 SsidManager::SsidManager() {
+    boot_id_ = esp_random();
     LoadFromNvs();
 }
 
@@ -16,10 +24,18 @@ SsidManager::~SsidManager() {
 }
 
 void SsidManager::Clear() {
+    for (const auto& item : ssid_list_) {
+        EraseLease(item.ssid);
+    }
     ssid_list_.clear();
+    RebuildIndex();
     SaveToNvs();
 }
 
+void SsidManager::RebuildIndex() {
+    index_.Build(ssid_list_);
+}
+
 void SsidManager::LoadFromNvs() {
     ssid_list_.clear();
 
@@ -31,6 +47,7 @@ void SsidManager::LoadFromNvs() {
     if (ret != ESP_OK) {
         // The namespace doesn't exist, just return
         ESP_LOGW(TAG, "NVS namespace %s doesn't exist", NVS_NAMESPACE);
+        RebuildIndex();
         return;
     }
     for (int i = 0; i < MAX_WIFI_SSID_COUNT; i++) {
@@ -69,6 +86,7 @@ void SsidManager::LoadFromNvs() {
         ssid_list_.push_back({ssid, password, bssid});
     }
     nvs_close(nvs_handle);
+    RebuildIndex();
 }
 
 void SsidManager::SaveToNvs() {
@@ -119,6 +137,7 @@ void SsidManager::AddSsid(const std::string& ssid, const std::string& password,
                 item.bssid = bssid;
                 ESP_LOGI(TAG, "Updated BSSID: %s", bssid.c_str());
             }
+            RebuildIndex();
             SaveToNvs();
             return;
         }
@@ -126,6 +145,7 @@ void SsidManager::AddSsid(const std::string& ssid, const std::string& password,
 
     if (ssid_list_.size() >= MAX_WIFI_SSID_COUNT) {
         ESP_LOGW(TAG, "SSID list is full, pop one");
+        EraseLease(ssid_list_.back().ssid);
         ssid_list_.pop_back();
     }
     // Add the new ssid to the front of the list
@@ -135,6 +155,7 @@ void SsidManager::AddSsid(const std::string& ssid, const std::string& password,
     } else {
         ESP_LOGI(TAG, "Added new SSID %s without BSSID", ssid.c_str());
     }
+    RebuildIndex();
     SaveToNvs();
 }
 
@@ -143,7 +164,9 @@ void SsidManager::RemoveSsid(int index) {
         ESP_LOGW(TAG, "Invalid index %d", index);
         return;
     }
+    EraseLease(ssid_list_[index].ssid);
     ssid_list_.erase(ssid_list_.begin() + index);
+    RebuildIndex();
     SaveToNvs();
 }
 
@@ -156,9 +179,96 @@ void SsidManager::SetDefaultSsid(int index) {
     auto item = ssid_list_[index];  // 这里自动拷贝整个结构，包括 bssid
     ssid_list_.erase(ssid_list_.begin() + index);
     ssid_list_.insert(ssid_list_.begin(), item);
+    RebuildIndex();
     SaveToNvs();
 }
 
+// 租约键名按 SSID 哈希生成，列表顺序变化不影响
+static void LeaseKey(const std::string& ssid, char* key, size_t size) {
+    snprintf(key, size, "lease_%08lx", (unsigned long)SsidIndex::HashSsid((const uint8_t*)ssid.data(), ssid.size()));
+}
+
+bool SsidManager::LoadLease(const std::string& ssid, DhcpLease* lease) const {
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return false;
+    }
+    char key[16];
+    LeaseKey(ssid, key, sizeof(key));
+    size_t length = sizeof(*lease);
+    esp_err_t ret = nvs_get_blob(nvs_handle, key, lease, &length);
+    nvs_close(nvs_handle);
+    return ret == ESP_OK && length == sizeof(*lease) && lease->version == DHCP_LEASE_VERSION;
+}
+
+int64_t SsidManager::LeaseAge(const DhcpLease& lease) const {
+    // 优先用系统时间，可以跨重启；时间未同步时只信任本次启动内获取的租约
+    time_t now = time(nullptr);
+    if (lease.obtained_epoch > 0 && now > VALID_EPOCH_S) {
+        return now - lease.obtained_epoch;
+    }
+    if (lease.boot_id == boot_id_) {
+        return (esp_timer_get_time() - lease.obtained_us) / 1000000;
+    }
+    return -1;
+}
+
+bool SsidManager::GetLease(const std::string& ssid, DhcpLease* lease, uint32_t* renew_in_s) const {
+    if (!LoadLease(ssid, lease)) {
+        return false;
+    }
+    int64_t age = LeaseAge(*lease);
+    int64_t t1 = lease->lease_s / 2;
+    if (age < 0 || age >= t1) {
+        return false;
+    }
+    if (renew_in_s != nullptr) {
+        *renew_in_s = t1 - age;
+    }
+    return true;
+}
+
+void SsidManager::SaveLease(const std::string& ssid, DhcpLease lease) {
+    lease.version = DHCP_LEASE_VERSION;
+    lease.boot_id = boot_id_;
+    lease.obtained_us = esp_timer_get_time();
+    time_t now = time(nullptr);
+    lease.obtained_epoch = now > VALID_EPOCH_S ? now : 0;
+
+    // 地址没变且旧记录还很新时不重写，减少 Flash 擦写
+    DhcpLease old;
+    if (LoadLease(ssid, &old) && old.ip == lease.ip && old.netmask == lease.netmask && old.gateway == lease.gateway &&
+        old.dns[0] == lease.dns[0] && old.dns[1] == lease.dns[1] && old.lease_s == lease.lease_s) {
+        int64_t age = LeaseAge(old);
+        if (age >= 0 && age < lease.lease_s / 4) {
+            return;
+        }
+    }
+
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle) != ESP_OK) {
+        return;
+    }
+    char key[16];
+    LeaseKey(ssid, key, sizeof(key));
+    nvs_set_blob(nvs_handle, key, &lease, sizeof(lease));
+    nvs_commit(nvs_handle);
+    nvs_close(nvs_handle);
+}
+
+void SsidManager::EraseLease(const std::string& ssid) {
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle) != ESP_OK) {
+        return;
+    }
+    char key[16];
+    LeaseKey(ssid, key, sizeof(key));
+    if (nvs_erase_key(nvs_handle, key) == ESP_OK) {
+        nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+}
+
 // 新增：保存带RSSI的扫描结果
 void SsidManager::ScanSsidRssiList(const std::vector<SsidRssiItem>& ssid_rssi_list) {
     scan_ssid_rssi_list_ = ssid_rssi_list;
@@ -0,0 +1,76 @@
+#include "station_fsm.h"
+
+#include <cstddef>
+
+namespace {
+
+struct Transition {
+    StationState to;
+    bool accepted;
+};
+
+// 不接受的输入
+constexpr Transition kReject = {StationState::kIdle, false};
+constexpr Transition kToIdle = {StationState::kIdle, true};
+constexpr Transition kToStarting = {StationState::kStarting, true};
+constexpr Transition kToScanning = {StationState::kScanning, true};
+constexpr Transition kToConnecting = {StationState::kConnecting, true};
+constexpr Transition kToConnected = {StationState::kConnected, true};
+constexpr Transition kToBackoff = {StationState::kBackoff, true};
+
+constexpr size_t kStateCount = 6;
+constexpr size_t kInputCount = 10;
+
+// kTable[input][from]，列顺序：Idle, Starting, Scanning, Connecting, Connected, Backoff
+constexpr Transition kTable[kInputCount][kStateCount] = {
+    // kStart
+    { kToStarting, kReject, kReject, kReject, kReject, kReject },
+    // kStop
+    { kReject, kToIdle, kToIdle, kToIdle, kToIdle, kToIdle },
+    // kScan：已连接时的扫描属于漫游，不经过状态机
+    { kReject, kToScanning, kToScanning, kToScanning, kReject, kToScanning },
+    // kScanDone：不在扫描状态时收到的是被打断的扫描，结果丢弃
+    { kReject, kReject, kToScanning, kReject, kReject, kReject },
+    // kConnect
+    { kReject, kToConnecting, kToConnecting, kToConnecting, kToConnecting, kToConnecting },
+    // kLinkUp
+    { kReject, kReject, kReject, kToConnecting, kToConnected, kReject },
+    // kGotIp：链路已经可用，除停止状态外都接受
+    { kReject, kToConnected, kToConnected, kToConnected, kToConnected, kToConnected },
+    // kDisconnected
+    { kReject, kReject, kReject, kToBackoff, kToBackoff, kToBackoff },
+    // kBackoff
+    { kReject, kReject, kToBackoff, kToBackoff, kReject, kToBackoff },
+    // kTimer：只有退避中的定时器有效，其余都是过期的
+    { kReject, kReject, kReject, kReject, kReject, kToBackoff },
+};
+
+} // namespace
+
+bool StationFsm::Next(StationState from, StationInput input, StationState* to) {
+    size_t state = static_cast<size_t>(from);
+    size_t index = static_cast<size_t>(input);
+    if (state >= kStateCount || index >= kInputCount) {
+        return false;
+    }
+    const Transition& transition = kTable[index][state];
+    if (!transition.accepted) {
+        return false;
+    }
+    *to = transition.to;
+    return true;
+}
+
+const char* StationFsm::StateName(StationState state) {
+    static const char* const kNames[] = {"Idle", "Starting", "Scanning", "Connecting", "Connected", "Backoff"};
+    size_t index = static_cast<size_t>(state);
+    return index < kStateCount ? kNames[index] : "Unknown";
+}
+
+const char* StationFsm::InputName(StationInput input) {
+    static const char* const kNames[] = {
+        "Start", "Stop", "Scan", "ScanDone", "Connect", "LinkUp", "GotIp", "Disconnected", "Backoff", "Timer",
+    };
+    size_t index = static_cast<size_t>(input);
+    return index < kInputCount ? kNames[index] : "Unknown";
+}
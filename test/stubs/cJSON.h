@@ -0,0 +1,149 @@
+// 主机测试用的 cJSON 最小替身：只实现诊断接口用到的构造与无格式输出，输出格式与 cJSON 一致
+#pragma once
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#define cJSON_False 1
+#define cJSON_True 2
+#define cJSON_Number 8
+#define cJSON_String 16
+#define cJSON_Array 32
+#define cJSON_Object 64
+
+typedef struct cJSON {
+    struct cJSON* next;
+    struct cJSON* child;
+    int type;
+    char* valuestring;
+    double valuedouble;
+    char* string;
+} cJSON;
+
+inline cJSON* cJSON_New(int type) {
+    cJSON* item = (cJSON*)calloc(1, sizeof(cJSON));
+    item->type = type;
+    return item;
+}
+
+inline void cJSON_Delete(cJSON* item) {
+    while (item != NULL) {
+        cJSON* next = item->next;
+        cJSON_Delete(item->child);
+        free(item->valuestring);
+        free(item->string);
+        free(item);
+        item = next;
+    }
+}
+
+inline cJSON* cJSON_CreateObject(void) { return cJSON_New(cJSON_Object); }
+inline cJSON* cJSON_CreateArray(void) { return cJSON_New(cJSON_Array); }
+
+inline int cJSON_AddItemToArray(cJSON* array, cJSON* item) {
+    cJSON** tail = &array->child;
+    while (*tail != NULL) {
+        tail = &(*tail)->next;
+    }
+    *tail = item;
+    return 1;
+}
+
+inline cJSON* cJSON_AddToObject(cJSON* object, const char* name, cJSON* item) {
+    item->string = strdup(name);
+    cJSON_AddItemToArray(object, item);
+    return item;
+}
+
+inline cJSON* cJSON_AddNumberToObject(cJSON* object, const char* name, double number) {
+    cJSON* item = cJSON_New(cJSON_Number);
+    item->valuedouble = number;
+    return cJSON_AddToObject(object, name, item);
+}
+
+inline cJSON* cJSON_AddStringToObject(cJSON* object, const char* name, const char* string) {
+    cJSON* item = cJSON_New(cJSON_String);
+    item->valuestring = strdup(string);
+    return cJSON_AddToObject(object, name, item);
+}
+
+inline cJSON* cJSON_AddBoolToObject(cJSON* object, const char* name, int boolean) {
+    return cJSON_AddToObject(object, name, cJSON_New(boolean ? cJSON_True : cJSON_False));
+}
+
+inline cJSON* cJSON_AddObjectToObject(cJSON* object, const char* name) {
+    return cJSON_AddToObject(object, name, cJSON_CreateObject());
+}
+
+inline cJSON* cJSON_AddArrayToObject(cJSON* object, const char* name) {
+    return cJSON_AddToObject(object, name, cJSON_CreateArray());
+}
+
+inline void cJSON_PrintString(const char* string, std::string* out) {
+    out->push_back('"');
+    for (const char* p = string; *p != '\0'; p++) {
+        unsigned char c = *p;
+        switch (c) {
+        case '"': *out += "\\\""; break;
+        case '\\': *out += "\\\\"; break;
+        case '\b': *out += "\\b"; break;
+        case '\f': *out += "\\f"; break;
+        case '\n': *out += "\\n"; break;
+        case '\r': *out += "\\r"; break;
+        case '\t': *out += "\\t"; break;
+        default:
+            if (c < 0x20) {
+                char buffer[8];
+                snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                *out += buffer;
+            } else {
+                out->push_back(c);
+            }
+        }
+    }
+    out->push_back('"');
+}
+
+inline void cJSON_PrintItem(const cJSON* item, std::string* out) {
+    char buffer[32];
+    switch (item->type) {
+    case cJSON_False: *out += "false"; break;
+    case cJSON_True: *out += "true"; break;
+    case cJSON_Number:
+        // 与 cJSON 相同：整数按整数输出，其他按 15 位有效数字
+        if (item->valuedouble == floor(item->valuedouble) && fabs(item->valuedouble) < 1e15) {
+            snprintf(buffer, sizeof(buffer), "%.0f", item->valuedouble);
+        } else {
+            snprintf(buffer, sizeof(buffer), "%1.15g", item->valuedouble);
+        }
+        *out += buffer;
+        break;
+    case cJSON_String: cJSON_PrintString(item->valuestring, out); break;
+    default: {
+        bool object = item->type == cJSON_Object;
+        out->push_back(object ? '{' : '[');
+        for (const cJSON* child = item->child; child != NULL; child = child->next) {
+            if (child != item->child) {
+                out->push_back(',');
+            }
+            if (object) {
+                cJSON_PrintString(child->string, out);
+                out->push_back(':');
+            }
+            cJSON_PrintItem(child, out);
+        }
+        out->push_back(object ? '}' : ']');
+    }
+    }
+}
+
+inline char* cJSON_PrintUnformatted(const cJSON* item) {
+    std::string out;
+    cJSON_PrintItem(item, &out);
+    return strdup(out.c_str());
+}
+
+inline void cJSON_free(void* p) { free(p); }
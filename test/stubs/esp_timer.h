@@ -0,0 +1,13 @@
+// 主机测试用的 ESP-IDF 最小替身：只声明单调时钟，由各测试自行实现
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,16 @@
+// 主机测试用的 ESP-IDF 最小替身：只声明纯逻辑模块调用的驱动接口，由各测试自行实现
+#pragma once
+#include "esp_wifi_types_generic.h"
+
+#define ESP_ERR_WIFI_CONN (ESP_ERR_WIFI_BASE + 7)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t esp_wifi_scan_get_ap_num(uint16_t* number);
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t* number, wifi_ap_record_t* ap_records);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,95 @@
+// 主机测试用的 ESP-IDF 最小替身：只包含纯逻辑模块用到的类型，取值与 ESP-IDF 一致
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum {
+    WIFI_AUTH_OPEN = 0, WIFI_AUTH_WEP, WIFI_AUTH_WPA_PSK, WIFI_AUTH_WPA2_PSK, WIFI_AUTH_WPA_WPA2_PSK,
+    WIFI_AUTH_ENTERPRISE, WIFI_AUTH_WPA2_ENTERPRISE = WIFI_AUTH_ENTERPRISE, WIFI_AUTH_WPA3_PSK,
+    WIFI_AUTH_WPA2_WPA3_PSK, WIFI_AUTH_WAPI_PSK, WIFI_AUTH_OWE, WIFI_AUTH_WPA3_ENT_192, WIFI_AUTH_MAX
+} wifi_auth_mode_t;
+
+typedef enum {
+    WIFI_REASON_UNSPECIFIED = 1, WIFI_REASON_AUTH_EXPIRE = 2, WIFI_REASON_AUTH_LEAVE = 3, WIFI_REASON_ASSOC_EXPIRE = 4,
+    WIFI_REASON_ASSOC_TOOMANY = 5, WIFI_REASON_NOT_AUTHED = 6, WIFI_REASON_NOT_ASSOCED = 7, WIFI_REASON_ASSOC_LEAVE = 8,
+    WIFI_REASON_ASSOC_NOT_AUTHED = 9, WIFI_REASON_DISASSOC_PWRCAP_BAD = 10, WIFI_REASON_DISASSOC_SUPCHAN_BAD = 11,
+    WIFI_REASON_BSS_TRANSITION_DISASSOC = 12, WIFI_REASON_IE_INVALID = 13, WIFI_REASON_MIC_FAILURE = 14,
+    WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT = 15, WIFI_REASON_GROUP_KEY_UPDATE_TIMEOUT = 16, WIFI_REASON_IE_IN_4WAY_DIFFERS = 17,
+    WIFI_REASON_GROUP_CIPHER_INVALID = 18, WIFI_REASON_PAIRWISE_CIPHER_INVALID = 19, WIFI_REASON_AKMP_INVALID = 20,
+    WIFI_REASON_UNSUPP_RSN_IE_VERSION = 21, WIFI_REASON_INVALID_RSN_IE_CAP = 22, WIFI_REASON_802_1X_AUTH_FAILED = 23,
+    WIFI_REASON_CIPHER_SUITE_REJECTED = 24, WIFI_REASON_TDLS_PEER_UNREACHABLE = 25, WIFI_REASON_TDLS_UNSPECIFIED = 26,
+    WIFI_REASON_SSP_REQUESTED_DISASSOC = 27, WIFI_REASON_NO_SSP_ROAMING_AGREEMENT = 28, WIFI_REASON_BAD_CIPHER_OR_AKM = 29,
+    WIFI_REASON_NOT_AUTHORIZED_THIS_LOCATION = 30, WIFI_REASON_SERVICE_CHANGE_PERCLUDES_TS = 31,
+    WIFI_REASON_UNSPECIFIED_QOS = 32, WIFI_REASON_NOT_ENOUGH_BANDWIDTH = 33, WIFI_REASON_MISSING_ACKS = 34,
+    WIFI_REASON_EXCEEDED_TXOP = 35, WIFI_REASON_STA_LEAVING = 36, WIFI_REASON_END_BA = 37, WIFI_REASON_UNKNOWN_BA = 38,
+    WIFI_REASON_TIMEOUT = 39, WIFI_REASON_PEER_INITIATED = 46, WIFI_REASON_AP_INITIATED = 47,
+    WIFI_REASON_INVALID_FT_ACTION_FRAME_COUNT = 48, WIFI_REASON_INVALID_PMKID = 49, WIFI_REASON_INVALID_MDE = 50,
+    WIFI_REASON_INVALID_FTE = 51, WIFI_REASON_TRANSMISSION_LINK_ESTABLISH_FAILED = 67,
+    WIFI_REASON_ALTERATIVE_CHANNEL_OCCUPIED = 68, WIFI_REASON_BEACON_TIMEOUT = 200, WIFI_REASON_NO_AP_FOUND = 201,
+    WIFI_REASON_AUTH_FAIL = 202, WIFI_REASON_ASSOC_FAIL = 203, WIFI_REASON_HANDSHAKE_TIMEOUT = 204,
+    WIFI_REASON_CONNECTION_FAIL = 205, WIFI_REASON_AP_TSF_RESET = 206, WIFI_REASON_ROAMING = 207,
+    WIFI_REASON_ASSOC_COMEBACK_TIME_TOO_LONG = 208, WIFI_REASON_SA_QUERY_TIMEOUT = 209,
+    WIFI_REASON_NO_AP_FOUND_W_COMPATIBLE_SECURITY = 210, WIFI_REASON_NO_AP_FOUND_IN_AUTHMODE_THRESHOLD = 211,
+    WIFI_REASON_NO_AP_FOUND_IN_RSSI_THRESHOLD = 212,
+} wifi_err_reason_t;
+
+typedef enum { WIFI_SECOND_CHAN_NONE, WIFI_SECOND_CHAN_ABOVE, WIFI_SECOND_CHAN_BELOW } wifi_second_chan_t;
+typedef enum { WIFI_CIPHER_TYPE_NONE } wifi_cipher_type_t;
+typedef enum { WIFI_ANT_ANT0 } wifi_ant_t;
+typedef enum { WIFI_BW_HT20 = 1, WIFI_BW_HT40 } wifi_bandwidth_t;
+typedef enum { WIFI_COUNTRY_POLICY_AUTO, WIFI_COUNTRY_POLICY_MANUAL } wifi_country_policy_t;
+typedef struct { char cc[3]; uint8_t schan; uint8_t nchan; int8_t max_tx_power; wifi_country_policy_t policy; } wifi_country_t;
+
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t ssid[33];
+    uint8_t primary;
+    wifi_second_chan_t second;
+    int8_t rssi;
+    wifi_auth_mode_t authmode;
+    wifi_cipher_type_t pairwise_cipher;
+    wifi_cipher_type_t group_cipher;
+    wifi_ant_t ant;
+    uint32_t phy_11b:1;
+    uint32_t phy_11g:1;
+    uint32_t phy_11n:1;
+    uint32_t phy_lr:1;
+    uint32_t phy_11a:1;
+    uint32_t phy_11ac:1;
+    uint32_t phy_11ax:1;
+    uint32_t wps:1;
+    uint32_t ftm_responder:1;
+    uint32_t ftm_initiator:1;
+    uint32_t reserved:22;
+    wifi_country_t country;
+    wifi_bandwidth_t bandwidth;
+    uint8_t vht_ch_freq1;
+    uint8_t vht_ch_freq2;
+} wifi_ap_record_t;
+
+typedef enum { WIFI_FAST_SCAN = 0, WIFI_ALL_CHANNEL_SCAN } wifi_scan_method_t;
+typedef enum { WIFI_CONNECT_AP_BY_SIGNAL = 0, WIFI_CONNECT_AP_BY_SECURITY } wifi_sort_method_t;
+typedef struct { int8_t rssi; wifi_auth_mode_t authmode; uint8_t rssi_5g_adjustment; } wifi_scan_threshold_t;
+typedef struct { bool capable; bool required; } wifi_pmf_config_t;
+
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t password[64];
+    wifi_scan_method_t scan_method;
+    bool bssid_set;
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint16_t listen_interval;
+    wifi_sort_method_t sort_method;
+    wifi_scan_threshold_t threshold;
+    wifi_pmf_config_t pmf_cfg;
+    uint32_t rm_enabled:1;
+    uint32_t btm_enabled:1;
+    uint32_t mbo_enabled:1;
+    uint32_t ft_enabled:1;
+    uint32_t owe_enabled:1;
+    uint32_t transition_disable:1;
+    uint32_t reserved:26;
+    uint8_t failure_retry_cnt;
+} wifi_sta_config_t;
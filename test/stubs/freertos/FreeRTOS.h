@@ -0,0 +1,12 @@
+// 主机测试用的 FreeRTOS 最小替身
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void* TaskHandle_t;
+typedef uint32_t TickType_t;
+
+#define pdPASS 1
+#define pdFAIL 0
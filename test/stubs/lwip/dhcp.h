@@ -0,0 +1,15 @@
+// 主机测试用的 lwIP 最小替身
+#pragma once
+#include "lwip/netif.h"
+
+// 只保留 dhcp_reboot.cc 用到的字段
+struct dhcp {
+    uint8_t state;
+    uint8_t tries;
+    ip4_addr_t offered_ip_addr;
+};
+
+#define netif_dhcp_data(netif) ((netif)->dhcp)
+
+// 由测试实现，记录调用
+void dhcp_network_changed(struct netif* netif);
@@ -0,0 +1,5 @@
+// 主机测试用的 lwIP 最小替身
+#pragma once
+// 与 ESP-IDF 5.3 自带的 lwIP 版本一致
+#define LWIP_VERSION_MAJOR 2
+#define LWIP_VERSION_MINOR 1
@@ -0,0 +1,10 @@
+// 主机测试用的 lwIP 最小替身
+#pragma once
+#include <cstdint>
+
+typedef struct {
+    uint32_t addr;
+} ip4_addr_t;
+
+#define ip4_addr_get_u32(src) ((src)->addr)
+#define ip4_addr_set_u32(dest, src) ((dest)->addr = (src))
@@ -0,0 +1,3 @@
+// 主机测试用的 lwIP 最小替身：域名解析直接使用主机的实现
+#pragma once
+#include <netdb.h>
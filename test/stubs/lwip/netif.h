@@ -0,0 +1,9 @@
+// 主机测试用的 lwIP 最小替身
+#pragma once
+#include "lwip/ip_addr.h"
+
+struct dhcp;
+
+struct netif {
+    struct dhcp* dhcp;
+};
@@ -0,0 +1,8 @@
+// 主机测试用的 lwIP 最小替身：BSD socket 接口直接使用主机的实现
+#pragma once
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
@@ -0,0 +1,158 @@
+// ExponentialBackoff：延时范围、下限与上限，以及一栋楼里的设备同时掉线后，改造前后两种策略发起请求的分布
+#include "backoff_policy.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <vector>
+
+// 与 WifiStation 中的参数一致
+static constexpr uint32_t kReconnectBaseMs = 500;
+static constexpr uint32_t kReconnectCapMs = 8 * 1000;
+static constexpr uint32_t kRescanBaseMs = 10 * 1000;
+static constexpr uint32_t kRescanCapMs = 120 * 1000;
+static constexpr uint32_t kRescanMinMs = kRescanBaseMs / 2;
+
+static void TestDelayBounds() {
+    ExponentialBackoff backoff(kReconnectBaseMs, kReconnectCapMs, 12345);
+    for (int round = 0; round < 2; round++) {
+        for (int attempt = 0; attempt < 40; attempt++) {
+            CHECK(backoff.GetAttempt() == std::min(attempt, 31));
+            uint32_t ceiling = attempt < 5 ? kReconnectBaseMs << attempt : kReconnectCapMs;
+            uint32_t delay = backoff.NextDelayMs();
+            CHECK(delay >= 100);
+            CHECK(delay <= ceiling);
+        }
+        backoff.Reset();
+        CHECK(backoff.GetAttempt() == 0);
+    }
+}
+
+static void TestRescanFloor() {
+    ExponentialBackoff backoff(kRescanBaseMs, kRescanCapMs, 1, kRescanMinMs);
+    uint32_t max_delay = 0;
+    for (int attempt = 0; attempt < 1000; attempt++) {
+        uint32_t delay = backoff.NextDelayMs();
+        CHECK(delay >= kRescanMinMs);
+        CHECK(delay <= kRescanCapMs);
+        if (attempt == 0) {
+            CHECK(delay <= kRescanBaseMs);
+        }
+        max_delay = std::max(max_delay, delay);
+    }
+    // 上限最终增长到 cap
+    CHECK(max_delay > kRescanCapMs / 2);
+
+    // 下限不低于 ceiling 时直接返回下限
+    ExponentialBackoff flat(100, 100, 1, 200);
+    CHECK(flat.NextDelayMs() == 200);
+}
+
+static void TestSeedFromMac() {
+    const uint8_t mac_a[6] = {0x24, 0x0a, 0xc4, 0x00, 0x00, 0x01};
+    const uint8_t mac_b[6] = {0x24, 0x0a, 0xc4, 0x00, 0x00, 0x02};
+    CHECK(ExponentialBackoff::SeedFromMac(mac_a) == ExponentialBackoff::SeedFromMac(mac_a));
+    CHECK(ExponentialBackoff::SeedFromMac(mac_a) != ExponentialBackoff::SeedFromMac(mac_b));
+    // 种子为 0 时 xorshift 会一直输出 0，构造函数换成固定的非零种子
+    ExponentialBackoff zero(kReconnectBaseMs, kReconnectCapMs, 0);
+    CHECK(zero.NextDelayMs() >= 100);
+}
+
+// 改造前的策略：掉线后立即重连 kMaxReconnects 次，用完后固定 10 秒重新扫描
+static constexpr int kMaxReconnects = 5;
+static constexpr uint32_t kBaselineRescanMs = 10 * 1000;
+// 一次失败的连接尝试（关联被拒或握手超时）与一次全信道扫描的耗时
+static constexpr uint32_t kAttemptMs = 1000;
+static constexpr uint32_t kScanMs = 1560;
+
+// 一台设备在 t=0 掉线后、路由器一直没有恢复时发起的连接与扫描时刻
+static std::vector<uint32_t> BaselineRequests(uint32_t horizon_ms) {
+    std::vector<uint32_t> requests;
+    uint32_t t = 0;
+    for (int i = 0; i < kMaxReconnects; i++) {
+        requests.push_back(t);
+        t += kAttemptMs;
+    }
+    for (t += kBaselineRescanMs; t < horizon_ms; t += kScanMs + kBaselineRescanMs) {
+        requests.push_back(t);
+    }
+    return requests;
+}
+
+// 与 WifiStation 相同：每次重连前按 reconnect_backoff_ 等待，次数用完后按 rescan_backoff_ 等待再扫描
+static std::vector<uint32_t> JitteredRequests(const uint8_t* mac, uint32_t horizon_ms) {
+    uint32_t seed = ExponentialBackoff::SeedFromMac(mac);
+    ExponentialBackoff reconnect(kReconnectBaseMs, kReconnectCapMs, seed);
+    ExponentialBackoff rescan(kRescanBaseMs, kRescanCapMs, seed ^ 0x5bd1e995u, kRescanMinMs);
+    std::vector<uint32_t> requests;
+    uint32_t t = 0;
+    for (int i = 0; i < kMaxReconnects; i++) {
+        t += reconnect.NextDelayMs();
+        requests.push_back(t);
+        t += kAttemptMs;
+    }
+    for (t += rescan.NextDelayMs(); t < horizon_ms; t += kScanMs + rescan.NextDelayMs()) {
+        requests.push_back(t);
+    }
+    return requests;
+}
+
+// kDevices 台相邻 MAC 的设备在 t=0 同时掉线（路由器重启），一分钟内路由器没有恢复。
+// 按 1 秒的桶并排打印两种策略的请求数，并比较 100 ms 桶内的峰值：改造前所有设备落在同一个桶里
+static void FleetSimulation() {
+    constexpr int kDevices = 200;
+    constexpr uint32_t kHorizonMs = 60 * 1000;
+    constexpr uint32_t kBucketMs = 100;
+    constexpr uint32_t kRowMs = 1000;
+
+    std::vector<int> baseline(kHorizonMs / kBucketMs);
+    std::vector<int> jittered(baseline.size());
+    int baseline_total = 0;
+    int jittered_total = 0;
+    for (int device = 0; device < kDevices; device++) {
+        uint8_t mac[6] = {0x24, 0x0a, 0xc4, 0x12, static_cast<uint8_t>(device >> 8), static_cast<uint8_t>(device)};
+        for (uint32_t t : BaselineRequests(kHorizonMs)) {
+            baseline[t / kBucketMs]++;
+            baseline_total++;
+        }
+        for (uint32_t t : JitteredRequests(mac, kHorizonMs)) {
+            if (t < kHorizonMs) {
+                jittered[t / kBucketMs]++;
+                jittered_total++;
+            }
+        }
+    }
+
+    printf("%d devices, router down for %u s: requests per %u ms\n", kDevices, (unsigned)(kHorizonMs / 1000),
+        (unsigned)kRowMs);
+    printf("%6s %9s %9s\n", "t (s)", "baseline", "jittered");
+    constexpr uint32_t kPerRow = kRowMs / kBucketMs;
+    for (size_t row = 0; row < baseline.size() / kPerRow; row++) {
+        int b = 0;
+        int j = 0;
+        for (size_t i = row * kPerRow; i < (row + 1) * kPerRow; i++) {
+            b += baseline[i];
+            j += jittered[i];
+        }
+        if (b != 0 || j != 0) {
+            printf("%6zu %9d %9d\n", row, b, j);
+        }
+    }
+    int baseline_peak = *std::max_element(baseline.begin(), baseline.end());
+    int jittered_peak = *std::max_element(jittered.begin(), jittered.end());
+    printf("total: baseline %d, jittered %d; peak per %u ms: baseline %d, jittered %d\n", baseline_total,
+        jittered_total, (unsigned)kBucketMs, baseline_peak, jittered_peak);
+
+    CHECK(baseline_peak == kDevices);
+    // 第一次重连只分散在 [100, 500] ms 的 4 个桶里，峰值出现在这里
+    CHECK(jittered_peak * 2 < kDevices);
+    CHECK(jittered_total < baseline_total);
+}
+
+int main() {
+    TestDelayBounds();
+    TestRescanFloor();
+    TestSeedFromMac();
+    FleetSimulation();
+    printf("test_backoff_policy: ok\n");
+    return 0;
+}
@@ -0,0 +1,112 @@
+// BssidBlocklist：各分类的屏蔽时长与翻倍、偶发失败的阈值、失败次数衰减、成功清除，以及满载替换
+#include "bssid_blocklist.h"
+#include "test_util.h"
+
+static const uint8_t kApA[6] = {1, 2, 3, 4, 5, 6};
+static const uint8_t kApB[6] = {9, 9, 9, 9, 9, 9};
+
+static void TestBlockDurationDoubles() {
+    BssidBlocklist list;
+    list.OnFailure(kApA, DisconnectClass::kOverloaded, 0);
+    CHECK(list.IsBlocked(kApA, 59999));
+    CHECK(!list.IsBlocked(kApA, 60000));
+    list.OnFailure(kApA, DisconnectClass::kOverloaded, 60000);
+    CHECK(list.IsBlocked(kApA, 60000 + 119999));
+    CHECK(!list.IsBlocked(kApA, 180000));
+
+    // 不超过 kMaxBlockMs
+    for (int i = 0; i < 20; i++) {
+        list.OnFailure(kApA, DisconnectClass::kOverloaded, 200000);
+    }
+    CHECK(list.IsBlocked(kApA, 200000 + BssidBlocklist::kMaxBlockMs - 1));
+    CHECK(!list.IsBlocked(kApA, 200000 + BssidBlocklist::kMaxBlockMs));
+}
+
+static void TestClassThresholds() {
+    BssidBlocklist list;
+    // 偶发失败第二次才屏蔽
+    list.OnFailure(kApB, DisconnectClass::kTransient, 0);
+    CHECK(!list.IsBlocked(kApB, 1));
+    list.OnFailure(kApB, DisconnectClass::kTransient, 1);
+    CHECK(list.IsBlocked(kApB, 2));
+    CHECK(!list.IsBlocked(kApB, 1 + BssidBlocklist::BaseBlockMs(DisconnectClass::kTransient)));
+
+    // 不在附近、本机断开不记录
+    BssidBlocklist other;
+    other.OnFailure(kApA, DisconnectClass::kNotFound, 0);
+    other.OnFailure(kApA, DisconnectClass::kLocal, 0);
+    BlocklistEntry entries[4];
+    CHECK(other.GetEntries(entries, 4, 0) == 0);
+
+    // 加密不兼容第一次就屏蔽到上限
+    other.OnFailure(kApA, DisconnectClass::kIncompatible, 0);
+    CHECK(other.IsBlocked(kApA, BssidBlocklist::kMaxBlockMs - 1));
+    // 成功连接后清除
+    other.OnSuccess(kApA);
+    CHECK(!other.IsBlocked(kApA, 1));
+    CHECK(other.GetEntries(entries, 4, 1) == 0);
+}
+
+static void TestStrikesDecay() {
+    BssidBlocklist list;
+    list.OnFailure(kApA, DisconnectClass::kOverloaded, 0);
+    list.OnFailure(kApA, DisconnectClass::kOverloaded, 60000);
+    list.OnFailure(kApB, DisconnectClass::kTransient, 0);
+
+    BlocklistEntry entries[4];
+    CHECK(list.GetEntries(entries, 4, 10) == 2);
+    CHECK(entries[0].bssid[5] == 6);
+    CHECK(entries[0].strikes == 2);
+    CHECK(entries[0].last_class == DisconnectClass::kOverloaded);
+    CHECK(entries[0].blocked_ms == 60000 + 120000 - 10);
+    // 偶发失败一次只记录不屏蔽
+    CHECK(entries[1].blocked_ms == 0);
+
+    // kDecayMs 没有新的失败，失败次数减一；再过一段时间全部清除
+    list.Expire(60000 + BssidBlocklist::kDecayMs);
+    CHECK(list.GetEntries(entries, 4, 60000 + BssidBlocklist::kDecayMs) == 1);
+    CHECK(entries[0].strikes == 1);
+    CHECK(entries[0].blocked_ms == 0);
+    list.Expire(60000 + 2 * BssidBlocklist::kDecayMs);
+    CHECK(list.GetEntries(entries, 4, 60000 + 2 * BssidBlocklist::kDecayMs) == 0);
+
+    // 衰减后再失败，屏蔽时间从较短的一级开始
+    list.OnFailure(kApA, DisconnectClass::kOverloaded, 1000000);
+    CHECK(!list.IsBlocked(kApA, 1000000 + 60000));
+}
+
+static void TestFullTableReplacesOldest() {
+    BssidBlocklist list;
+    for (uint32_t i = 0; i < BssidBlocklist::kCapacity + 4; i++) {
+        uint8_t bssid[6] = {0, 0, 0, 0, 0, static_cast<uint8_t>(i)};
+        list.OnFailure(bssid, DisconnectClass::kOverloaded, i);
+    }
+    BlocklistEntry entries[BssidBlocklist::kCapacity];
+    CHECK(list.GetEntries(entries, 4, 100) == 4);
+    CHECK(list.GetEntries(entries, BssidBlocklist::kCapacity, 100) == BssidBlocklist::kCapacity);
+    uint8_t oldest[6] = {0, 0, 0, 0, 0, 3};
+    uint8_t newest[6] = {0, 0, 0, 0, 0, BssidBlocklist::kCapacity + 3};
+    CHECK(!list.IsBlocked(oldest, 100));
+    CHECK(list.IsBlocked(newest, 100));
+
+    list.Clear();
+    CHECK(list.GetEntries(entries, BssidBlocklist::kCapacity, 100) == 0);
+}
+
+static void TestWraparound() {
+    BssidBlocklist list;
+    uint32_t now = 0xffffffffu - 1000;
+    list.OnFailure(kApA, DisconnectClass::kOverloaded, now);
+    CHECK(list.IsBlocked(kApA, now + 30000));
+    CHECK(!list.IsBlocked(kApA, now + 60000));
+}
+
+int main() {
+    TestBlockDurationDoubles();
+    TestClassThresholds();
+    TestStrikesDecay();
+    TestFullTableReplacesOldest();
+    TestWraparound();
+    printf("test_bssid_blocklist: ok\n");
+    return 0;
+}
@@ -0,0 +1,158 @@
+// CandidateScorer 与 CandidateQueue：评分各项的加减分、历史记录淘汰，以及定长堆满载时的淘汰顺序
+#include "candidate_scorer.h"
+#include "test_util.h"
+
+#include <cstring>
+
+static constexpr int64_t kSecondUs = 1000000;
+
+struct Item {
+    int id;
+    int32_t score;
+};
+
+static void TestQueueKeepsHighestScores() {
+    CandidateQueue<Item, 4> queue;
+    const int32_t scores[] = {5, 1, 9, 3, 7, 2, 8};
+    for (int i = 0; i < 7; i++) {
+        queue.push({i, scores[i]});
+    }
+    CHECK(queue.size() == 4);
+    // 满载后只留下得分最高的 4 个，按分数从高到低弹出
+    const int32_t expected[] = {9, 8, 7, 5};
+    for (int32_t score : expected) {
+        CHECK(!queue.empty());
+        CHECK(queue.pop().score == score);
+    }
+    CHECK(queue.empty());
+
+    // 不比当前最小值高的候选不会挤掉已有的
+    queue.clear();
+    for (int i = 0; i < 4; i++) {
+        queue.push({i, 10});
+    }
+    queue.push({99, 10});
+    queue.push({98, 1});
+    while (!queue.empty()) {
+        CHECK(queue.pop().id < 4);
+    }
+}
+
+static void TestScoreComponents() {
+    CandidateScorer scorer;
+    const ScoreWeights& w = scorer.GetWeights();
+    const uint8_t open_ap[6] = {0, 0, 0, 0, 0, 1};
+    const uint8_t secure_ap[6] = {0, 0, 0, 0, 0, 2};
+    const uint8_t ap_5g[6] = {0, 0, 0, 0, 0, 3};
+    const uint8_t weak_5g[6] = {0, 0, 0, 0, 0, 4};
+
+    scorer.BeginRound();
+    CHECK(scorer.Score(open_ap, -60, WIFI_AUTH_OPEN, 6, 0) == w.rssi * 40);
+    CHECK(scorer.Score(secure_ap, -60, WIFI_AUTH_WPA2_PSK, 6, 0) == w.rssi * 40 + w.secure_auth);
+    CHECK(scorer.Score(ap_5g, -60, WIFI_AUTH_OPEN, 36, 0) == w.rssi * (40 + w.band_5g_rssi_offset));
+    // 低于可用门限的 5 GHz 不享受加成
+    CHECK(scorer.Score(weak_5g, -80, WIFI_AUTH_OPEN, 36, 0) == w.rssi * 20);
+
+    ScoreBreakdown scores[CandidateScorer::kMaxScores];
+    CHECK(scorer.GetLastScores(scores, CandidateScorer::kMaxScores) == 4);
+    CHECK(memcmp(scores[2].bssid, ap_5g, 6) == 0);
+    CHECK(scores[2].channel == 36);
+    CHECK(scores[2].since_success_s == -1);
+}
+
+static void TestFailuresLowerScore() {
+    CandidateScorer scorer;
+    const ScoreWeights& w = scorer.GetWeights();
+    const uint8_t flaky[6] = {1, 2, 3, 4, 5, 6};
+    const uint8_t steady[6] = {1, 2, 3, 4, 5, 7};
+
+    scorer.RecordFailure(flaky, 0);
+    scorer.RecordFailure(flaky, 0);
+    scorer.BeginRound();
+    // 两次失败足以让强 10 dB 的 AP 排到后面
+    int32_t flaky_score = scorer.Score(flaky, -50, WIFI_AUTH_WPA2_PSK, 6, kSecondUs);
+    int32_t steady_score = scorer.Score(steady, -60, WIFI_AUTH_WPA2_PSK, 6, kSecondUs);
+    CHECK(flaky_score == w.rssi * 50 + w.secure_auth - 2 * w.failure);
+    CHECK(steady_score == w.rssi * 40 + w.secure_auth);
+    CHECK(flaky_score < steady_score);
+
+    // 成功一次：失败计数减半，并获得满额的最近成功加分
+    scorer.RecordSuccess(flaky, 2 * kSecondUs);
+    scorer.BeginRound();
+    CHECK(scorer.Score(flaky, -50, WIFI_AUTH_WPA2_PSK, 6, 2 * kSecondUs) ==
+        w.rssi * 50 + w.secure_auth + w.success - w.failure + w.recency);
+
+    // 最近成功加分在窗口内线性衰减，窗口外为 0
+    int64_t half_window_us = 2 * kSecondUs + w.recency_window_s / 2 * kSecondUs;
+    scorer.BeginRound();
+    CHECK(scorer.Score(flaky, -50, WIFI_AUTH_WPA2_PSK, 6, half_window_us) ==
+        w.rssi * 50 + w.secure_auth + w.success - w.failure + w.recency / 2);
+    int64_t after_window_us = 2 * kSecondUs + w.recency_window_s * kSecondUs;
+    scorer.BeginRound();
+    CHECK(scorer.Score(flaky, -50, WIFI_AUTH_WPA2_PSK, 6, after_window_us) ==
+        w.rssi * 50 + w.secure_auth + w.success - w.failure);
+}
+
+static void TestRssiSmoothing() {
+    CandidateScorer scorer;
+    const uint8_t ap[6] = {2, 0, 0, 0, 0, 1};
+    scorer.BeginRound();
+    scorer.Score(ap, -50, WIFI_AUTH_OPEN, 1, 0);
+    // 单次掉到 -90 只把平滑值拉低 30%
+    scorer.BeginRound();
+    scorer.Score(ap, -90, WIFI_AUTH_OPEN, 1, 0);
+    ScoreBreakdown breakdown;
+    CHECK(scorer.GetLastScores(&breakdown, 1) == 1);
+    CHECK(breakdown.rssi == -90);
+    CHECK(breakdown.smoothed_rssi == -62);
+}
+
+static void TestHistoryEvictsLeastRecentlyUsed() {
+    CandidateScorer scorer;
+    const ScoreWeights& w = scorer.GetWeights();
+    uint8_t bssid[6] = {3, 0, 0, 0, 0, 0};
+    // 第 0 个 BSSID 有失败记录，之后有 kHistorySize 个更新的 BSSID 把它挤出历史表
+    scorer.RecordFailure(bssid, 0);
+    for (size_t i = 1; i <= CandidateScorer::kHistorySize; i++) {
+        bssid[5] = i;
+        scorer.RecordFailure(bssid, i);
+    }
+    bssid[5] = 0;
+    scorer.BeginRound();
+    CHECK(scorer.Score(bssid, -60, WIFI_AUTH_OPEN, 1, 100) == w.rssi * 40);
+    // 最近用过的仍保留失败计数
+    bssid[5] = CandidateScorer::kHistorySize;
+    CHECK(scorer.Score(bssid, -60, WIFI_AUTH_OPEN, 1, 100) == w.rssi * 40 - w.failure);
+
+    scorer.Clear();
+    scorer.BeginRound();
+    CHECK(scorer.Score(bssid, -60, WIFI_AUTH_OPEN, 1, 200) == w.rssi * 40);
+}
+
+static void TestBand5gOffsetGate() {
+    CandidateScorer scorer;
+    const ScoreWeights& w = scorer.GetWeights();
+    auto score = [&](uint8_t id, int8_t rssi, uint8_t channel) {
+        const uint8_t bssid[6] = {0, 0, 0, 0, 1, id};
+        return scorer.Score(bssid, rssi, WIFI_AUTH_OPEN, channel, 0);
+    };
+    scorer.BeginRound();
+    // 门限本身算可用，低 1 dB 就不加成；信道 14 仍是 2.4 GHz
+    CHECK(score(1, w.band_5g_min_rssi, 36) == w.rssi * (w.band_5g_min_rssi + 100 + w.band_5g_rssi_offset));
+    CHECK(score(2, w.band_5g_min_rssi - 1, 36) == w.rssi * (w.band_5g_min_rssi - 1 + 100));
+    CHECK(score(3, -60, 14) == w.rssi * 40);
+    // 可用的 5 GHz 优先于响不到 offset 的 2.4 GHz，更响的 2.4 GHz 仍然优先
+    CHECK(score(4, -65, 149) > score(5, -65 + w.band_5g_rssi_offset - 1, 6));
+    CHECK(score(6, -65, 149) < score(7, -65 + w.band_5g_rssi_offset + 1, 6));
+}
+
+int main() {
+    TestQueueKeepsHighestScores();
+    TestScoreComponents();
+    TestBand5gOffsetGate();
+    TestFailuresLowerScore();
+    TestRssiSmoothing();
+    TestHistoryEvictsLeastRecentlyUsed();
+    printf("test_candidate_scorer: ok\n");
+    return 0;
+}
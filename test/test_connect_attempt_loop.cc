@@ -0,0 +1,220 @@
+// ConnectAttemptLoop：用虚拟时钟上的驱动替身推动 WifiConnectionManager 实际使用的尝试循环，
+// 各断开原因的判定耗时，过期的定时器回调，超时后才到达的断开原因，以及连接失败与取消
+#include "connect_attempt_loop.h"
+#include "connect_report.h"
+#include "test_util.h"
+
+#include <esp_wifi.h>
+
+// 与 ConnectOptions 的默认值一致
+static constexpr uint32_t kAttemptTimeoutMs = 10000;
+
+// 每次发起连接后 latency_ms 以 reason 断开（reason 为 0 表示没有事件），定时器在 timer_at 到期
+class FakeDriver : public ConnectAttemptDriver {
+public:
+    esp_err_t StartConnect() override {
+        connects++;
+        if (connect_error != ESP_OK) {
+            return connect_error;
+        }
+        event_at = reason != 0 ? now + latency_ms : -1;
+        return ESP_OK;
+    }
+    void ArmTimer(uint32_t ms) override { timer_at = now + ms; }
+    void StopTimer() override { timer_at = -1; }
+
+    int64_t now = 0;
+    int64_t timer_at = -1;
+    int64_t event_at = -1;
+    uint16_t reason = 0;
+    uint32_t latency_ms = 0;
+    esp_err_t connect_error = ESP_OK;
+    int connects = 0;
+};
+
+// 按时间顺序送出断开事件和定时器到期，直到循环给出结束判定；同一时刻定时器先到
+static RetryDecision Run(ConnectAttemptLoop& loop, FakeDriver& driver, RetryDecision decision) {
+    while (decision.verdict == RetryVerdict::kRetry) {
+        CHECK(loop.Active());
+        CHECK(driver.timer_at >= 0);
+        if (driver.event_at >= 0 && driver.event_at < driver.timer_at) {
+            driver.now = driver.event_at;
+            driver.event_at = -1;
+            decision = loop.OnDisconnect(driver.reason, 0, driver.now);
+        } else {
+            driver.now = driver.timer_at;
+            decision = loop.OnTimer(driver.now);
+        }
+    }
+    CHECK(!loop.Active());
+    return decision;
+}
+
+static ConnectRecord Current() {
+    ConnectRecord record;
+    CHECK(ConnectReport::GetInstance().GetCurrent(&record));
+    return record;
+}
+
+static void TimeToVerdictTable() {
+    struct Case {
+        const char* name;
+        uint16_t reason;
+        uint32_t latency_ms;
+        bool psk_ap;
+        RetryVerdict verdict;
+        uint32_t elapsed_ms;
+        int tries;
+    };
+    const Case cases[] = {
+        {"AUTH_FAIL", WIFI_REASON_AUTH_FAIL, 1000, true, RetryVerdict::kWrongPassword, 1000, 1},
+        {"MIC_FAILURE", WIFI_REASON_MIC_FAILURE, 1000, true, RetryVerdict::kWrongPassword, 1000, 1},
+        {"4-way timeout, PSK in scan", WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT, 4000, true,
+            RetryVerdict::kWrongPassword, 9000, 2},
+        {"4-way timeout, not PSK in scan", WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT, 4000, false,
+            RetryVerdict::kExhausted, 19000, 4},
+        {"ASSOC_TOOMANY", WIFI_REASON_ASSOC_TOOMANY, 500, true, RetryVerdict::kExhausted, 2600, 4},
+        {"BEACON_TIMEOUT", WIFI_REASON_BEACON_TIMEOUT, 6000, true, RetryVerdict::kExhausted, 24600, 4},
+        {"PAIRWISE_CIPHER_INVALID", WIFI_REASON_PAIRWISE_CIPHER_INVALID, 1000, true,
+            RetryVerdict::kIncompatible, 1000, 1},
+        {"no events", 0, 0, true, RetryVerdict::kExhausted, 43000, 4},
+    };
+    printf("%-32s %8s  %-15s %8s %5s\n", "case", "latency", "verdict", "time", "tries");
+    for (const auto& c : cases) {
+        FakeDriver driver;
+        driver.reason = c.reason;
+        driver.latency_ms = c.latency_ms;
+        ConnectAttemptLoop loop(driver);
+        ConnectReport::GetInstance().Begin("ap", c.psk_ap, 0);
+        RetryDecision decision = Run(loop, driver,
+            loop.Begin(RetryPolicyConfig(), kAttemptTimeoutMs, c.psk_ap, -60, 6, driver.now));
+        printf("%-32s %6u ms  %-15s %5u ms %5d\n", c.name, (unsigned)c.latency_ms, RetryVerdictName(decision.verdict),
+            (unsigned)driver.now, loop.attempts());
+        CHECK(decision.verdict == c.verdict);
+        CHECK(driver.now == c.elapsed_ms);
+        CHECK(loop.attempts() == c.tries);
+        CHECK(driver.connects == c.tries);
+        // 结束后不再有定时器
+        CHECK(driver.timer_at < 0);
+
+        // 每次尝试都写入了诊断记录
+        ConnectRecord record = Current();
+        CHECK(record.attempt_count == c.tries);
+        const AttemptRecord& last = record.attempts[c.tries - 1];
+        CHECK(last.outcome == (c.reason != 0 ? AttemptOutcome::kDisconnected : AttemptOutcome::kTimeout));
+        CHECK(last.reason == c.reason);
+        CHECK(last.rssi == -60 && last.channel == 6);
+    }
+}
+
+static void TestStaleTimerIgnored() {
+    FakeDriver driver;
+    ConnectAttemptLoop loop(driver);
+    ConnectReport::GetInstance().Begin("ap", false, 0);
+    CHECK(loop.Begin(RetryPolicyConfig(), kAttemptTimeoutMs, false, 0, 0, 0).verdict == RetryVerdict::kRetry);
+    CHECK(loop.phase() == ConnectAttemptLoop::Phase::kWaiting);
+    CHECK(driver.timer_at == kAttemptTimeoutMs);
+
+    // 还没到期的回调不算超时
+    CHECK(loop.OnTimer(5000).verdict == RetryVerdict::kRetry);
+    CHECK(loop.phase() == ConnectAttemptLoop::Phase::kWaiting);
+    CHECK(loop.attempts() == 0);
+
+    driver.now = 6000;
+    CHECK(loop.OnDisconnect(WIFI_REASON_ASSOC_EXPIRE, -70, driver.now).delay_ms == 1000);
+    CHECK(loop.phase() == ConnectAttemptLoop::Phase::kRetryDelay);
+    CHECK(driver.timer_at == 7000);
+    // 重新装填前已在排队的回调在间隔结束前到达：不提前发起下一次
+    CHECK(loop.OnTimer(6500).verdict == RetryVerdict::kRetry);
+    CHECK(driver.connects == 1);
+    driver.now = 7000;
+    CHECK(loop.OnTimer(driver.now).verdict == RetryVerdict::kRetry);
+    CHECK(driver.connects == 2);
+    CHECK(loop.phase() == ConnectAttemptLoop::Phase::kWaiting);
+    CHECK(Current().attempts[1].wait_ms == 1000);
+}
+
+static void TestLateReasonAmendsTimeout() {
+    FakeDriver driver;
+    ConnectAttemptLoop loop(driver);
+    ConnectReport::GetInstance().Begin("ap", false, 0);
+    loop.Begin(RetryPolicyConfig(), kAttemptTimeoutMs, false, -60, 6, 0);
+    driver.now = kAttemptTimeoutMs;
+    CHECK(loop.OnTimer(driver.now).delay_ms == 1000);
+
+    // 超时之后才到达的断开原因补充到上一次尝试，不算新的尝试，也不改变重试间隔
+    CHECK(loop.OnDisconnect(WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT, 0, driver.now + 100).verdict == RetryVerdict::kRetry);
+    CHECK(loop.attempts() == 1);
+    CHECK(loop.phase() == ConnectAttemptLoop::Phase::kRetryDelay);
+    CHECK(driver.timer_at == kAttemptTimeoutMs + 1000);
+    AttemptRecord attempt = Current().attempts[0];
+    CHECK(attempt.outcome == AttemptOutcome::kTimeout);
+    CHECK(attempt.error == ESP_ERR_TIMEOUT);
+    CHECK(attempt.reason == WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT);
+    CHECK(attempt.rssi == -60);
+}
+
+static void TestConnectErrorAndConnected() {
+    FakeDriver driver;
+    driver.connect_error = ESP_ERR_NO_MEM;
+    ConnectAttemptLoop loop(driver);
+    ConnectReport::GetInstance().Begin("ap", false, 0);
+    // esp_wifi_connect 失败也是一次尝试，按一般失败的间隔重试
+    RetryDecision decision = loop.Begin(RetryPolicyConfig(), kAttemptTimeoutMs, false, -60, 6, 0);
+    CHECK(decision.verdict == RetryVerdict::kRetry && decision.delay_ms == 1000);
+    CHECK(loop.phase() == ConnectAttemptLoop::Phase::kRetryDelay);
+    CHECK(loop.attempts() == 1);
+    CHECK(Current().attempts[0].outcome == AttemptOutcome::kConnectError);
+    CHECK(Current().attempts[0].error == ESP_ERR_NO_MEM);
+
+    driver.connect_error = ESP_OK;
+    driver.now = 1000;
+    loop.OnTimer(driver.now);
+    CHECK(loop.phase() == ConnectAttemptLoop::Phase::kWaiting);
+    CHECK(loop.OnConnected(-55, 11, 3000));
+    CHECK(!loop.Active());
+    CHECK(driver.timer_at < 0);
+    AttemptRecord attempt = Current().attempts[1];
+    CHECK(attempt.outcome == AttemptOutcome::kConnected);
+    CHECK(attempt.rssi == -55 && attempt.channel == 11);
+    CHECK(attempt.wait_ms == 1000 && attempt.duration_ms == 2000);
+    // 已结束：迟到的连接事件和定时器回调都被忽略
+    CHECK(!loop.OnConnected(-55, 11, 3100));
+    CHECK(loop.OnTimer(20000).verdict == RetryVerdict::kRetry);
+    CHECK(driver.connects == 2);
+
+    // 每次都失败：用完次数后结束
+    FakeDriver failing;
+    failing.connect_error = ESP_ERR_NO_MEM;
+    ConnectAttemptLoop failing_loop(failing);
+    CHECK(Run(failing_loop, failing, failing_loop.Begin(RetryPolicyConfig(), kAttemptTimeoutMs, false, 0, 0, 0))
+        .verdict == RetryVerdict::kExhausted);
+    CHECK(failing.now == 3000);
+    CHECK(failing.connects == 4);
+}
+
+static void TestStop() {
+    FakeDriver driver;
+    driver.reason = WIFI_REASON_AUTH_FAIL;
+    driver.latency_ms = 1000;
+    ConnectAttemptLoop loop(driver);
+    ConnectReport::GetInstance().Begin("ap", false, 0);
+    loop.Begin(RetryPolicyConfig(), kAttemptTimeoutMs, false, 0, 0, 0);
+    loop.Stop();
+    CHECK(!loop.Active());
+    CHECK(driver.timer_at < 0);
+    // 取消之后到达的事件不再推进循环，也不写入诊断记录
+    CHECK(loop.OnDisconnect(WIFI_REASON_AUTH_FAIL, 0, 1000).verdict == RetryVerdict::kRetry);
+    CHECK(loop.attempts() == 0);
+    CHECK(Current().attempts[0].outcome == AttemptOutcome::kPending);
+}
+
+int main() {
+    TimeToVerdictTable();
+    TestStaleTimerIgnored();
+    TestLateReasonAmendsTimeout();
+    TestConnectErrorAndConnected();
+    TestStop();
+    printf("test_connect_attempt_loop: ok\n");
+    return 0;
+}
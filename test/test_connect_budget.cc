@@ -0,0 +1,137 @@
+// ConnectBudget：每个 SSID 的次数与时间预算、整轮时限、确定性失败，以及耗时统计；附带断开原因的分类
+#include "connect_budget.h"
+#include "disconnect_reason.h"
+#include "test_util.h"
+
+#include <cstring>
+
+#include <esp_wifi_types_generic.h>
+
+static void TestPerSsidAttempts() {
+    ConnectBudget budget;
+    budget.BeginCycle(0);
+    // 同一 SSID 的不同 BSSID 共用次数
+    for (uint32_t i = 0; i < 4; i++) {
+        CHECK(budget.CanAttempt(1, i * 10));
+        budget.OnAttempt(1, i * 10);
+    }
+    CHECK(!budget.CanAttempt(1, 50));
+    CHECK(budget.CanAttempt(2, 50));
+}
+
+static void TestSsidTimeBudgetAndDeadline() {
+    ConnectBudget budget;
+    budget.BeginCycle(0);
+    budget.OnAttempt(3, 1000);
+    CHECK(budget.CanAttempt(3, 20999));
+    CHECK(!budget.CanAttempt(3, 21000));
+
+    // 总时限对所有 SSID 生效，包括还没尝试过的
+    CHECK(!budget.DeadlineExpired(59999));
+    CHECK(budget.CanAttempt(4, 59999));
+    CHECK(budget.DeadlineExpired(60000));
+    CHECK(!budget.CanAttempt(4, 60000));
+
+    // 不在一轮连接中时总时限不生效
+    budget.AbortCycle();
+    CHECK(!budget.DeadlineExpired(120000));
+}
+
+static void TestDefinitiveFailureBlocksSsid() {
+    ConnectBudget budget;
+    budget.BeginCycle(0);
+    budget.OnAttempt(2, 100);
+    budget.OnFailure(2, false);
+    CHECK(budget.CanAttempt(2, 101));
+    budget.OnFailure(2, true);
+    CHECK(!budget.CanAttempt(2, 102));
+    // 新的一轮重新开始计算
+    budget.BeginCycle(200);
+    CHECK(budget.CanAttempt(2, 200));
+}
+
+static void TestMoreSsidsThanSlots() {
+    ConnectBudget budget;
+    budget.BeginCycle(0);
+    for (uint32_t hash = 1; hash <= ConnectBudget::kMaxSsids + 1; hash++) {
+        budget.OnAttempt(hash, 0);
+    }
+    // 超出的网络不记录次数，只受总时限约束
+    uint32_t extra = ConnectBudget::kMaxSsids + 1;
+    for (int i = 0; i < 10; i++) {
+        budget.OnAttempt(extra, 0);
+    }
+    CHECK(budget.CanAttempt(extra, 1000));
+    CHECK(!budget.CanAttempt(extra, 60000));
+}
+
+static void TestReport() {
+    ConnectBudget budget;
+    CHECK(!budget.InCycle());
+    // 第一次尝试自动开始一轮
+    budget.OnAttempt(1, 1000);
+    CHECK(budget.InCycle());
+    budget.OnAttempt(1, 2000);
+    budget.EndCycle(true, false, 6000);
+    CHECK(!budget.InCycle());
+    const auto& report = budget.GetReport();
+    CHECK(report.cycles == 1);
+    CHECK(report.successes == 1);
+    CHECK(report.last_duration_ms == 5000);
+    CHECK(report.worst_duration_ms == 5000);
+    CHECK(report.last_attempts == 2);
+    CHECK(report.worst_attempts == 2);
+
+    // 更快的成功不降低最坏值
+    budget.OnAttempt(1, 10000);
+    budget.EndCycle(true, false, 11000);
+    CHECK(report.worst_duration_ms == 5000);
+    CHECK(report.last_duration_ms == 1000);
+
+    budget.OnAttempt(1, 20000);
+    budget.EndCycle(false, true, 80000);
+    budget.OnAttempt(1, 90000);
+    budget.EndCycle(false, false, 95000);
+    CHECK(report.cycles == 4);
+    CHECK(report.deadline_hits == 1);
+    CHECK(report.exhausted == 1);
+    CHECK(report.worst_duration_ms == 5000);
+
+    // 没有任何尝试的失败轮次不计入
+    budget.BeginCycle(100000);
+    budget.EndCycle(false, false, 100500);
+    CHECK(report.cycles == 4);
+    // 重复结束无效
+    budget.EndCycle(true, false, 100600);
+    CHECK(report.successes == 2);
+}
+
+static void TestDisconnectClassification() {
+    CHECK(ClassifyDisconnect(WIFI_REASON_AUTH_FAIL) == DisconnectClass::kCredential);
+    CHECK(ClassifyDisconnect(WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT) == DisconnectClass::kCredential);
+    CHECK(ClassifyDisconnect(WIFI_REASON_PAIRWISE_CIPHER_INVALID) == DisconnectClass::kIncompatible);
+    CHECK(ClassifyDisconnect(WIFI_REASON_NO_AP_FOUND) == DisconnectClass::kNotFound);
+    CHECK(ClassifyDisconnect(WIFI_REASON_ASSOC_LEAVE) == DisconnectClass::kLocal);
+    CHECK(ClassifyDisconnect(WIFI_REASON_ASSOC_TOOMANY) == DisconnectClass::kOverloaded);
+    CHECK(ClassifyDisconnect(WIFI_REASON_BEACON_TIMEOUT) == DisconnectClass::kTransient);
+    CHECK(ClassifyDisconnect(0xffff) == DisconnectClass::kTransient);
+
+    CHECK(IsDefinitiveFailure(DisconnectClass::kCredential));
+    CHECK(IsDefinitiveFailure(DisconnectClass::kIncompatible));
+    CHECK(!IsDefinitiveFailure(DisconnectClass::kTransient));
+    CHECK(!IsDefinitiveFailure(DisconnectClass::kOverloaded));
+
+    CHECK(strcmp(DisconnectReasonString(WIFI_REASON_AUTH_FAIL), "") != 0);
+    CHECK(DisconnectReasonString(0xffff) != nullptr);
+}
+
+int main() {
+    TestPerSsidAttempts();
+    TestSsidTimeBudgetAndDeadline();
+    TestDefinitiveFailureBlocksSsid();
+    TestMoreSsidsThanSlots();
+    TestReport();
+    TestDisconnectClassification();
+    printf("test_connect_budget: ok\n");
+    return 0;
+}
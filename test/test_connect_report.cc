@@ -0,0 +1,247 @@
+// ConnectReport：二进制格式的字段偏移、按整条记录截断、环形缓冲区回绕、超过 kMaxAttempts 的尝试与 32 字节 SSID，以及 JSON 输出
+#include "connect_report.h"
+#include "test_util.h"
+
+#include <cstring>
+#include <string>
+
+#include <esp_wifi.h>
+
+static uint32_t GetU32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t GetU16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static size_t CountOf(const std::string& text, const std::string& pattern) {
+    size_t count = 0;
+    for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+// 一次握手超时断开，一次连接成功
+static uint32_t AddConnected(ConnectReport& report) {
+    report.Begin("home", true, 1000);
+    report.AttemptStarted(1000);
+    report.AttemptEnded(AttemptOutcome::kDisconnected, WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT, -60, 6, ESP_ERR_WIFI_CONN,
+                        1500);
+    report.AttemptStarted(2500);
+    report.AttemptEnded(AttemptOutcome::kConnected, 0, -55, 6, ESP_OK, 4000);
+    report.Finish(ConnectOutcome::kConnected, ESP_OK, 4100);
+    ConnectRecord record;
+    CHECK(report.GetCurrent(&record));
+    return record.seq;
+}
+
+// 一次超时后用完次数
+static void AddFailed(ConnectReport& report, const char* ssid, uint32_t start_ms) {
+    report.Begin(ssid, false, start_ms);
+    report.AttemptStarted(start_ms);
+    report.AttemptEnded(AttemptOutcome::kTimeout, 0, -80, 1, ESP_ERR_TIMEOUT, start_ms + 10000);
+    report.Finish(ConnectOutcome::kExhausted, ESP_FAIL, start_ms + 10000);
+}
+
+static void TestBinaryLayout() {
+    auto& report = ConnectReport::GetInstance();
+    report.Clear();
+    uint32_t seq = AddConnected(report);
+
+    uint8_t out[256];
+    size_t size = report.GetBinary(out, sizeof(out));
+    CHECK(size == 2 + ConnectReport::kBinaryRecordHeaderSize + 4 + 2 * ConnectReport::kBinaryAttemptSize);
+    CHECK(out[0] == ConnectReport::kBinaryVersion);
+    CHECK(out[1] == 1);
+
+    const uint8_t* record = out + 2;
+    CHECK(GetU32(record) == seq);
+    CHECK(GetU32(record + 4) == 1000);
+    CHECK(GetU32(record + 8) == 3100);
+    CHECK(GetU32(record + 12) == ESP_OK);
+    CHECK(record[16] == (uint8_t)ConnectOutcome::kConnected);
+    CHECK(record[17] == 1);
+    CHECK(record[18] == 4);
+    CHECK(memcmp(record + 19, "home", 4) == 0);
+    CHECK(record[23] == 2);
+    // 固定部分（四个 u32、分类、psk、SSID 长度、尝试数）正好 20 字节
+    CHECK(4 * 4 + 4 == ConnectReport::kBinaryRecordHeaderSize);
+
+    const uint8_t* attempt = record + 24;
+    CHECK(attempt[0] == (uint8_t)AttemptOutcome::kDisconnected);
+    CHECK(attempt[1] == WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT);
+    CHECK((int8_t)attempt[2] == -60);
+    CHECK(attempt[3] == 6);
+    CHECK(GetU16(attempt + 4) == ESP_ERR_WIFI_CONN);
+    CHECK(GetU16(attempt + 6) == 0);
+    CHECK(GetU16(attempt + 8) == 500);
+
+    attempt += ConnectReport::kBinaryAttemptSize;
+    CHECK(attempt[0] == (uint8_t)AttemptOutcome::kConnected);
+    CHECK(attempt[1] == 0);
+    CHECK((int8_t)attempt[2] == -55);
+    CHECK(GetU16(attempt + 4) == 0);
+    CHECK(GetU16(attempt + 6) == 1000);
+    CHECK(GetU16(attempt + 8) == 1500);
+    CHECK(attempt + ConnectReport::kBinaryAttemptSize == out + size);
+
+    // 负的结果按 32 位补码写入
+    AddFailed(report, "x", 5000);
+    size = report.GetBinary(out, sizeof(out));
+    CHECK(out[1] == 2);
+    CHECK(GetU32(out + 2 + 12) == (uint32_t)ESP_FAIL);
+}
+
+static void TestBinaryTruncation() {
+    auto& report = ConnectReport::GetInstance();
+    report.Clear();
+    AddFailed(report, "a", 0);
+    AddConnected(report);
+    // 最新的在前：44 字节的 "home"，然后 31 字节的 "a"
+    const size_t newest = ConnectReport::kBinaryRecordHeaderSize + 4 + 2 * ConnectReport::kBinaryAttemptSize;
+    const size_t oldest = ConnectReport::kBinaryRecordHeaderSize + 1 + ConnectReport::kBinaryAttemptSize;
+    CHECK(newest == 44 && oldest == 31);
+
+    uint8_t out[256];
+    // 放不下版本和条数
+    CHECK(report.GetBinary(out, 0) == 0);
+    CHECK(report.GetBinary(out, 1) == 0);
+
+    const struct {
+        size_t out_size;
+        size_t size;
+        uint8_t count;
+    } cases[] = {
+        {2, 2, 0},
+        {2 + newest - 1, 2, 0},
+        {2 + newest, 2 + newest, 1},
+        {2 + newest + oldest - 1, 2 + newest, 1},
+        {2 + newest + oldest, 2 + newest + oldest, 2},
+        {sizeof(out), 2 + newest + oldest, 2},
+    };
+    for (const auto& c : cases) {
+        memset(out, 0xAA, sizeof(out));
+        size_t size = report.GetBinary(out, c.out_size);
+        CHECK(size == c.size);
+        CHECK(out[1] == c.count);
+        // 不写半条记录
+        CHECK(out[size] == 0xAA);
+    }
+}
+
+static void TestRingWraps() {
+    auto& report = ConnectReport::GetInstance();
+    report.Clear();
+    const size_t total = ConnectReport::kHistory + 3;
+    for (size_t i = 0; i < total; i++) {
+        std::string ssid = "ap" + std::to_string(i);
+        AddFailed(report, ssid.c_str(), i * 20000);
+    }
+
+    // 只保留最近 kHistory 条，最新的在前，seq 依次递减
+    ConnectRecord records[ConnectReport::kHistory + 1];
+    CHECK(report.GetRecords(records, ConnectReport::kHistory + 1) == ConnectReport::kHistory);
+    CHECK(strcmp(records[0].ssid, ("ap" + std::to_string(total - 1)).c_str()) == 0);
+    CHECK(strcmp(records[ConnectReport::kHistory - 1].ssid, "ap3") == 0);
+    for (size_t i = 1; i < ConnectReport::kHistory; i++) {
+        CHECK(records[i].seq == records[0].seq - i);
+    }
+
+    uint8_t out[1024];
+    size_t size = report.GetBinary(out, sizeof(out));
+    CHECK(out[1] == ConnectReport::kHistory);
+    const uint8_t* p = out + 2;
+    for (size_t i = 0; i < ConnectReport::kHistory; i++) {
+        CHECK(GetU32(p) == records[i].seq);
+        CHECK(GetU32(p + 4) == records[i].start_ms);
+        uint8_t ssid_len = p[18];
+        CHECK(memcmp(p + 19, records[i].ssid, ssid_len) == 0);
+        CHECK(p[19 + ssid_len] == 1);
+        p += ConnectReport::kBinaryRecordHeaderSize + ssid_len + ConnectReport::kBinaryAttemptSize;
+    }
+    CHECK(p == out + size);
+
+    std::string json = report.GetJson();
+    CHECK(CountOf(json, "\"seq\":") == ConnectReport::kHistory);
+    CHECK(json.find("\"ssid\":\"ap2\"") == std::string::npos);
+    CHECK(json.find("\"ssid\":\"ap3\"") != std::string::npos);
+    CHECK(json.find("\"ssid\":\"ap" + std::to_string(total - 1) + "\"") < json.find("\"ssid\":\"ap3\""));
+}
+
+static void TestManyAttemptsAndLongSsid() {
+    auto& report = ConnectReport::GetInstance();
+    report.Clear();
+    // 超过 32 字节的部分被截掉
+    const std::string ssid(40, 's');
+    report.Begin(ssid.c_str(), false, 0);
+    // 第一次尝试持续 70 s，之后隔 70 s 再试：都在 65535 饱和
+    uint32_t now = 0;
+    const int attempts = ConnectRecord::kMaxAttempts + 3;
+    for (int i = 0; i < attempts; i++) {
+        report.AttemptStarted(now);
+        now += i == 0 ? 70000 : 100;
+        report.AttemptEnded(AttemptOutcome::kTimeout, 0, -70, 1, ESP_ERR_TIMEOUT, now);
+        now += i == 0 ? 70000 : 50;
+    }
+    report.Finish(ConnectOutcome::kExhausted, ESP_ERR_TIMEOUT, now);
+
+    // 只保留前 kMaxAttempts 次的细节，次数照常计
+    ConnectRecord record;
+    CHECK(report.GetCurrent(&record));
+    CHECK(record.attempt_count == attempts);
+    CHECK(strlen(record.ssid) == 32);
+    CHECK(record.attempts[0].duration_ms == UINT16_MAX);
+    CHECK(record.attempts[1].wait_ms == UINT16_MAX);
+    CHECK(record.attempts[ConnectRecord::kMaxAttempts - 1].duration_ms == 100);
+    CHECK(record.attempts[ConnectRecord::kMaxAttempts - 1].wait_ms == 50);
+
+    uint8_t out[256];
+    size_t size = report.GetBinary(out, sizeof(out));
+    CHECK(size == 2 + ConnectReport::kBinaryRecordHeaderSize + 32 + ConnectRecord::kMaxAttempts *
+        ConnectReport::kBinaryAttemptSize);
+    CHECK(out[2 + 18] == 32);
+    CHECK(memcmp(out + 2 + 19, ssid.data(), 32) == 0);
+    CHECK(out[2 + 19 + 32] == ConnectRecord::kMaxAttempts);
+    CHECK(GetU16(out + 2 + 20 + 32 + 8) == UINT16_MAX);
+
+    std::string json = report.GetJson();
+    CHECK(json.find("\"ssid\":\"" + ssid.substr(0, 32) + "\"") != std::string::npos);
+    CHECK(json.find("\"attempt_count\":" + std::to_string(attempts)) != std::string::npos);
+    CHECK(CountOf(json, "\"outcome\":\"timeout\"") == ConnectRecord::kMaxAttempts);
+}
+
+static void TestJson() {
+    auto& report = ConnectReport::GetInstance();
+    report.Clear();
+    CHECK(report.GetJson() == "[]");
+
+    uint32_t seq = AddConnected(report);
+    CHECK(report.GetJson() ==
+        "[{\"seq\":" + std::to_string(seq) + ",\"ssid\":\"home\",\"outcome\":\"connected\",\"result\":0,"
+        "\"psk_ap\":true,\"start_ms\":1000,\"total_ms\":3100,\"attempt_count\":2,\"attempts\":["
+        "{\"outcome\":\"disconnected\",\"reason\":15,\"reason_name\":\"4-way handshake timeout\",\"error\":12295,"
+        "\"rssi\":-60,\"channel\":6,\"wait_ms\":0,\"duration_ms\":500},"
+        "{\"outcome\":\"connected\",\"rssi\":-55,\"channel\":6,\"wait_ms\":1000,\"duration_ms\":1500}]}]");
+
+    // 进行中的请求：未结束的尝试为 pending，取消时一并结束
+    report.Begin("next", false, 5000);
+    report.AttemptStarted(5000);
+    CHECK(report.GetJson().find("\"outcome\":\"pending\",\"rssi\":0") != std::string::npos);
+    report.Finish(ConnectOutcome::kCancelled, ESP_ERR_INVALID_STATE, 5300);
+    std::string json = report.GetJson();
+    CHECK(json.find("{\"seq\":" + std::to_string(seq + 1) + ",\"ssid\":\"next\",\"outcome\":\"cancelled\"") == 1);
+    CHECK(json.find("{\"outcome\":\"cancelled\",\"rssi\":0,\"channel\":0,\"wait_ms\":0,\"duration_ms\":300}") !=
+        std::string::npos);
+}
+
+int main() {
+    TestBinaryLayout();
+    TestBinaryTruncation();
+    TestRingWraps();
+    TestManyAttemptsAndLongSsid();
+    TestJson();
+    printf("test_connect_report: ok\n");
+    return 0;
+}
@@ -0,0 +1,66 @@
+// ConnectRetryPolicy：各断开原因的判定、重试间隔与总截止时间；判定耗时见 test_connect_attempt_loop
+#include "connect_retry_policy.h"
+#include "test_util.h"
+
+#include <cstring>
+
+#include <esp_wifi_types_generic.h>
+
+static void TestImmediateVerdicts() {
+    ConnectRetryPolicy policy;
+    policy.Begin(0, false);
+    CHECK(policy.OnDisconnect(WIFI_REASON_AUTH_FAIL, 100).verdict == RetryVerdict::kWrongPassword);
+    policy.Begin(0, false);
+    CHECK(policy.OnDisconnect(WIFI_REASON_MIC_FAILURE, 100).verdict == RetryVerdict::kWrongPassword);
+    policy.Begin(0, false);
+    CHECK(policy.OnDisconnect(WIFI_REASON_PAIRWISE_CIPHER_INVALID, 100).verdict == RetryVerdict::kIncompatible);
+    CHECK(policy.GetAttempts() == 1);
+}
+
+static void TestHandshakeTimeoutNeedsPskScan() {
+    ConnectRetryPolicy policy;
+    policy.Begin(0, true);
+    RetryDecision decision = policy.OnDisconnect(WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT, 100);
+    CHECK(decision.verdict == RetryVerdict::kRetry);
+    CHECK(decision.delay_ms == 1000);
+    // 中间夹着其他原因也累计
+    CHECK(policy.OnDisconnect(WIFI_REASON_BEACON_TIMEOUT, 200).verdict == RetryVerdict::kRetry);
+    CHECK(policy.OnDisconnect(WIFI_REASON_HANDSHAKE_TIMEOUT, 300).verdict == RetryVerdict::kWrongPassword);
+
+    // 扫描中不是 PSK（或没扫到）时，握手超时可能只是丢包，一直重试到次数用完
+    policy.Begin(0, false);
+    for (int i = 0; i < 3; i++) {
+        CHECK(policy.OnDisconnect(WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT, 100 * i).verdict == RetryVerdict::kRetry);
+    }
+    CHECK(policy.OnDisconnect(WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT, 400).verdict == RetryVerdict::kExhausted);
+}
+
+static void TestDelaysAndDeadline() {
+    ConnectRetryPolicy policy;
+    policy.Begin(1000, false);
+    CHECK(policy.OnDisconnect(WIFI_REASON_ASSOC_TOOMANY, 1500).delay_ms == 200);
+    CHECK(policy.OnDisconnect(WIFI_REASON_BEACON_TIMEOUT, 2000).delay_ms == 200);
+    CHECK(policy.OnDisconnect(WIFI_REASON_ASSOC_EXPIRE, 2500).delay_ms == 1000);
+
+    // 等待结束时已经到达截止时间
+    policy.Begin(0, false);
+    CHECK(policy.RemainingMs(0) == 44000);
+    CHECK(policy.OnTimeout(42999).verdict == RetryVerdict::kRetry);
+    CHECK(policy.OnConnectError(43000).verdict == RetryVerdict::kDeadline);
+    CHECK(policy.RemainingMs(44000) == 0);
+
+    RetryPolicyConfig config;
+    config.max_attempts = 1;
+    policy.SetConfig(config);
+    policy.Begin(0, false);
+    CHECK(policy.OnTimeout(10000).verdict == RetryVerdict::kExhausted);
+    CHECK(strcmp(RetryVerdictName(RetryVerdict::kDeadline), "deadline") == 0);
+}
+
+int main() {
+    TestImmediateVerdicts();
+    TestHandshakeTimeoutNeedsPskScan();
+    TestDelaysAndDeadline();
+    printf("test_connect_retry_policy: ok\n");
+    return 0;
+}
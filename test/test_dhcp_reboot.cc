@@ -0,0 +1,311 @@
+// DhcpRequestCachedAddress：只在 SELECTING 状态接管、拒绝空地址，
+// 以及把钩子接到假的 lwIP DHCP 客户端与服务器上，比较 INIT-REBOOT 与完整 DISCOVER 流程绑定地址的耗时
+#include "dhcp_reboot.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include <lwip/dhcp.h>
+#include <lwip/prot/dhcp.h>
+
+static int network_changed_calls = 0;
+static uint8_t state_at_network_changed = DHCP_STATE_OFF;
+
+static constexpr uint32_t kCachedIp = 0x6401a8c0;   // 192.168.1.100，网络字节序
+
+static void TestSeedsOnlyWhileSelecting() {
+    struct dhcp dhcp = {};
+    struct netif netif = {&dhcp};
+
+    for (int state = DHCP_STATE_OFF; state <= DHCP_STATE_BACKING_OFF; state++) {
+        if (state == DHCP_STATE_SELECTING) {
+            continue;
+        }
+        dhcp = {};
+        dhcp.state = state;
+        network_changed_calls = 0;
+        CHECK(!DhcpRequestCachedAddress(&netif, kCachedIp));
+        CHECK(dhcp.state == state);
+        CHECK(dhcp.offered_ip_addr.addr == 0);
+        CHECK(network_changed_calls == 0);
+    }
+
+    dhcp = {};
+    dhcp.state = DHCP_STATE_SELECTING;
+    network_changed_calls = 0;
+    CHECK(!DhcpRequestCachedAddress(&netif, 0));
+    CHECK(dhcp.state == DHCP_STATE_SELECTING);
+    CHECK(network_changed_calls == 0);
+
+    CHECK(DhcpRequestCachedAddress(&netif, kCachedIp));
+    CHECK(dhcp.offered_ip_addr.addr == kCachedIp);
+    CHECK(network_changed_calls == 1);
+    // lwIP 在链路变化时按 REBOOTING 状态发起 dhcp_reboot()
+    CHECK(state_at_network_changed == DHCP_STATE_REBOOTING);
+
+    // DHCP 还没启动的 netif
+    struct netif no_dhcp = {nullptr};
+    CHECK(!DhcpRequestCachedAddress(&no_dhcp, kCachedIp));
+}
+
+// 假的 lwIP DHCP 客户端与服务器：客户端按 lwIP 2.1 dhcp.c 的状态转换处理报文与超时，
+// dhcp_network_changed 在 REBOOTING 状态走 dhcp_reboot()，其他状态走 dhcp_discover()。
+// 不模拟丢包；ESP-IDF 默认开启 DHCP_DOES_ARP_CHECK，REQUESTING 收到 ACK 后先做 ARP 检测再绑定，
+// INIT-REBOOT 收到 ACK 直接绑定
+class FakeDhcp {
+public:
+    struct Config {
+        uint32_t one_way_ms;        // 客户端到服务器的单程时延
+        uint32_t lease_ip;          // 服务器上该客户端的租约
+        bool silent_reboot;         // 服务器对 INIT-REBOOT 不应答（RFC 2131：没有该客户端的记录时应保持沉默）
+        uint32_t offer_delay_ms;    // 服务器发 OFFER 前的处理时间（例如先 ping 一次要分配的地址）
+    };
+
+    static constexpr uint32_t kArpCheckMs = 500;
+    static constexpr uint8_t kRebootTries = 2;
+
+    explicit FakeDhcp(const Config& config) : config_(config), netif_{&dhcp_} {}
+
+    struct netif* netif() { return &netif_; }
+
+    // t=0 链路建立，lwIP 立即广播 DISCOVER；hook_at_ms 时 WifiStation 调用钩子。返回绑定的时刻
+    uint32_t RunToBound(uint32_t cached_ip, uint32_t hook_at_ms) {
+        Discover();
+        At(hook_at_ms, [this, cached_ip] { DhcpRequestCachedAddress(&netif_, cached_ip); });
+        while (dhcp_.state != DHCP_STATE_BOUND) {
+            CHECK(!events_.empty());
+            auto next = std::min_element(events_.begin(), events_.end(),
+                [](const Event& a, const Event& b) { return a.at_ms != b.at_ms ? a.at_ms < b.at_ms : a.seq < b.seq; });
+            Event event = std::move(*next);
+            events_.erase(next);
+            now_ms_ = event.at_ms;
+            event.action();
+        }
+        return now_ms_;
+    }
+
+    // dhcp_network_changed() 的替身
+    void NetworkChanged() {
+        switch (dhcp_.state) {
+        case DHCP_STATE_REBOOTING:
+        case DHCP_STATE_BOUND:
+            dhcp_.tries = 0;
+            Reboot();
+            break;
+        case DHCP_STATE_OFF:
+            break;
+        default:
+            dhcp_.tries = 0;
+            Discover();
+            break;
+        }
+    }
+
+    uint32_t bound_ip() const { return bound_ip_; }
+    int discovers() const { return discovers_; }
+
+private:
+    enum class Message { kDiscover, kOffer, kRequest, kRebootRequest, kAck, kNak };
+
+    struct Event {
+        uint32_t at_ms;
+        uint32_t seq;
+        std::function<void()> action;
+    };
+
+    void At(uint32_t at_ms, std::function<void()> action) { events_.push_back({at_ms, seq_++, std::move(action)}); }
+
+    void SetState(uint8_t state) {
+        if (dhcp_.state != state) {
+            dhcp_.state = state;
+            dhcp_.tries = 0;
+        }
+        timer_generation_++;
+    }
+
+    void SetTimeout(uint32_t ms) {
+        uint32_t generation = timer_generation_;
+        At(now_ms_ + ms, [this, generation] {
+            if (generation == timer_generation_) {
+                Timeout();
+            }
+        });
+    }
+
+    void Discover() {
+        SetState(DHCP_STATE_SELECTING);
+        discovers_++;
+        ToServer(Message::kDiscover, 0);
+        dhcp_.tries++;
+        SetTimeout((dhcp_.tries < 6 ? 1u << dhcp_.tries : 60u) * 1000);
+    }
+
+    void Select() {
+        SetState(DHCP_STATE_REQUESTING);
+        ToServer(Message::kRequest, dhcp_.offered_ip_addr.addr);
+        dhcp_.tries++;
+        SetTimeout((dhcp_.tries < 6 ? 1u << dhcp_.tries : 60u) * 1000);
+    }
+
+    void Reboot() {
+        SetState(DHCP_STATE_REBOOTING);
+        ToServer(Message::kRebootRequest, dhcp_.offered_ip_addr.addr);
+        dhcp_.tries++;
+        SetTimeout((dhcp_.tries < 10 ? dhcp_.tries : 10u) * 1000);
+    }
+
+    void Bind() {
+        SetState(DHCP_STATE_BOUND);
+        bound_ip_ = dhcp_.offered_ip_addr.addr;
+    }
+
+    void Timeout() {
+        switch (dhcp_.state) {
+        case DHCP_STATE_SELECTING:
+            Discover();
+            break;
+        case DHCP_STATE_REQUESTING:
+            if (dhcp_.tries <= 5) {
+                Select();
+            } else {
+                Discover();
+            }
+            break;
+        case DHCP_STATE_REBOOTING:
+            if (dhcp_.tries < kRebootTries) {
+                Reboot();
+            } else {
+                Discover();
+            }
+            break;
+        case DHCP_STATE_CHECKING:
+            Bind();
+            break;
+        }
+    }
+
+    void ToServer(Message message, uint32_t ip) {
+        At(now_ms_ + config_.one_way_ms, [this, message, ip] { ServerReceive(message, ip); });
+    }
+
+    void ToClient(Message message, uint32_t ip, uint32_t delay_ms = 0) {
+        At(now_ms_ + delay_ms + config_.one_way_ms, [this, message, ip] { ClientReceive(message, ip); });
+    }
+
+    void ServerReceive(Message message, uint32_t ip) {
+        switch (message) {
+        case Message::kDiscover:
+            ToClient(Message::kOffer, config_.lease_ip, config_.offer_delay_ms);
+            break;
+        case Message::kRequest:
+            ToClient(ip == config_.lease_ip ? Message::kAck : Message::kNak, ip);
+            break;
+        case Message::kRebootRequest:
+            if (!config_.silent_reboot) {
+                ToClient(ip == config_.lease_ip ? Message::kAck : Message::kNak, ip);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    void ClientReceive(Message message, uint32_t ip) {
+        switch (message) {
+        case Message::kOffer:
+            // 只有 SELECTING 状态处理 OFFER，已经转入 INIT-REBOOT 时忽略最初那个 DISCOVER 的应答
+            if (dhcp_.state == DHCP_STATE_SELECTING) {
+                ip4_addr_set_u32(&dhcp_.offered_ip_addr, ip);
+                Select();
+            }
+            break;
+        case Message::kAck:
+            if (dhcp_.state == DHCP_STATE_REQUESTING) {
+                SetState(DHCP_STATE_CHECKING);
+                SetTimeout(kArpCheckMs);
+            } else if (dhcp_.state == DHCP_STATE_REBOOTING) {
+                Bind();
+            }
+            break;
+        case Message::kNak:
+            if (dhcp_.state == DHCP_STATE_REQUESTING || dhcp_.state == DHCP_STATE_REBOOTING) {
+                // dhcp_handle_nak：清掉地址，立即重新 DISCOVER
+                SetState(DHCP_STATE_BACKING_OFF);
+                ip4_addr_set_u32(&dhcp_.offered_ip_addr, 0);
+                Discover();
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    Config config_;
+    struct dhcp dhcp_ = {};
+    struct netif netif_;
+    std::vector<Event> events_;
+    uint32_t seq_ = 0;
+    uint32_t now_ms_ = 0;
+    uint32_t timer_generation_ = 0;
+    uint32_t bound_ip_ = 0;
+    int discovers_ = 0;
+};
+
+static FakeDhcp* active_dhcp = nullptr;
+
+void dhcp_network_changed(struct netif* netif) {
+    network_changed_calls++;
+    state_at_network_changed = netif_dhcp_data(netif)->state;
+    if (active_dhcp != nullptr) {
+        active_dhcp->NetworkChanged();
+    }
+}
+
+static uint32_t TimeToBoundMs(const FakeDhcp::Config& config, uint32_t cached_ip, uint32_t* bound_ip = nullptr) {
+    FakeDhcp fake(config);
+    active_dhcp = &fake;
+    // 钩子与 DHCP 客户端都在 STA_CONNECTED 时启动，钩子晚 1 ms 执行
+    uint32_t bound_ms = fake.RunToBound(cached_ip, 1);
+    active_dhcp = nullptr;
+    if (bound_ip != nullptr) {
+        *bound_ip = fake.bound_ip();
+    }
+    return bound_ms;
+}
+
+static void TimeToBoundTable() {
+    constexpr uint32_t kOtherIp = kCachedIp + 0x01000000;
+    struct Case {
+        const char* name;
+        FakeDhcp::Config config;
+        bool cached;
+        uint32_t bound_ms;
+    };
+    const Case cases[] = {
+        {"no cached lease", {10, kCachedIp, false, 0}, false, 540},
+        {"cached, server ACKs", {10, kCachedIp, false, 0}, true, 21},
+        {"cached, server NAKs", {10, kOtherIp, false, 0}, true, 561},
+        {"cached, server silent", {10, kCachedIp, true, 0}, true, 3541},
+        {"no cache, 1 s ping before OFFER", {10, kCachedIp, false, 1000}, false, 1540},
+        {"cached, 1 s ping before OFFER", {10, kCachedIp, false, 1000}, true, 21},
+        {"no cached lease, rtt 100 ms", {50, kCachedIp, false, 0}, false, 700},
+        {"cached, server ACKs, rtt 100 ms", {50, kCachedIp, false, 0}, true, 101},
+    };
+    printf("%-36s %10s\n", "case", "bound");
+    for (const auto& c : cases) {
+        uint32_t bound_ip = 0;
+        uint32_t bound_ms = TimeToBoundMs(c.config, c.cached ? kCachedIp : 0, &bound_ip);
+        printf("%-36s %7u ms\n", c.name, (unsigned)bound_ms);
+        CHECK(bound_ms == c.bound_ms);
+        CHECK(bound_ip == c.config.lease_ip);
+    }
+}
+
+int main() {
+    TestSeedsOnlyWhileSelecting();
+    TimeToBoundTable();
+    printf("test_dhcp_reboot: ok\n");
+    return 0;
+}
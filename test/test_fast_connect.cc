@@ -0,0 +1,273 @@
+// FastConnect：记录匹配、锁定的 BSSID/信道/加密门限、时限与连续失败，以及用假驱动对比快速重连与扫描路径的开机到拿到 IP 的耗时
+#include "fast_connect.h"
+#include "test_util.h"
+
+#include <cstring>
+
+// 假驱动的时间模型：ESP-IDF 默认主动扫描每信道最多 120 ms，2.4 GHz 共 13 个信道
+static constexpr uint32_t kChannelScanMs = 120;
+static constexpr uint8_t kChannels = 13;
+// 认证、关联与四次握手
+static constexpr uint32_t kAssocMs = 150;
+// DISCOVER/OFFER/REQUEST/ACK
+static constexpr uint32_t kDhcpMs = 300;
+
+static const uint8_t kHomeAp[6] = {0x24, 0x0a, 0xc4, 0x00, 0x00, 0x01};
+static const uint8_t kNewAp[6] = {0x24, 0x0a, 0xc4, 0x00, 0x00, 0x02};
+
+struct FakeAp {
+    const uint8_t* bssid;
+    uint8_t channel;
+    wifi_auth_mode_t authmode;
+    bool responds;      // false 表示 AP 在但不回应认证，驱动一直重试直到被主动断开
+};
+
+struct ConnectResult {
+    const FakeAp* ap;   // 关联上的 AP，失败时为空
+    uint32_t elapsed_ms;
+    uint16_t reason;    // 失败时驱动报告的断开原因，0 表示一直没有结果
+};
+
+// 假驱动的 esp_wifi_connect：按 WIFI_FAST_SCAN 从 sta.channel 开始逐信道探测（0 表示从 1 开始），
+// 找到第一个符合 bssid_set 与加密门限的 AP 即关联；门限与驱动一样按枚举值比较
+static ConnectResult FakeConnect(const std::vector<FakeAp>& aps, const wifi_sta_config_t& sta) {
+    uint8_t order[kChannels + 1];
+    size_t count = 0;
+    if (sta.channel != 0) {
+        order[count++] = sta.channel;
+    }
+    for (uint8_t channel = 1; channel <= kChannels; channel++) {
+        if (channel != sta.channel) {
+            order[count++] = channel;
+        }
+    }
+
+    uint32_t elapsed = 0;
+    bool below_threshold = false;
+    for (size_t i = 0; i < count; i++) {
+        elapsed += kChannelScanMs;
+        for (const auto& ap : aps) {
+            if (ap.channel != order[i] || (sta.bssid_set && memcmp(ap.bssid, sta.bssid, 6) != 0)) {
+                continue;
+            }
+            if (ap.authmode < sta.threshold.authmode) {
+                below_threshold = true;
+                continue;
+            }
+            if (!ap.responds) {
+                return {nullptr, elapsed, 0};
+            }
+            return {&ap, elapsed + kAssocMs, 0};
+        }
+    }
+    return {nullptr, elapsed,
+        static_cast<uint16_t>(below_threshold ? WIFI_REASON_NO_AP_FOUND_IN_AUTHMODE_THRESHOLD : WIFI_REASON_NO_AP_FOUND)};
+}
+
+static LastApRecord RecordFor(const FakeAp& ap, uint8_t ssid_index, const char* ssid) {
+    LastApRecord record = {};
+    record.version = 1;
+    record.ssid_index = ssid_index;
+    record.channel = ap.channel;
+    record.authmode = ap.authmode;
+    memcpy(record.bssid, ap.bssid, 6);
+    strncpy(record.ssid, ssid, sizeof(record.ssid) - 1);
+    return record;
+}
+
+static void TestFindAndLock() {
+    std::vector<SsidItem> saved = {{"cafe", "cafe-pass", ""}, {"home", "home-pass", ""}};
+    FastConnect fast;
+    wifi_sta_config_t sta;
+    CHECK(fast.Begin(saved, 0, &sta) == -1);
+
+    FakeAp ap = {kHomeAp, 11, WIFI_AUTH_WPA2_WPA3_PSK, true};
+    fast.Load(RecordFor(ap, 1, "home"), 0);
+    CHECK(fast.FindSaved(saved) == 1);
+    // 列表顺序变化后按 SSID 查找
+    std::vector<SsidItem> reordered = {saved[1], saved[0]};
+    CHECK(fast.FindSaved(reordered) == 0);
+    std::vector<SsidItem> removed = {saved[0]};
+    CHECK(fast.Begin(removed, 0, &sta) == -1);
+    CHECK(!fast.InProgress());
+
+    CHECK(fast.Begin(saved, 1000, &sta) == 1);
+    CHECK(fast.state() == FastConnect::State::kActive);
+    CHECK(memcmp(sta.ssid, "home", 5) == 0);
+    CHECK(memcmp(sta.password, "home-pass", 10) == 0);
+    CHECK(sta.bssid_set);
+    CHECK(memcmp(sta.bssid, kHomeAp, 6) == 0);
+    CHECK(sta.channel == 11);
+    // 记录中的加密方式作为门限，混合模式取较弱的一种
+    CHECK(sta.threshold.authmode == WIFI_AUTH_WPA2_PSK);
+    CHECK(fast.deadline_ms() == 1000 + FastConnect::kTimeoutMs);
+
+    // 32 字节的 SSID 填满定长字段，不带结尾的 0
+    std::vector<SsidItem> long_ssid = {{std::string(32, 's'), "", ""}};
+    fast.Load(RecordFor(ap, 0, long_ssid[0].ssid.c_str()), 0);
+    CHECK(fast.Begin(long_ssid, 0, &sta) == 0);
+    CHECK(sta.ssid[31] == 's');
+
+    CHECK(AuthThresholdFor(WIFI_AUTH_OPEN) == WIFI_AUTH_OPEN);
+    CHECK(AuthThresholdFor(WIFI_AUTH_WPA_WPA2_PSK) == WIFI_AUTH_WPA_PSK);
+    CHECK(AuthThresholdFor(WIFI_AUTH_WPA3_PSK) == WIFI_AUTH_WPA3_PSK);
+    CHECK(AuthThresholdFor(WIFI_AUTH_WPA2_ENTERPRISE) == WIFI_AUTH_OPEN);
+}
+
+static void TestDeadlineAndFailures() {
+    std::vector<SsidItem> saved = {{"home", "home-pass", ""}};
+    FakeAp ap = {kHomeAp, 6, WIFI_AUTH_WPA2_PSK, true};
+    FastConnect fast;
+    fast.Load(RecordFor(ap, 0, "home"), 0);
+
+    CHECK(fast.Begin(saved, 100, nullptr) == 0);
+    CHECK(!fast.Expired(100 + FastConnect::kTimeoutMs - 1));
+    CHECK(fast.Expired(100 + FastConnect::kTimeoutMs));
+    CHECK(fast.OnTimeout());
+    // 超时后等待断开事件，不会重复触发
+    CHECK(!fast.OnTimeout());
+    CHECK(fast.state() == FastConnect::State::kAborting);
+    CHECK(!fast.OnFailed());
+    CHECK(fast.failures() == 1);
+    CHECK(!fast.InProgress());
+
+    // 被打断不计失败；关联成功清零
+    fast.Begin(saved, 0, nullptr);
+    fast.Cancel();
+    CHECK(fast.failures() == 1);
+    fast.Begin(saved, 0, nullptr);
+    CHECK(fast.OnAssociated());
+    CHECK(fast.failures() == 0);
+    CHECK(!fast.OnAssociated());
+
+    // 连续 kMaxFailures 次失败丢弃记录
+    for (uint8_t i = 1; i < FastConnect::kMaxFailures; i++) {
+        fast.Begin(saved, 0, nullptr);
+        CHECK(!fast.OnFailed());
+    }
+    fast.Begin(saved, 0, nullptr);
+    CHECK(fast.OnFailed());
+    CHECK(!fast.valid());
+    CHECK(fast.Begin(saved, 0, nullptr) == -1);
+
+    // 持久化的失败计数跨开机累计
+    fast.Load(RecordFor(ap, 0, "home"), FastConnect::kMaxFailures - 1);
+    fast.Begin(saved, 0, nullptr);
+    CHECK(fast.OnFailed());
+}
+
+// 与 WifiStation::SaveLastAp 相同：内容没有变化时不重写记录
+static void SaveLastAp(FastConnect& fast, const FakeAp& ap) {
+    LastApRecord record = RecordFor(ap, 0, "home");
+    if (!fast.valid() || memcmp(&record, &fast.record(), sizeof(record)) != 0) {
+        fast.Load(record, 0);
+    }
+}
+
+struct BootResult {
+    uint32_t to_ip_ms;
+    bool fast_path;     // 按记录直连成功
+    bool fell_back;     // 按记录直连失败后回退到扫描
+};
+
+// 从 STA_START 到拿到 IP，与 WifiStation 的 OnStaStart / OnFastConnectTimeout / OnDisconnected / OnGotIp 相同：
+// 有记录时先直连，时限内没有关联就主动断开，断开事件（或驱动报告失败）后回退到全信道扫描并按扫描结果连接，
+// 拿到 IP 后保存本次连接的 AP 作为下次的记录
+static BootResult BootToIp(FastConnect& fast, const std::vector<FakeAp>& aps, const std::vector<SsidItem>& saved) {
+    uint32_t now = 0;
+    bool fell_back = false;
+    wifi_sta_config_t sta;
+    if (fast.Begin(saved, now, &sta) >= 0) {
+        ConnectResult result = FakeConnect(aps, sta);
+        if (result.ap != nullptr && !fast.Expired(now + result.elapsed_ms)) {
+            now += result.elapsed_ms;
+            fast.OnAssociated();
+            SaveLastAp(fast, *result.ap);
+            return {now + kDhcpMs, true, false};
+        }
+        if (result.reason != 0 && !fast.Expired(now + result.elapsed_ms)) {
+            now += result.elapsed_ms;
+        } else {
+            now = fast.deadline_ms();
+            CHECK(fast.Expired(now));
+            CHECK(fast.OnTimeout());
+        }
+        fast.OnFailed();
+        fell_back = true;
+    }
+
+    now += kChannels * kChannelScanMs;
+    wifi_sta_config_t scan_sta = {};
+    ConnectResult result = FakeConnect(aps, scan_sta);
+    CHECK(result.ap != nullptr);
+    now += result.elapsed_ms + kDhcpMs;
+    SaveLastAp(fast, *result.ap);
+    return {now, false, fell_back};
+}
+
+static void BootToIpTable() {
+    std::vector<SsidItem> saved = {{"home", "home-pass", ""}};
+    const FakeAp home = {kHomeAp, 11, WIFI_AUTH_WPA2_PSK, true};
+    struct Case {
+        const char* name;
+        bool has_record;
+        std::vector<FakeAp> aps;
+        uint32_t to_ip_ms;
+        bool fast_path;
+    };
+    const Case cases[] = {
+        {"no record (scan path)", false, {home}, 3330, false},
+        {"record valid (fast path)", true, {home}, 570, true},
+        {"AP moved to channel 3", true, {{kHomeAp, 3, WIFI_AUTH_WPA2_PSK, true}}, 930, true},
+        {"AP replaced, new BSSID", true, {{kNewAp, 11, WIFI_AUTH_WPA2_PSK, true}}, 4890, false},
+        {"AP downgraded to WPA", true, {{kHomeAp, 11, WIFI_AUTH_WPA_PSK, true}}, 4890, false},
+        {"AP silent, mesh node on ch 6", true,
+            {{kHomeAp, 11, WIFI_AUTH_WPA2_PSK, false}, {kNewAp, 6, WIFI_AUTH_WPA2_PSK, true}}, 7730, false},
+    };
+    printf("%-32s %10s  %s\n", "case", "to IP", "path");
+    for (const auto& c : cases) {
+        FastConnect fast;
+        if (c.has_record) {
+            fast.Load(RecordFor(home, 0, "home"), 0);
+        }
+        BootResult result = BootToIp(fast, c.aps, saved);
+        printf("%-32s %7u ms  %s\n", c.name, (unsigned)result.to_ip_ms,
+            result.fast_path ? "fast" : (result.fell_back ? "fast -> scan" : "scan"));
+        CHECK(result.to_ip_ms == c.to_ip_ms);
+        CHECK(result.fast_path == c.fast_path);
+        CHECK(result.fell_back == (c.has_record && !c.fast_path));
+    }
+}
+
+static void TestRecordFollowsAp() {
+    std::vector<SsidItem> saved = {{"home", "home-pass", ""}};
+    const FakeAp home = {kHomeAp, 11, WIFI_AUTH_WPA2_PSK, true};
+    std::vector<FakeAp> replaced = {{kNewAp, 11, WIFI_AUTH_WPA2_PSK, true}};
+    FastConnect fast;
+    fast.Load(RecordFor(home, 0, "home"), 0);
+
+    // 回退扫描连上新的 AP 后记录随之更新，下次开机重新走快速路径
+    BootResult first = BootToIp(fast, replaced, saved);
+    CHECK(first.fell_back);
+    CHECK(memcmp(fast.record().bssid, kNewAp, 6) == 0);
+    CHECK(fast.failures() == 0);
+    BootResult second = BootToIp(fast, replaced, saved);
+    CHECK(second.fast_path);
+    CHECK(second.to_ip_ms == 570);
+
+    // 之前累计的失败在一次成功的快速重连后清零
+    FastConnect recovering;
+    recovering.Load(RecordFor(home, 0, "home"), FastConnect::kMaxFailures - 1);
+    BootResult last = BootToIp(recovering, {home}, saved);
+    CHECK(last.fast_path);
+    CHECK(recovering.failures() == 0);
+}
+
+int main() {
+    TestFindAndLock();
+    TestDeadlineAndFailures();
+    BootToIpTable();
+    TestRecordFollowsAp();
+    printf("test_fast_connect: ok\n");
+    return 0;
+}
@@ -0,0 +1,254 @@
+// HiddenProbeScheduler：探测批次的大小与优先级、未知网络的轮换、可见网络在连续漏扫后重新参与探测，
+// 以及用假驱动对比改造前（显示隐藏 SSID、按 BSSID 匹配）与定向探测发现隐藏网络的耗时
+#include "hidden_probe.h"
+#include "scan_planner.h"
+#include "test_util.h"
+
+#include <vector>
+
+using Visibility = HiddenProbeScheduler::Visibility;
+
+static bool Contains(const uint8_t* indexes, size_t count, uint8_t value) {
+    for (size_t i = 0; i < count; i++) {
+        if (indexes[i] == value) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void TestBatchPriorityAndRotation() {
+    HiddenProbeScheduler scheduler;
+    const uint32_t saved[5] = {11, 22, 33, 44, 55};
+    uint8_t batch[HiddenProbeScheduler::kBatchSize];
+
+    // 全部未知时按游标轮换，每轮最多 kBatchSize 个，几轮之内覆盖所有网络
+    bool probed[5] = {};
+    for (int round = 0; round < 3; round++) {
+        size_t count = scheduler.BuildBatch(saved, 5, batch);
+        CHECK(count == HiddenProbeScheduler::kBatchSize);
+        for (size_t i = 0; i < count; i++) {
+            probed[batch[i]] = true;
+        }
+    }
+    for (bool p : probed) {
+        CHECK(p);
+    }
+
+    // 可见网络不再探测，已确认隐藏的网络每轮都在批次里
+    scheduler.MarkVisible(11);
+    scheduler.MarkVisible(22);
+    scheduler.MarkHidden(55);
+    bool unknown_probed[5] = {};
+    for (int round = 0; round < 4; round++) {
+        size_t count = scheduler.BuildBatch(saved, 5, batch);
+        CHECK(count == 2);
+        CHECK(batch[0] == 4);
+        CHECK(!Contains(batch, count, 0));
+        CHECK(!Contains(batch, count, 1));
+        unknown_probed[batch[1]] = true;
+    }
+    CHECK(unknown_probed[2] && unknown_probed[3]);
+
+    // 全部可见时没有需要探测的
+    scheduler.Clear();
+    for (uint32_t hash : saved) {
+        scheduler.MarkVisible(hash);
+    }
+    CHECK(scheduler.BuildBatch(saved, 5, batch) == 0);
+    CHECK(scheduler.BuildBatch(saved, 0, batch) == 0);
+}
+
+static void TestVisibleExpiresAfterMissedScans() {
+    HiddenProbeScheduler scheduler;
+    scheduler.MarkVisible(7);
+    scheduler.MarkVisible(8);
+    scheduler.EndBroadcastScan();
+
+    // 8 每次都出现；7 之后不再出现，第 kMaxMissedScans 次漏扫时回到未知
+    for (uint8_t miss = 1; miss <= HiddenProbeScheduler::kMaxMissedScans; miss++) {
+        CHECK(scheduler.GetVisibility(7) == Visibility::kVisible);
+        scheduler.MarkVisible(8);
+        scheduler.EndBroadcastScan();
+    }
+    CHECK(scheduler.GetVisibility(7) == Visibility::kUnknown);
+    CHECK(scheduler.GetVisibility(8) == Visibility::kVisible);
+
+    const uint32_t saved[2] = {7, 8};
+    uint8_t batch[HiddenProbeScheduler::kBatchSize];
+    CHECK(scheduler.BuildBatch(saved, 2, batch) == 1);
+    CHECK(batch[0] == 0);
+
+    // 中途再次出现会清零漏扫计数
+    scheduler.MarkVisible(7);
+    scheduler.EndBroadcastScan();
+    scheduler.EndBroadcastScan();
+    scheduler.MarkVisible(7);
+    scheduler.EndBroadcastScan();
+    scheduler.EndBroadcastScan();
+    scheduler.EndBroadcastScan();
+    CHECK(scheduler.GetVisibility(7) == Visibility::kVisible);
+
+    // 隐藏网络不受普通扫描漏扫影响
+    scheduler.MarkHidden(9);
+    for (int i = 0; i < 10; i++) {
+        scheduler.EndBroadcastScan();
+    }
+    CHECK(scheduler.GetVisibility(9) == Visibility::kHidden);
+}
+
+static void TestFullTableKeepsHidden() {
+    HiddenProbeScheduler scheduler;
+    scheduler.MarkHidden(1000);
+    for (uint32_t hash = 1; hash < HiddenProbeScheduler::kMaxNetworks; hash++) {
+        scheduler.MarkVisible(hash);
+    }
+    // 表满后新网络复用可见网络的槽位，已确认的隐藏网络保留
+    scheduler.MarkHidden(2000);
+    CHECK(scheduler.GetVisibility(1000) == Visibility::kHidden);
+    CHECK(scheduler.GetVisibility(2000) == Visibility::kHidden);
+}
+
+static void TestHintHidden() {
+    HiddenProbeScheduler scheduler;
+    scheduler.HintHidden(1);
+    CHECK(scheduler.GetVisibility(1) == Visibility::kHidden);
+    // 普通扫描见到后改为可见，之后的提示不再改变状态
+    scheduler.MarkVisible(1);
+    scheduler.HintHidden(1);
+    CHECK(scheduler.GetVisibility(1) == Visibility::kVisible);
+}
+
+// 假驱动的时间模型：全信道扫描每信道 120 ms（ESP-IDF 默认），定向扫描按规划的驻留时间
+static constexpr uint32_t kChannelScanMs = 120;
+static constexpr uint32_t kChannels = 13;
+// 重新扫描退避的第一级上限
+static constexpr uint32_t kRescanMs = 10 * 1000;
+static constexpr uint32_t kHorizonMs = 5 * 60 * 1000;
+static constexpr uint32_t kNever = UINT32_MAX;
+
+struct SavedNetwork {
+    uint32_t hash;
+    bool bssid_saved;   // 保存时配置了 BSSID
+};
+
+struct HiddenAp {
+    size_t saved_index;
+    uint8_t channel;
+};
+
+static uint32_t ScanMs(const ScanPlan& plan) {
+    return plan.full ? kChannels * kChannelScanMs : plan.channel_count * plan.active_max_ms;
+}
+
+static bool Covers(const ScanPlan& plan, uint8_t channel) {
+    return plan.channel_count == 0 || (plan.channels_2g & (1u << channel));
+}
+
+// 改造前：每个周期一次显示隐藏 SSID 的全信道扫描，隐藏 AP 的 SSID 为空，只有保存了 BSSID 才能匹配
+static uint32_t DiscoverBaseline(const std::vector<SavedNetwork>& saved, const HiddenAp& ap) {
+    for (uint32_t now = 0; now < kHorizonMs; now += kRescanMs) {
+        now += kChannels * kChannelScanMs;
+        if (saved[ap.saved_index].bssid_saved) {
+            return now;
+        }
+    }
+    return kNever;
+}
+
+// 现在的流程，与 WifiStation::HandleScanResult / StartHiddenProbe 相同：按规划做普通扫描（不显示隐藏 SSID），
+// 定向扫描未命中时立即升级为全信道扫描；普通扫描没有找到保存网络时逐个定向探测本周期的批次，仍未找到就等待下一次扫描
+static uint32_t DiscoverWithProbes(ScanPlanner& planner, HiddenProbeScheduler& scheduler,
+    const std::vector<SavedNetwork>& saved, const HiddenAp& ap) {
+    std::vector<uint32_t> hashes;
+    for (const auto& network : saved) {
+        hashes.push_back(network.hash);
+    }
+    uint32_t now = 0;
+    while (now < kHorizonMs) {
+        ScanPlan plan = planner.Next(hashes.data(), hashes.size());
+        now += ScanMs(plan);
+        planner.BeginRound();
+        scheduler.EndBroadcastScan();
+        if (planner.OnScanDone(false)) {
+            continue;
+        }
+
+        for (const auto& network : saved) {
+            if (network.bssid_saved) {
+                scheduler.HintHidden(network.hash);
+            }
+        }
+        uint8_t batch[HiddenProbeScheduler::kBatchSize];
+        size_t count = scheduler.BuildBatch(hashes.data(), hashes.size(), batch);
+        for (size_t i = 0; i < count; i++) {
+            uint32_t hash = hashes[batch[i]];
+            ScanPlan probe = planner.PlanFor(&hash, 1);
+            now += ScanMs(probe);
+            if (batch[i] == ap.saved_index && Covers(probe, ap.channel)) {
+                planner.RecordSeen(hash, ap.channel);
+                scheduler.MarkHidden(hash);
+                return now;
+            }
+        }
+        now += kRescanMs;
+    }
+    return kNever;
+}
+
+static void PrintMs(uint32_t ms) {
+    if (ms == kNever) {
+        printf(" %10s", "never");
+    } else {
+        printf(" %7u ms", (unsigned)ms);
+    }
+}
+
+// 6 个保存网络，只有最后一个在附近且是隐藏网络；"again" 为发现之后掉线重连时再次找到它的耗时
+static void DiscoveryTimeTable() {
+    struct Case {
+        const char* name;
+        bool bssid_saved;
+        uint32_t baseline_ms;
+        uint32_t first_ms;
+        uint32_t again_ms;
+    };
+    const Case cases[] = {
+        // 配置了 BSSID 的网络第一个周期就被探测：普通扫描 + 一次全信道定向扫描
+        {"hidden, BSSID saved", true, 1560, 3120, 1760},
+        // 未知网络每周期轮换 kBatchSize 个，第三个周期才轮到
+        {"hidden, no BSSID saved", false, kNever, 34040, 1760},
+    };
+    printf("%-24s %10s %10s %10s\n", "case", "baseline", "first", "again");
+    for (const auto& c : cases) {
+        std::vector<SavedNetwork> saved;
+        for (uint32_t i = 0; i < 6; i++) {
+            saved.push_back({0x1000 + i, i == 5 && c.bssid_saved});
+        }
+        HiddenAp ap = {5, 6};
+        ScanPlanner planner;
+        HiddenProbeScheduler scheduler;
+        uint32_t baseline = DiscoverBaseline(saved, ap);
+        uint32_t first = DiscoverWithProbes(planner, scheduler, saved, ap);
+        // 再次连接：已知信道的定向扫描未命中后升级为全信道扫描，隐藏网络排在探测批次的最前面，只探测已知信道
+        uint32_t again = DiscoverWithProbes(planner, scheduler, saved, ap);
+        printf("%-24s", c.name);
+        PrintMs(baseline);
+        PrintMs(first);
+        PrintMs(again);
+        printf("\n");
+        CHECK(baseline == c.baseline_ms);
+        CHECK(first == c.first_ms);
+        CHECK(again == c.again_ms);
+    }
+}
+
+int main() {
+    TestBatchPriorityAndRotation();
+    TestVisibleExpiresAfterMissedScans();
+    TestFullTableKeepsHidden();
+    TestHintHidden();
+    DiscoveryTimeTable();
+    printf("test_hidden_probe: ok\n");
+    return 0;
+}
@@ -0,0 +1,159 @@
+// LinkMetrics：汇总与重连耗时分位数（含环形缓冲区回绕），二进制格式的字段偏移、按整条截断，以及 JSON 输出
+#include "link_metrics.h"
+#include "test_util.h"
+
+#include <string>
+
+#include <esp_wifi_types_generic.h>
+
+static uint32_t GetU32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t GetU16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+// 先断开再清空（Clear 保留在线状态），然后：两个 RSSI 样本、一次连接失败、一次掉线后重连，结束时仍然在线
+static void Populate(LinkMetrics& metrics) {
+    metrics.OnDisconnected(WIFI_REASON_ASSOC_LEAVE, 0);
+    metrics.Clear();
+    metrics.OnRssi(-50);
+    metrics.OnRssi(-60);
+    metrics.OnDisconnected(WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT, 100);
+    metrics.OnConnected(1000);
+    metrics.OnConnected(1500);  // 续约后的重复 GOT_IP
+    metrics.OnDisconnected(WIFI_REASON_ASSOC_LEAVE, 6000);
+    metrics.OnDisconnected(WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT, 6500);
+    metrics.OnConnected(7200);
+}
+
+static void TestSummary() {
+    auto& metrics = LinkMetrics::GetInstance();
+    Populate(metrics);
+    LinkMetricsSummary summary = metrics.GetSummary(10000);
+    // alpha = 1/8：-50 + (-60 - -50) / 8
+    CHECK(summary.rssi_avg == -51);
+    CHECK(summary.rssi_min == -60);
+    CHECK(summary.rssi_max == -50);
+    CHECK(summary.rssi_samples == 2);
+    CHECK(summary.associations == 2);
+    CHECK(summary.disconnects == 3);
+    CHECK(summary.reconnects == 1);
+    CHECK(summary.uptime_current_ms == 2800);
+    CHECK(summary.uptime_last_ms == 5000);
+    CHECK(summary.uptime_avg_ms == 5000);
+    CHECK(summary.reconnect_p50_ms == 1200);
+    CHECK(summary.reconnect_max_ms == 1200);
+
+    uint8_t reasons[4];
+    uint16_t counts[4];
+    CHECK(metrics.GetReasons(reasons, counts, 4) == 2);
+    CHECK(reasons[0] == WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT && counts[0] == 2);
+    CHECK(reasons[1] == WIFI_REASON_ASSOC_LEAVE && counts[1] == 1);
+}
+
+static void TestReconnectRingWraps() {
+    auto& metrics = LinkMetrics::GetInstance();
+    metrics.OnDisconnected(WIFI_REASON_ASSOC_LEAVE, 0);
+    metrics.Clear();
+
+    // 先 8 次很慢的重连，再 kReconnectSamples 次 10..320 ms：慢的那几次已被覆盖
+    uint32_t now = 0;
+    metrics.OnConnected(now);
+    for (uint32_t i = 0; i < 8 + LinkMetrics::kReconnectSamples; i++) {
+        now += 1000;
+        metrics.OnDisconnected(WIFI_REASON_BEACON_TIMEOUT, now);
+        now += i < 8 ? 100000 : (i - 7) * 10;
+        metrics.OnConnected(now);
+    }
+    LinkMetricsSummary summary = metrics.GetSummary(now);
+    CHECK(summary.reconnects == 8 + LinkMetrics::kReconnectSamples);
+    CHECK(summary.reconnect_max_ms == 320);
+    // 第 (n - 1) * p / 100 小的样本
+    CHECK(summary.reconnect_p50_ms == 160);
+    CHECK(summary.reconnect_p90_ms == 280);
+}
+
+static void TestBinaryLayout() {
+    auto& metrics = LinkMetrics::GetInstance();
+    Populate(metrics);
+
+    uint8_t out[256];
+    size_t size = metrics.GetBinary(out, sizeof(out), 10000);
+    CHECK(size == LinkMetrics::kBinaryHeaderSize + 1 + 2 * 3);
+    CHECK(out[0] == LinkMetrics::kBinaryVersion);
+    CHECK((int8_t)out[1] == -51);
+    CHECK((int8_t)out[2] == -60);
+    CHECK((int8_t)out[3] == -50);
+    const uint32_t expected[] = {2, 2, 3, 1, 2800, 5000, 5000, 5000, 1200, 1200, 1200};
+    for (size_t i = 0; i < std::size(expected); i++) {
+        CHECK(GetU32(out + 4 + i * 4) == expected[i]);
+    }
+    // 固定部分正好 48 字节，之后是原因数
+    CHECK(4 + std::size(expected) * 4 == LinkMetrics::kBinaryHeaderSize);
+    const uint8_t* reasons = out + LinkMetrics::kBinaryHeaderSize;
+    CHECK(reasons[0] == 2);
+    CHECK(reasons[1] == WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT && GetU16(reasons + 2) == 2);
+    CHECK(reasons[4] == WIFI_REASON_ASSOC_LEAVE && GetU16(reasons + 5) == 1);
+}
+
+static void TestBinaryTruncation() {
+    auto& metrics = LinkMetrics::GetInstance();
+    Populate(metrics);
+    uint8_t out[256];
+
+    // 放不下固定部分和原因数
+    CHECK(metrics.GetBinary(out, LinkMetrics::kBinaryHeaderSize, 10000) == 0);
+    // 只放得下原因数
+    CHECK(metrics.GetBinary(out, LinkMetrics::kBinaryHeaderSize + 1, 10000) == LinkMetrics::kBinaryHeaderSize + 1);
+    CHECK(out[LinkMetrics::kBinaryHeaderSize] == 0);
+    // 差一个字节放不下第二条：只写次数最多的一条，不写半条
+    size_t size = metrics.GetBinary(out, LinkMetrics::kBinaryHeaderSize + 1 + 2 * 3 - 1, 10000);
+    CHECK(size == LinkMetrics::kBinaryHeaderSize + 1 + 3);
+    CHECK(out[LinkMetrics::kBinaryHeaderSize] == 1);
+    CHECK(out[LinkMetrics::kBinaryHeaderSize + 1] == WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT);
+
+    // 原因超过 32 种时只输出前 32 种；单个原因的次数在 65535 饱和
+    for (int reason = 100; reason < 140; reason++) {
+        metrics.OnDisconnected(reason, 20000);
+    }
+    for (int i = 0; i < 70000; i++) {
+        metrics.OnDisconnected(WIFI_REASON_ASSOC_LEAVE, 20000);
+    }
+    size = metrics.GetBinary(out, sizeof(out), 20000);
+    CHECK(size == LinkMetrics::kBinaryHeaderSize + 1 + 32 * 3);
+    CHECK(out[LinkMetrics::kBinaryHeaderSize] == 32);
+    CHECK(out[LinkMetrics::kBinaryHeaderSize + 1] == WIFI_REASON_ASSOC_LEAVE);
+    CHECK(GetU16(out + LinkMetrics::kBinaryHeaderSize + 2) == UINT16_MAX);
+    CHECK(GetU32(out + 12) == 3 + 40 + 70000);
+}
+
+static void TestJson() {
+    auto& metrics = LinkMetrics::GetInstance();
+    Populate(metrics);
+    std::string json = metrics.GetJson(10000);
+    CHECK(json ==
+        "{\"rssi\":{\"avg\":-51,\"min\":-60,\"max\":-50,\"samples\":2},"
+        "\"associations\":2,\"disconnects\":3,\"reconnects\":1,"
+        "\"uptime_ms\":{\"current\":2800,\"last\":5000,\"avg\":5000,\"max\":5000},"
+        "\"reconnect_ms\":{\"p50\":1200,\"p90\":1200,\"max\":1200},"
+        "\"reasons\":[{\"reason\":15,\"name\":\"4-way handshake timeout\",\"count\":2},"
+        "{\"reason\":8,\"name\":\"Association left\",\"count\":1}]}");
+
+    // 清空后保留在线状态，之后的掉线仍能算出持续时间
+    metrics.Clear();
+    CHECK(metrics.GetJson(10000).find("\"reasons\":[]") != std::string::npos);
+    metrics.OnDisconnected(WIFI_REASON_ASSOC_LEAVE, 12200);
+    CHECK(metrics.GetSummary(12200).uptime_last_ms == 5000);
+}
+
+int main() {
+    TestSummary();
+    TestReconnectRingWraps();
+    TestBinaryLayout();
+    TestBinaryTruncation();
+    TestJson();
+    printf("test_link_metrics: ok\n");
+    return 0;
+}
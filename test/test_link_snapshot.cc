@@ -0,0 +1,121 @@
+// LinkSnapshot：单线程读写，以及一个写线程与多个读线程并发时读到的副本总是一致的，
+// 所有线程绑在同一个 CPU 上时写入端会被抢占在中途，读取端必须让出 CPU 才能继续
+#include "link_snapshot.h"
+#include "test_util.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <freertos/task.h>
+
+static std::atomic<uint32_t> delays{0};
+
+// 替身：睡一个 tick，写入端得以继续
+extern "C" void vTaskDelay(TickType_t ticks) {
+    delays++;
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+// 所有字段都由 n 推出，读到混合了两次写入的副本时 Consistent 返回 false
+static LinkState StateOf(uint32_t n) {
+    LinkState state = {};
+    state.connected = n & 1;
+    state.rssi = -(int8_t)(n % 100);
+    state.channel = n % 14;
+    state.phy_mode = n % 7;
+    memset(state.bssid, n & 0xff, sizeof(state.bssid));
+    state.ip = n;
+    state.connected_since_ms = ~n;
+    state.updated_ms = n * 3;
+    return state;
+}
+
+static bool Consistent(const LinkState& state) {
+    LinkState expected = StateOf(state.ip);
+    return state.connected == expected.connected && state.rssi == expected.rssi && state.channel == expected.channel &&
+        state.phy_mode == expected.phy_mode && memcmp(state.bssid, expected.bssid, sizeof(state.bssid)) == 0 &&
+        state.connected_since_ms == expected.connected_since_ms && state.updated_ms == expected.updated_ms;
+}
+
+static void TestRoundTrip() {
+    LinkSnapshot snapshot;
+    LinkState empty = snapshot.Read();
+    CHECK(!empty.connected);
+    CHECK(empty.ip == 0);
+
+    snapshot.Write(StateOf(12345));
+    LinkState state = snapshot.Read();
+    CHECK(state.ip == 12345);
+    CHECK(Consistent(state));
+}
+
+static void PinToCpu0() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(0, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+// 写线程不停写入递增的状态，读线程检查每个副本的一致性且序号不后退
+static void Stress(const char* name, int readers, bool single_cpu) {
+    static LinkSnapshot snapshot;
+    snapshot.Write(StateOf(0));
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint32_t> writes{0};
+    delays = 0;
+
+    std::thread writer([&] {
+        if (single_cpu) {
+            PinToCpu0();
+        }
+        uint32_t n = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            snapshot.Write(StateOf(++n));
+        }
+        writes = n;
+    });
+    std::vector<std::thread> threads;
+    for (int i = 0; i < readers; i++) {
+        threads.emplace_back([&] {
+            if (single_cpu) {
+                PinToCpu0();
+            }
+            uint32_t last = 0;
+            uint64_t count = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                LinkState state = snapshot.Read();
+                CHECK(Consistent(state));
+                CHECK(state.ip >= last);
+                last = state.ip;
+                count++;
+            }
+            reads += count;
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    stop = true;
+    writer.join();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    printf("%-24s %u writes, %llu consistent reads, %u yields\n", name, (unsigned)writes.load(),
+        (unsigned long long)reads.load(), (unsigned)delays.load());
+    CHECK(writes > 0);
+    CHECK(reads > 0);
+}
+
+int main() {
+    TestRoundTrip();
+    Stress("1 writer, 3 readers", 3, false);
+    Stress("same cpu, 3 readers", 3, true);
+    printf("test_link_snapshot: ok\n");
+    return 0;
+}
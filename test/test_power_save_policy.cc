@@ -0,0 +1,164 @@
+// PowerSavePolicy：突发立即关闭省电、分阶段回落的迟滞，嵌套的低延迟窗口，以及各模式的停留时间统计
+#include "power_save_policy.h"
+#include "test_util.h"
+
+// 与 WifiStation 的采样周期一致
+static constexpr uint32_t kSampleMs = 1000;
+
+// 以 kSampleMs 为步长从 *now 推进到 until（含，允许回绕），每个周期 pps 个包，返回最后的模式
+static PowerSaveMode Run(PowerSavePolicy& policy, uint32_t* now, uint32_t until, uint32_t pps) {
+    PowerSaveMode mode = policy.GetMode();
+    while ((int32_t)(until - (*now + kSampleMs)) >= 0) {
+        *now += kSampleMs;
+        mode = policy.Update(*now, pps * kSampleMs / 1000);
+    }
+    return mode;
+}
+
+static void TestHysteresis() {
+    PowerSavePolicy policy;
+    PowerSaveConfig config;
+    policy.SetConfig(config);
+    uint32_t now = 0;
+    policy.Reset(PowerSaveMode::kMinModem, now);
+
+    // 刚开始没有流量：停在起始模式，不先切到 NONE
+    CHECK(Run(policy, &now, 1000, 0) == PowerSaveMode::kMinModem);
+    CHECK(policy.GetStats(now).switches == 0);
+    // 介于 idle_pps 与 busy_pps 之间：保持 MIN_MODEM
+    CHECK(Run(policy, &now, 5000, 5) == PowerSaveMode::kMinModem);
+
+    // 一个周期达到 busy_pps 就立即进入 NONE
+    CHECK(Run(policy, &now, 6000, config.busy_pps) == PowerSaveMode::kNone);
+    uint32_t last_busy = now;
+    // 突发结束后保持 none_hold_ms
+    CHECK(Run(policy, &now, last_busy + config.none_hold_ms - kSampleMs, 0) == PowerSaveMode::kNone);
+    CHECK(Run(policy, &now, last_busy + config.none_hold_ms, 0) == PowerSaveMode::kMinModem);
+
+    // 持续空闲 max_modem_idle_ms 后才进入 MAX_MODEM（最后一次活跃是突发那个周期）
+    CHECK(Run(policy, &now, last_busy + config.max_modem_idle_ms - kSampleMs, 0) == PowerSaveMode::kMinModem);
+    CHECK(Run(policy, &now, last_busy + config.max_modem_idle_ms, 0) == PowerSaveMode::kMaxModem);
+
+    // 空闲期间的少量流量（不超过 idle_pps）不打断 MAX_MODEM
+    CHECK(Run(policy, &now, now + 10 * kSampleMs, config.idle_pps) == PowerSaveMode::kMaxModem);
+    // 超过 idle_pps 但没到 busy_pps：直接回到 MIN_MODEM，不经过 NONE
+    CHECK(Run(policy, &now, now + kSampleMs, config.idle_pps + 1) == PowerSaveMode::kMinModem);
+    // MAX_MODEM 下的突发同样立即进入 NONE
+    Run(policy, &now, now + config.max_modem_idle_ms, 0);
+    CHECK(policy.GetMode() == PowerSaveMode::kMaxModem);
+    CHECK(Run(policy, &now, now + kSampleMs, config.busy_pps) == PowerSaveMode::kNone);
+
+    // 间隔不超过 none_hold_ms 的突发：一直停在 NONE，不来回切换
+    uint32_t switches = policy.GetStats(now).switches;
+    for (int i = 0; i < 20; i++) {
+        CHECK(Run(policy, &now, now + kSampleMs, 0) == PowerSaveMode::kNone);
+        CHECK(Run(policy, &now, now + kSampleMs, config.busy_pps) == PowerSaveMode::kNone);
+    }
+    CHECK(policy.GetStats(now).switches == switches);
+
+    // 从 NONE 开始时同样保持 none_hold_ms
+    PowerSavePolicy from_none;
+    from_none.SetConfig(config);
+    now = 0;
+    from_none.Reset(PowerSaveMode::kNone, now);
+    CHECK(Run(from_none, &now, config.none_hold_ms - kSampleMs, 0) == PowerSaveMode::kNone);
+    CHECK(Run(from_none, &now, config.none_hold_ms, 0) == PowerSaveMode::kMinModem);
+}
+
+static void TestNestedLatencyWindows() {
+    PowerSavePolicy policy;
+    PowerSaveConfig config;
+    policy.SetConfig(config);
+    uint32_t now = 0;
+    policy.Reset(PowerSaveMode::kMinModem, now);
+    Run(policy, &now, config.max_modem_idle_ms, 0);
+    CHECK(policy.GetMode() == PowerSaveMode::kMaxModem);
+
+    // 两层窗口：内层结束后外层仍然保持 NONE，无论空闲多久
+    CHECK(policy.BeginLatencyCritical(now) == PowerSaveMode::kNone);
+    CHECK(policy.BeginLatencyCritical(now) == PowerSaveMode::kNone);
+    Run(policy, &now, now + 5000, 0);
+    CHECK(policy.EndLatencyCritical(now) == PowerSaveMode::kNone);
+    CHECK(Run(policy, &now, now + 2 * config.max_modem_idle_ms, 0) == PowerSaveMode::kNone);
+
+    // 最外层结束视为一次突发：再保持 none_hold_ms 后回到 MIN_MODEM
+    uint32_t end = now;
+    CHECK(policy.EndLatencyCritical(now) == PowerSaveMode::kNone);
+    CHECK(Run(policy, &now, end + config.none_hold_ms - kSampleMs, 0) == PowerSaveMode::kNone);
+    CHECK(Run(policy, &now, end + config.none_hold_ms, 0) == PowerSaveMode::kMinModem);
+
+    // 多余的 End 不会下溢，之后的 Begin 仍然生效
+    policy.EndLatencyCritical(now);
+    CHECK(policy.BeginLatencyCritical(now) == PowerSaveMode::kNone);
+    CHECK(Run(policy, &now, now + 10 * kSampleMs, 0) == PowerSaveMode::kNone);
+    policy.EndLatencyCritical(now);
+    CHECK(Run(policy, &now, now + config.none_hold_ms, 0) == PowerSaveMode::kMinModem);
+
+    // Hold 到期自动结束；较短的 Hold 不会缩短已有的窗口
+    uint32_t hold = now;
+    CHECK(policy.HoldLatency(hold, 5000) == PowerSaveMode::kNone);
+    policy.HoldLatency(hold + 1000, 1000);
+    CHECK(Run(policy, &now, hold + 4000, 0) == PowerSaveMode::kNone);
+    CHECK(Run(policy, &now, hold + 5000, 0) == PowerSaveMode::kMinModem);
+
+    // Hold 与 Begin/End 叠加：End 之后 Hold 还没到期，继续保持
+    hold = now;
+    policy.BeginLatencyCritical(now);
+    policy.HoldLatency(now, 10000);
+    Run(policy, &now, hold + 1000, 0);
+    policy.EndLatencyCritical(now);
+    CHECK(Run(policy, &now, hold + 9000, 0) == PowerSaveMode::kNone);
+    CHECK(Run(policy, &now, hold + 10000, 0) == PowerSaveMode::kMinModem);
+
+    // 毫秒计数回绕时 Hold 照常计时
+    PowerSavePolicy wrap;
+    wrap.SetConfig(config);
+    now = 0xffffffffu - 2500;
+    wrap.Reset(PowerSaveMode::kMinModem, now);
+    hold = now;
+    wrap.HoldLatency(hold, 5000);
+    CHECK(Run(wrap, &now, hold + 4000, 0) == PowerSaveMode::kNone);
+    CHECK(Run(wrap, &now, hold + 5000, 0) == PowerSaveMode::kMinModem);
+}
+
+static void TestResidency() {
+    PowerSavePolicy policy;
+    PowerSaveConfig config;
+    policy.SetConfig(config);
+    uint32_t now = 1000;
+    policy.Reset(PowerSaveMode::kMinModem, now);
+
+    // MIN_MODEM 10 s，NONE（突发 3 s + 保持 2 s），MIN_MODEM 到空闲满 30 s，然后 MAX_MODEM 60 s
+    Run(policy, &now, 11000, 5);
+    Run(policy, &now, 14000, 50);
+    Run(policy, &now, 16000, 0);
+    CHECK(policy.GetMode() == PowerSaveMode::kMinModem);
+    Run(policy, &now, 14000 + config.max_modem_idle_ms, 0);
+    CHECK(policy.GetMode() == PowerSaveMode::kMaxModem);
+    Run(policy, &now, now + 60000, 0);
+    policy.HoldLatency(now, 3000);
+
+    PowerSaveStats stats = policy.GetStats(now + 500);
+    // 10 s 之后第一个突发周期（11 s -> 12 s）结束时切到 NONE
+    CHECK(stats.residency_ms[(size_t)PowerSaveMode::kMinModem] == (12000 - 1000) + (14000 + 30000 - 16000));
+    CHECK(stats.residency_ms[(size_t)PowerSaveMode::kNone] == (16000 - 12000) + 500);
+    CHECK(stats.residency_ms[(size_t)PowerSaveMode::kMaxModem] == 60000);
+    uint32_t total = 0;
+    for (uint32_t ms : stats.residency_ms) {
+        total += ms;
+    }
+    CHECK(total == now + 500 - 1000);
+    // MIN -> NONE -> MIN -> MAX -> NONE
+    CHECK(stats.switches == 4);
+    CHECK(stats.latency_windows == 1);
+    // GetStats 不修改状态，多次调用结果一致
+    CHECK(policy.GetStats(now + 500).residency_ms[(size_t)PowerSaveMode::kNone] == stats.residency_ms[(size_t)PowerSaveMode::kNone]);
+}
+
+int main() {
+    TestHysteresis();
+    TestNestedLatencyWindows();
+    TestResidency();
+    printf("test_power_save_policy: ok\n");
+    return 0;
+}
@@ -0,0 +1,203 @@
+// ReachabilityProbe：状态行解析，对本机回环服务器的检查（204、302、连接被拒、DNS 失败、超时），
+// 后台任务的回调，以及 DemotionList 的到期与替换
+#include "reachability_probe.h"
+#include "test_util.h"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+#include <esp_timer.h>
+#include <freertos/task.h>
+
+extern "C" int64_t esp_timer_get_time(void) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 任务用分离的线程代替，任务函数返回即线程结束
+extern "C" BaseType_t xTaskCreate(TaskFunction_t task, const char* name, uint32_t stack_depth, void* parameters,
+    UBaseType_t priority, TaskHandle_t* created_task) {
+    std::thread(task, parameters).detach();
+    return pdPASS;
+}
+
+extern "C" void vTaskDelete(TaskHandle_t task) {
+}
+
+// 在回环地址上接受一个连接，读取请求后回复 response；response 为空时不回复，hold_ms 后关闭
+static uint16_t ServeOnce(const char* response, int hold_ms = 0) {
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    CHECK(server >= 0);
+    int one = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK(bind(server, (sockaddr*)&addr, sizeof(addr)) == 0);
+    CHECK(listen(server, 1) == 0);
+    socklen_t length = sizeof(addr);
+    getsockname(server, (sockaddr*)&addr, &length);
+
+    std::thread([server, response, hold_ms] {
+        int client = accept(server, nullptr, nullptr);
+        char request[256];
+        recv(client, request, sizeof(request), 0);
+        if (response != nullptr) {
+            send(client, response, strlen(response), 0);
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(hold_ms));
+        }
+        close(client);
+        close(server);
+    }).detach();
+    return ntohs(addr.sin_port);
+}
+
+// 找一个当前没有监听的端口：绑定后不 listen 直接关闭
+static uint16_t UnusedPort() {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(sock, (sockaddr*)&addr, sizeof(addr));
+    socklen_t length = sizeof(addr);
+    getsockname(sock, (sockaddr*)&addr, &length);
+    close(sock);
+    return ntohs(addr.sin_port);
+}
+
+static ReachabilityConfig LoopbackConfig(uint16_t port) {
+    ReachabilityConfig config;
+    strcpy(config.host, "127.0.0.1");
+    config.port = port;
+    config.timeout_ms = 2000;
+    return config;
+}
+
+static int Parse(const char* line) {
+    return ReachabilityProbe::ParseHttpStatus(line, strlen(line));
+}
+
+static void TestParseHttpStatus() {
+    CHECK(Parse("HTTP/1.1 204 No Content\r\n") == 204);
+    CHECK(Parse("HTTP/1.0 302 Found\r\n") == 302);
+    // 没有原因短语
+    CHECK(Parse("HTTP/1.1 200") == 200);
+    CHECK(Parse("HTTX/1.1 204 No Content") == -1);
+    CHECK(Parse("HTTP/2 204 No Content") == -1);
+    CHECK(Parse("HTTP/1.1  204") == -1);
+    CHECK(Parse("HTTP/1.1 2x4 Bad") == -1);
+    CHECK(Parse("HTTP/1.1 20") == -1);
+    CHECK(Parse("") == -1);
+    // 只看给定的长度
+    CHECK(ReachabilityProbe::ParseHttpStatus("HTTP/1.1 204", 11) == -1);
+}
+
+static void TestCheckAgainstLoopback() {
+    auto config = LoopbackConfig(ServeOnce("HTTP/1.1 204 No Content\r\n\r\n"));
+    CHECK(ReachabilityProbe::Check(config) == Reachability::kReachable);
+
+    // 强制门户通常回 302 或 200 登录页
+    config = LoopbackConfig(ServeOnce("HTTP/1.1 302 Found\r\nLocation: http://portal/\r\n\r\n"));
+    CHECK(ReachabilityProbe::Check(config) == Reachability::kHttpFailed);
+    config = LoopbackConfig(ServeOnce("HTTP/1.1 200 OK\r\n\r\n"));
+    CHECK(ReachabilityProbe::Check(config) == Reachability::kHttpFailed);
+    config = LoopbackConfig(ServeOnce("HTTP/1.1 200 OK\r\n\r\n"));
+    config.expect_status = 0;
+    CHECK(ReachabilityProbe::Check(config) == Reachability::kReachable);
+    config = LoopbackConfig(ServeOnce("garbage\r\n"));
+    CHECK(ReachabilityProbe::Check(config) == Reachability::kHttpFailed);
+
+    // 只检查 TCP 连接
+    config = LoopbackConfig(ServeOnce(nullptr));
+    config.path[0] = '\0';
+    CHECK(ReachabilityProbe::Check(config) == Reachability::kReachable);
+
+    config = LoopbackConfig(UnusedPort());
+    CHECK(ReachabilityProbe::Check(config) == Reachability::kConnectFailed);
+
+    // .invalid 保证解析失败（RFC 2606）
+    config = LoopbackConfig(80);
+    strcpy(config.host, "reachability-test.invalid");
+    CHECK(ReachabilityProbe::Check(config) == Reachability::kDnsFailed);
+
+    // 连接成功但一直不回复，总时限用完
+    config = LoopbackConfig(ServeOnce(nullptr, 1000));
+    config.timeout_ms = 300;
+    int64_t start_us = esp_timer_get_time();
+    CHECK(ReachabilityProbe::Check(config) == Reachability::kTimeout);
+    CHECK(esp_timer_get_time() - start_us < 900 * 1000);
+}
+
+struct ProbeResult {
+    std::atomic<bool> done{false};
+    uint32_t generation = 0;
+    Reachability result = Reachability::kUnknown;
+};
+
+static void OnProbeDone(void* arg, uint32_t generation, Reachability result, uint32_t elapsed_ms) {
+    auto* probe_result = static_cast<ProbeResult*>(arg);
+    probe_result->generation = generation;
+    probe_result->result = result;
+    probe_result->done = true;
+}
+
+static void TestStartRunsInBackground() {
+    ReachabilityProbe probe;
+    ProbeResult result;
+    auto config = LoopbackConfig(ServeOnce(nullptr, 200));
+    CHECK(probe.Start(config, 7, OnProbeDone, &result));
+    // 同一时间只允许一个检查
+    CHECK(probe.Busy());
+    CHECK(!probe.Start(config, 8, OnProbeDone, &result));
+    for (int i = 0; i < 300 && !result.done; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    CHECK(result.done);
+    CHECK(result.generation == 7);
+    CHECK(result.result == Reachability::kHttpFailed);
+    CHECK(!probe.Busy());
+}
+
+static void TestDemotionList() {
+    DemotionList list;
+    CHECK(!list.IsDemoted(1, 0));
+    list.Demote(1, 1000);
+    CHECK(list.IsDemoted(1, 999));
+    CHECK(!list.IsDemoted(1, 1000));
+    // 再次降级延长到期时间
+    list.Demote(1, 5000);
+    CHECK(list.IsDemoted(1, 2000));
+
+    // 已满时替换最早到期的记录
+    list.Clear();
+    for (uint32_t i = 0; i < DemotionList::kCapacity + 2; i++) {
+        list.Demote(i, 1000 + i);
+    }
+    CHECK(!list.IsDemoted(0, 0));
+    CHECK(!list.IsDemoted(1, 0));
+    for (uint32_t i = 2; i < DemotionList::kCapacity + 2; i++) {
+        CHECK(list.IsDemoted(i, 0));
+    }
+
+    // 毫秒计数回绕
+    list.Clear();
+    list.Demote(2, 100);
+    CHECK(list.IsDemoted(2, 0xffffff00u));
+}
+
+int main() {
+    TestParseHttpStatus();
+    TestCheckAgainstLoopback();
+    TestStartRunsInBackground();
+    TestDemotionList();
+    CHECK(strcmp(ReachabilityName(Reachability::kHttpFailed), "http_failed") == 0);
+    printf("test_reachability_probe: ok\n");
+    return 0;
+}
@@ -0,0 +1,156 @@
+// ScanArena：按 RSSI 排序的下标与 SSID 视图、超出容量的截断，以及稳态下处理一次扫描结果的堆分配次数
+#include "scan_arena.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <esp_wifi.h>
+
+// 统计全局 operator new 的调用次数
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+// 假驱动：返回 fake_ap_count 个 AP，SSID 长度超过 std::string 的短字符串优化
+static uint16_t fake_ap_count = 0;
+
+static void FillFakeRecord(wifi_ap_record_t* record, uint16_t i) {
+    memset(record, 0, sizeof(*record));
+    snprintf((char*)record->ssid, sizeof(record->ssid), "neighbor-network-%02u", (unsigned)i);
+    record->bssid[5] = i;
+    record->rssi = -30 - (i * 7) % 60;
+    record->primary = 1 + i % 11;
+}
+
+extern "C" esp_err_t esp_wifi_scan_get_ap_num(uint16_t* number) {
+    *number = fake_ap_count;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_wifi_scan_get_ap_records(uint16_t* number, wifi_ap_record_t* ap_records) {
+    uint16_t count = std::min(*number, fake_ap_count);
+    for (uint16_t i = 0; i < count; i++) {
+        FillFakeRecord(&ap_records[i], i);
+    }
+    *number = count;
+    return ESP_OK;
+}
+
+static void TestCommitSortsByRssi() {
+    static ScanArena arena;
+    auto* records = arena.Records();
+    memset(records, 0, sizeof(wifi_ap_record_t) * 3);
+    strcpy((char*)records[0].ssid, "a");
+    records[0].rssi = -70;
+    strcpy((char*)records[1].ssid, "bb");
+    records[1].rssi = -40;
+    records[2].rssi = -50;
+    arena.Commit(3);
+
+    CHECK(arena.size() == 3);
+    CHECK(arena[0].rssi == -40);
+    CHECK(arena[1].rssi == -50);
+    CHECK(arena[2].rssi == -70);
+    auto ssids = arena.Ssids();
+    CHECK(ssids.size() == 3);
+    CHECK(ssids[0] == "bb");
+    CHECK(ssids[1].empty());
+    CHECK(ssids[2] == "a");
+
+    // 32 字节填满的 SSID，第 33 字节不是 0（驱动不保证清零）时也只取 32 字节
+    memset(records[0].ssid, 'x', ScanArena::kMaxSsidLength);
+    records[0].ssid[ScanArena::kMaxSsidLength] = 'y';
+    arena.Commit(1);
+    CHECK(arena.Ssids()[0].size() == 32);
+    CHECK(arena.Ssids()[0] == std::string(32, 'x'));
+
+    arena.Commit(0);
+    CHECK(arena.empty());
+}
+
+static void TestLoadTruncatesToCapacity() {
+    static ScanArena arena;
+    fake_ap_count = ScanArena::kCapacity + 10;
+    CHECK(arena.Load() == ScanArena::kCapacity);
+    CHECK(arena.dropped() == 10);
+    CHECK(arena.dropped_total() == 10);
+    for (size_t i = 1; i < arena.size(); i++) {
+        CHECK(arena[i - 1].rssi >= arena[i].rssi);
+    }
+
+    // 放得下时不计丢弃，累计值保留
+    fake_ap_count = ScanArena::kCapacity;
+    CHECK(arena.Load() == ScanArena::kCapacity);
+    CHECK(arena.dropped() == 0);
+    CHECK(arena.dropped_total() == 10);
+}
+
+// 改造前 HandleScanResult 的做法：每次扫描申请记录数组、整条记录排序，并为每个 SSID 构造 std::string
+static size_t BaselineScan() {
+    uint16_t ap_num = fake_ap_count;
+    auto* ap_records = new wifi_ap_record_t[ap_num];
+    esp_wifi_scan_get_ap_records(&ap_num, ap_records);
+    std::sort(ap_records, ap_records + ap_num, [](const wifi_ap_record_t& a, const wifi_ap_record_t& b) {
+        return a.rssi > b.rssi;
+    });
+    std::vector<std::string> all_ssids;
+    for (int i = 0; i < ap_num; i++) {
+        all_ssids.push_back((char*)ap_records[i].ssid);
+    }
+    delete[] ap_records;
+    return all_ssids.size();
+}
+
+static void TestSteadyStateDoesNotAllocate() {
+    static ScanArena arena;
+    fake_ap_count = 20;
+    arena.Load();
+
+    size_t before = allocations;
+    size_t visible = 0;
+    for (int scan = 0; scan < 100; scan++) {
+        arena.Load();
+        for (auto ssid : arena.Ssids()) {
+            visible += ssid.size();
+        }
+    }
+    size_t arena_allocations = allocations - before;
+
+    before = allocations;
+    for (int scan = 0; scan < 100; scan++) {
+        visible += BaselineScan();
+    }
+    size_t baseline_allocations = allocations - before;
+
+    printf("100 scans x 20 APs: arena %zu allocations, per-scan buffers %zu allocations\n",
+        arena_allocations, baseline_allocations);
+    CHECK(visible > 0);
+    CHECK(arena_allocations == 0);
+    CHECK(baseline_allocations > 0);
+}
+
+int main() {
+    TestCommitSortsByRssi();
+    TestLoadTruncatesToCapacity();
+    TestSteadyStateDoesNotAllocate();
+    printf("test_scan_arena: ok\n");
+    return 0;
+}
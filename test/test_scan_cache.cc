@@ -0,0 +1,126 @@
+// ScanCache：RSSI 平滑、第 kMaxMissedScans 次漏扫时删除、删除后保序，以及满载替换和随机输入下的不变量
+#include "scan_cache.h"
+#include "test_util.h"
+
+#include <cstring>
+#include <random>
+#include <set>
+
+static wifi_ap_record_t Record(int id, int rssi) {
+    wifi_ap_record_t record = {};
+    record.bssid[4] = id >> 8;
+    record.bssid[5] = id;
+    snprintf(reinterpret_cast<char*>(record.ssid), sizeof(record.ssid), "n%d", id / 2);
+    record.rssi = rssi;
+    return record;
+}
+
+static int IdOf(const wifi_ap_record_t& record) {
+    return record.bssid[5] | (record.bssid[4] << 8);
+}
+
+static void TestMergeAndExpire() {
+    static ScanCache cache;
+    const wifi_ap_record_t first[3] = {Record(1, -40), Record(2, -60), Record(3, -70)};
+    cache.Merge(first, 3, 100);
+    CHECK(cache.size() == 3);
+
+    const wifi_ap_record_t only_two[1] = {Record(2, -80)};
+    cache.Merge(only_two, 1, 200);
+    CHECK(cache.size() == 3);
+    // alpha = 1/4：-60 + (-80 - -60) / 4
+    CHECK(cache.Records()[1].rssi == -65);
+    CHECK(cache.Info(0).missed_scans == 1);
+    CHECK(cache.Info(1).missed_scans == 0);
+    CHECK(cache.Info(1).first_seen_ms == 100);
+    CHECK(cache.Info(1).last_seen_ms == 200);
+
+    cache.Merge(only_two, 1, 300);
+    CHECK(cache.size() == 3);
+    CHECK(cache.Info(0).missed_scans == 2);
+    // 第 kMaxMissedScans 次漏扫时删除
+    cache.Merge(only_two, 1, 400);
+    CHECK(cache.size() == 1);
+    CHECK(IdOf(cache.Records()[0]) == 2);
+
+    // 重新出现的排在已有记录之后，已有记录的位置不变
+    cache.Merge(first, 3, 500);
+    CHECK(cache.size() == 3);
+    CHECK(IdOf(cache.Records()[0]) == 2);
+    CHECK(IdOf(cache.Records()[1]) == 1);
+    CHECK(cache.Info(1).first_seen_ms == 500);
+
+    // 一次漏扫后再出现，计数清零
+    cache.Merge(only_two, 1, 600);
+    cache.Merge(first, 3, 700);
+    cache.Merge(only_two, 1, 800);
+    cache.Merge(only_two, 1, 900);
+    CHECK(cache.size() == 3);
+
+    cache.Clear();
+    CHECK(cache.size() == 0);
+}
+
+static void TestFullCacheKeepsStrongest() {
+    static ScanCache cache;
+    static wifi_ap_record_t records[ScanCache::kCapacity + 8];
+    for (size_t i = 0; i < ScanCache::kCapacity; i++) {
+        records[i] = Record(i, -50);
+    }
+    cache.Merge(records, ScanCache::kCapacity, 0);
+    CHECK(cache.size() == ScanCache::kCapacity);
+
+    // 本次都扫到时，更弱的新 BSSID 进不来，更强的替换最弱的
+    records[ScanCache::kCapacity] = Record(1000, -90);
+    records[ScanCache::kCapacity + 1] = Record(1001, -30);
+    records[0].rssi = -80;
+    cache.Merge(records, ScanCache::kCapacity + 2, 100);
+    CHECK(cache.size() == ScanCache::kCapacity);
+    std::set<int> ids;
+    for (const auto& record : cache.Records()) {
+        ids.insert(IdOf(record));
+    }
+    CHECK(ids.count(1001) == 1);
+    CHECK(ids.count(1000) == 0);
+    CHECK(ids.count(0) == 0);
+}
+
+static void TestRandomizedInvariants() {
+    static ScanCache cache;
+    std::mt19937 rng(1);
+    for (uint32_t scan = 0; scan < 3000; scan++) {
+        wifi_ap_record_t records[80];
+        std::set<int> in_scan;
+        size_t count = 0;
+        size_t n = rng() % 80;
+        for (size_t i = 0; i < n; i++) {
+            int id = rng() % 100;
+            if (!in_scan.insert(id).second) {
+                continue;
+            }
+            records[count++] = Record(id, -30 - (int)(rng() % 60));
+        }
+        cache.Merge(records, count, scan);
+
+        CHECK(cache.size() <= ScanCache::kCapacity);
+        std::set<int> cached;
+        for (size_t i = 0; i < cache.size(); i++) {
+            CHECK(cached.insert(IdOf(cache.Records()[i])).second);
+            CHECK(cache.Info(i).missed_scans < ScanCache::kMaxMissedScans);
+        }
+        // 放得下时本次扫到的都在缓存中
+        if (count <= ScanCache::kCapacity) {
+            for (int id : in_scan) {
+                CHECK(cached.count(id) == 1);
+            }
+        }
+    }
+}
+
+int main() {
+    TestMergeAndExpire();
+    TestFullCacheKeepsStrongest();
+    TestRandomizedInvariants();
+    printf("test_scan_cache: ok\n");
+    return 0;
+}
@@ -0,0 +1,99 @@
+// ScanDemand：扫描合并规则，以及按 WifiConnectionManager 的调用方式模拟一小时内发起的扫描次数
+#include "scan_demand.h"
+#include "test_util.h"
+
+// 与 WifiConnectionManager 一致
+static constexpr uint32_t kScanMinIntervalMs = 10 * 1000;
+static constexpr uint32_t kBackgroundScanMs = 5 * 60 * 1000;
+// 改造前的周期扫描间隔
+static constexpr uint32_t kOldScanIntervalMs = 10 * 1000;
+// 一次全信道扫描的耗时
+static constexpr uint32_t kScanDurationMs = 2000;
+static constexpr uint32_t kHourMs = 60 * 60 * 1000;
+
+static void TestCoalescing() {
+    ScanDemand demand(kScanMinIntervalMs);
+    CHECK(demand.Request(0));
+    demand.OnStarted();
+    CHECK(demand.InFlight());
+    // 进行中的扫描合并
+    CHECK(!demand.Request(500));
+    CHECK(demand.OnDone(true, 2000));
+    CHECK(!demand.InFlight());
+    // 距上次完整扫描不足最小间隔
+    CHECK(!demand.Request(11999));
+    CHECK(demand.Request(12000));
+    CHECK(demand.started() == 1);
+    CHECK(demand.coalesced() == 2);
+
+    // 不是自己发起的扫描不处理
+    CHECK(!demand.OnDone(true, 13000));
+    CHECK(demand.Request(13000));
+
+    // 不完整的扫描不算新鲜
+    demand.OnStarted();
+    CHECK(demand.OnDone(false, 14000));
+    CHECK(demand.Request(14001));
+
+    // 毫秒计数回绕
+    ScanDemand wrap(kScanMinIntervalMs);
+    wrap.OnStarted();
+    wrap.OnDone(true, 0xffffffffu - 1000);
+    CHECK(!wrap.Request(5000));
+    CHECK(wrap.Request(9000));
+}
+
+// 以 100 ms 为步长模拟一小时：client_poll_ms 为 0 表示没有配网客户端，否则客户端按该间隔请求列表。
+// 与 WifiConnectionManager 相同：STA 启动时请求一次，扫描完成后重新设置后台定时器
+static uint32_t SimulateScansPerHour(uint32_t client_poll_ms) {
+    constexpr uint32_t kStepMs = 100;
+    ScanDemand demand(kScanMinIntervalMs);
+    uint32_t done_at = 0;
+    uint32_t background_at = 0;
+
+    auto request = [&](uint32_t now) {
+        if (demand.Request(now)) {
+            demand.OnStarted();
+            done_at = now + kScanDurationMs;
+        }
+    };
+
+    request(0);
+    for (uint32_t now = kStepMs; now < kHourMs; now += kStepMs) {
+        if (demand.InFlight() && now >= done_at) {
+            CHECK(demand.OnDone(true, now));
+            background_at = now + kBackgroundScanMs;
+        }
+        if (!demand.InFlight() && now >= background_at) {
+            request(now);
+            if (!demand.InFlight()) {
+                background_at = now + kBackgroundScanMs;
+            }
+        }
+        if (client_poll_ms != 0 && now % client_poll_ms == 0) {
+            request(now);
+        }
+    }
+    return demand.started();
+}
+
+static void ScansPerHour() {
+    uint32_t before = kHourMs / kOldScanIntervalMs;
+    uint32_t idle = SimulateScansPerHour(0);
+    uint32_t polling = SimulateScansPerHour(2000);
+    printf("scans per hour (%u ms per scan): before %u, idle %u, client polling every 2 s %u\n",
+        (unsigned)kScanDurationMs, (unsigned)before, (unsigned)idle, (unsigned)polling);
+
+    CHECK(before == 360);
+    // 每次扫描完成后 5 分钟：3600 / 302 次
+    CHECK(idle == 12);
+    // 扫描 2 s + 最小间隔 10 s
+    CHECK(polling == 300);
+}
+
+int main() {
+    TestCoalescing();
+    ScansPerHour();
+    printf("test_scan_demand: ok\n");
+    return 0;
+}
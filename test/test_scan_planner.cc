@@ -0,0 +1,228 @@
+// ScanPlanner：按信道历史的定向扫描、未命中升级为全信道扫描、定期全信道扫描、国家码与容量限制，以及双频扫描与分频段耗时
+#include "scan_planner.h"
+#include "test_util.h"
+
+static constexpr uint32_t kHome = 0x1111;
+static constexpr uint32_t kOffice = 0x2222;
+
+static void TestNoHistoryScansAll() {
+    ScanPlanner planner;
+    const uint32_t saved[] = {kHome};
+    ScanPlan plan = planner.Next(saved, 1);
+    CHECK(plan.full);
+    CHECK(plan.bands == kScanBand2g);
+    CHECK(plan.channel_count == 0);
+    CHECK(plan.channels_2g == 0);
+    CHECK(plan.active_max_ms == 0);
+    // 全信道扫描未命中不再升级
+    CHECK(!planner.OnScanDone(false));
+}
+
+static void TestTargetedAndEscalation() {
+    ScanPlanner planner;
+    const uint32_t saved[] = {kHome, kOffice};
+    planner.BeginRound();
+    planner.RecordSeen(kHome, 6);
+    planner.RecordSeen(kOffice, 11);
+
+    ScanPlan plan = planner.Next(saved, 2);
+    CHECK(!plan.full);
+    CHECK(plan.bands == kScanBand2g);
+    CHECK(plan.channels_2g == ((1u << 6) | (1u << 11)));
+    CHECK(plan.channel_count == 2);
+    CHECK(plan.active_min_ms == ScanPlanner::kTargetedActiveMinMs);
+    CHECK(plan.active_max_ms == ScanPlanner::kTargetedActiveMaxMs);
+
+    // 命中时继续定向扫描；未命中时立即升级为一次全信道扫描，之后回到定向扫描
+    CHECK(!planner.OnScanDone(true));
+    CHECK(!planner.Next(saved, 2).full);
+    CHECK(planner.OnScanDone(false));
+    plan = planner.Next(saved, 2);
+    CHECK(plan.full);
+    CHECK(plan.channel_count == 0);
+    CHECK(!planner.OnScanDone(false));
+    CHECK(!planner.Next(saved, 2).full);
+
+    // 只规划指定的网络，不影响规划状态
+    ScanPlan only_home = planner.PlanFor(saved, 1);
+    CHECK(only_home.channels_2g == (1u << 6));
+    const uint32_t unknown[] = {0x3333};
+    CHECK(planner.PlanFor(unknown, 1).channel_count == 0);
+}
+
+static void TestPeriodicFullSweep() {
+    ScanPlanner planner;
+    const uint32_t saved[] = {kHome};
+    planner.BeginRound();
+    planner.RecordSeen(kHome, 1);
+    // 连续 kFullSweepInterval 次定向扫描都命中后做一次全信道扫描
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < ScanPlanner::kFullSweepInterval; i++) {
+            CHECK(!planner.Next(saved, 1).full);
+            planner.OnScanDone(true);
+        }
+        CHECK(planner.Next(saved, 1).full);
+        planner.OnScanDone(true);
+    }
+}
+
+static void TestChannelHistory() {
+    ScanPlanner planner;
+    const uint32_t saved[] = {kHome};
+
+    // 换了信道：最近的信道在前，上一次的作为备选
+    planner.BeginRound();
+    planner.RecordSeen(kHome, 1);
+    planner.BeginRound();
+    planner.RecordSeen(kHome, 6);
+    CHECK(planner.PlanFor(saved, 1).channels_2g == ((1u << 1) | (1u << 6)));
+    planner.BeginRound();
+    planner.RecordSeen(kHome, 11);
+    CHECK(planner.PlanFor(saved, 1).channels_2g == ((1u << 6) | (1u << 11)));
+
+    // 同一轮内多个 AP 按出现顺序保留，超过 kChannelsPerNetwork 的忽略
+    planner.BeginRound();
+    planner.RecordSeen(kHome, 3);
+    planner.RecordSeen(kHome, 3);
+    planner.RecordSeen(kHome, 8);
+    planner.RecordSeen(kHome, 13);
+    CHECK(planner.PlanFor(saved, 1).channels_2g == ((1u << 3) | (1u << 8)));
+
+    // 信道 0 不记录
+    planner.RecordSeen(kOffice, 0);
+    const uint32_t office[] = {kOffice};
+    CHECK(planner.PlanFor(office, 1).channel_count == 0);
+
+    planner.Clear();
+    CHECK(planner.PlanFor(saved, 1).channel_count == 0);
+}
+
+static void TestCountryAndCapacity() {
+    ScanPlanner planner;
+    const uint32_t saved[] = {kHome};
+    planner.BeginRound();
+    planner.RecordSeen(kHome, 13);
+    // 国家码只允许 1-11 时不扫描 13，没有可用历史就全信道扫描
+    planner.SetCountry(1, 11);
+    CHECK(planner.Next(saved, 1).full);
+    // 无效的国家码参数忽略
+    planner.SetCountry(0, 0);
+    CHECK(planner.PlanFor(saved, 1).channel_count == 0);
+    planner.SetCountry(1, 13);
+    CHECK(planner.PlanFor(saved, 1).channels_2g == (1u << 13));
+
+    // 超过 kMaxNetworks 时淘汰最久未出现的网络
+    ScanPlanner lru;
+    lru.BeginRound();
+    for (uint32_t i = 0; i <= ScanPlanner::kMaxNetworks; i++) {
+        lru.RecordSeen(0x100 + i, 1 + i % 13);
+    }
+    const uint32_t oldest[] = {0x100};
+    const uint32_t newest[] = {0x100 + ScanPlanner::kMaxNetworks};
+    CHECK(lru.PlanFor(oldest, 1).channel_count == 0);
+    CHECK(lru.PlanFor(newest, 1).channel_count == 1);
+}
+
+static void TestDualBandFullScans() {
+    ScanPlanner planner;
+    planner.SetDualBand(true);
+    const uint32_t saved[] = {kHome};
+
+    // 第一次以及每 kDualBandInterval 次全信道扫描覆盖两个频段，其余只给出 2.4 GHz 的位图
+    for (int i = 0; i < 2 * ScanPlanner::kDualBandInterval + 1; i++) {
+        ScanPlan plan = planner.Next(saved, 1);
+        CHECK(plan.full);
+        if (i % ScanPlanner::kDualBandInterval == 0) {
+            CHECK(plan.bands == kScanBandBoth);
+            CHECK(plan.channels_2g == 0 && plan.channels_5g == 0);
+        } else {
+            CHECK(plan.bands == kScanBand2g);
+            CHECK(plan.channels_2g == 0x3ffe);
+            CHECK(plan.channel_count == 13);
+            CHECK(plan.channels_5g == 0);
+        }
+        planner.OnScanDone(true);
+    }
+
+    // 只扫 2.4 GHz 时未命中，网络可能在 5 GHz：立即升级为双频全信道扫描
+    ScanPlan plan = planner.Next(saved, 1);
+    CHECK(plan.bands == kScanBand2g);
+    CHECK(planner.OnScanDone(false));
+    plan = planner.Next(saved, 1);
+    CHECK(plan.bands == kScanBandBoth);
+    CHECK(!planner.OnScanDone(false));
+
+    // 国家码限制 2.4 GHz 位图
+    ScanPlanner limited;
+    limited.SetDualBand(true);
+    limited.SetCountry(1, 11);
+    limited.Next(saved, 1);
+    limited.OnScanDone(true);
+    CHECK(limited.Next(saved, 1).channels_2g == 0x0ffe);
+}
+
+static void TestTargeted5g() {
+    CHECK(ScanPlanner::Channel5gBit(36) == 1);
+    CHECK(ScanPlanner::Channel5gBit(144) == 20);
+    CHECK(ScanPlanner::Channel5gBit(177) == 28);
+    CHECK(ScanPlanner::Channel5gBit(38) == -1);
+
+    ScanPlanner planner;
+    planner.SetDualBand(true);
+    const uint32_t saved[] = {kHome, kOffice};
+    planner.BeginRound();
+    planner.RecordSeen(kHome, 149);
+    planner.RecordSeen(kOffice, 6);
+    // 不在 wifi_5g_channel_bit_t 中的信道忽略
+    planner.RecordSeen(kOffice, 183);
+    ScanPlan plan = planner.Next(saved, 2);
+    CHECK(!plan.full);
+    CHECK(plan.bands == kScanBandBoth);
+    CHECK(plan.channels_5g == (1u << ScanPlanner::Channel5gBit(149)));
+    CHECK(plan.channels_2g == (1u << 6));
+    CHECK(plan.channel_count == 2);
+
+    const uint32_t home[] = {kHome};
+    CHECK(planner.PlanFor(home, 1).bands == kScanBand5g);
+    // 没有历史时按是否双频决定全信道扫描的频段
+    const uint32_t unknown[] = {0x3333};
+    CHECK(planner.PlanFor(unknown, 1).bands == kScanBandBoth);
+}
+
+static void TestBandStats() {
+    ScanPlanner planner;
+    planner.RecordScanTime(kScanBand2g, 1000, 12);
+    planner.RecordScanTime(kScanBand2g, 2000, 15);
+    planner.RecordScanTime(kScanBandBoth, 4000, 30);
+    // 无效的频段组合不记录
+    planner.RecordScanTime(0, 9999, 1);
+    planner.RecordScanTime(kScanBandBoth + 1, 9999, 1);
+
+    const auto& two = planner.GetBandStats(kScanBand2g);
+    CHECK(two.scans == 2);
+    CHECK(two.last_ms == 2000);
+    // alpha = 1/4：1000 + (2000 - 1000) / 4
+    CHECK(two.avg_ms == 1250);
+    CHECK(two.max_ms == 2000);
+    CHECK(two.last_aps == 15);
+    const auto& both = planner.GetBandStats(kScanBandBoth);
+    CHECK(both.scans == 1);
+    CHECK(both.avg_ms == 4000);
+    CHECK(planner.GetBandStats(kScanBand5g).scans == 0);
+
+    planner.RecordScanTime(kScanBand5g, 500, 100000);
+    CHECK(planner.GetBandStats(kScanBand5g).last_aps == UINT16_MAX);
+}
+
+int main() {
+    TestNoHistoryScansAll();
+    TestTargetedAndEscalation();
+    TestPeriodicFullSweep();
+    TestChannelHistory();
+    TestCountryAndCapacity();
+    TestDualBandFullScans();
+    TestTargeted5g();
+    TestBandStats();
+    printf("test_scan_planner: ok\n");
+    return 0;
+}
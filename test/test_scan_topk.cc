@@ -0,0 +1,120 @@
+// ScanTopK：按 SSID 去重、隐藏网络计数、前 k 项的顺序，并在随机输入上与排序 + std::map 去重的参考实现对照
+#include "scan_topk.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+static const char* SsidOf(const wifi_ap_record_t* records, const SsidGroup& group) {
+    return reinterpret_cast<const char*>(records[group.index].ssid);
+}
+
+static void TestMeshCollapses() {
+    wifi_ap_record_t records[10] = {};
+    auto set = [&](int i, const char* ssid, int rssi) {
+        strcpy(reinterpret_cast<char*>(records[i].ssid), ssid);
+        records[i].rssi = rssi;
+    };
+    set(0, "mesh", -70);
+    set(1, "mesh", -50);
+    set(2, "", -30);
+    set(3, "cafe", -60);
+    set(4, "mesh", -65);
+    set(5, "home", -40);
+    set(6, "", -45);
+    set(7, "guest", -80);
+    set(8, "cafe", -55);
+    set(9, "iot", -90);
+
+    ScanTopK topk;
+    CHECK(topk.Select(records, 10, 3) == 5);
+    CHECK(topk.hidden_count() == 2);
+    auto top = topk.Top();
+    CHECK(top.size() == 3);
+    CHECK(strcmp(SsidOf(records, top[0]), "home") == 0);
+    CHECK(top[0].bssid_count == 1);
+    CHECK(strcmp(SsidOf(records, top[1]), "mesh") == 0);
+    CHECK(top[1].rssi == -50);
+    CHECK(top[1].index == 1);
+    CHECK(top[1].bssid_count == 3);
+    CHECK(strcmp(SsidOf(records, top[2]), "cafe") == 0);
+    CHECK(top[2].rssi == -55);
+    CHECK(top[2].bssid_count == 2);
+    CHECK(topk.Groups().size() == 5);
+
+    // k 大于 SSID 数时全部排序
+    CHECK(topk.Select(records, 10, 100) == 5);
+    CHECK(topk.Top().size() == 5);
+    CHECK(strcmp(SsidOf(records, topk.Top()[4]), "iot") == 0);
+
+    // 32 字节填满、没有结尾 0 的 SSID 与前 31 字节相同的 SSID 不合并
+    wifi_ap_record_t full[2] = {};
+    memset(full[0].ssid, 'a', sizeof(full[0].ssid));
+    memset(full[1].ssid, 'a', sizeof(full[1].ssid) - 1);
+    CHECK(topk.Select(full, 2, 2) == 2);
+}
+
+static void TestAgainstReference() {
+    std::mt19937 rng(1);
+    for (int iteration = 0; iteration < 2000; iteration++) {
+        size_t count = rng() % 70;
+        std::vector<wifi_ap_record_t> records(count);
+        for (auto& record : records) {
+            memset(&record, 0, sizeof(record));
+            int id = rng() % 12;
+            if (id != 0) {
+                snprintf(reinterpret_cast<char*>(record.ssid), sizeof(record.ssid), "n%d", id);
+            }
+            record.rssi = -(int)(rng() % 60 + 30);
+        }
+        size_t k = rng() % 8;
+
+        ScanTopK topk;
+        size_t groups = topk.Select(records.data(), count, k);
+
+        // 参考实现：超过容量的记录同样忽略
+        std::map<std::string, std::pair<int, int>> reference;
+        size_t hidden = 0;
+        for (size_t i = 0; i < std::min(count, ScanTopK::kMaxRecords); i++) {
+            std::string ssid(reinterpret_cast<const char*>(records[i].ssid));
+            if (ssid.empty()) {
+                hidden++;
+                continue;
+            }
+            auto it = reference.find(ssid);
+            if (it == reference.end()) {
+                reference[ssid] = {records[i].rssi, 1};
+            } else {
+                it->second.first = std::max<int>(it->second.first, records[i].rssi);
+                it->second.second++;
+            }
+        }
+        CHECK(groups == reference.size());
+        CHECK(topk.hidden_count() == hidden);
+
+        std::vector<int> strongest;
+        for (const auto& [ssid, entry] : reference) {
+            strongest.push_back(entry.first);
+        }
+        std::sort(strongest.rbegin(), strongest.rend());
+        auto top = topk.Top();
+        CHECK(top.size() == std::min(k, reference.size()));
+        for (size_t i = 0; i < top.size(); i++) {
+            CHECK(top[i].rssi == strongest[i]);
+            const auto& entry = reference[SsidOf(records.data(), top[i])];
+            CHECK(entry.first == top[i].rssi);
+            CHECK(entry.second == top[i].bssid_count);
+        }
+    }
+}
+
+int main() {
+    TestMeshCollapses();
+    TestAgainstReference();
+    printf("test_scan_topk: ok\n");
+    return 0;
+}
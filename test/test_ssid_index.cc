@@ -0,0 +1,156 @@
+// SsidIndex：与原来的线性匹配逐条对照，并给出 100 个 AP × 10 个保存网络的匹配耗时
+#include "ssid_index.h"
+#include "ssid_manager.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <strings.h>
+#include <vector>
+
+#include <esp_wifi_types_generic.h>
+
+// 改造前 HandleScanResult 的匹配方式：每次扫描复制一次保存列表，每个 AP 格式化 BSSID 字符串后线性比较
+static int LinearMatch(const std::vector<SsidItem>& ssid_list, const wifi_ap_record_t& ap_record) {
+    char bssid_str[18];
+    sprintf(bssid_str, "%02x:%02x:%02x:%02x:%02x:%02x",
+        ap_record.bssid[0], ap_record.bssid[1], ap_record.bssid[2],
+        ap_record.bssid[3], ap_record.bssid[4], ap_record.bssid[5]);
+    auto it = std::find_if(ssid_list.begin(), ssid_list.end(), [&ap_record, &bssid_str](const SsidItem& item) {
+        if (strlen((char *)ap_record.ssid) > 0 && strcmp((char *)ap_record.ssid, item.ssid.c_str()) == 0) {
+            return true;
+        }
+        if (strlen((char *)ap_record.ssid) == 0 && !item.bssid.empty() &&
+            strcasecmp(bssid_str, item.bssid.c_str()) == 0) {
+            return true;
+        }
+        return false;
+    });
+    return it == ssid_list.end() ? SsidIndex::kNotFound : (int)(it - ssid_list.begin());
+}
+
+static void FormatBssid(const uint8_t* bssid, char* out, bool upper) {
+    sprintf(out, upper ? "%02X:%02X:%02X:%02X:%02X:%02X" : "%02x:%02x:%02x:%02x:%02x:%02x",
+        bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]);
+}
+
+static void TestBasicMatch() {
+    std::vector<SsidItem> saved = {
+        {"home", "pw", ""},
+        {"office", "pw", "AA:BB:CC:DD:EE:01"},
+        {"", "pw", ""},
+    };
+    SsidIndex index;
+    index.Build(saved);
+
+    wifi_ap_record_t ap = {};
+    strcpy((char*)ap.ssid, "office");
+    CHECK(index.Match(ap.ssid, ap.bssid) == 1);
+    strcpy((char*)ap.ssid, "offic");
+    CHECK(index.Match(ap.ssid, ap.bssid) == SsidIndex::kNotFound);
+
+    // 隐藏网络按 BSSID 匹配，大小写不敏感
+    uint8_t bssid[6] = {0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0x01};
+    memset(ap.ssid, 0, sizeof(ap.ssid));
+    memcpy(ap.bssid, bssid, 6);
+    CHECK(index.Match(ap.ssid, ap.bssid) == 1);
+    ap.bssid[5] = 0x02;
+    CHECK(index.Match(ap.ssid, ap.bssid) == SsidIndex::kNotFound);
+
+    uint64_t value = 0;
+    CHECK(SsidIndex::ParseBssid("aa:bb:cc:dd:ee:01", &value) && value == SsidIndex::BssidToU64(bssid));
+    CHECK(!SsidIndex::ParseBssid("aa:bb:cc:dd:ee", &value));
+    CHECK(!SsidIndex::ParseBssid("", &value));
+}
+
+static std::vector<SsidItem> MakeSaved(std::mt19937& rng) {
+    std::vector<SsidItem> saved;
+    for (int i = 0; i < 10; i++) {
+        char ssid[33];
+        snprintf(ssid, sizeof(ssid), "saved-network-%d", i);
+        std::string bssid;
+        if (i % 3 == 0) {
+            uint8_t mac[6] = {0x24, 0x0a, 0xc4, 0, 0, (uint8_t)i};
+            char text[18];
+            FormatBssid(mac, text, rng() % 2);
+            bssid = text;
+        }
+        saved.push_back({ssid, "password", bssid});
+    }
+    return saved;
+}
+
+// 办公环境：少数保存网络，大量不相关或隐藏的 AP
+static std::vector<wifi_ap_record_t> MakeScan(std::mt19937& rng, size_t count) {
+    std::vector<wifi_ap_record_t> scan(count);
+    for (auto& ap : scan) {
+        memset(&ap, 0, sizeof(ap));
+        int kind = rng() % 10;
+        uint8_t id = rng() % 12;
+        if (kind < 2) {
+            snprintf((char*)ap.ssid, sizeof(ap.ssid), "saved-network-%d", id);
+        } else if (kind < 4) {
+            // 隐藏网络，部分 BSSID 属于保存项
+            uint8_t mac[6] = {0x24, 0x0a, 0xc4, 0, 0, id};
+            memcpy(ap.bssid, mac, 6);
+            continue;
+        } else {
+            snprintf((char*)ap.ssid, sizeof(ap.ssid), "neighbor-%u", (unsigned)(rng() % 1000));
+        }
+        for (auto& byte : ap.bssid) {
+            byte = rng();
+        }
+    }
+    return scan;
+}
+
+static void TestAgainstLinearMatch() {
+    std::mt19937 rng(1);
+    for (int round = 0; round < 200; round++) {
+        auto saved = MakeSaved(rng);
+        SsidIndex index;
+        index.Build(saved);
+        for (const auto& ap : MakeScan(rng, 100)) {
+            CHECK(index.Match(ap.ssid, ap.bssid) == LinearMatch(saved, ap));
+        }
+    }
+}
+
+static void Benchmark() {
+    constexpr int kRounds = 2000;
+    std::mt19937 rng(2);
+    auto saved = MakeSaved(rng);
+    auto scan = MakeScan(rng, 100);
+    SsidIndex index;
+    index.Build(saved);
+
+    volatile int sink = 0;
+    long long start = NowNs();
+    for (int round = 0; round < kRounds; round++) {
+        auto ssid_list = saved;
+        for (const auto& ap : scan) {
+            sink = sink + LinearMatch(ssid_list, ap);
+        }
+    }
+    long long linear_ns = (NowNs() - start) / kRounds;
+
+    start = NowNs();
+    for (int round = 0; round < kRounds; round++) {
+        for (const auto& ap : scan) {
+            sink = sink + index.Match(ap.ssid, ap.bssid);
+        }
+    }
+    long long indexed_ns = (NowNs() - start) / kRounds;
+
+    printf("100 APs x 10 saved: linear %lld ns/scan, indexed %lld ns/scan (%.1fx)\n",
+        linear_ns, indexed_ns, indexed_ns > 0 ? (double)linear_ns / indexed_ns : 0.0);
+}
+
+int main() {
+    TestBasicMatch();
+    TestAgainstLinearMatch();
+    Benchmark();
+    printf("test_ssid_index: ok\n");
+    return 0;
+}
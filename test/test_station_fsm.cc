@@ -0,0 +1,113 @@
+// StationFsm：正常连接流程、过期输入的丢弃，以及停止后只接受启动
+#include "station_fsm.h"
+#include "test_util.h"
+
+#include <cstring>
+
+using S = StationState;
+using I = StationInput;
+
+static constexpr S kStates[] = {S::kIdle, S::kStarting, S::kScanning, S::kConnecting, S::kConnected, S::kBackoff};
+static constexpr I kInputs[] = {
+    I::kStart, I::kStop, I::kScan, I::kScanDone, I::kConnect, I::kLinkUp, I::kGotIp, I::kDisconnected, I::kBackoff,
+    I::kTimer,
+};
+
+static S Step(S from, I input) {
+    S to = from;
+    if (!StationFsm::Next(from, input, &to)) {
+        fprintf(stderr, "rejected %s in %s\n", StationFsm::InputName(input), StationFsm::StateName(from));
+        CHECK(false);
+    }
+    return to;
+}
+
+static bool Rejects(S from, I input) {
+    S to = S::kConnected;
+    bool accepted = StationFsm::Next(from, input, &to);
+    // 不接受时不写输出
+    CHECK(accepted || to == S::kConnected);
+    return !accepted;
+}
+
+static void TestConnectLifecycle() {
+    S state = S::kIdle;
+    state = Step(state, I::kStart);
+    CHECK(state == S::kStarting);
+    state = Step(state, I::kScan);
+    CHECK(state == S::kScanning);
+    state = Step(state, I::kScanDone);
+    CHECK(state == S::kScanning);
+    state = Step(state, I::kConnect);
+    CHECK(state == S::kConnecting);
+    state = Step(state, I::kLinkUp);
+    CHECK(state == S::kConnecting);
+    state = Step(state, I::kGotIp);
+    CHECK(state == S::kConnected);
+    // 已连接时再次 LinkUp（漫游）留在已连接
+    CHECK(Step(state, I::kLinkUp) == S::kConnected);
+
+    state = Step(state, I::kDisconnected);
+    CHECK(state == S::kBackoff);
+    state = Step(state, I::kTimer);
+    CHECK(state == S::kBackoff);
+    state = Step(state, I::kScan);
+    CHECK(state == S::kScanning);
+    // 没有找到网络，等待下一次扫描
+    state = Step(state, I::kBackoff);
+    CHECK(state == S::kBackoff);
+    state = Step(state, I::kConnect);
+    CHECK(state == S::kConnecting);
+    state = Step(state, I::kDisconnected);
+    CHECK(state == S::kBackoff);
+    state = Step(state, I::kStop);
+    CHECK(state == S::kIdle);
+}
+
+static void TestStaleInputsRejected() {
+    // 只有退避中的定时器有效
+    for (S state : kStates) {
+        CHECK(Rejects(state, I::kTimer) == (state != S::kBackoff));
+    }
+    // 被连接打断的扫描结果丢弃
+    for (S state : kStates) {
+        CHECK(Rejects(state, I::kScanDone) == (state != S::kScanning));
+    }
+    // 已连接时的扫描属于漫游，不改变状态
+    CHECK(Rejects(S::kConnected, I::kScan));
+    CHECK(Rejects(S::kConnected, I::kBackoff));
+    // 重复启动
+    for (S state : kStates) {
+        CHECK(Rejects(state, I::kStart) == (state != S::kIdle));
+    }
+}
+
+static void TestIdleAcceptsOnlyStart() {
+    for (I input : kInputs) {
+        CHECK(Rejects(S::kIdle, input) == (input != I::kStart));
+    }
+    for (S state : kStates) {
+        if (state != S::kIdle) {
+            CHECK(Step(state, I::kStop) == S::kIdle);
+        }
+    }
+}
+
+static void TestOutOfRangeAndNames() {
+    S to = S::kIdle;
+    CHECK(!StationFsm::Next(static_cast<S>(6), I::kStart, &to));
+    CHECK(!StationFsm::Next(S::kIdle, static_cast<I>(10), &to));
+    CHECK(strcmp(StationFsm::StateName(S::kBackoff), "Backoff") == 0);
+    CHECK(strcmp(StationFsm::StateName(static_cast<S>(6)), "Unknown") == 0);
+    CHECK(strcmp(StationFsm::InputName(I::kTimer), "Timer") == 0);
+    CHECK(strcmp(StationFsm::InputName(static_cast<I>(10)), "Unknown") == 0);
+}
+
+int main() {
+    TestConnectLifecycle();
+    TestStaleInputsRejected();
+    TestIdleAcceptsOnlyStart();
+    TestOutOfRangeAndNames();
+    printf("test_station_fsm: ok\n");
+    return 0;
+}
@@ -0,0 +1,169 @@
+// TxPowerController：没有失败来源时不下调，余量充足时按 hold_ms 逐级下调，单次 RSSI 尖峰不调整，
+// 连续偏低、发送失败与掉线时上调，以及按时间加权的平均功率
+#include "tx_power_controller.h"
+#include "test_util.h"
+
+// 与 WifiStation 的采样周期一致
+static constexpr uint32_t kSampleMs = 2000;
+
+static int8_t Sample(TxPowerController& controller, uint32_t* now, int8_t rssi, uint32_t failures = 0) {
+    *now += kSampleMs;
+    return controller.Update(*now, rssi, failures);
+}
+
+static TxPowerConfig FeedbackConfig() {
+    TxPowerConfig config;
+    config.failure_feedback = true;
+    return config;
+}
+
+static void TestNoFailureSourceHoldsMax() {
+    TxPowerController controller;
+    controller.SetConfig(TxPowerConfig());
+    uint32_t now = 0;
+    controller.Reset(now);
+    for (int i = 0; i < 100; i++) {
+        CHECK(Sample(controller, &now, -40) == 80);
+    }
+    CHECK(controller.GetStats(now).steps_down == 0);
+}
+
+static void TestStepDownWithFeedback() {
+    TxPowerController controller;
+    TxPowerConfig config = FeedbackConfig();
+    controller.SetConfig(config);
+    uint32_t now = 0;
+    controller.Reset(now);
+
+    // 两次下调之间至少 hold_ms
+    for (uint32_t t = kSampleMs; t < config.hold_ms; t += kSampleMs) {
+        CHECK(Sample(controller, &now, -40) == 80);
+    }
+    CHECK(Sample(controller, &now, -40) == 80 - config.step);
+    for (uint32_t t = kSampleMs; t < config.hold_ms; t += kSampleMs) {
+        CHECK(Sample(controller, &now, -40) == 80 - config.step);
+    }
+    CHECK(Sample(controller, &now, -40) == 80 - 2 * config.step);
+
+    // 一直下调到 min_power 为止
+    for (int i = 0; i < 200; i++) {
+        Sample(controller, &now, -40);
+    }
+    CHECK(controller.GetPower() == config.min_power);
+
+    // 余量一般（介于 rssi_low 与 rssi_high 之间）时保持不动
+    TxPowerController middle;
+    middle.SetConfig(config);
+    now = 0;
+    middle.Reset(now);
+    for (int i = 0; i < 50; i++) {
+        CHECK(Sample(middle, &now, -60) == 80);
+    }
+
+    // 有发送失败（未达到门限）时不下调
+    TxPowerController failing;
+    failing.SetConfig(config);
+    now = 0;
+    failing.Reset(now);
+    for (int i = 0; i < 50; i++) {
+        CHECK(Sample(failing, &now, -40, 1) == 80);
+    }
+}
+
+// 先下调若干级，留出上调的空间
+static void StepDown(TxPowerController& controller, uint32_t* now, int8_t target) {
+    while (controller.GetPower() > target) {
+        Sample(controller, now, -40);
+    }
+}
+
+static void TestSingleSpikeIgnored() {
+    TxPowerController controller;
+    TxPowerConfig config = FeedbackConfig();
+    controller.SetConfig(config);
+    uint32_t now = 0;
+    controller.Reset(now);
+    StepDown(controller, &now, 60);
+    uint32_t steps_up = controller.GetStats(now).steps_up;
+
+    // 单次 -80：平均值 -40 -> -50，不调整
+    CHECK(Sample(controller, &now, -80) == 60);
+    CHECK(Sample(controller, &now, -40) == 60);
+    CHECK(controller.GetStats(now).steps_up == steps_up);
+
+    // 连续两次偏低即确认，加两级，不等平均值追上
+    CHECK(Sample(controller, &now, -80) == 60);
+    CHECK(Sample(controller, &now, -80) == 60 + 2 * config.step);
+    // 仍然偏低：继续按两级上调，上调不受 hold_ms 限制
+    CHECK(Sample(controller, &now, -80) == 60 + 4 * config.step);
+}
+
+static void TestAverageBelowLowRaisesOneStep() {
+    TxPowerController controller;
+    TxPowerConfig config = FeedbackConfig();
+    controller.SetConfig(config);
+    uint32_t now = 0;
+    controller.Reset(now);
+    StepDown(controller, &now, 60);
+
+    // 瞬时值在 -80 与 -60 之间交替，从不连续两次偏低；平均值跌破 rssi_low 后每次只加一级
+    int8_t previous = controller.GetPower();
+    bool raised = false;
+    for (int i = 0; i < 20; i++) {
+        int8_t power = Sample(controller, &now, i % 2 == 0 ? -80 : -60);
+        CHECK(power == previous || power == previous + config.step);
+        raised |= power > previous;
+        previous = power;
+    }
+    CHECK(raised);
+}
+
+static void TestFailuresAndLinkLoss() {
+    TxPowerController controller;
+    TxPowerConfig config = FeedbackConfig();
+    controller.SetConfig(config);
+    uint32_t now = 0;
+    controller.Reset(now);
+    StepDown(controller, &now, 60);
+
+    // 一个周期内发送失败达到门限：即使 RSSI 很好也立即加两级
+    CHECK(Sample(controller, &now, -40, config.failure_threshold) == 60 + 2 * config.step);
+    // 刚上调过，hold_ms 内不会再下调
+    CHECK(Sample(controller, &now, -40) == 60 + 2 * config.step);
+
+    // 掉线后回到上限，平均值重新开始
+    CHECK(controller.OnLinkLoss(now) == config.max_power);
+    CHECK(controller.GetStats(now).link_losses == 1);
+    CHECK(Sample(controller, &now, -80) == config.max_power);
+}
+
+static void TestStats() {
+    TxPowerController controller;
+    TxPowerConfig config = FeedbackConfig();
+    controller.SetConfig(config);
+    uint32_t now = 1000;
+    controller.Reset(now);
+
+    // 80 持续 10 s，76 持续 10 s：平均 78
+    while (controller.GetPower() == 80) {
+        Sample(controller, &now, -40);
+    }
+    CHECK(now == 1000 + config.hold_ms);
+    TxPowerStats stats = controller.GetStats(now + config.hold_ms);
+    CHECK(stats.current == 76);
+    CHECK(stats.average == 78);
+    CHECK(stats.lowest == 76);
+    CHECK(stats.steps_down == 1);
+    CHECK(stats.steps_up == 0);
+}
+
+int main() {
+    TestNoFailureSourceHoldsMax();
+    TestStepDownWithFeedback();
+    TestSingleSpikeIgnored();
+    TestAverageBelowLowRaisesOneStep();
+    TestFailuresAndLinkLoss();
+    TestStats();
+    printf("test_tx_power_controller: ok\n");
+    return 0;
+}
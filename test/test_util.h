@@ -0,0 +1,23 @@
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// 与 assert 不同，NDEBUG 下也会检查
+#define CHECK(condition)                                                              \
+    do {                                                                              \
+        if (!(condition)) {                                                           \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            std::exit(1);                                                             \
+        }                                                                             \
+    } while (0)
+
+// 基准测试用的单调时钟（纳秒）
+inline long long NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif // TEST_UTIL_H
@@ -0,0 +1,159 @@
+// RoamingPolicy 与 RoamSelection：迟滞、驻留时间、切换统计、候选选择，以及邻居报告在截断与超长元素下的解析
+#include "wifi_roaming.h"
+#include "test_util.h"
+
+#include <vector>
+
+static const uint8_t kCurrent[6] = {0, 0, 0, 0, 0, 1};
+static const uint8_t kApA[6] = {0, 0, 0, 0, 0, 2};
+static const uint8_t kApB[6] = {0, 0, 0, 0, 0, 3};
+
+static void TestHysteresisAndDwell() {
+    RoamingPolicy policy;
+    const RoamConfig& config = policy.GetConfig();
+    CHECK(policy.IsBetter(-80, -80 + config.hysteresis_db));
+    CHECK(!policy.IsBetter(-80, -80 + config.hysteresis_db - 1));
+
+    // 第一次漫游不受驻留时间限制，切换期间不再发起
+    CHECK(policy.CanRoam(0));
+    policy.OnRoamStart(1000);
+    CHECK(policy.IsRoaming());
+    CHECK(!policy.CanRoam(1000 + config.min_dwell_ms * 2));
+    policy.OnRoamDone(true, 1400);
+    CHECK(!policy.CanRoam(1400 + config.min_dwell_ms - 1));
+    CHECK(policy.CanRoam(1400 + config.min_dwell_ms));
+
+    // 失败同样计入驻留时间
+    policy.OnRoamStart(100000);
+    policy.OnRoamDone(false, 100500);
+    CHECK(!policy.CanRoam(100500 + config.min_dwell_ms - 1));
+    CHECK(policy.GetStats().failures == 1);
+
+    // 毫秒计数回绕
+    RoamingPolicy wrap;
+    wrap.OnRoamStart(0xffffffffu - 100);
+    wrap.OnRoamDone(true, 0xffffffffu - 50);
+    CHECK(wrap.GetStats().last_latency_ms == 50);
+    CHECK(!wrap.CanRoam(1000));
+    CHECK(wrap.CanRoam(config.min_dwell_ms));
+
+    // 没有开始切换时的完成事件忽略
+    RoamingPolicy idle;
+    idle.OnRoamDone(true, 10);
+    CHECK(idle.GetStats().roams == 0);
+    CHECK(idle.CanRoam(10));
+}
+
+static void TestLatencyStats() {
+    RoamingPolicy policy;
+    const uint32_t latencies[] = {300, 900, 600};
+    uint32_t now = 0;
+    for (uint32_t latency : latencies) {
+        now += 100000;
+        policy.OnRoamStart(now);
+        policy.OnRoamDone(true, now + latency);
+    }
+    const RoamStats& stats = policy.GetStats();
+    CHECK(stats.roams == 3);
+    CHECK(stats.last_latency_ms == 600);
+    CHECK(stats.max_latency_ms == 900);
+    CHECK(stats.avg_latency_ms == 600);
+}
+
+static void TestSelection() {
+    RoamingPolicy policy;
+    const RoamConfig& config = policy.GetConfig();
+
+    // 当前 AP 出现在扫描中时用本次扫描的 RSSI；被屏蔽的跳过，取第一个（最强）
+    RoamSelection selection(kCurrent, -70);
+    selection.Offer(0, kApA, -55, true);
+    selection.Offer(1, kApB, -60, false);
+    selection.Offer(2, kCurrent, -78, false);
+    CHECK(selection.current_rssi() == -78);
+    CHECK(selection.Best(policy) == 1);
+
+    // 候选不够强（迟滞内）
+    RoamSelection close(kCurrent, -70);
+    close.Offer(0, kApA, -70 + config.hysteresis_db - 1, false);
+    CHECK(close.Best(policy) == -1);
+    // 扫描中的当前 AP 比触发时弱，同一个候选变得值得切换
+    close.Offer(1, kCurrent, -75, false);
+    CHECK(close.Best(policy) == 0);
+
+    // 只有当前 AP 或全部被屏蔽
+    RoamSelection only_current(kCurrent, -80);
+    only_current.Offer(0, kCurrent, -80, false);
+    CHECK(only_current.Best(policy) == -1);
+    RoamSelection all_blocked(kCurrent, -90);
+    all_blocked.Offer(0, kApA, -40, true);
+    CHECK(all_blocked.Best(policy) == -1);
+}
+
+// Neighbor Report 元素：BSSID(6) + BSSID Info(4) + Operating Class(1) + Channel(1) + PHY Type(1) + 子元素
+static void AppendNeighbor(std::vector<uint8_t>& report, uint8_t channel, size_t subelements = 0) {
+    report.push_back(52);
+    report.push_back(13 + subelements);
+    for (int i = 0; i < 11; i++) {
+        report.push_back(i);
+    }
+    report.push_back(channel);
+    report.push_back(7);
+    report.insert(report.end(), subelements, 0xdd);
+}
+
+static void TestParseNeighborChannels() {
+    uint8_t channels[8];
+    std::vector<uint8_t> report;
+    AppendNeighbor(report, 1);
+    AppendNeighbor(report, 6, 5);
+    AppendNeighbor(report, 1);
+    // 其他元素跳过
+    report.insert(report.end(), {221, 3, 0x50, 0x6f, 0x9a});
+    AppendNeighbor(report, 36);
+    // 信道 0 忽略
+    AppendNeighbor(report, 0);
+    CHECK(RoamingPolicy::ParseNeighborChannels(report.data(), report.size(), channels, 8) == 3);
+    CHECK(channels[0] == 1 && channels[1] == 6 && channels[2] == 36);
+
+    // 输出个数上限
+    CHECK(RoamingPolicy::ParseNeighborChannels(report.data(), report.size(), channels, 2) == 2);
+    CHECK(RoamingPolicy::ParseNeighborChannels(report.data(), 0, channels, 8) == 0);
+
+    // 过短的 Neighbor Report 元素跳过，后面的仍然解析
+    std::vector<uint8_t> short_element = {52, 12};
+    short_element.insert(short_element.end(), 12, 11);
+    AppendNeighbor(short_element, 11);
+    CHECK(RoamingPolicy::ParseNeighborChannels(short_element.data(), short_element.size(), channels, 8) == 1);
+    CHECK(channels[0] == 11);
+
+    // 末尾元素被截断：声明的长度超出报告，停止解析，不越界读取
+    std::vector<uint8_t> truncated;
+    AppendNeighbor(truncated, 6);
+    AppendNeighbor(truncated, 11);
+    for (size_t cut = 1; cut < 15; cut++) {
+        CHECK(RoamingPolicy::ParseNeighborChannels(truncated.data(), truncated.size() - cut, channels, 8) == 1);
+        CHECK(channels[0] == 6);
+    }
+    // 只剩元素头的一个字节
+    CHECK(RoamingPolicy::ParseNeighborChannels(truncated.data(), 16, channels, 8) == 1);
+
+    // 长度为 255 的超长元素：完整时跳过子元素继续，声明超出报告时停止
+    std::vector<uint8_t> oversized;
+    AppendNeighbor(oversized, 149, 255 - 13);
+    AppendNeighbor(oversized, 3);
+    CHECK(oversized[1] == 255);
+    CHECK(RoamingPolicy::ParseNeighborChannels(oversized.data(), oversized.size(), channels, 8) == 2);
+    CHECK(channels[0] == 149 && channels[1] == 3);
+    std::vector<uint8_t> lying = {52, 255};
+    lying.insert(lying.end(), 20, 6);
+    CHECK(RoamingPolicy::ParseNeighborChannels(lying.data(), lying.size(), channels, 8) == 0);
+}
+
+int main() {
+    TestHysteresisAndDwell();
+    TestLatencyStats();
+    TestSelection();
+    TestParseNeighborChannels();
+    printf("test_wifi_roaming: ok\n");
+    return 0;
+}
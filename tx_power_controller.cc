@@ -0,0 +1,89 @@
+#include "tx_power_controller.h"
+
+#include <algorithm>
+
+void TxPowerController::SetConfig(const TxPowerConfig& config) {
+    config_ = config;
+    config_.max_power = std::clamp(config_.max_power, kMinPower, kMaxPower);
+    config_.min_power = std::clamp(config_.min_power, kMinPower, config_.max_power);
+    if (config_.step <= 0) {
+        config_.step = 1;
+    }
+    power_ = std::clamp(power_, config_.min_power, config_.max_power);
+}
+
+void TxPowerController::Reset(uint32_t now_ms) {
+    power_ = config_.max_power;
+    lowest_ = power_;
+    rssi_valid_ = false;
+    low_samples_ = 0;
+    last_change_ms_ = now_ms;
+    since_ms_ = now_ms;
+    start_ms_ = now_ms;
+    power_time_sum_ = 0;
+}
+
+void TxPowerController::SetPower(int8_t power, uint32_t now_ms) {
+    power = std::clamp(power, config_.min_power, config_.max_power);
+    if (power == power_) {
+        return;
+    }
+    if (power > power_) {
+        steps_up_++;
+    } else {
+        steps_down_++;
+    }
+    power_time_sum_ += (int64_t)power_ * (uint32_t)(now_ms - since_ms_);
+    since_ms_ = now_ms;
+    last_change_ms_ = now_ms;
+    power_ = power;
+    lowest_ = std::min(lowest_, power_);
+}
+
+int8_t TxPowerController::Update(uint32_t now_ms, int8_t rssi, uint32_t tx_failures) {
+    if (!rssi_valid_) {
+        rssi_avg_x4_ = rssi * 4;
+        rssi_valid_ = true;
+    } else {
+        // alpha = 1/4，单次尖峰不会引起调整
+        rssi_avg_x4_ += rssi - rssi_avg_x4_ / 4;
+    }
+    int rssi_avg = rssi_avg_x4_ / 4;
+    if (rssi >= config_.rssi_low) {
+        low_samples_ = 0;
+    } else if (low_samples_ < UINT8_MAX) {
+        low_samples_++;
+    }
+
+    if (tx_failures >= config_.failure_threshold || low_samples_ >= 2) {
+        // 余量不足时加两级，尽快恢复；瞬时 RSSI 连续两次偏低即确认，不等平均值追上
+        SetPower(power_ + config_.step * 2, now_ms);
+    } else if (rssi_avg < config_.rssi_low) {
+        SetPower(power_ + config_.step, now_ms);
+    } else if (config_.failure_feedback && rssi_avg > config_.rssi_high && tx_failures == 0 &&
+        now_ms - last_change_ms_ >= config_.hold_ms) {
+        SetPower(power_ - config_.step, now_ms);
+    }
+    return power_;
+}
+
+int8_t TxPowerController::OnLinkLoss(uint32_t now_ms) {
+    link_losses_++;
+    rssi_valid_ = false;
+    low_samples_ = 0;
+    SetPower(config_.max_power, now_ms);
+    return power_;
+}
+
+TxPowerStats TxPowerController::GetStats(uint32_t now_ms) const {
+    TxPowerStats stats = {};
+    stats.current = power_;
+    uint32_t elapsed_ms = now_ms - start_ms_;
+    int64_t sum = power_time_sum_ + (int64_t)power_ * (uint32_t)(now_ms - since_ms_);
+    stats.average = elapsed_ms > 0 ? (int8_t)(sum / elapsed_ms) : power_;
+    stats.lowest = lowest_;
+    stats.steps_up = steps_up_;
+    stats.steps_down = steps_down_;
+    stats.link_losses = link_losses_;
+    return stats;
+}
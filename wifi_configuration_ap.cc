@@ -1,6 +1,7 @@
 #include "wifi_configuration_ap.h"
 #include <cstdio>
 #include <memory>
+#include <atomic>
 #include <freertos/FreeRTOS.h>
 #include <freertos/event_groups.h>
 #include <esp_err.h>
@@ -16,6 +17,9 @@
 #include <esp_smartconfig.h>
 #include "ssid_manager.h"
 #include "wifi_connection_manager.h"
+#include "connection_timeline.h"
+#include "link_metrics.h"
+#include "connect_report.h"
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -88,7 +92,7 @@ void WifiConfigurationAp::Start()
     StartUdpServer();
     
     // Start scan immediately
-    esp_wifi_scan_start(nullptr, false);
+    WifiConnectionManager::GetInstance().RequestScan();
 #endif
 }
 
@@ -258,13 +262,57 @@ void WifiConfigurationAp::UdpServerTask(void* arg)
     socklen_t client_len = sizeof(client_addr);
     char buffer[1024];
 
+    // 异步连接的结果由 WiFi 事件任务写入，本任务轮询处理，连接期间仍可收包
+    struct PendingConnect {
+        std::atomic<bool> done{false};
+        esp_err_t result = ESP_FAIL;
+        char bssid[18] = {};
+    };
+    std::shared_ptr<PendingConnect> pending;
+    WifiConfigData pending_config;
+    struct sockaddr_in pending_addr;
+    socklen_t pending_len = 0;
+
     ESP_LOGI(TAG, "UDP server task started, waiting for messages...");
 
     while (1) {
-        // 如果正在连接中，跳过接收消息
-        if (is_connecting_) {
-            vTaskDelay(pdMS_TO_TICKS(100));  // 等待100ms再检查
-            continue;
+        if (pending && pending->done.load()) {
+            auto& wifi_manager = WifiConnectionManager::GetInstance();
+            if (pending->result == ESP_OK) {
+                wifi_manager.SaveCredentials(pending_config.ssid, pending_config.password, std::string(pending->bssid));
+                if (!pending_config.uid.empty()) {
+                    wifi_manager.SaveUid(pending_config.uid);
+                }
+                ESP_LOGI(TAG, "WiFi configuration applied successfully");
+
+                // 发送固定格式的响应
+                uint8_t response[] = {
+                    0x00, 0x00, 0x00, 0x03,  // 固定包头
+                    0x03,                    // 可变长度
+                    0x00,                    // Flag
+                    0x00, 0x02              // 命令字
+                };
+                
+                int sent = sendto(tcp_server_socket_, response, sizeof(response), 0,
+                                (struct sockaddr *)&pending_addr, pending_len);
+                if (sent < 0) {
+                    ESP_LOGE(TAG, "Failed to send response, error: %d", errno);
+                } else {
+                    ESP_LOGI(TAG, "Response sent successfully");
+                }
+
+                vTaskDelay(pdMS_TO_TICKS(500));
+                esp_restart();
+            } else {
+                ESP_LOGE(TAG, "Failed to connect to WiFi");
+                // Notify that configuration failed
+                WifiConfiguration::GetInstance().NotifyEvent(WifiConfigEvent::CONFIG_FAILED, 
+                    "Failed to connect to WiFi: " + pending_config.ssid);
+            }
+
+            // 重置连接标志
+            pending.reset();
+            is_connecting_ = false;
         }
 
         // Receive UDP message
@@ -287,6 +335,12 @@ void WifiConfigurationAp::UdpServerTask(void* arg)
                 ntohs(client_addr.sin_port),
                 len);
 
+        // 如果正在连接中，忽略新的配网包
+        if (is_connecting_) {
+            ESP_LOGW(TAG, "WiFi connection already in progress, ignoring message");
+            continue;
+        }
+
         // Parse the protocol
         WifiConfigData config;
         if (ParseWifiConfig((uint8_t*)buffer, len, config)) {
@@ -299,44 +353,18 @@ void WifiConfigurationAp::UdpServerTask(void* arg)
 
             // 设置连接标志
             is_connecting_ = true;
+            pending = std::make_shared<PendingConnect>();
+            pending_config = config;
+            pending_addr = client_addr;
+            pending_len = client_len;
 
             // 使用WiFi连接管理器进行连接
-            auto& wifi_manager = WifiConnectionManager::GetInstance();
-            char bssid[18];
-            if (wifi_manager.Connect(config.ssid, config.password, bssid) == ESP_OK) {
-                wifi_manager.SaveCredentials(config.ssid, config.password, std::string(bssid));
-                if (!config.uid.empty()) {
-                    wifi_manager.SaveUid(config.uid);
-                }
-                ESP_LOGI(TAG, "WiFi configuration applied successfully");
-
-                // 发送固定格式的响应
-                uint8_t response[] = {
-                    0x00, 0x00, 0x00, 0x03,  // 固定包头
-                    0x03,                    // 可变长度
-                    0x00,                    // Flag
-                    0x00, 0x02              // 命令字
-                };
-                
-                int sent = sendto(tcp_server_socket_, response, sizeof(response), 0,
-                                (struct sockaddr *)&client_addr, client_len);
-                if (sent < 0) {
-                    ESP_LOGE(TAG, "Failed to send response, error: %d", errno);
-                } else {
-                    ESP_LOGI(TAG, "Response sent successfully");
-                }
-
-                vTaskDelay(pdMS_TO_TICKS(500));
-                esp_restart();
-            } else {
-                ESP_LOGE(TAG, "Failed to connect to WiFi");
-                // Notify that configuration failed
-                WifiConfiguration::GetInstance().NotifyEvent(WifiConfigEvent::CONFIG_FAILED, 
-                    "Failed to connect to WiFi: " + config.ssid);
-            }
-
-            // 重置连接标志
-            is_connecting_ = false;
+            WifiConnectionManager::GetInstance().ConnectAsync(config.ssid, config.password, ConnectOptions(),
+                [pending](esp_err_t result, const char* bssid) {
+                    pending->result = result;
+                    snprintf(pending->bssid, sizeof(pending->bssid), "%s", bssid);
+                    pending->done.store(true);
+                });
         }
     }
 }
@@ -529,21 +557,23 @@ void WifiConfigurationAp::StartWebServer()
         .uri = "/scan",
         .method = HTTP_GET,
         .handler = [](httpd_req_t *req) -> esp_err_t {
-            auto *this_ = static_cast<WifiConfigurationAp *>(req->user_ctx);
-            std::lock_guard<std::mutex> lock(this_->mutex_);
+            // 先返回缓存中的列表，同时按需触发扫描，页面下次刷新时拿到新结果
+            auto& wifi_manager = WifiConnectionManager::GetInstance();
+            wifi_manager.RequestScan();
+            auto ap_list = wifi_manager.GetScanList();
 
             // Send the scan results as JSON
             httpd_resp_set_type(req, "application/json");
             httpd_resp_set_hdr(req, "Connection", "close");
             httpd_resp_sendstr_chunk(req, "[");
-            for (int i = 0; i < this_->ap_records_.size(); i++) {
+            for (int i = 0; i < ap_list.size(); i++) {
                 ESP_LOGI(TAG, "SSID: %s, RSSI: %d, Authmode: %d",
-                    (char *)this_->ap_records_[i].ssid, this_->ap_records_[i].rssi, this_->ap_records_[i].authmode);
+                    ap_list[i].ssid.c_str(), ap_list[i].rssi, ap_list[i].authmode);
                 char buf[128];
                 snprintf(buf, sizeof(buf), "{\"ssid\":\"%s\",\"rssi\":%d,\"authmode\":%d}",
-                    (char *)this_->ap_records_[i].ssid, this_->ap_records_[i].rssi, this_->ap_records_[i].authmode);
+                    ap_list[i].ssid.c_str(), ap_list[i].rssi, ap_list[i].authmode);
                 httpd_resp_sendstr_chunk(req, buf);
-                if (i < this_->ap_records_.size() - 1) {
+                if (i < ap_list.size() - 1) {
                     httpd_resp_sendstr_chunk(req, ",");
                 }
             }
@@ -555,6 +585,51 @@ void WifiConfigurationAp::StartWebServer()
     };
     ESP_ERROR_CHECK(httpd_register_uri_handler(server_, &scan));
 
+    // Register the /diag/timeline URI: 最近连接尝试的分阶段耗时
+    httpd_uri_t diag_timeline = {
+        .uri = "/diag/timeline",
+        .method = HTTP_GET,
+        .handler = [](httpd_req_t *req) -> esp_err_t {
+            std::string json_str = ConnectionTimeline::GetInstance().GetAttemptsJson();
+            httpd_resp_set_type(req, "application/json");
+            httpd_resp_set_hdr(req, "Connection", "close");
+            httpd_resp_send(req, json_str.c_str(), HTTPD_RESP_USE_STRLEN);
+            return ESP_OK;
+        },
+        .user_ctx = NULL
+    };
+    ESP_ERROR_CHECK(httpd_register_uri_handler(server_, &diag_timeline));
+
+    // Register the /diag/link URI: RSSI、断开原因直方图、连接时长与重连耗时
+    httpd_uri_t diag_link = {
+        .uri = "/diag/link",
+        .method = HTTP_GET,
+        .handler = [](httpd_req_t *req) -> esp_err_t {
+            std::string json_str = LinkMetrics::GetInstance().GetJson(esp_timer_get_time() / 1000);
+            httpd_resp_set_type(req, "application/json");
+            httpd_resp_set_hdr(req, "Connection", "close");
+            httpd_resp_send(req, json_str.c_str(), HTTPD_RESP_USE_STRLEN);
+            return ESP_OK;
+        },
+        .user_ctx = NULL
+    };
+    ESP_ERROR_CHECK(httpd_register_uri_handler(server_, &diag_link));
+
+    // Register the /diag/connect URI: 最近配网连接请求的逐次尝试结果
+    httpd_uri_t diag_connect = {
+        .uri = "/diag/connect",
+        .method = HTTP_GET,
+        .handler = [](httpd_req_t *req) -> esp_err_t {
+            std::string json_str = ConnectReport::GetInstance().GetJson();
+            httpd_resp_set_type(req, "application/json");
+            httpd_resp_set_hdr(req, "Connection", "close");
+            httpd_resp_send(req, json_str.c_str(), HTTPD_RESP_USE_STRLEN);
+            return ESP_OK;
+        },
+        .user_ctx = NULL
+    };
+    ESP_ERROR_CHECK(httpd_register_uri_handler(server_, &diag_connect));
+
     // Register the form submission
     httpd_uri_t form_submit = {
         .uri = "/submit",
@@ -615,22 +690,52 @@ void WifiConfigurationAp::StartWebServer()
                 uid_str = uid_item->valuestring;
             }
 
-            // 使用 WiFi 连接管理器进行连接
-            auto& wifi_manager = WifiConnectionManager::GetInstance();
-            char bssid[18];
-            if (wifi_manager.Connect(ssid_str, password_str, bssid) == ESP_OK) {
-                wifi_manager.SaveCredentials(ssid_str, password_str, std::string(bssid));
-                if (!uid_str.empty()) {
-                    wifi_manager.SaveUid(uid_str);
-                }
-                cJSON_Delete(json);
-                httpd_resp_send(req, "{\"success\":true}", HTTPD_RESP_USE_STRLEN);
-                return ESP_OK;
-            } else {
-                cJSON_Delete(json);
-                httpd_resp_send(req, "{\"success\":false,\"error\":\"无法连接到 WiFi\"}", HTTPD_RESP_USE_STRLEN);
-                return ESP_OK;
+            cJSON_Delete(json);
+
+            // 连接过程可能持续数十秒，把请求转为异步，释放 httpd 工作线程，结果在回调中回复
+            httpd_req_t* async_req = nullptr;
+            if (httpd_req_async_handler_begin(req, &async_req) != ESP_OK) {
+                httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to defer request");
+                return ESP_FAIL;
             }
+
+            // 回调运行在 WiFi 事件任务中，保存 NVS 和回复交给独立任务完成
+            struct SubmitResult {
+                httpd_req_t* req;
+                esp_err_t result;
+                std::string ssid;
+                std::string password;
+                std::string uid;
+                std::string bssid;
+            };
+            WifiConnectionManager::GetInstance().ConnectAsync(ssid_str, password_str, ConnectOptions(),
+                [async_req, ssid_str, password_str, uid_str](esp_err_t result, const char* bssid) {
+                    auto* submit = new SubmitResult{async_req, result, ssid_str, password_str, uid_str, bssid};
+                    BaseType_t task_created = xTaskCreate([](void* arg) {
+                        auto* submit = static_cast<SubmitResult*>(arg);
+                        auto& wifi_manager = WifiConnectionManager::GetInstance();
+                        if (submit->result == ESP_OK) {
+                            wifi_manager.SaveCredentials(submit->ssid, submit->password, submit->bssid);
+                            if (!submit->uid.empty()) {
+                                wifi_manager.SaveUid(submit->uid);
+                            }
+                            httpd_resp_send(submit->req, "{\"success\":true}", HTTPD_RESP_USE_STRLEN);
+                        } else {
+                            httpd_resp_send(submit->req, "{\"success\":false,\"error\":\"无法连接到 WiFi\"}", HTTPD_RESP_USE_STRLEN);
+                        }
+                        httpd_req_async_handler_complete(submit->req);
+                        delete submit;
+                        vTaskDelete(NULL);
+                    }, "wifi_submit", 4096, submit, 5, NULL);
+                    if (task_created != pdPASS) {
+                        // 内存不足，无法在事件任务中保存 NVS：直接回复失败并结束请求，否则连接会一直挂起
+                        ESP_LOGE(TAG, "Failed to create submit task");
+                        httpd_resp_send(submit->req, "{\"success\":false,\"error\":\"内存不足，请重试\"}", HTTPD_RESP_USE_STRLEN);
+                        httpd_req_async_handler_complete(submit->req);
+                        delete submit;
+                    }
+                });
+            return ESP_OK;
         },
         .user_ctx = this
     };
@@ -952,13 +1057,16 @@ void WifiConfigurationAp::SmartConfigEventHandler(void *arg, esp_event_base_t ev
             memcpy(ssid, evt->ssid, sizeof(evt->ssid));
             memcpy(password, evt->password, sizeof(evt->password));
             ESP_LOGI(TAG, "SmartConfig SSID: %s, Password: %s", ssid, password);
-            // 尝试连接WiFi会失败，故不连接
-            WifiConnectionManager::GetInstance().Connect(ssid, password);
-            xTaskCreate([](void *ctx){
-                ESP_LOGI(TAG, "Restarting in 3 second");
-                vTaskDelay(pdMS_TO_TICKS(3000));
-                esp_restart();
-            }, "restart_task", 4096, NULL, 5, NULL);
+            // 本处理函数运行在事件循环中，阻塞连接会收不到 WiFi 事件，必须用异步接口
+            WifiConnectionManager::GetInstance().ConnectAsync(ssid, password, ConnectOptions(),
+                [](esp_err_t result, const char* bssid) {
+                    ESP_LOGI(TAG, "SmartConfig connect result: %s", esp_err_to_name(result));
+                    xTaskCreate([](void *ctx){
+                        ESP_LOGI(TAG, "Restarting in 3 second");
+                        vTaskDelay(pdMS_TO_TICKS(3000));
+                        esp_restart();
+                    }, "restart_task", 4096, NULL, 5, NULL);
+                });
             break;
         }
         case SC_EVENT_SEND_ACK_DONE:
@@ -2,14 +2,28 @@
 #include "ssid_manager.h"
 #include <string.h>
 #include <cstdio>  // Added for sprintf
+#include <cinttypes>
 #include <nvs_flash.h>
 #include "wifi_manager_c.h"
+#include "connection_timeline.h"
+#include "disconnect_reason.h"
+#include "connect_report.h"
 #include <algorithm> // Added for std::sort
+#include <freertos/semphr.h>
 #define NVS_NAMESPACE "wifi"
 #define MAX_WIFI_SCAN_SSID_COUNT 20
 
 const char* WifiConnectionManager::TAG = "WifiConnectionManager";
 
+static void RecordPhase(TimelinePhase phase, uint16_t arg = 0) {
+    ConnectionTimeline::GetInstance().Record(TimelineSource::kManager, phase, arg);
+}
+
+// 尝试循环使用不回绕的 64 位时间，其他模块取低 32 位
+static int64_t NowMs() {
+    return esp_timer_get_time() / 1000;
+}
+
 // C++ 类实现
 WifiConnectionManager& WifiConnectionManager::GetInstance() {
     static WifiConnectionManager instance;
@@ -37,8 +51,7 @@ esp_err_t WifiConnectionManager::InitializeWiFi() {
 WifiConnectionManager::WifiConnectionManager() 
     : event_group_(xEventGroupCreate())
     , is_connecting_(false)
-    , scan_timer_(nullptr)
-    , first_scan_done_(false) {
+    , scan_timer_(nullptr) {
     
     // Register event handlers
     ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT,
@@ -51,10 +64,38 @@ WifiConnectionManager::WifiConnectionManager()
                                                       &WifiConnectionManager::IpEventHandler,
                                                       this,
                                                       &instance_got_ip_));
+
+    // 单次尝试超时和重试间隔共用一个定时器
+    esp_timer_create_args_t attempt_timer_args = {
+        .callback = [](void* arg) {
+            static_cast<WifiConnectionManager*>(arg)->OnAttemptTimer();
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "wifi_attempt_timer",
+        .skip_unhandled_events = true
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&attempt_timer_args, &attempt_timer_));
+
+    esp_timer_create_args_t scan_timer_args = {
+        .callback = &WifiConnectionManager::ScanTimerCallback,
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "wifi_scan_timer",
+        .skip_unhandled_events = true
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&scan_timer_args, &scan_timer_));
 }
 
 WifiConnectionManager::~WifiConnectionManager() {
-    StopScanTimer();
+    if (scan_timer_) {
+        esp_timer_stop(scan_timer_);
+        esp_timer_delete(scan_timer_);
+    }
+    if (attempt_timer_) {
+        esp_timer_stop(attempt_timer_);
+        esp_timer_delete(attempt_timer_);
+    }
     if (event_group_) {
         vEventGroupDelete(event_group_);
     }
@@ -69,284 +110,354 @@ WifiConnectionManager::~WifiConnectionManager() {
     esp_wifi_deinit();
 }
 
-void WifiConnectionManager::StartScanTimer() {
-    if (scan_timer_) return;
-    esp_timer_create_args_t timer_args = {
-        .callback = &WifiConnectionManager::ScanTimerCallback,
-        .arg = this,
-        .dispatch_method = ESP_TIMER_TASK,
-        .name = "wifi_scan_timer",
-        .skip_unhandled_events = true
-    };
-    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &scan_timer_));
-    
-    // 根据是否已完成首次扫描来设置不同的扫描周期
-    uint64_t scan_period = first_scan_done_ ? (10 * 1000000) : (5 * 1000000);  // 首次2秒，后续10秒
-    ESP_ERROR_CHECK(esp_timer_start_periodic(scan_timer_, scan_period));
-    ESP_LOGI(TAG, "Start scan timer with period: %llu seconds", scan_period / 1000000);
+void WifiConnectionManager::RequestScan() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 扫描会打断关联过程，连接结束后的下一次请求再扫
+    if (is_connecting_) {
+        return;
+    }
+    if (!scan_demand_.Request(NowMs())) {
+        return;
+    }
+    RecordPhase(TimelinePhase::kScanStart);
+    esp_err_t ret = esp_wifi_scan_start(nullptr, false);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Scan start failed: %s", esp_err_to_name(ret));
+        return;
+    }
+    scan_demand_.OnStarted();
+}
 
-    esp_wifi_scan_start(nullptr, false);
+void WifiConnectionManager::SetBackgroundScanInterval(uint32_t ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    background_scan_ms_ = ms;
+    ArmBackgroundScanLocked();
 }
 
-void WifiConnectionManager::StopScanTimer() {
-    if (scan_timer_) {
-        esp_timer_stop(scan_timer_);
-        esp_timer_delete(scan_timer_);
-        scan_timer_ = nullptr;
+void WifiConnectionManager::ArmBackgroundScanLocked() {
+    esp_timer_stop(scan_timer_);
+    if (background_scan_ms_ > 0) {
+        esp_timer_start_once(scan_timer_, (uint64_t)background_scan_ms_ * 1000);
     }
 }
 
 void WifiConnectionManager::ScanTimerCallback(void* arg) {
     auto* self = static_cast<WifiConnectionManager*>(arg);
-    if (!self->is_connecting_) {
-        esp_wifi_scan_start(nullptr, false);
+    self->RequestScan();
+    // 正在连接等原因没有扫成时，下一个周期再试
+    std::lock_guard<std::mutex> lock(self->mutex_);
+    if (!self->scan_demand_.InFlight()) {
+        self->ArmBackgroundScanLocked();
     }
 }
 
-esp_err_t WifiConnectionManager::Connect(const std::string& ssid, const std::string& password, char* bssid_out) {
-    if (ssid.empty()) {
-        ESP_LOGE(TAG, "SSID cannot be empty");
-        return ESP_ERR_WIFI_SSID;
-    }
-    
-    if (ssid.length() > 32) {
-        ESP_LOGE(TAG, "SSID too long");
-        return ESP_ERR_WIFI_SSID;
-    }
-    
-    is_connecting_ = true;
-    xEventGroupClearBits(event_group_, WIFI_CONNECTED_BIT | WIFI_FAIL_BIT);
+std::vector<WifiConnectionManager::ScanInfo> WifiConnectionManager::GetScanList() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {scan_info_.begin(), scan_info_.begin() + scan_top_count_};
+}
 
-    wifi_config_t wifi_config;
-    memset(&wifi_config, 0, sizeof(wifi_config));
-    bzero(&wifi_config, sizeof(wifi_config));
-    strcpy((char *)wifi_config.sta.ssid, ssid.c_str());
-    strcpy((char *)wifi_config.sta.password, password.c_str());
-    wifi_config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
-    wifi_config.sta.failure_retry_cnt = 1;
-    
-    esp_err_t ret = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "esp_wifi_set_config failed: %s", esp_err_to_name(ret));
-        is_connecting_ = false;
-        return ret;
+void WifiConnectionManager::Completion::Run() {
+    if (callback) {
+        callback(result, bssid);
     }
-    
-    int retry_count = 0;
-    const int max_retries = 4;
-    
-    // 重置错误统计
-    error_stats_count_ = 0;
-    current_retry_count_ = 0;
-    memset(error_stats_, 0, sizeof(error_stats_));
-    
-    while (retry_count < max_retries) {
-        current_retry_count_ = retry_count;  // 更新当前重试次数
-        ret = esp_wifi_connect();
-        if (ret != ESP_OK) {
-            // 详细处理esp_wifi_connect()的错误码
-            const char* error_str = "Unknown error";
-            switch (ret) {
-                case ESP_ERR_WIFI_NOT_INIT:
-                    error_str = "WiFi not initialized";
-                    break;
-                case ESP_ERR_WIFI_NOT_STARTED:
-                    error_str = "WiFi not started";
-                    break;
-                case ESP_ERR_WIFI_CONN:
-                    error_str = "WiFi connection failed";
-                    break;
-                case ESP_ERR_WIFI_SSID:
-                    error_str = "Invalid SSID";
-                    break;
-                case ESP_ERR_WIFI_PASSWORD:
-                    error_str = "Invalid password";
-                    break;
-                case ESP_ERR_WIFI_NVS:
-                    error_str = "WiFi NVS error";
-                    break;
-                case ESP_ERR_WIFI_MODE:
-                    error_str = "WiFi mode error";
-                    break;
-                case ESP_ERR_WIFI_STATE:
-                    error_str = "WiFi state error";
-                    break;
-                default:
-                    error_str = esp_err_to_name(ret);
-                    break;
-            }
-            ESP_LOGE(TAG, "esp_wifi_connect() failed: %s (code: %d)", error_str, ret);
-            
-            // 统计错误出现次数
-            bool found = false;
-            for (int i = 0; i < error_stats_count_; i++) {
-                if (error_stats_[i].error == ret && !error_stats_[i].is_disconnect_error) {
-                    error_stats_[i].count++;
-                    error_stats_[i].last_occurrence = retry_count;
-                    found = true;
-                    break;
-                }
-            }
-            if (!found && error_stats_count_ < 10) {
-                error_stats_[error_stats_count_].error = ret;
-                error_stats_[error_stats_count_].disconnect_reason = WIFI_REASON_UNSPECIFIED;
-                error_stats_[error_stats_count_].count = 1;
-                error_stats_[error_stats_count_].last_occurrence = retry_count;
-                error_stats_[error_stats_count_].is_disconnect_error = false;
-                error_stats_count_++;
-            }
-            
-            retry_count++;
-            vTaskDelay(pdMS_TO_TICKS(1000));
-            continue;
+}
+
+ConnectHandle WifiConnectionManager::ConnectAsync(const std::string& ssid, const std::string& password,
+                                                  const ConnectOptions& options, ConnectCallback callback) {
+    Completion superseded;
+    Completion done;
+    ConnectHandle handle;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (attempt_loop_.Active()) {
+            ESP_LOGW(TAG, "Cancel pending connection to %s for new request", ssid_.c_str());
+            FinishLocked(ConnectOutcome::kCancelled, ESP_ERR_INVALID_STATE, superseded);
         }
-        ESP_LOGI(TAG, "Connecting to WiFi %s (try %d/%d)", ssid.c_str(), retry_count + 1, max_retries);
-
-        // 等待连接结果
-        EventBits_t bits = xEventGroupWaitBits(event_group_, WIFI_CONNECTED_BIT | WIFI_FAIL_BIT, pdTRUE, pdFALSE, pdMS_TO_TICKS(10000));
-        if (bits & WIFI_CONNECTED_BIT) {
-            ESP_LOGI(TAG, "Connected to WiFi %s", ssid.c_str());
-            
-            // 获取连接后的 BSSID
-            if (bssid_out != nullptr) {
-                wifi_ap_record_t ap_info;
-                if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
-                    sprintf(bssid_out, "%02x:%02x:%02x:%02x:%02x:%02x",
-                        ap_info.bssid[0], ap_info.bssid[1], ap_info.bssid[2],
-                        ap_info.bssid[3], ap_info.bssid[4], ap_info.bssid[5]);
-                    ESP_LOGI(TAG, "Connected to BSSID: %s", bssid_out);
-                } else {
-                    ESP_LOGW(TAG, "Failed to get AP info for BSSID");
-                    bssid_out[0] = '\0';  // 设置为空字符串
-                }
-            }
-            
-            is_connecting_ = false;
-            return ESP_OK;
-        } else if (bits & WIFI_FAIL_BIT) {
-            ESP_LOGE(TAG, "Failed to connect to WiFi %s (try %d/%d)", ssid.c_str(), retry_count + 1, max_retries);
-            // 统计连接失败错误
-            esp_err_t conn_error = ESP_ERR_WIFI_CONN;
-            bool found = false;
-            for (int i = 0; i < error_stats_count_; i++) {
-                if (error_stats_[i].error == conn_error) {
-                    error_stats_[i].count++;
-                    error_stats_[i].last_occurrence = retry_count;
-                    found = true;
-                    break;
-                }
-            }
-            if (!found && error_stats_count_ < 10) {
-                error_stats_[error_stats_count_].error = conn_error;
-                error_stats_[error_stats_count_].count = 1;
-                error_stats_[error_stats_count_].last_occurrence = retry_count;
-                error_stats_count_++;
-            }
+
+        const ScanInfo* scan = FindScanLocked(ssid);
+        target_rssi_ = scan != nullptr ? scan->rssi : 0;
+        uint8_t target_channel = scan != nullptr ? scan->channel : 0;
+        ConnectReport::GetInstance().Begin(ssid.c_str(), IsPskApLocked(ssid), NowMs());
+
+        handle = next_handle_++;
+        if (next_handle_ == 0) {
+            next_handle_ = 1;
+        }
+        active_handle_ = handle;
+        callback_ = std::move(callback);
+        options_ = options;
+        ssid_ = ssid;
+        bssid_[0] = '\0';
+
+        wifi_config_t wifi_config;
+        memset(&wifi_config, 0, sizeof(wifi_config));
+        if (ssid.empty() || ssid.length() > sizeof(wifi_config.sta.ssid)) {
+            ESP_LOGE(TAG, "Invalid SSID length: %u", (unsigned)ssid.length());
+            FinishLocked(ConnectOutcome::kInvalid, ESP_ERR_WIFI_SSID, done);
+        } else if (password.length() > sizeof(wifi_config.sta.password)) {
+            ESP_LOGE(TAG, "Password too long");
+            FinishLocked(ConnectOutcome::kInvalid, ESP_ERR_WIFI_PASSWORD, done);
         } else {
-            ESP_LOGE(TAG, "Connection timeout for WiFi %s (try %d/%d)", ssid.c_str(), retry_count + 1, max_retries);
-            // 统计超时错误
-            esp_err_t timeout_error = ESP_ERR_TIMEOUT;
-            bool found = false;
-            for (int i = 0; i < error_stats_count_; i++) {
-                if (error_stats_[i].error == timeout_error) {
-                    error_stats_[i].count++;
-                    error_stats_[i].last_occurrence = retry_count;
-                    found = true;
-                    break;
-                }
-            }
-            if (!found && error_stats_count_ < 10) {
-                error_stats_[error_stats_count_].error = timeout_error;
-                error_stats_[error_stats_count_].count = 1;
-                error_stats_[error_stats_count_].last_occurrence = retry_count;
-                error_stats_count_++;
+            is_connecting_ = true;
+            xEventGroupClearBits(event_group_, WIFI_CONNECTED_BIT | WIFI_FAIL_BIT);
+            RecordPhase(TimelinePhase::kRequest);
+
+            memcpy(wifi_config.sta.ssid, ssid.data(), ssid.length());
+            memcpy(wifi_config.sta.password, password.data(), password.length());
+            wifi_config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+            wifi_config.sta.failure_retry_cnt = 1;
+
+            esp_err_t ret = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "esp_wifi_set_config failed: %s", esp_err_to_name(ret));
+                FinishLocked(ConnectOutcome::kInvalid, ret, done);
+            } else {
+                RetryPolicyConfig policy;
+                policy.max_attempts = options.max_retries;
+                policy.deadline_ms = options.deadline_ms;
+                policy.retry_delay_ms = options.retry_delay_ms;
+                policy.transient_delay_ms = options.transient_delay_ms;
+                ApplyDecisionLocked(attempt_loop_.Begin(policy, options.attempt_timeout_ms, IsPskApLocked(ssid),
+                                                        target_rssi_, target_channel, NowMs()), done);
             }
         }
-        retry_count++;
-        vTaskDelay(pdMS_TO_TICKS(1000));
     }
-    
-    // 找出出现次数最多的错误，如果有重复则返回最后一次出现的
-    esp_err_t most_frequent_error = ESP_OK;
-    int max_count = 0;
-    int last_occurrence = -1;
-    
-    // 首先检查是否存在4次握手超时错误
-    bool has_handshake_timeout = false;
-    int handshake_timeout_count = 0;
-    int handshake_timeout_last_occurrence = -1;
-    
-    for (int i = 0; i < error_stats_count_; i++) {
-        if (error_stats_[i].disconnect_reason == WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT) {
-            has_handshake_timeout = true;
-            handshake_timeout_count = error_stats_[i].count;
-            handshake_timeout_last_occurrence = error_stats_[i].last_occurrence;
-            break;
+    superseded.Run();
+    done.Run();
+    return handle;
+}
+
+bool WifiConnectionManager::Cancel(ConnectHandle handle) {
+    Completion done;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (handle == 0 || handle != active_handle_) {
+            return false;
         }
+        ESP_LOGI(TAG, "Connection to %s cancelled", ssid_.c_str());
+        FinishLocked(ConnectOutcome::kCancelled, ESP_ERR_INVALID_STATE, done);
+        esp_wifi_disconnect();
     }
-    
-    // 首先检查是否存在密码相关错误
-    bool has_password_error = false;
-    int password_error_count = 0;
-    int password_error_last_occurrence = -1;
-    
-    for (int i = 0; i < error_stats_count_; i++) {
-        if (error_stats_[i].is_disconnect_error) {
-            // 检查是否为密码相关错误
-            if (error_stats_[i].disconnect_reason == WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT ||
-                error_stats_[i].disconnect_reason == WIFI_REASON_AUTH_FAIL ||
-                error_stats_[i].disconnect_reason == WIFI_REASON_MIC_FAILURE ||
-                error_stats_[i].disconnect_reason == WIFI_REASON_CIPHER_SUITE_REJECTED) {
-                has_password_error = true;
-                password_error_count += error_stats_[i].count;
-                if (error_stats_[i].last_occurrence > password_error_last_occurrence) {
-                    password_error_last_occurrence = error_stats_[i].last_occurrence;
-                }
-            }
+    done.Run();
+    return true;
+}
+
+ConnectStatus WifiConnectionManager::GetStatus(ConnectHandle handle) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (handle == 0) {
+        return ConnectStatus::kInvalid;
+    }
+    if (handle == active_handle_) {
+        return ConnectStatus::kPending;
+    }
+    for (const auto& entry : history_) {
+        if (entry.handle == handle) {
+            return entry.status;
         }
     }
-    
-    // 如果存在密码相关错误，优先返回
-    if (has_password_error) {
-        most_frequent_error = ESP_ERR_WIFI_PASSWORD_INCORRECT;  // 返回密码错误码
-        max_count = password_error_count;
-        last_occurrence = password_error_last_occurrence;
-        ESP_LOGI(TAG, "Found password-related errors, returning password error");
-    } else {
-        // 如果没有4次握手超时，则按原逻辑选择最频繁的错误
-        for (int i = 0; i < error_stats_count_; i++) {
-            if (error_stats_[i].count > max_count || 
-                (error_stats_[i].count == max_count && error_stats_[i].last_occurrence > last_occurrence)) {
-                max_count = error_stats_[i].count;
-                last_occurrence = error_stats_[i].last_occurrence;
-                most_frequent_error = error_stats_[i].error;
-            }
+    return ConnectStatus::kInvalid;
+}
+
+esp_err_t WifiConnectionManager::Connect(const std::string& ssid, const std::string& password, char* bssid_out) {
+    StaticSemaphore_t done_buffer;
+    SemaphoreHandle_t done = xSemaphoreCreateBinaryStatic(&done_buffer);
+    esp_err_t result = ESP_FAIL;
+    char bssid[18] = {};
+
+    ConnectAsync(ssid, password, ConnectOptions(), [&](esp_err_t r, const char* b) {
+        result = r;
+        snprintf(bssid, sizeof(bssid), "%s", b);
+        xSemaphoreGive(done);
+    });
+    // 所有路径都有超时兜底，回调一定会被调用
+    xSemaphoreTake(done, portMAX_DELAY);
+    vSemaphoreDelete(done);
+
+    if (result == ESP_OK && bssid_out != nullptr) {
+        strcpy(bssid_out, bssid);
+    }
+    return result;
+}
+
+esp_err_t WifiConnectionManager::StartConnect() {
+    RecordPhase(TimelinePhase::kConnectStart);
+    xEventGroupClearBits(event_group_, WIFI_CONNECTED_BIT | WIFI_FAIL_BIT);
+    esp_err_t ret = esp_wifi_connect();
+    if (ret != ESP_OK) {
+        // 详细处理esp_wifi_connect()的错误码
+        const char* error_str = "Unknown error";
+        switch (ret) {
+            case ESP_ERR_WIFI_NOT_INIT:
+                error_str = "WiFi not initialized";
+                break;
+            case ESP_ERR_WIFI_NOT_STARTED:
+                error_str = "WiFi not started";
+                break;
+            case ESP_ERR_WIFI_CONN:
+                error_str = "WiFi connection failed";
+                break;
+            case ESP_ERR_WIFI_SSID:
+                error_str = "Invalid SSID";
+                break;
+            case ESP_ERR_WIFI_PASSWORD:
+                error_str = "Invalid password";
+                break;
+            case ESP_ERR_WIFI_NVS:
+                error_str = "WiFi NVS error";
+                break;
+            case ESP_ERR_WIFI_MODE:
+                error_str = "WiFi mode error";
+                break;
+            case ESP_ERR_WIFI_STATE:
+                error_str = "WiFi state error";
+                break;
+            default:
+                error_str = esp_err_to_name(ret);
+                break;
         }
+        ESP_LOGE(TAG, "esp_wifi_connect() failed: %s (code: %d)", error_str, ret);
+        return ret;
     }
-    
-    // 打印错误统计信息
-    ESP_LOGI(TAG, "Error statistics after %d retries:", max_retries);
-    for (int i = 0; i < error_stats_count_; i++) {
-        if (error_stats_[i].is_disconnect_error) {
-            ESP_LOGI(TAG, "  Disconnect error: 0x%x (reason: %d - %s), %d times, last at retry %d", 
-                     error_stats_[i].error, error_stats_[i].disconnect_reason, 
-                     GetDisconnectReasonString(error_stats_[i].disconnect_reason),
-                     error_stats_[i].count, error_stats_[i].last_occurrence);
-        } else {
-            ESP_LOGI(TAG, "  Connect error: 0x%x, %d times, last at retry %d", 
-                     error_stats_[i].error, error_stats_[i].count, error_stats_[i].last_occurrence);
+    ESP_LOGI(TAG, "Connecting to WiFi %s (try %d/%d)", ssid_.c_str(), attempt_loop_.attempts() + 1,
+             options_.max_retries);
+    return ESP_OK;
+}
+
+void WifiConnectionManager::ApplyDecisionLocked(const RetryDecision& decision, Completion& done) {
+    if (decision.verdict == RetryVerdict::kRetry) {
+        return;
+    }
+
+    ESP_LOGW(TAG, "Stop connecting to %s after %d tries: %s", ssid_.c_str(), attempt_loop_.attempts(),
+             RetryVerdictName(decision.verdict));
+    esp_err_t result = ResolveError();
+    ConnectOutcome outcome = ConnectOutcome::kExhausted;
+    switch (decision.verdict) {
+        case RetryVerdict::kWrongPassword:
+            outcome = ConnectOutcome::kWrongPassword;
+            result = ESP_ERR_WIFI_PASSWORD_INCORRECT;
+            break;
+        case RetryVerdict::kIncompatible:
+            outcome = ConnectOutcome::kIncompatible;
+            break;
+        case RetryVerdict::kDeadline:
+            outcome = ConnectOutcome::kDeadline;
+            break;
+        default:
+            break;
+    }
+    FinishLocked(outcome, result, done);
+}
+
+const WifiConnectionManager::ScanInfo* WifiConnectionManager::FindScanLocked(const std::string& ssid) const {
+    for (const auto& info : scan_info_) {
+        if (info.ssid == ssid) {
+            return &info;
         }
     }
-    
-    if (has_password_error) {
-        ESP_LOGI(TAG, "Returning password error: 0x%x (password-related errors, occurred %d times)", 
-                 most_frequent_error, max_count);
-    } else {
-        ESP_LOGI(TAG, "Returning most frequent error: 0x%x (occurred %d times)", 
-                 most_frequent_error, max_count);
+    return nullptr;
+}
+
+bool WifiConnectionManager::IsPskApLocked(const std::string& ssid) const {
+    const ScanInfo* info = FindScanLocked(ssid);
+    if (info == nullptr) {
+        return false;
     }
-    
+    return info->authmode == WIFI_AUTH_WPA_PSK || info->authmode == WIFI_AUTH_WPA2_PSK ||
+           info->authmode == WIFI_AUTH_WPA_WPA2_PSK || info->authmode == WIFI_AUTH_WPA2_WPA3_PSK;
+}
+
+void WifiConnectionManager::ArmTimer(uint32_t ms) {
+    esp_timer_stop(attempt_timer_);
+    esp_timer_start_once(attempt_timer_, (uint64_t)ms * 1000);
+}
+
+void WifiConnectionManager::StopTimer() {
+    esp_timer_stop(attempt_timer_);
+}
+
+void WifiConnectionManager::FinishLocked(ConnectOutcome outcome, esp_err_t result, Completion& done) {
+    ConnectStatus status = ConnectStatus::kFailed;
+    if (outcome == ConnectOutcome::kConnected) {
+        status = ConnectStatus::kConnected;
+    } else if (outcome == ConnectOutcome::kCancelled) {
+        status = ConnectStatus::kCancelled;
+    }
+    ConnectReport::GetInstance().Finish(outcome, result, NowMs());
+
+    attempt_loop_.Stop();
     is_connecting_ = false;
+    RememberStatus(active_handle_, status);
+    active_handle_ = 0;
+
+    done.callback = std::move(callback_);
+    callback_ = nullptr;
+    done.result = result;
+    if (status == ConnectStatus::kConnected) {
+        strcpy(done.bssid, bssid_);
+    }
+}
+
+void WifiConnectionManager::OnAttemptTimer() {
+    Completion done;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ApplyDecisionLocked(attempt_loop_.OnTimer(NowMs()), done);
+    }
+    done.Run();
+}
+
+void WifiConnectionManager::RememberStatus(ConnectHandle handle, ConnectStatus status) {
+    history_[history_next_].handle = handle;
+    history_[history_next_].status = status;
+    history_next_ = (history_next_ + 1) % kStatusHistory;
+}
+
+esp_err_t WifiConnectionManager::ResolveError() const {
+    ConnectRecord record;
+    if (!ConnectReport::GetInstance().GetCurrent(&record)) {
+        return ESP_FAIL;
+    }
+    size_t attempt_count = std::min<size_t>(record.attempt_count, ConnectRecord::kMaxAttempts);
+
+    // 打印每次尝试的结果
+    ESP_LOGI(TAG, "Connect report after %d tries:", record.attempt_count);
+    for (size_t i = 0; i < attempt_count; i++) {
+        const AttemptRecord& attempt = record.attempts[i];
+        ESP_LOGI(TAG, "  #%u %s, error 0x%x, reason %d (%s), rssi %d, channel %d, wait %u ms, took %u ms",
+                 (unsigned)i, AttemptOutcomeName(attempt.outcome), attempt.error, attempt.reason,
+                 DisconnectReasonString(attempt.reason), attempt.rssi, attempt.channel,
+                 attempt.wait_ms, attempt.duration_ms);
+    }
+
+    // 存在密码相关的断开原因时优先返回密码错误
+    for (size_t i = 0; i < attempt_count; i++) {
+        uint8_t reason = record.attempts[i].reason;
+        if (reason == WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT || reason == WIFI_REASON_AUTH_FAIL ||
+            reason == WIFI_REASON_MIC_FAILURE || reason == WIFI_REASON_CIPHER_SUITE_REJECTED) {
+            ESP_LOGI(TAG, "Found password-related errors, returning password error");
+            return ESP_ERR_WIFI_PASSWORD_INCORRECT;
+        }
+    }
+
+    // 找出出现次数最多的错误，次数相同时取最后出现的
+    esp_err_t most_frequent_error = ESP_FAIL;
+    int max_count = 0;
+    for (size_t i = attempt_count; i-- > 0;) {
+        uint16_t error = record.attempts[i].error;
+        if (error == 0) {
+            continue;
+        }
+        int count = 0;
+        for (size_t j = 0; j < attempt_count; j++) {
+            count += record.attempts[j].error == error;
+        }
+        if (count > max_count) {
+            max_count = count;
+            most_frequent_error = error;
+        }
+    }
+    ESP_LOGI(TAG, "Returning most frequent error: 0x%x (occurred %d times)", most_frequent_error, max_count);
     return most_frequent_error;
 }
 
@@ -416,265 +527,116 @@ void WifiConnectionManager::SaveCredentials(const std::string& ssid, const std::
 void WifiConnectionManager::WifiEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
     WifiConnectionManager* self = static_cast<WifiConnectionManager*>(arg);
     if (event_id == WIFI_EVENT_STA_START) {
-        // 启动周期性扫描定时器（首次扫描周期5秒，后续10秒）
-        self->StartScanTimer();
+        // 启动后先扫一次，配网客户端连上时已有列表可用；之后只按需和后台低频刷新
+        self->RequestScan();
     } else if (event_id == WIFI_EVENT_STA_CONNECTED) {
+        auto* connected_data = (wifi_event_sta_connected_t*)event_data;
+        RecordPhase(TimelinePhase::kConnected, connected_data->channel);
         xEventGroupSetBits(self->event_group_, WIFI_CONNECTED_BIT);
+
+        Completion done;
+        {
+            std::lock_guard<std::mutex> lock(self->mutex_);
+            if (self->attempt_loop_.phase() == ConnectAttemptLoop::Phase::kWaiting) {
+                snprintf(self->bssid_, sizeof(self->bssid_), "%02x:%02x:%02x:%02x:%02x:%02x",
+                    connected_data->bssid[0], connected_data->bssid[1], connected_data->bssid[2],
+                    connected_data->bssid[3], connected_data->bssid[4], connected_data->bssid[5]);
+                ESP_LOGI(TAG, "Connected to WiFi %s, BSSID: %s", self->ssid_.c_str(), self->bssid_);
+                wifi_ap_record_t ap_info;
+                int8_t rssi = esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK ? ap_info.rssi : self->target_rssi_;
+                self->attempt_loop_.OnConnected(rssi, connected_data->channel, NowMs());
+                self->FinishLocked(ConnectOutcome::kConnected, ESP_OK, done);
+            }
+        }
+        done.Run();
     } else if (event_id == WIFI_EVENT_STA_DISCONNECTED) {
         // 获取断开连接的具体原因
         wifi_event_sta_disconnected_t* disconnected_data = (wifi_event_sta_disconnected_t*)event_data;
+        RecordPhase(TimelinePhase::kDisconnected, disconnected_data->reason);
         ESP_LOGE(TAG, "WiFi disconnected, reason: %d", disconnected_data->reason);
         
-        // 记录断开原因到错误统计中
-        bool found = false;
-        for (int i = 0; i < self->error_stats_count_; i++) {
-            if (self->error_stats_[i].disconnect_reason == static_cast<wifi_err_reason_t>(disconnected_data->reason) && 
-                self->error_stats_[i].is_disconnect_error) {
-                self->error_stats_[i].count++;
-                self->error_stats_[i].last_occurrence = self->current_retry_count_;
-                found = true;
-                break;
+        ESP_LOGE(TAG, "WiFi disconnect reason: %s (code: %d)", DisconnectReasonString(disconnected_data->reason),
+            disconnected_data->reason);
+        xEventGroupSetBits(self->event_group_, WIFI_FAIL_BIT);
+
+        Completion done;
+        {
+            std::lock_guard<std::mutex> lock(self->mutex_);
+            if (self->attempt_loop_.phase() == ConnectAttemptLoop::Phase::kWaiting) {
+                ESP_LOGE(TAG, "Failed to connect to WiFi %s (try %d/%d)", self->ssid_.c_str(),
+                         self->attempt_loop_.attempts() + 1, self->options_.max_retries);
             }
+            // 重试间隔中到达的是超时之后的断开原因，由尝试循环补充到上一次尝试
+            self->ApplyDecisionLocked(self->attempt_loop_.OnDisconnect(disconnected_data->reason,
+                                                                       disconnected_data->rssi, NowMs()), done);
         }
-        if (!found && self->error_stats_count_ < 10) {
-            self->error_stats_[self->error_stats_count_].error = ESP_ERR_WIFI_CONN;
-            self->error_stats_[self->error_stats_count_].disconnect_reason = static_cast<wifi_err_reason_t>(disconnected_data->reason);
-            self->error_stats_[self->error_stats_count_].count = 1;
-            self->error_stats_[self->error_stats_count_].last_occurrence = self->current_retry_count_;
-            self->error_stats_[self->error_stats_count_].is_disconnect_error = true;
-            self->error_stats_count_++;
-        }
-        
-        // 根据错误码提供更详细的错误信息
-        const char* reason_str = "Unknown";
-        switch (disconnected_data->reason) {
-            case WIFI_REASON_UNSPECIFIED:
-                reason_str = "Unspecified reason";
-                break;
-            case WIFI_REASON_AUTH_EXPIRE:
-                reason_str = "Authentication expired";
-                break;
-            case WIFI_REASON_AUTH_LEAVE:
-                reason_str = "Authentication left";
-                break;
-            case WIFI_REASON_ASSOC_EXPIRE:
-                reason_str = "Association expired";
-                break;
-            case WIFI_REASON_ASSOC_TOOMANY:
-                reason_str = "Too many associations";
-                break;
-            case WIFI_REASON_NOT_AUTHED:
-                reason_str = "Not authenticated";
-                break;
-            case WIFI_REASON_NOT_ASSOCED:
-                reason_str = "Not associated";
-                break;
-            case WIFI_REASON_ASSOC_LEAVE:
-                reason_str = "Association left";
-                break;
-            case WIFI_REASON_ASSOC_NOT_AUTHED:
-                reason_str = "Associated but not authenticated";
-                break;
-            case WIFI_REASON_DISASSOC_PWRCAP_BAD:
-                reason_str = "Power capability mismatch";
-                break;
-            case WIFI_REASON_DISASSOC_SUPCHAN_BAD:
-                reason_str = "Supported channel mismatch";
-                break;
-            case WIFI_REASON_BSS_TRANSITION_DISASSOC:
-                reason_str = "BSS transition disassociation";
-                break;
-            case WIFI_REASON_IE_INVALID:
-                reason_str = "Invalid IE";
-                break;
-            case WIFI_REASON_MIC_FAILURE:
-                reason_str = "MIC failure";
-                break;
-            case WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT:
-                reason_str = "4-way handshake timeout";
-                break;
-            case WIFI_REASON_GROUP_KEY_UPDATE_TIMEOUT:
-                reason_str = "Group key update timeout";
-                break;
-            case WIFI_REASON_IE_IN_4WAY_DIFFERS:
-                reason_str = "4-way handshake IE differs";
-                break;
-            case WIFI_REASON_GROUP_CIPHER_INVALID:
-                reason_str = "Group cipher invalid";
-                break;
-            case WIFI_REASON_PAIRWISE_CIPHER_INVALID:
-                reason_str = "Pairwise cipher invalid";
-                break;
-            case WIFI_REASON_AKMP_INVALID:
-                reason_str = "AKMP invalid";
-                break;
-            case WIFI_REASON_UNSUPP_RSN_IE_VERSION:
-                reason_str = "Unsupported RSN IE version";
-                break;
-            case WIFI_REASON_INVALID_RSN_IE_CAP:
-                reason_str = "Invalid RSN IE capability";
-                break;
-            case WIFI_REASON_802_1X_AUTH_FAILED:
-                reason_str = "802.1x authentication failed";
-                break;
-            case WIFI_REASON_CIPHER_SUITE_REJECTED:
-                reason_str = "Cipher suite rejected";
-                break;
-            case WIFI_REASON_TDLS_PEER_UNREACHABLE:
-                reason_str = "TDLS peer unreachable";
-                break;
-            case WIFI_REASON_TDLS_UNSPECIFIED:
-                reason_str = "TDLS unspecified";
-                break;
-            case WIFI_REASON_SSP_REQUESTED_DISASSOC:
-                reason_str = "SSP requested disassociation";
-                break;
-            case WIFI_REASON_NO_SSP_ROAMING_AGREEMENT:
-                reason_str = "No SSP roaming agreement";
-                break;
-            case WIFI_REASON_BAD_CIPHER_OR_AKM:
-                reason_str = "Bad cipher or AKM";
-                break;
-            case WIFI_REASON_NOT_AUTHORIZED_THIS_LOCATION:
-                reason_str = "Not authorized for this location";
-                break;
-            case WIFI_REASON_SERVICE_CHANGE_PERCLUDES_TS:
-                reason_str = "Service change precludes TS";
-                break;
-            case WIFI_REASON_UNSPECIFIED_QOS:
-                reason_str = "Unspecified QoS";
-                break;
-            case WIFI_REASON_NOT_ENOUGH_BANDWIDTH:
-                reason_str = "Not enough bandwidth";
-                break;
-            case WIFI_REASON_MISSING_ACKS:
-                reason_str = "Missing ACKs";
-                break;
-            case WIFI_REASON_EXCEEDED_TXOP:
-                reason_str = "Exceeded TXOP";
-                break;
-            case WIFI_REASON_STA_LEAVING:
-                reason_str = "Station leaving";
-                break;
-            case WIFI_REASON_END_BA:
-                reason_str = "End BA";
-                break;
-            case WIFI_REASON_UNKNOWN_BA:
-                reason_str = "Unknown BA";
-                break;
-            case WIFI_REASON_TIMEOUT:
-                reason_str = "Timeout";
-                break;
-            case WIFI_REASON_PEER_INITIATED:
-                reason_str = "Peer initiated";
-                break;
-            case WIFI_REASON_AP_INITIATED:
-                reason_str = "AP initiated";
-                break;
-            case WIFI_REASON_INVALID_FT_ACTION_FRAME_COUNT:
-                reason_str = "Invalid FT action frame count";
-                break;
-            case WIFI_REASON_INVALID_PMKID:
-                reason_str = "Invalid PMKID";
-                break;
-            case WIFI_REASON_INVALID_MDE:
-                reason_str = "Invalid MDE";
-                break;
-            case WIFI_REASON_INVALID_FTE:
-                reason_str = "Invalid FTE";
-                break;
-            case WIFI_REASON_TRANSMISSION_LINK_ESTABLISH_FAILED:
-                reason_str = "Transmission link establish failed";
-                break;
-            case WIFI_REASON_ALTERATIVE_CHANNEL_OCCUPIED:
-                reason_str = "Alternative channel occupied";
-                break;
-            case WIFI_REASON_BEACON_TIMEOUT:
-                reason_str = "Beacon timeout";
-                break;
-            case WIFI_REASON_NO_AP_FOUND:
-                reason_str = "No AP found";
-                break;
-            case WIFI_REASON_AUTH_FAIL:
-                reason_str = "Authentication failed";
-                break;
-            case WIFI_REASON_ASSOC_FAIL:
-                reason_str = "Association failed";
-                break;
-            case WIFI_REASON_HANDSHAKE_TIMEOUT:
-                reason_str = "Handshake timeout";
-                break;
-            case WIFI_REASON_CONNECTION_FAIL:
-                reason_str = "Connection failed";
-                break;
-            case WIFI_REASON_AP_TSF_RESET:
-                reason_str = "AP TSF reset";
-                break;
-            case WIFI_REASON_ROAMING:
-                reason_str = "Roaming";
-                break;
-            case WIFI_REASON_ASSOC_COMEBACK_TIME_TOO_LONG:
-                reason_str = "Association comeback time too long";
-                break;
-            case WIFI_REASON_SA_QUERY_TIMEOUT:
-                reason_str = "SA query timeout";
-                break;
-            case WIFI_REASON_NO_AP_FOUND_W_COMPATIBLE_SECURITY:
-                reason_str = "No AP found with compatible security";
-                break;
-            case WIFI_REASON_NO_AP_FOUND_IN_AUTHMODE_THRESHOLD:
-                reason_str = "No AP found in authmode threshold";
-                break;
-            case WIFI_REASON_NO_AP_FOUND_IN_RSSI_THRESHOLD:
-                reason_str = "No AP found in RSSI threshold";
-                break;
-            default:
-                reason_str = "Unknown reason";
-                break;
-        }
-        
-        ESP_LOGE(TAG, "WiFi disconnect reason: %s (code: %d)", reason_str, disconnected_data->reason);
-        xEventGroupSetBits(self->event_group_, WIFI_FAIL_BIT);
+        done.Run();
     } else if (event_id == WIFI_EVENT_SCAN_DONE) {
         // 新增：保存扫描到的所有 SSID，按 rssi 降序排序，并回调上层
+        auto* scan_done = static_cast<wifi_event_sta_scan_done_t*>(event_data);
+        {
+            std::lock_guard<std::mutex> lock(self->mutex_);
+            // WifiStation 的定向扫描、漫游扫描等也会产生 SCAN_DONE：不是自己发起的扫描不合并，
+            // 也不取记录，esp_wifi_scan_get_ap_records 会释放发起方还要读的结果
+            if (!self->scan_demand_.OnDone(scan_done->status == 0, NowMs())) {
+                return;
+            }
+            self->ArmBackgroundScanLocked();
+            ESP_LOGD(TAG, "Scan done, %" PRIu32 " started, %" PRIu32 " requests coalesced",
+                     self->scan_demand_.started(), self->scan_demand_.coalesced());
+        }
         uint16_t ap_num = 0;
         std::vector<SsidRssiItem> scan_ssid_rssi_list;
         std::vector<std::string> ssid_list;
-        if (esp_wifi_scan_get_ap_num(&ap_num) == ESP_OK && ap_num > 0) {
-            std::vector<wifi_ap_record_t> ap_records(ap_num);
-            if (esp_wifi_scan_get_ap_records(&ap_num, ap_records.data()) == ESP_OK) {
-                // 按 rssi 降序排序
-                std::sort(ap_records.begin(), ap_records.end(), [](const wifi_ap_record_t& a, const wifi_ap_record_t& b) {
-                    return a.rssi > b.rssi;
-                });
-                // 只保留前 MAX_WIFI_SCAN_SSID_COUNT 个
-                int count = std::min<int>(ap_num, MAX_WIFI_SCAN_SSID_COUNT);
-                for (int i = 0; i < count; ++i) {
-                    std::string ssid(reinterpret_cast<char*>(ap_records[i].ssid));
-                    scan_ssid_rssi_list.emplace_back(ssid, ap_records[i].rssi);
-                    ssid_list.emplace_back(ssid);
+        esp_err_t ap_num_ret = esp_wifi_scan_get_ap_num(&ap_num);
+        RecordPhase(TimelinePhase::kScanDone, ap_num);
+        if (ap_num_ret == ESP_OK) {
+            // 记录缓冲区跨扫描复用，只在 AP 数变多时重新分配
+            auto& ap_records = self->scan_records_;
+            ap_records.resize(std::min<size_t>(ap_num, ScanCache::kCapacity));
+            ap_num = ap_records.size();
+            // 取回记录同时释放驱动中的扫描结果
+            if (ap_num == 0 || esp_wifi_scan_get_ap_records(&ap_num, ap_records.data()) == ESP_OK) {
+                // 被连接打断的扫描结果不完整，不参与老化，否则会把没扫到的网络误判为消失
+                if (scan_done->status == 0) {
+                    self->scan_cache_.Merge(ap_records.data(), ap_num, NowMs());
+                } else {
+                    ESP_LOGD(TAG, "Scan incomplete, keeping cached results");
                 }
             }
         }
+
+        // 列表来自缓存而不是本次扫描：RSSI 经过平滑，偶尔漏扫的网络也会保留
+        // 每个 SSID 只保留最强的 BSSID，隐藏网络不列出，取最强的 MAX_WIFI_SCAN_SSID_COUNT 个
+        static_assert(ScanCache::kCapacity <= ScanTopK::kMaxRecords, "cache must fit the selector");
+        auto cached = self->scan_cache_.Records();
+        auto& topk = self->scan_topk_;
+        size_t group_count = topk.Select(cached.data(), cached.size(), MAX_WIFI_SCAN_SSID_COUNT);
+        ESP_LOGD(TAG, "Scan: %u records, %u cached, %u SSIDs, %u hidden", ap_num, (unsigned)cached.size(),
+                 (unsigned)group_count, (unsigned)topk.hidden_count());
+        {
+            std::lock_guard<std::mutex> lock(self->mutex_);
+            self->scan_info_.clear();
+            self->scan_top_count_ = topk.Top().size();
+            for (const auto& group : topk.Groups()) {
+                const auto& record = cached[group.index];
+                self->scan_info_.push_back({reinterpret_cast<const char*>(record.ssid), record.authmode,
+                                            record.rssi, record.primary});
+            }
+        }
+        scan_ssid_rssi_list.reserve(topk.Top().size());
+        ssid_list.reserve(topk.Top().size());
+        for (const auto& group : topk.Top()) {
+            std::string ssid(reinterpret_cast<const char*>(cached[group.index].ssid));
+            scan_ssid_rssi_list.emplace_back(ssid, group.rssi, group.bssid_count);
+            ssid_list.emplace_back(std::move(ssid));
+        }
         // 保存带RSSI的扫描结果
         SsidManager::GetInstance().ScanSsidRssiList(scan_ssid_rssi_list);
         // 回调仅包含 SSID 列表，供上层快速判断
         if (self->on_scan_results_) {
             self->on_scan_results_(ssid_list);
         }
-        
-        // 如果是首次扫描完成，调整扫描周期
-        if (!self->first_scan_done_ && !ssid_list.empty()) {
-            self->first_scan_done_ = true;
-            ESP_LOGI(TAG, "First scan completed with %zu SSIDs, adjusting scan period to 10 seconds", ssid_list.size());
-            
-            // 重新配置定时器周期为10秒
-            if (self->scan_timer_) {
-                esp_timer_stop(self->scan_timer_);
-                ESP_ERROR_CHECK(esp_timer_start_periodic(self->scan_timer_, 10 * 1000000));  // 10秒
-            }
-        }
-        
     }
 }
 
@@ -719,135 +681,9 @@ void WifiConnectionManager::IpEventHandler(void* arg, esp_event_base_t event_bas
     WifiConnectionManager* self = static_cast<WifiConnectionManager*>(arg);
     if (event_id == IP_EVENT_STA_GOT_IP) {
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
+        RecordPhase(TimelinePhase::kGotIp);
         ESP_LOGI(TAG, "Got IP:" IPSTR, IP2STR(&event->ip_info.ip));
         xEventGroupSetBits(self->event_group_, WIFI_CONNECTED_BIT);
     }
 }
-
-// 静态函数：将WiFi断开原因码转换为可读的错误信息
-const char* WifiConnectionManager::GetDisconnectReasonString(wifi_err_reason_t reason) {
-    switch (reason) {
-        case WIFI_REASON_UNSPECIFIED:
-            return "Unspecified reason";
-        case WIFI_REASON_AUTH_EXPIRE:
-            return "Authentication expired";
-        case WIFI_REASON_AUTH_LEAVE:
-            return "Authentication left";
-        case WIFI_REASON_ASSOC_EXPIRE:
-            return "Association expired";
-        case WIFI_REASON_ASSOC_TOOMANY:
-            return "Too many associations";
-        case WIFI_REASON_NOT_AUTHED:
-            return "Not authenticated";
-        case WIFI_REASON_NOT_ASSOCED:
-            return "Not associated";
-        case WIFI_REASON_ASSOC_LEAVE:
-            return "Association left";
-        case WIFI_REASON_ASSOC_NOT_AUTHED:
-            return "Associated but not authenticated";
-        case WIFI_REASON_DISASSOC_PWRCAP_BAD:
-            return "Power capability mismatch";
-        case WIFI_REASON_DISASSOC_SUPCHAN_BAD:
-            return "Supported channel mismatch";
-        case WIFI_REASON_BSS_TRANSITION_DISASSOC:
-            return "BSS transition disassociation";
-        case WIFI_REASON_IE_INVALID:
-            return "Invalid IE";
-        case WIFI_REASON_MIC_FAILURE:
-            return "MIC failure";
-        case WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT:
-            return "4-way handshake timeout";
-        case WIFI_REASON_GROUP_KEY_UPDATE_TIMEOUT:
-            return "Group key update timeout";
-        case WIFI_REASON_IE_IN_4WAY_DIFFERS:
-            return "4-way handshake IE differs";
-        case WIFI_REASON_GROUP_CIPHER_INVALID:
-            return "Group cipher invalid";
-        case WIFI_REASON_PAIRWISE_CIPHER_INVALID:
-            return "Pairwise cipher invalid";
-        case WIFI_REASON_AKMP_INVALID:
-            return "AKMP invalid";
-        case WIFI_REASON_UNSUPP_RSN_IE_VERSION:
-            return "Unsupported RSN IE version";
-        case WIFI_REASON_INVALID_RSN_IE_CAP:
-            return "Invalid RSN IE capability";
-        case WIFI_REASON_802_1X_AUTH_FAILED:
-            return "802.1x authentication failed";
-        case WIFI_REASON_CIPHER_SUITE_REJECTED:
-            return "Cipher suite rejected";
-        case WIFI_REASON_TDLS_PEER_UNREACHABLE:
-            return "TDLS peer unreachable";
-        case WIFI_REASON_TDLS_UNSPECIFIED:
-            return "TDLS unspecified";
-        case WIFI_REASON_SSP_REQUESTED_DISASSOC:
-            return "SSP requested disassociation";
-        case WIFI_REASON_NO_SSP_ROAMING_AGREEMENT:
-            return "No SSP roaming agreement";
-        case WIFI_REASON_BAD_CIPHER_OR_AKM:
-            return "Bad cipher or AKM";
-        case WIFI_REASON_NOT_AUTHORIZED_THIS_LOCATION:
-            return "Not authorized for this location";
-        case WIFI_REASON_SERVICE_CHANGE_PERCLUDES_TS:
-            return "Service change precludes TS";
-        case WIFI_REASON_UNSPECIFIED_QOS:
-            return "Unspecified QoS";
-        case WIFI_REASON_NOT_ENOUGH_BANDWIDTH:
-            return "Not enough bandwidth";
-        case WIFI_REASON_MISSING_ACKS:
-            return "Missing ACKs";
-        case WIFI_REASON_EXCEEDED_TXOP:
-            return "Exceeded TXOP";
-        case WIFI_REASON_STA_LEAVING:
-            return "Station leaving";
-        case WIFI_REASON_END_BA:
-            return "End BA";
-        case WIFI_REASON_UNKNOWN_BA:
-            return "Unknown BA";
-        case WIFI_REASON_TIMEOUT:
-            return "Timeout";
-        case WIFI_REASON_PEER_INITIATED:
-            return "Peer initiated";
-        case WIFI_REASON_AP_INITIATED:
-            return "AP initiated";
-        case WIFI_REASON_INVALID_FT_ACTION_FRAME_COUNT:
-            return "Invalid FT action frame count";
-        case WIFI_REASON_INVALID_PMKID:
-            return "Invalid PMKID";
-        case WIFI_REASON_INVALID_MDE:
-            return "Invalid MDE";
-        case WIFI_REASON_INVALID_FTE:
-            return "Invalid FTE";
-        case WIFI_REASON_TRANSMISSION_LINK_ESTABLISH_FAILED:
-            return "Transmission link establish failed";
-        case WIFI_REASON_ALTERATIVE_CHANNEL_OCCUPIED:
-            return "Alternative channel occupied";
-        case WIFI_REASON_BEACON_TIMEOUT:
-            return "Beacon timeout";
-        case WIFI_REASON_NO_AP_FOUND:
-            return "No AP found";
-        case WIFI_REASON_AUTH_FAIL:
-            return "Authentication failed";
-        case WIFI_REASON_ASSOC_FAIL:
-            return "Association failed";
-        case WIFI_REASON_HANDSHAKE_TIMEOUT:
-            return "Handshake timeout";
-        case WIFI_REASON_CONNECTION_FAIL:
-            return "Connection failed";
-        case WIFI_REASON_AP_TSF_RESET:
-            return "AP TSF reset";
-        case WIFI_REASON_ROAMING:
-            return "Roaming";
-        case WIFI_REASON_ASSOC_COMEBACK_TIME_TOO_LONG:
-            return "Association comeback time too long";
-        case WIFI_REASON_SA_QUERY_TIMEOUT:
-            return "SA query timeout";
-        case WIFI_REASON_NO_AP_FOUND_W_COMPATIBLE_SECURITY:
-            return "No AP found with compatible security";
-        case WIFI_REASON_NO_AP_FOUND_IN_AUTHMODE_THRESHOLD:
-            return "No AP found in authmode threshold";
-        case WIFI_REASON_NO_AP_FOUND_IN_RSSI_THRESHOLD:
-            return "No AP found in RSSI threshold";
-        default:
-            return "Unknown reason";
-    }
-} 
\ No newline at end of file
+ 
\ No newline at end of file
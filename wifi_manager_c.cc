@@ -69,4 +69,8 @@ void WifiConnectionManager_SaveServerUrl(const char* server_url) {
     WifiConnectionManager::GetInstance().SaveServerUrl(std::string(server_url ? server_url : ""));
 }
 
+void WifiConnectionManager_RequestScan(void) {
+    WifiConnectionManager::GetInstance().RequestScan();
+}
+
 } // extern "C" 
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "wifi_roaming.h"
+
+#include <cstring>
+
+// Neighbor Report 元素：ID 52，内容为 BSSID(6) + BSSID Info(4) + Operating Class(1) + Channel(1) + PHY Type(1) + 子元素
+#define NEIGHBOR_REPORT_ELEMENT_ID 52
+#define NEIGHBOR_REPORT_MIN_LEN 13
+#define NEIGHBOR_REPORT_CHANNEL_OFFSET 11
+
+bool RoamingPolicy::CanRoam(uint32_t now_ms) const {
+    if (roaming_) {
+        return false;
+    }
+    return !has_roamed_ || now_ms - last_roam_ms_ >= config_.min_dwell_ms;
+}
+
+void RoamingPolicy::OnRoamStart(uint32_t now_ms) {
+    roaming_ = true;
+    roam_start_ms_ = now_ms;
+}
+
+void RoamingPolicy::OnRoamDone(bool success, uint32_t now_ms) {
+    if (!roaming_) {
+        return;
+    }
+    roaming_ = false;
+    // 失败也计入驻留时间，避免对同一个 AP 反复尝试
+    has_roamed_ = true;
+    last_roam_ms_ = now_ms;
+    if (!success) {
+        stats_.failures++;
+        return;
+    }
+    uint32_t latency = now_ms - roam_start_ms_;
+    stats_.roams++;
+    stats_.last_latency_ms = latency;
+    if (latency > stats_.max_latency_ms) {
+        stats_.max_latency_ms = latency;
+    }
+    // 累计平均
+    stats_.avg_latency_ms = (uint32_t)(((uint64_t)stats_.avg_latency_ms * (stats_.roams - 1) + latency) / stats_.roams);
+}
+
+size_t RoamingPolicy::ParseNeighborChannels(const uint8_t* report, size_t report_len, uint8_t* channels, size_t max_channels) {
+    size_t count = 0;
+    size_t pos = 0;
+    while (pos + 2 <= report_len && count < max_channels) {
+        uint8_t id = report[pos];
+        uint8_t len = report[pos + 1];
+        if (pos + 2 + len > report_len) {
+            break;
+        }
+        if (id == NEIGHBOR_REPORT_ELEMENT_ID && len >= NEIGHBOR_REPORT_MIN_LEN) {
+            uint8_t channel = report[pos + 2 + NEIGHBOR_REPORT_CHANNEL_OFFSET];
+            bool seen = false;
+            for (size_t i = 0; i < count; i++) {
+                if (channels[i] == channel) {
+                    seen = true;
+                    break;
+                }
+            }
+            if (!seen && channel != 0) {
+                channels[count++] = channel;
+            }
+        }
+        pos += 2 + len;
+    }
+    return count;
+}
+
+RoamSelection::RoamSelection(const uint8_t* current_bssid, int8_t current_rssi) : current_rssi_(current_rssi) {
+    memcpy(current_bssid_, current_bssid, 6);
+}
+
+void RoamSelection::Offer(size_t index, const uint8_t* bssid, int8_t rssi, bool blocked) {
+    if (memcmp(bssid, current_bssid_, 6) == 0) {
+        current_rssi_ = rssi;
+        return;
+    }
+    // 已按 RSSI 排序，第一个没有被屏蔽的即最强
+    if (best_ < 0 && !blocked) {
+        best_ = index;
+        best_rssi_ = rssi;
+    }
+}
+
+int RoamSelection::Best(const RoamingPolicy& policy) const {
+    if (best_ < 0 || !policy.IsBetter(current_rssi_, best_rssi_)) {
+        return -1;
+    }
+    return best_;
+}
@@ -5,17 +5,97 @@
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/event_groups.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
 #include <esp_log.h>
 #include <esp_wifi.h>
 #include <nvs.h>
 #include "nvs_flash.h"
 #include <esp_netif.h>
 #include <esp_system.h>
+#include <esp_mac.h>
+#include <lwip/dhcp.h>
 #include "ssid_manager.h"
+#include "dhcp_reboot.h"
+#include "ssid_index.h"
+#include "connection_timeline.h"
+#include "disconnect_reason.h"
+#include "link_metrics.h"
+
+#if CONFIG_WPA_11KV_SUPPORT
+#include <esp_rrm.h>
+#endif
 
 #define TAG "wifi"
 #define WIFI_EVENT_CONNECTED BIT0
-#define MAX_RECONNECT_COUNT 5
+#define DEFAULT_MAX_RECONNECT_COUNT 5
+// 重连退避：0.5 秒起，最长 8 秒；重新扫描退避：10 秒起，最长 2 分钟
+// 重新扫描的抖动下限取 base / 2，最短也要等 5 秒，不会比原来固定 10 秒的间隔扫得更频繁太多
+#define RECONNECT_BACKOFF_BASE_MS 500
+#define RECONNECT_BACKOFF_CAP_MS (8 * 1000)
+#define RESCAN_BACKOFF_BASE_MS (10 * 1000)
+#define RESCAN_BACKOFF_CAP_MS (120 * 1000)
+#define RESCAN_BACKOFF_MIN_MS (RESCAN_BACKOFF_BASE_MS / 2)
+#define LAST_AP_NVS_KEY "last_ap"
+#define LAST_AP_RECORD_VERSION 1
+#define LAST_AP_FAIL_NVS_KEY "last_ap_fail"
+// 自动省电的流量采样周期
+#define POWER_SAVE_SAMPLE_MS 1000
+// 发射功率控制的采样周期
+#define TX_POWER_SAMPLE_MS 2000
+// 黑名单中的 BSSID 排在所有正常候选之后，只有没有其他选择时才会尝试
+#define BLOCKED_SCORE_PENALTY 10000
+// 链路快照的采样周期，期间 RSSI 由 RSSI 事件和发射功率控制的采样更新
+#define LINK_SAMPLE_MS 5000
+// 读不到租期时按 1 小时处理
+#define DEFAULT_DHCP_LEASE_S 3600
+// 站点任务与消息队列
+#define STATION_TASK_STACK_SIZE 4096
+#define STATION_TASK_PRIORITY 5
+#define STATION_QUEUE_LENGTH 16
+// 为驱动事件保留的位置：公开接口的消息不能把队列占满，断开、拿到 IP 等事件不会因此丢失
+#define STATION_QUEUE_RESERVED 6
+// 队列满时公开接口最多等待的时间，超时丢弃该消息；事件处理函数运行在系统事件任务中，不等待
+#define STATION_POST_TIMEOUT_MS 100
+
+static void RecordPhase(TimelinePhase phase, uint16_t arg = 0) {
+    ConnectionTimeline::GetInstance().Record(TimelineSource::kStation, phase, arg);
+}
+
+static uint32_t NowMs() {
+    return esp_timer_get_time() / 1000;
+}
+
+static uint32_t HashOf(const char* ssid) {
+    return SsidIndex::HashSsid((const uint8_t*)ssid, strlen(ssid));
+}
+
+// 计算保存网络的 SSID 哈希，用于扫描规划与隐藏网络探测
+static size_t CollectSavedHashes(uint32_t* out, size_t max_count) {
+    const auto& ssid_list = SsidManager::GetInstance().GetSsidList();
+    size_t count = 0;
+    for (const auto& item : ssid_list) {
+        if (count >= max_count) {
+            break;
+        }
+        out[count++] = SsidIndex::HashSsid((const uint8_t*)item.ssid.data(), item.ssid.size());
+    }
+    return count;
+}
+
+// 检查长度并拷贝到定长消息中
+static bool CopyCredentials(const std::string& ssid, const std::string& password, char* out_ssid, size_t ssid_size,
+    char* out_password, size_t password_size) {
+    if (ssid.empty() || ssid.size() >= ssid_size || password.size() >= password_size) {
+        ESP_LOGE(TAG, "Invalid SSID or password length: %d / %d", (int)ssid.size(), (int)password.size());
+        return false;
+    }
+    memcpy(out_ssid, ssid.data(), ssid.size());
+    out_ssid[ssid.size()] = '\0';
+    memcpy(out_password, password.data(), password.size());
+    out_password[password.size()] = '\0';
+    return true;
+}
 
 // 静态变量定义
 bool WifiStation::netif_initialized_ = false;
@@ -29,6 +109,15 @@ WifiStation::WifiStation() {
     // Create the event group
     event_group_ = xEventGroupCreate();
 
+    // 用 MAC 作为退避抖动的种子，避免整栋楼的设备同步重连
+    uint8_t mac[6] = {};
+    esp_read_mac(mac, ESP_MAC_WIFI_STA);
+    uint32_t seed = ExponentialBackoff::SeedFromMac(mac);
+    max_reconnect_count_ = DEFAULT_MAX_RECONNECT_COUNT;
+    reconnect_backoff_ = std::make_unique<ExponentialBackoff>(RECONNECT_BACKOFF_BASE_MS, RECONNECT_BACKOFF_CAP_MS, seed);
+    rescan_backoff_ = std::make_unique<ExponentialBackoff>(RESCAN_BACKOFF_BASE_MS, RESCAN_BACKOFF_CAP_MS, seed ^ 0x5bd1e995u,
+        RESCAN_BACKOFF_MIN_MS);
+
     // 读取配置
     nvs_handle_t nvs;
     esp_err_t err = nvs_open("wifi", NVS_READONLY, &nvs);
@@ -44,28 +133,355 @@ WifiStation::WifiStation() {
         remember_bssid_ = 0;
     }
     nvs_close(nvs);
+
+    LoadLastAp();
+    if (fast_connect_.valid()) {
+        // 用上次连接的信道作为扫描规划的初始历史，快速重连失败后的扫描也能先定向
+        const auto& last_ap = fast_connect_.record();
+        scan_planner_.RecordSeen(SsidIndex::HashSsid((const uint8_t*)last_ap.ssid, strlen(last_ap.ssid)), last_ap.channel);
+    }
+
+    static_assert(std::is_trivially_copyable_v<Message>, "Message is copied by the queue");
+    message_queue_ = xQueueCreate(STATION_QUEUE_LENGTH, sizeof(Message));
+    xTaskCreate([](void* arg) {
+        static_cast<WifiStation*>(arg)->Run();
+    }, "wifi_station", STATION_TASK_STACK_SIZE, this, STATION_TASK_PRIORITY, &task_);
 }
 
 WifiStation::~WifiStation() {
     vEventGroupDelete(event_group_);
 }
 
+bool WifiStation::Post(const Message& message) const {
+    // 检查与发送之间不加锁，多个任务同时投递时保留的位置可能少几个，只要不被占满即可
+    TickType_t start = xTaskGetTickCount();
+    while (uxQueueSpacesAvailable(message_queue_) <= STATION_QUEUE_RESERVED) {
+        if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(STATION_POST_TIMEOUT_MS)) {
+            ESP_LOGE(TAG, "Station queue full, drop message %d", (int)message.type);
+            return false;
+        }
+        vTaskDelay(1);
+    }
+    return PostEvent(message);
+}
+
+bool WifiStation::PostEvent(const Message& message, TickType_t wait) const {
+    if (xQueueSend(message_queue_, &message, wait) != pdTRUE) {
+        ESP_LOGE(TAG, "Station queue full, drop message %d", (int)message.type);
+        return false;
+    }
+    return true;
+}
+
+void WifiStation::PostTimer(MessageType type) {
+    uint32_t bit = 1u << ((int)type - (int)MessageType::kScanTimer);
+    if (pending_timers_.fetch_or(bit) != 0) {
+        return;     // 已有唤醒消息在队列中，一起处理
+    }
+    Message message = {};
+    message.type = MessageType::kTimers;
+    if (!PostEvent(message)) {
+        timers_wake_lost_ = true;
+    }
+}
+
+void WifiStation::DispatchTimers() {
+    // 取走之后到期的定时器会投递新的唤醒消息
+    uint32_t bits = pending_timers_.exchange(0);
+    for (int type = (int)MessageType::kScanTimer; bits != 0; type++, bits >>= 1) {
+        if (bits & 1) {
+            Message message = {};
+            message.type = static_cast<MessageType>(type);
+            Dispatch(message);
+        }
+    }
+}
+
+bool WifiStation::Post(MessageType type) const {
+    Message message = {};
+    message.type = type;
+    return Post(message);
+}
+
+bool WifiStation::Call(void (*fn)(void* context), void* context) const {
+    if (xTaskGetCurrentTaskHandle() == task_) {
+        // 回调中调用，已经在站点任务里，等待自己会死锁
+        fn(context);
+        return true;
+    }
+    // 信号量放在调用方的栈上，多个任务同时调用时互不干扰，也不申请堆内存
+    StaticSemaphore_t buffer;
+    Message message = {};
+    message.type = MessageType::kCall;
+    message.call.fn = fn;
+    message.call.context = context;
+    message.call.done = xSemaphoreCreateBinaryStatic(&buffer);
+    bool ok = Post(message);
+    if (ok) {
+        xSemaphoreTake(message.call.done, portMAX_DELAY);
+    }
+    vSemaphoreDelete(message.call.done);
+    return ok;
+}
+
+void WifiStation::Run() {
+    Message message = {};
+    while (true) {
+        if (xQueueReceive(message_queue_, &message, portMAX_DELAY) == pdTRUE) {
+            Dispatch(message);
+        }
+        if (timers_wake_lost_.exchange(false)) {
+            DispatchTimers();
+        }
+    }
+}
+
+void WifiStation::Dispatch(const Message& message) {
+    switch (message.type) {
+    case MessageType::kCall:
+        message.call.fn(message.call.context);
+        xSemaphoreGive(message.call.done);
+        break;
+    case MessageType::kConnectTo:
+        DoConnectTo(message.credentials);
+        break;
+    case MessageType::kSetReconnectPolicy:
+        if (message.backoff.policy != nullptr) {
+            reconnect_backoff_.reset(message.backoff.policy);
+        }
+        max_reconnect_count_ = message.backoff.max_count;
+        break;
+    case MessageType::kSetRescanPolicy:
+        if (message.backoff.policy != nullptr) {
+            rescan_backoff_.reset(message.backoff.policy);
+        }
+        break;
+    case MessageType::kSetLeaseCache:
+        dhcp_lease_cache_ = message.value != 0;
+        break;
+    case MessageType::kSetScoreWeights:
+        scorer_.SetWeights(message.weights);
+        break;
+    case MessageType::kSetConnectBudget:
+        connect_budget_.SetConfig(message.budget_config);
+        break;
+    case MessageType::kSetRoamConfig:
+        roaming_.SetConfig(message.roam_config);
+        if (roam_state_ == RoamState::kIdle) {
+            ArmRoaming();
+        }
+        break;
+    case MessageType::kSetPowerSave:
+        StopPowerSave();
+        DisableTrafficEvents();
+        auto_power_save_ = false;
+        ApplyPowerSave(message.value ? WIFI_PS_MIN_MODEM : WIFI_PS_NONE);
+        break;
+    case MessageType::kSetAutoPowerSave:
+        StopPowerSave();
+        auto_power_save_ = message.power_save.enabled;
+        if (auto_power_save_) {
+            power_save_.SetConfig(message.power_save.config);
+            // 站点未启动时 netif 还不存在，由 DoStart 安装
+            if (state_ != StationState::kIdle) {
+                EnableTrafficEvents();
+            }
+            if (IsConnected()) {
+                StartPowerSave();
+            }
+        } else {
+            DisableTrafficEvents();
+        }
+        break;
+    case MessageType::kSetTxPowerControl: {
+        TxPowerConfig config = message.tx_power.config;
+        if (max_tx_power_ != 0) {
+            config.max_power = std::min(config.max_power, max_tx_power_);
+        }
+        tx_power_.SetConfig(config);
+        tx_power_control_ = message.tx_power.enabled;
+        if (tx_power_control_ && IsConnected()) {
+            StartTxPowerControl();
+        } else if (!tx_power_control_) {
+            if (tx_power_timer_ != nullptr) {
+                esp_timer_stop(tx_power_timer_);
+            }
+            // 回到固定设置
+            ApplyTxPower(max_tx_power_ != 0 ? max_tx_power_ : TxPowerController::kMaxPower);
+        }
+        break;
+    }
+    case MessageType::kSetReachability:
+        reachability_check_ = message.reachability.enabled;
+        reachability_config_ = message.reachability.config;
+        ResetReachability();
+        if (!reachability_check_) {
+            demoted_.Clear();
+        } else if (IsConnected()) {
+            StartReachabilityProbe();
+        }
+        break;
+    case MessageType::kLatencyBegin:
+        ApplyPowerSaveMode(power_save_.BeginLatencyCritical(NowMs()));
+        break;
+    case MessageType::kLatencyEnd:
+        ApplyPowerSaveMode(power_save_.EndLatencyCritical(NowMs()));
+        break;
+    case MessageType::kLatencyHold:
+        ApplyPowerSaveMode(power_save_.HoldLatency(NowMs(), message.value));
+        break;
+    case MessageType::kStaStart:
+        OnStaStart();
+        break;
+    case MessageType::kScanDone:
+        HandleScanResult();
+        break;
+    case MessageType::kLinkUp:
+        OnLinkUp(message.value);
+        break;
+    case MessageType::kDisconnected:
+        OnDisconnected(message.value);
+        break;
+    case MessageType::kGotIp:
+        OnGotIp(message.ip_info);
+        break;
+    case MessageType::kRssiLow:
+        OnRssiLow(message.value);
+        break;
+    case MessageType::kNeighborReport:
+        OnNeighborReport(message.neighbor.channels, message.neighbor.count);
+        break;
+    case MessageType::kProbeDone:
+        OnProbeDone(message.probe.generation, message.probe.result, message.probe.elapsed_ms);
+        break;
+    case MessageType::kTimers:
+        DispatchTimers();
+        break;
+    case MessageType::kScanTimer:
+        if (Transition(StationInput::kTimer)) {
+            StartScan();
+        }
+        break;
+    case MessageType::kFastConnectTimer:
+        OnFastConnectTimeout();
+        break;
+    case MessageType::kReconnectTimer:
+        OnReconnectTimer();
+        break;
+    case MessageType::kRoamTimer:
+        OnRoamTimer();
+        break;
+    case MessageType::kPowerSaveTimer:
+        OnPowerSaveTimer();
+        break;
+    case MessageType::kTxPowerTimer:
+        OnTxPowerTimer();
+        break;
+    case MessageType::kProbeTimer:
+        if (IsConnected()) {
+            StartReachabilityProbe();
+        }
+        break;
+    case MessageType::kLinkTimer:
+        if (IsConnected()) {
+            SampleLink();
+        }
+        break;
+    }
+}
+
+bool WifiStation::Transition(StationInput input) {
+    StationState current = state_.load();
+    StationState next;
+    if (!StationFsm::Next(current, input, &next)) {
+        ESP_LOGD(TAG, "Ignore %s in state %s", StationFsm::InputName(input), StationFsm::StateName(current));
+        return false;
+    }
+    if (next != current) {
+        ESP_LOGD(TAG, "State %s -> %s on %s", StationFsm::StateName(current), StationFsm::StateName(next),
+            StationFsm::InputName(input));
+        state_ = next;
+    }
+    return true;
+}
+
 void WifiStation::AddAuth(const std::string &&ssid, const std::string &&password) {
-    auto& ssid_manager = SsidManager::GetInstance();
-    ssid_manager.AddSsid(ssid, password);  // 使用默认的空 BSSID
+    Credentials credentials;
+    if (!CopyCredentials(ssid, password, credentials.ssid, sizeof(credentials.ssid),
+        credentials.password, sizeof(credentials.password))) {
+        return;
+    }
+    Call([&credentials] {
+        SsidManager::GetInstance().AddSsid(credentials.ssid, credentials.password);  // 使用默认的空 BSSID
+    });
 }
 
 void WifiStation::ClearAuth() {
-    auto& ssid_manager = SsidManager::GetInstance();
-    ssid_manager.Clear();
+    Call([this] {
+        SsidManager::GetInstance().Clear();
+        hidden_probe_.Clear();
+    });
 }
 
 void WifiStation::Stop() {
+    // 返回时事件处理函数已注销、定时器已删除，调用方可以安全地切换模式或释放资源
+    Call([this] { DoStop(); });
+}
+
+void WifiStation::DoStop() {
+    if (!Transition(StationInput::kStop)) {
+        // 没有启动过站点（例如只开了配网热点），与以前一样仍然停止驱动，方便调用方切换模式
+        esp_err_t err = esp_wifi_stop();
+        if (err != ESP_OK && err != ESP_ERR_WIFI_NOT_INIT) {
+            ESP_LOGW(TAG, "Failed to stop wifi: %s", esp_err_to_name(err));
+        }
+        return;
+    }
     if (timer_handle_ != nullptr) {
         esp_timer_stop(timer_handle_);
         esp_timer_delete(timer_handle_);
         timer_handle_ = nullptr;
     }
+    if (fast_connect_timer_ != nullptr) {
+        esp_timer_stop(fast_connect_timer_);
+        esp_timer_delete(fast_connect_timer_);
+        fast_connect_timer_ = nullptr;
+    }
+    fast_connect_.Cancel();
+    if (reconnect_timer_ != nullptr) {
+        esp_timer_stop(reconnect_timer_);
+        esp_timer_delete(reconnect_timer_);
+        reconnect_timer_ = nullptr;
+    }
+    lease_hint_ip_ = 0;
+    AbortRoam();
+    roam_state_ = RoamState::kIdle;     // 事件处理已取消注册，不会再收到漫游扫描的结果
+    if (roam_timer_ != nullptr) {
+        esp_timer_delete(roam_timer_);
+        roam_timer_ = nullptr;
+    }
+    StopPowerSave();
+    if (power_save_timer_ != nullptr) {
+        esp_timer_delete(power_save_timer_);
+        power_save_timer_ = nullptr;
+    }
+    if (tx_power_timer_ != nullptr) {
+        esp_timer_stop(tx_power_timer_);
+        esp_timer_delete(tx_power_timer_);
+        tx_power_timer_ = nullptr;
+    }
+    ResetReachability();
+    if (probe_timer_ != nullptr) {
+        esp_timer_delete(probe_timer_);
+        probe_timer_ = nullptr;
+    }
+    if (link_timer_ != nullptr) {
+        esp_timer_stop(link_timer_);
+        esp_timer_delete(link_timer_);
+        link_timer_ = nullptr;
+    }
+    link_state_.connected = false;
+    PublishLink();
     
     // 取消注册事件处理程序
     if (instance_any_id_ != nullptr) {
@@ -76,6 +492,7 @@ void WifiStation::Stop() {
         ESP_ERROR_CHECK(esp_event_handler_instance_unregister(IP_EVENT, IP_EVENT_STA_GOT_IP, instance_got_ip_));
         instance_got_ip_ = nullptr;
     }
+    DisableTrafficEvents();
 
     // 清除连接状态标志位
     xEventGroupClearBits(event_group_, WIFI_EVENT_CONNECTED);
@@ -83,6 +500,7 @@ void WifiStation::Stop() {
     // 清理连接队列
     connect_queue_.clear();
     reconnect_count_ = 0;
+    connect_budget_.AbortCycle();
 
     // 只停止 wifi，不销毁 netif
     ESP_ERROR_CHECK(esp_wifi_stop());
@@ -91,6 +509,53 @@ void WifiStation::Stop() {
     ESP_LOGI(TAG, "WifiStation stopped (wifi stack preserved)");
 }
 
+void WifiStation::SetReconnectPolicy(std::unique_ptr<BackoffPolicy> policy, int max_reconnect_count) {
+    Message message = {};
+    message.type = MessageType::kSetReconnectPolicy;
+    message.backoff.policy = policy.release();
+    message.backoff.max_count = max_reconnect_count;
+    if (!Post(message)) {
+        delete message.backoff.policy;
+    }
+}
+
+void WifiStation::SetRescanPolicy(std::unique_ptr<BackoffPolicy> policy) {
+    Message message = {};
+    message.type = MessageType::kSetRescanPolicy;
+    message.backoff.policy = policy.release();
+    if (!Post(message)) {
+        delete message.backoff.policy;
+    }
+}
+
+void WifiStation::SetDhcpLeaseCache(bool enabled) {
+    Message message = {};
+    message.type = MessageType::kSetLeaseCache;
+    message.value = enabled;
+    Post(message);
+}
+
+void WifiStation::SetScoreWeights(const ScoreWeights& weights) {
+    Message message = {};
+    message.type = MessageType::kSetScoreWeights;
+    message.weights = weights;
+    Post(message);
+}
+
+void WifiStation::SetConnectBudget(const ConnectBudgetConfig& config) {
+    Message message = {};
+    message.type = MessageType::kSetConnectBudget;
+    message.budget_config = config;
+    Post(message);
+}
+
+void WifiStation::SetRoamConfig(const RoamConfig& config) {
+    Message message = {};
+    message.type = MessageType::kSetRoamConfig;
+    message.roam_config = config;
+    Post(message);
+}
+
 void WifiStation::OnScanBegin(std::function<void()> on_scan_begin) {
     on_scan_begin_ = on_scan_begin;
 }
@@ -104,13 +569,18 @@ void WifiStation::OnConnected(std::function<void(const std::string& ssid)> on_co
 }
 
 
-void WifiStation::OnScanResults(std::function<void(const std::vector<std::string>& ssids)> on_scan_results) {
+void WifiStation::OnScanResults(std::function<void(std::span<const std::string_view> ssids)> on_scan_results) {
+    // 回调拿到的视图指向 scan_arena_，有效期见头文件说明
     on_scan_results_ = on_scan_results;
 }
 
 void WifiStation::Start() {
+    Call([this] { DoStart(); });
+}
+
+void WifiStation::DoStart() {
     // 检查是否已经启动
-    if (timer_handle_ != nullptr) {
+    if (!Transition(StationInput::kStart)) {
         ESP_LOGW(TAG, "WifiStation already started");
         return;
     }
@@ -119,9 +589,14 @@ void WifiStation::Start() {
     xEventGroupClearBits(event_group_, WIFI_EVENT_CONNECTED);
     connect_queue_.clear();
     reconnect_count_ = 0;
+    RecordPhase(TimelinePhase::kRequest);
+    fast_connect_.Cancel();
+    start_time_us_ = esp_timer_get_time();
+    connect_budget_.BeginCycle(NowMs());
 
     // Initialize the TCP/IP stack
     ESP_ERROR_CHECK(esp_netif_init());
+    scan_start_us_ = 0;
 
     ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT,
                                                         ESP_EVENT_ANY_ID,
@@ -140,6 +615,9 @@ void WifiStation::Start() {
         netif_initialized_ = true;
         ESP_LOGI(TAG, "Created default wifi sta netif");
     }
+    if (auto_power_save_) {
+        EnableTrafficEvents();
+    }
 
     // 检查 wifi 栈是否已经初始化
     wifi_mode_t mode;
@@ -162,17 +640,17 @@ void WifiStation::Start() {
         ESP_ERROR_CHECK(esp_wifi_set_max_tx_power(max_tx_power_));
     }
 
+#ifdef CONFIG_SOC_WIFI_SUPPORT_5G
+    // 配网热点只使用 2.4 GHz，站点模式下两个频段都扫描
+    if (esp_wifi_set_band_mode(WIFI_BAND_MODE_AUTO) == ESP_OK) {
+        scan_planner_.SetDualBand(true);
+    }
+#endif
+
     // Setup the timer to scan WiFi
     esp_timer_create_args_t timer_args = {
         .callback = [](void* arg) {
-            // 配置扫描参数，显示隐藏的 SSID
-            wifi_scan_config_t scan_config = {
-                .ssid = NULL,
-                .bssid = NULL,
-                .channel = 0,
-                .show_hidden = true,  // 显示隐藏的 WiFi
-            };
-            esp_wifi_scan_start(&scan_config, false);
+            static_cast<WifiStation*>(arg)->PostTimer(MessageType::kScanTimer);
         },
         .arg = this,
         .dispatch_method = ESP_TIMER_TASK,
@@ -180,6 +658,207 @@ void WifiStation::Start() {
         .skip_unhandled_events = true
     };
     ESP_ERROR_CHECK(esp_timer_create(&timer_args, &timer_handle_));
+
+    // 快速重连超时定时器：超时未拿到 IP 则断开并回退到扫描流程
+    esp_timer_create_args_t fast_connect_timer_args = {
+        .callback = [](void* arg) {
+            static_cast<WifiStation*>(arg)->PostTimer(MessageType::kFastConnectTimer);
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "WiFiFastConnect",
+        .skip_unhandled_events = true
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&fast_connect_timer_args, &fast_connect_timer_));
+
+    // 断开后的延迟重连定时器
+    esp_timer_create_args_t reconnect_timer_args = {
+        .callback = [](void* arg) {
+            static_cast<WifiStation*>(arg)->PostTimer(MessageType::kReconnectTimer);
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "WiFiReconnect",
+        .skip_unhandled_events = true
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&reconnect_timer_args, &reconnect_timer_));
+
+    // 漫游定时器：等待邻居报告超时后改为扫描；空闲时用于延迟重新设置 RSSI 阈值
+    esp_timer_create_args_t roam_timer_args = {
+        .callback = [](void* arg) {
+            static_cast<WifiStation*>(arg)->PostTimer(MessageType::kRoamTimer);
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "WiFiRoam",
+        .skip_unhandled_events = true
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&roam_timer_args, &roam_timer_));
+
+    // 自动省电的流量采样定时器，只在已连接且开启自动省电时运行
+    esp_timer_create_args_t power_save_timer_args = {
+        .callback = [](void* arg) {
+            static_cast<WifiStation*>(arg)->PostTimer(MessageType::kPowerSaveTimer);
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "WiFiPowerSave",
+        .skip_unhandled_events = true
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&power_save_timer_args, &power_save_timer_));
+
+    // 发射功率控制的采样定时器，只在已连接且开启控制时运行
+    esp_timer_create_args_t tx_power_timer_args = {
+        .callback = [](void* arg) {
+            static_cast<WifiStation*>(arg)->PostTimer(MessageType::kTxPowerTimer);
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "WiFiTxPower",
+        .skip_unhandled_events = true
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&tx_power_timer_args, &tx_power_timer_));
+
+    // 可达性检查的重试定时器：没有其他网络可切换时，隔一段时间重新检查
+    esp_timer_create_args_t probe_timer_args = {
+        .callback = [](void* arg) {
+            static_cast<WifiStation*>(arg)->PostTimer(MessageType::kProbeTimer);
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "WiFiProbe",
+        .skip_unhandled_events = true
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&probe_timer_args, &probe_timer_));
+
+    // 链路快照的低频采样，只在已连接时运行
+    esp_timer_create_args_t link_timer_args = {
+        .callback = [](void* arg) {
+            static_cast<WifiStation*>(arg)->PostTimer(MessageType::kLinkTimer);
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "WiFiLink",
+        .skip_unhandled_events = true
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&link_timer_args, &link_timer_));
+}
+
+void WifiStation::StartScan() {
+    if (!Transition(StationInput::kScan)) {
+        return;
+    }
+    // 一轮连接从扫描开始计时，定向探测与升级后的全信道扫描属于同一轮
+    if (!connect_budget_.InCycle()) {
+        connect_budget_.BeginCycle(NowMs());
+    }
+    // 国家码可能在运行时被修改，每次规划前同步允许的信道范围
+    wifi_country_t country;
+    if (esp_wifi_get_country(&country) == ESP_OK) {
+        scan_planner_.SetCountry(country.schan, country.nchan);
+    }
+
+    uint32_t saved_hashes[ScanPlanner::kMaxNetworks];
+    size_t saved_count = CollectSavedHashes(saved_hashes, ScanPlanner::kMaxNetworks);
+    ScanPlan plan = scan_planner_.Next(saved_hashes, saved_count);
+    scan_phase_ = ScanPhase::kNormal;
+    probe_count_ = 0;
+    probe_pos_ = 0;
+
+    // 普通扫描不显示隐藏的 SSID，隐藏网络由之后的定向扫描查找
+    wifi_scan_config_t scan_config = {
+        .ssid = NULL,
+        .bssid = NULL,
+        .channel = 0,
+        .show_hidden = false,
+    };
+    // 双频时只扫 2.4 GHz 的全信道扫描也通过位图指定信道
+    scan_config.channel_bitmap.ghz_2_channels = plan.channels_2g;
+    scan_config.channel_bitmap.ghz_5_channels = plan.channels_5g;
+    if (!plan.full) {
+        // 只扫描保存网络最近出现过的信道，并缩短每个信道的驻留时间
+        scan_config.scan_type = WIFI_SCAN_TYPE_ACTIVE;
+        scan_config.scan_time.active.min = plan.active_min_ms;
+        scan_config.scan_time.active.max = plan.active_max_ms;
+        ESP_LOGI(TAG, "Targeted scan on %d channel(s), 2G: 0x%04x, 5G: 0x%08lx", plan.channel_count,
+            plan.channels_2g, (unsigned long)plan.channels_5g);
+    } else if (plan.bands == kScanBandBoth) {
+        ESP_LOGI(TAG, "Full scan on both bands");
+    }
+    scan_bands_ = plan.bands;
+    scan_start_us_ = esp_timer_get_time();
+    RecordPhase(TimelinePhase::kScanStart);
+    esp_wifi_scan_start(&scan_config, false);
+}
+
+bool WifiStation::StartHiddenProbe() {
+    const auto& ssid_list = SsidManager::GetInstance().GetSsidList();
+    if (scan_phase_ != ScanPhase::kHiddenProbe) {
+        uint32_t saved_hashes[HiddenProbeScheduler::kMaxNetworks];
+        size_t saved_count = CollectSavedHashes(saved_hashes, HiddenProbeScheduler::kMaxNetworks);
+        for (size_t i = 0; i < saved_count; i++) {
+            if (!ssid_list[i].bssid.empty()) {
+                hidden_probe_.HintHidden(saved_hashes[i]);
+            }
+        }
+        probe_count_ = hidden_probe_.BuildBatch(saved_hashes, saved_count, probe_batch_);
+        probe_pos_ = 0;
+        scan_phase_ = ScanPhase::kHiddenProbe;
+    }
+
+    while (probe_pos_ < probe_count_) {
+        size_t index = probe_batch_[probe_pos_++];
+        if (index >= ssid_list.size()) {
+            continue;
+        }
+        const auto& item = ssid_list[index];
+        uint32_t hash = SsidIndex::HashSsid((const uint8_t*)item.ssid.data(), item.ssid.size());
+        // 定向扫描：探测请求携带 SSID，隐藏 AP 会回复带真实 SSID 的探测响应
+        memset(probe_ssid_, 0, sizeof(probe_ssid_));
+        memcpy(probe_ssid_, item.ssid.data(), std::min(item.ssid.size(), sizeof(probe_ssid_) - 1));
+        wifi_scan_config_t scan_config = {
+            .ssid = probe_ssid_,
+            .bssid = NULL,
+            .channel = 0,
+            .show_hidden = false,
+        };
+        scan_config.scan_type = WIFI_SCAN_TYPE_ACTIVE;
+        // 已知信道时只探测这些信道
+        ScanPlan plan = scan_planner_.PlanFor(&hash, 1);
+        if (!plan.full) {
+            scan_config.scan_time.active.min = plan.active_min_ms;
+            scan_config.scan_time.active.max = plan.active_max_ms;
+            scan_config.channel_bitmap.ghz_2_channels = plan.channels_2g;
+            scan_config.channel_bitmap.ghz_5_channels = plan.channels_5g;
+        }
+        ESP_LOGI(TAG, "Directed probe for %s (%d/%d) on %s", item.ssid.c_str(), (int)probe_pos_, (int)probe_count_,
+            plan.full ? "all channels" : "known channels");
+        RecordPhase(TimelinePhase::kScanStart);
+        if (esp_wifi_scan_start(&scan_config, false) == ESP_OK) {
+            return true;
+        }
+    }
+
+    scan_phase_ = ScanPhase::kNormal;
+    return false;
+}
+
+void WifiStation::ScheduleRescan() {
+    if (!Transition(StationInput::kBackoff)) {
+        return;
+    }
+    // 候选或预算已用完，本轮结束
+    uint32_t now_ms = NowMs();
+    if (connect_budget_.InCycle()) {
+        bool deadline = connect_budget_.DeadlineExpired(now_ms);
+        connect_budget_.EndCycle(false, deadline, now_ms);
+        if (deadline) {
+            ESP_LOGW(TAG, "Connect deadline of %lu ms reached", (unsigned long)connect_budget_.GetConfig().cycle_deadline_ms);
+        }
+    }
+    uint32_t delay_ms = rescan_backoff_->NextDelayMs();
+    ESP_LOGI(TAG, "Next scan in %lu ms (backoff attempt %d)", (unsigned long)delay_ms, rescan_backoff_->GetAttempt());
+    esp_timer_start_once(timer_handle_, (uint64_t)delay_ms * 1000);
 }
 
 bool WifiStation::WaitForConnected(int timeout_ms) {
@@ -188,87 +867,131 @@ bool WifiStation::WaitForConnected(int timeout_ms) {
 }
 
 void WifiStation::HandleScanResult() {
-    uint16_t ap_num = 0;
-    esp_wifi_scan_get_ap_num(&ap_num);
-    wifi_ap_record_t *ap_records = (wifi_ap_record_t *)malloc(ap_num * sizeof(wifi_ap_record_t));
-    esp_wifi_scan_get_ap_records(&ap_num, ap_records);
-    // sort by rssi descending
-    std::sort(ap_records, ap_records + ap_num, [](const wifi_ap_record_t& a, const wifi_ap_record_t& b) {
-        return a.rssi > b.rssi;
-    });
+    // 结果取到复用的缓冲区并按 RSSI 排序，稳态下不申请堆内存
+    size_t ap_num = scan_arena_.Load();
+    if (roam_state_ == RoamState::kScanning) {
+        // 连接状态下的漫游扫描，不进入连接流程
+        HandleRoamScan();
+        return;
+    }
+    if (!Transition(StationInput::kScanDone)) {
+        // 扫描期间已切换到连接或停止，结果作废
+        return;
+    }
+    RecordPhase(TimelinePhase::kScanDone, ap_num);
 
     auto& ssid_manager = SsidManager::GetInstance();
-    auto ssid_list = ssid_manager.GetSsidList();
-
-    std::vector<std::string> all_ssids;
-
-    for (int i = 0; i < ap_num; i++) {
-        auto ap_record = ap_records[i];
-
-        all_ssids.push_back((char *)ap_record.ssid);
-
-        // 将 BSSID 转换为字符串格式以便比较
-        char bssid_str[18];
-        sprintf(bssid_str, "%02x:%02x:%02x:%02x:%02x:%02x",
-            ap_record.bssid[0], ap_record.bssid[1], ap_record.bssid[2],
-            ap_record.bssid[3], ap_record.bssid[4], ap_record.bssid[5]);
-        
-        // 查找匹配的 SSID 配置
-        auto it = std::find_if(ssid_list.begin(), ssid_list.end(), [&ap_record, &bssid_str](const SsidItem& item) {
-            // 1. 原有规则：SSID 匹配
-            if (strlen((char *)ap_record.ssid) > 0 && strcmp((char *)ap_record.ssid, item.ssid.c_str()) == 0) {
-                return true;
-            }
-            
-            // 2. 新规则：对于隐藏 WiFi（SSID 为空），通过 BSSID 匹配
-            if (strlen((char *)ap_record.ssid) == 0 && !item.bssid.empty() && 
-                strcasecmp(bssid_str, item.bssid.c_str()) == 0) {
-                ESP_LOGI(TAG, "Hidden WiFi matched by BSSID: %s", bssid_str);
-                return true;
-            }
-            
-            return false;
-        });
-        
-        if (it != ssid_list.end()) {
-            ESP_LOGI(TAG, "Found AP: %s, BSSID: %s, RSSI: %d, Channel: %d, Authmode: %d",
-                strlen((char *)ap_record.ssid) > 0 ? (char *)ap_record.ssid : "[HIDDEN]", 
-                bssid_str,
-                ap_record.rssi, ap_record.primary, ap_record.authmode);
-            WifiApRecord record = {
-                .ssid = it->ssid,
-                .password = it->password,
-                .channel = ap_record.primary,
-                .authmode = ap_record.authmode
-            };
-            memcpy(record.bssid, ap_record.bssid, 6);
-            connect_queue_.push_back(record);
-        }
-    }
-
-
-    // 扫描回调：返回 SSID 列表
-    if (on_scan_results_ && !all_ssids.empty()) {
-        
-        on_scan_results_(all_ssids);
+    const auto& ssid_list = ssid_manager.GetSsidList();
+    int64_t now_us = esp_timer_get_time();
+    uint32_t now_ms = NowMs();
+    scorer_.BeginRound();
+    blocklist_.Expire(now_ms);
+    bool probing = scan_phase_ == ScanPhase::kHiddenProbe;
+    if (!probing) {
+        scan_planner_.BeginRound();
+        seen_saved_count_ = 0;
+        if (scan_start_us_ != 0) {
+            scan_planner_.RecordScanTime(scan_bands_, (esp_timer_get_time() - scan_start_us_) / 1000, ap_num);
+            scan_start_us_ = 0;
+        }
+    }
+
+    for (size_t i = 0; i < ap_num; i++) {
+        const auto& ap_record = scan_arena_[i];
+
+        // 通过索引查找匹配的 SSID 配置；普通扫描不显示隐藏 SSID，隐藏网络由定向扫描找到，结果中带有真实 SSID
+        int index = ssid_manager.MatchAp(ap_record.ssid, ap_record.bssid);
+        if (index < 0) {
+            continue;
+        }
+
+        const auto& item = ssid_list[index];
+        uint32_t ssid_hash = SsidIndex::HashSsid((const uint8_t*)item.ssid.data(), item.ssid.size());
+        scan_planner_.RecordSeen(ssid_hash, ap_record.primary);
+        RecordSeenSaved(ssid_hash);
+        if (probing) {
+            // 普通扫描没有出现，定向扫描才找到，记为隐藏网络，之后每个周期优先探测
+            hidden_probe_.MarkHidden(ssid_hash);
+        } else {
+            hidden_probe_.MarkVisible(ssid_hash);
+        }
+        ESP_LOGI(TAG, "Found AP: %s, BSSID: " MACSTR ", RSSI: %d, Channel: %d, Authmode: %d",
+            (char *)ap_record.ssid,
+            MAC2STR(ap_record.bssid),
+            ap_record.rssi, ap_record.primary, ap_record.authmode);
+        WifiApRecord record = {};
+        memcpy(record.ssid, item.ssid.data(), std::min(item.ssid.size(), sizeof(record.ssid) - 1));
+        memcpy(record.password, item.password.data(), std::min(item.password.size(), sizeof(record.password) - 1));
+        record.channel = ap_record.primary;
+        record.authmode = ap_record.authmode;
+        memcpy(record.bssid, ap_record.bssid, 6);
+        // 综合平滑 RSSI、历史成功/失败、加密方式、频段与最近成功时间评分
+        record.score = scorer_.Score(ap_record.bssid, ap_record.rssi, ap_record.authmode, ap_record.primary, now_us);
+        if (reachability_check_ && demoted_.IsDemoted(ssid_hash, now_ms)) {
+            record.score -= reachability_config_.demote_penalty;   // 最近检查过没有外网
+        }
+        if (blocklist_.IsBlocked(ap_record.bssid, now_ms)) {
+            ESP_LOGI(TAG, "Candidate " MACSTR " is blocklisted", MAC2STR(ap_record.bssid));
+            record.score -= BLOCKED_SCORE_PENALTY;
+        }
+        ESP_LOGI(TAG, "Candidate " MACSTR " score: %ld", MAC2STR(ap_record.bssid), (long)record.score);
+        connect_queue_.push(record);
+    }
+    if (!probing) {
+        hidden_probe_.EndBroadcastScan();
+    }
+
+    // 扫描回调：返回 SSID 列表（定向扫描只包含被探测的网络，不回调）
+    if (on_scan_results_ && !probing && !scan_arena_.empty()) {
+        on_scan_results_(scan_arena_.Ssids());
+    }
+
+    // 定向扫描未命中，说明网络换了信道或不在附近，立即做一次全信道扫描
+    if (!probing && scan_planner_.OnScanDone(!connect_queue_.empty())) {
+        ESP_LOGI(TAG, "Targeted scan found nothing, escalate to full scan");
+        StartScan();
+        return;
     }
-    
-    free(ap_records);
 
     if (connect_queue_.empty()) {
+        // 普通扫描没有找到保存的网络，继续对可能隐藏的网络做定向探测
+        if (StartHiddenProbe()) {
+            return;
+        }
         ESP_LOGI(TAG, "Wait for next scan");
-        esp_timer_start_once(timer_handle_, 10 * 1000 * 1000);  // 10 秒（单位是微秒）
+        ScheduleRescan();
         return;
     }
 
-    StartConnect();
+    if (!StartConnect()) {
+        ESP_LOGI(TAG, "Connect budget of all candidates used up, wait for next scan");
+        ScheduleRescan();
+    }
+}
+
+bool WifiStation::StartConnect() {
+    // 按得分依次取候选，跳过预算已用完（或确定性失败）的 SSID
+    uint32_t now_ms = NowMs();
+    while (!connect_queue_.empty()) {
+        auto ap_record = connect_queue_.pop();
+        if (!connect_budget_.CanAttempt(HashOf(ap_record.ssid), now_ms)) {
+            ESP_LOGI(TAG, "Skip %s " MACSTR ", connect budget used up", ap_record.ssid, MAC2STR(ap_record.bssid));
+            continue;
+        }
+        ConnectToRecord(ap_record, remember_bssid_);
+        return true;
+    }
+    return false;
 }
 
-void WifiStation::StartConnect() {
-    auto ap_record = connect_queue_.front();
-    connect_queue_.erase(connect_queue_.begin());
+void WifiStation::ConnectToRecord(const WifiApRecord& ap_record, bool lock_bssid) {
+    if (!Transition(StationInput::kConnect)) {
+        return;
+    }
     ssid_ = ap_record.ssid;
     password_ = ap_record.password;
+    memcpy(current_bssid_, ap_record.bssid, 6);
+    RecordPhase(TimelinePhase::kCandidate, ap_record.channel);
 
     if (on_connect_) {
         on_connect_(ssid_);
@@ -276,66 +999,834 @@ void WifiStation::StartConnect() {
 
     wifi_config_t wifi_config;
     bzero(&wifi_config, sizeof(wifi_config));
-    strcpy((char *)wifi_config.sta.ssid, ap_record.ssid.c_str());
-    strcpy((char *)wifi_config.sta.password, ap_record.password.c_str());
-    if (remember_bssid_) {
-        wifi_config.sta.channel = ap_record.channel;
-        memcpy(wifi_config.sta.bssid, ap_record.bssid, 6);
-        wifi_config.sta.bssid_set = true;
+    // sta.ssid / sta.password 为定长字段，满长时不带结尾的 0
+    memcpy(wifi_config.sta.ssid, ap_record.ssid, strnlen(ap_record.ssid, sizeof(wifi_config.sta.ssid)));
+    memcpy(wifi_config.sta.password, ap_record.password, strnlen(ap_record.password, sizeof(wifi_config.sta.password)));
+    if (lock_bssid) {
+        LockStaConfig(&wifi_config.sta, ap_record.bssid, ap_record.channel, ap_record.authmode);
     }
+#if CONFIG_WPA_11KV_SUPPORT
+    // 允许 AP 提供邻居报告，并由 supplicant 响应 BSS Transition Management 请求
+    wifi_config.sta.rm_enabled = 1;
+    wifi_config.sta.btm_enabled = 1;
+#endif
+    ApplyListenInterval(wifi_config);
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
 
     reconnect_count_ = 0;
+    connect_budget_.OnAttempt(HashOf(ap_record.ssid), NowMs());
+    ApplyCachedLease(ssid_);
+    RecordPhase(TimelinePhase::kConnectStart);
     ESP_ERROR_CHECK(esp_wifi_connect());
 }
 
-int8_t WifiStation::GetRssi() {
-    // Get station info
-    wifi_ap_record_t ap_info;
-    ESP_ERROR_CHECK(esp_wifi_sta_get_ap_info(&ap_info));
-    return ap_info.rssi;
-}
-
-uint8_t WifiStation::GetChannel() {
-    // Get station info
-    wifi_ap_record_t ap_info;
-    ESP_ERROR_CHECK(esp_wifi_sta_get_ap_info(&ap_info));
-    return ap_info.primary;
-}
+bool WifiStation::TryFastConnect() {
+    if (!fast_connect_.valid()) {
+        return false;
+    }
+    const auto& ssid_list = SsidManager::GetInstance().GetSsidList();
+    int index = fast_connect_.Begin(ssid_list, NowMs());
+    if (index < 0) {
+        ESP_LOGI(TAG, "Last AP %s is no longer saved, skip fast connect", fast_connect_.record().ssid);
+        ClearLastAp();
+        return false;
+    }
 
-bool WifiStation::IsConnected() {
-    return xEventGroupGetBits(event_group_) & WIFI_EVENT_CONNECTED;
-}
+    const auto& item = ssid_list[index];
+    const auto& last_ap = fast_connect_.record();
+    WifiApRecord record = {};
+    memcpy(record.ssid, item.ssid.data(), std::min(item.ssid.size(), sizeof(record.ssid) - 1));
+    memcpy(record.password, item.password.data(), std::min(item.password.size(), sizeof(record.password) - 1));
+    record.channel = last_ap.channel;
+    record.authmode = static_cast<wifi_auth_mode_t>(last_ap.authmode);
+    memcpy(record.bssid, last_ap.bssid, 6);
 
-void WifiStation::SetPowerSaveMode(bool enabled) {
-    ESP_ERROR_CHECK(esp_wifi_set_ps(enabled ? WIFI_PS_MIN_MODEM : WIFI_PS_NONE));
+    ESP_LOGI(TAG, "Fast connect to %s, BSSID: " MACSTR ", Channel: %d, Authmode threshold: %d",
+        record.ssid, MAC2STR(record.bssid), record.channel, AuthThresholdFor(record.authmode));
+    esp_timer_start_once(fast_connect_timer_, FastConnect::kTimeoutMs * 1000);
+    ConnectToRecord(record, true);
+    return true;
 }
 
-bool WifiStation::ConnectToWifi(const std::string& ssid, const std::string& password) {
-    ESP_LOGI(TAG, "Attempting temporary connection to WiFi: %s", ssid.c_str());
-    
-    // 检查是否已经启动
-    if (timer_handle_ == nullptr) {
-        ESP_LOGE(TAG, "WifiStation not started, call Start() first");
-        return false;
+void WifiStation::AbortFastConnect() {
+    esp_timer_stop(fast_connect_timer_);
+    if (fast_connect_.OnFailed()) {
+        ESP_LOGI(TAG, "Fast connect failed %d times in a row, drop last AP record", FastConnect::kMaxFailures);
+        ClearLastAp();
+    } else {
+        SaveLastApFailures(fast_connect_.failures());
     }
-    
-    // 清除连接状态
-    xEventGroupClearBits(event_group_, WIFI_EVENT_CONNECTED);
     connect_queue_.clear();
     reconnect_count_ = 0;
-    
-    // 若正在扫描，先停止扫描，避免与连接流程冲突（STA is connecting, scan are not allowed）
-    esp_err_t stop_scan_ret = esp_wifi_scan_stop();
-    if (stop_scan_ret != ESP_OK && stop_scan_ret != ESP_ERR_WIFI_STATE) {
-        // ESP_ERR_WIFI_STATE 表示当前未在扫描，属于可忽略状态
-        ESP_LOGW(TAG, "Failed to stop wifi scan before connect: %s", esp_err_to_name(stop_scan_ret));
+    StartScan();
+    if (on_scan_begin_) {
+        on_scan_begin_();
     }
+}
 
-    // 设置临时连接参数
-    ssid_ = ssid;
-    password_ = password;
-    
+void WifiStation::ApplyCachedLease(const std::string& ssid) {
+    // DHCP 客户端保持运行，缓存的地址只作为 INIT-REBOOT 请求的提示，是否可用由服务器决定
+    DhcpLease lease;
+    lease_hint_ip_ = 0;
+    if (dhcp_lease_cache_ && SsidManager::GetInstance().GetLease(ssid, &lease)) {
+        lease_hint_ip_ = lease.ip;
+    }
+}
+
+void WifiStation::RequestCachedLease() {
+    uint32_t ip = lease_hint_ip_;
+    lease_hint_ip_ = 0;
+    esp_netif_t* netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    if (ip == 0 || netif == nullptr) {
+        return;
+    }
+    // lwIP 的 DHCP 状态只能在 tcpip 线程中修改
+    struct Context {
+        struct netif* netif;
+        uint32_t ip;
+        bool rebooting;
+    } context = { static_cast<struct netif*>(esp_netif_get_netif_impl(netif)), ip, false };
+    esp_netif_tcpip_exec([](void* ctx) -> esp_err_t {
+        auto* context = static_cast<Context*>(ctx);
+        context->rebooting = context->netif != nullptr && DhcpRequestCachedAddress(context->netif, context->ip);
+        return ESP_OK;
+    }, &context);
+    if (context.rebooting) {
+        esp_ip4_addr_t address = { ip };
+        ESP_LOGI(TAG, "Request cached address " IPSTR " for %s (INIT-REBOOT)", IP2STR(&address), ssid_.c_str());
+    }
+}
+
+void WifiStation::SaveDhcpLease(const esp_netif_ip_info_t& ip_info) {
+    if (!dhcp_lease_cache_) {
+        return;
+    }
+    // 只缓存保存过的网络，临时连接的网络不占用 NVS
+    const auto& ssid_list = SsidManager::GetInstance().GetSsidList();
+    if (std::none_of(ssid_list.begin(), ssid_list.end(), [this](const SsidItem& item) { return item.ssid == ssid_; })) {
+        return;
+    }
+    esp_netif_t* netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    if (netif == nullptr) {
+        return;
+    }
+
+    DhcpLease lease = {};
+    lease.ip = ip_info.ip.addr;
+    lease.netmask = ip_info.netmask.addr;
+    lease.gateway = ip_info.gw.addr;
+    for (int i = 0; i < 2; i++) {
+        esp_netif_dns_info_t dns;
+        if (esp_netif_get_dns_info(netif, i == 0 ? ESP_NETIF_DNS_MAIN : ESP_NETIF_DNS_BACKUP, &dns) == ESP_OK &&
+            dns.ip.type == ESP_IPADDR_TYPE_V4) {
+            lease.dns[i] = dns.ip.u_addr.ip4.addr;
+        }
+    }
+    // esp_netif 不提供租期，直接读 lwIP 的 DHCP 状态
+    lease.lease_s = DEFAULT_DHCP_LEASE_S;
+    auto* lwip_netif = static_cast<struct netif*>(esp_netif_get_netif_impl(netif));
+    struct dhcp* dhcp = lwip_netif != nullptr ? netif_dhcp_data(lwip_netif) : nullptr;
+    if (dhcp != nullptr && dhcp->offered_t0_lease != 0) {
+        lease.lease_s = dhcp->offered_t0_lease;
+    }
+    SsidManager::GetInstance().SaveLease(ssid_, lease);
+}
+
+void WifiStation::LoadLastAp() {
+    fast_connect_.Clear();
+    nvs_handle_t nvs;
+    if (nvs_open("wifi", NVS_READONLY, &nvs) != ESP_OK) {
+        return;
+    }
+    LastApRecord record;
+    size_t length = sizeof(record);
+    if (nvs_get_blob(nvs, LAST_AP_NVS_KEY, &record, &length) == ESP_OK &&
+        length == sizeof(record) && record.version == LAST_AP_RECORD_VERSION) {
+        uint8_t failures = 0;
+        nvs_get_u8(nvs, LAST_AP_FAIL_NVS_KEY, &failures);
+        fast_connect_.Load(record, failures);
+    }
+    nvs_close(nvs);
+}
+
+void WifiStation::SaveLastApFailures(uint8_t failures) {
+    nvs_handle_t nvs;
+    if (nvs_open("wifi", NVS_READWRITE, &nvs) != ESP_OK) {
+        return;
+    }
+    // 失败计数单独存放，不改变 LastApRecord 的格式，也不会让成功连接时重写整条记录
+    esp_err_t err = failures == 0 ? nvs_erase_key(nvs, LAST_AP_FAIL_NVS_KEY) : nvs_set_u8(nvs, LAST_AP_FAIL_NVS_KEY, failures);
+    if (err == ESP_OK) {
+        nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+}
+
+void WifiStation::SaveLastAp() {
+    wifi_ap_record_t ap_info;
+    if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK) {
+        return;
+    }
+    const auto& ssid_list = SsidManager::GetInstance().GetSsidList();
+    int index = -1;
+    for (int i = 0; i < ssid_list.size(); i++) {
+        if (ssid_list[i].ssid == ssid_) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        // 临时连接（ConnectToWifi）的网络没有保存，不作为快速重连目标
+        return;
+    }
+
+    LastApRecord record = {};
+    record.version = LAST_AP_RECORD_VERSION;
+    record.ssid_index = index;
+    record.channel = ap_info.primary;
+    record.authmode = ap_info.authmode;
+    memcpy(record.bssid, ap_info.bssid, 6);
+    strncpy(record.ssid, ssid_.c_str(), sizeof(record.ssid) - 1);
+
+    // 内容没有变化时不写 flash
+    if (fast_connect_.valid() && memcmp(&record, &fast_connect_.record(), sizeof(record)) == 0) {
+        return;
+    }
+
+    nvs_handle_t nvs;
+    if (nvs_open("wifi", NVS_READWRITE, &nvs) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS for last AP");
+        return;
+    }
+    if (nvs_set_blob(nvs, LAST_AP_NVS_KEY, &record, sizeof(record)) == ESP_OK) {
+        nvs_commit(nvs);
+        fast_connect_.Load(record, 0);
+    }
+    nvs_close(nvs);
+}
+
+void WifiStation::ClearLastAp() {
+    fast_connect_.Clear();
+    nvs_handle_t nvs;
+    if (nvs_open("wifi", NVS_READWRITE, &nvs) == ESP_OK) {
+        nvs_erase_key(nvs, LAST_AP_NVS_KEY);
+        nvs_erase_key(nvs, LAST_AP_FAIL_NVS_KEY);
+        nvs_commit(nvs);
+        nvs_close(nvs);
+    }
+}
+
+void WifiStation::ArmRoaming() {
+    if (state_ != StationState::kConnected) {
+        return;
+    }
+    // 阈值事件只触发一次，每次处理完都需要重新设置
+    esp_err_t ret = esp_wifi_set_rssi_threshold(roaming_.GetConfig().rssi_threshold);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to set RSSI threshold: %s", esp_err_to_name(ret));
+    }
+}
+
+void WifiStation::OnRssiLow(int8_t rssi) {
+    if (link_state_.connected) {
+        link_state_.rssi = rssi;
+        PublishLink();
+        LinkMetrics::GetInstance().OnRssi(rssi);
+    }
+    if (roam_state_ != RoamState::kIdle || state_ != StationState::kConnected) {
+        return;
+    }
+    roaming_.OnTrigger();
+    uint32_t now_ms = esp_timer_get_time() / 1000;
+    const auto& config = roaming_.GetConfig();
+    if (!roaming_.CanRoam(now_ms)) {
+        // 刚漫游过，等驻留时间过后再评估
+        esp_timer_stop(roam_timer_);
+        esp_timer_start_once(roam_timer_, (uint64_t)config.rescan_interval_ms * 1000);
+        return;
+    }
+    ESP_LOGI(TAG, "RSSI %d below %d, look for a better AP", rssi, config.rssi_threshold);
+    roam_trigger_rssi_ = rssi;
+    roam_channel_count_ = 0;
+
+#if CONFIG_WPA_11KV_SUPPORT
+    // AP 支持 802.11k 时先请求邻居报告，只扫描报告中的信道
+    if (esp_rrm_is_rrm_supported_connection() && esp_rrm_send_neighbor_report_request() == 0) {
+        roam_state_ = RoamState::kWaitNeighbor;
+        esp_timer_stop(roam_timer_);
+        esp_timer_start_once(roam_timer_, (uint64_t)config.neighbor_timeout_ms * 1000);
+        return;
+    }
+#endif
+    StartRoamScan();
+}
+
+void WifiStation::OnNeighborReport(const uint8_t* channels, size_t count) {
+    if (roam_state_ != RoamState::kWaitNeighbor) {
+        return;
+    }
+    esp_timer_stop(roam_timer_);
+    roaming_.OnNeighborReport();
+    roam_channel_count_ = std::min(count, kMaxRoamChannels);
+    memcpy(roam_channels_, channels, roam_channel_count_);
+    ESP_LOGI(TAG, "Neighbor report: %d channel(s)", (int)roam_channel_count_);
+    StartRoamScan();
+}
+
+void WifiStation::OnRoamTimer() {
+    if (roam_state_ == RoamState::kWaitNeighbor) {
+        ESP_LOGI(TAG, "Neighbor report timed out, scan for roaming candidates");
+        StartRoamScan();
+    } else if (roam_state_ == RoamState::kIdle) {
+        ArmRoaming();
+    }
+}
+
+void WifiStation::StartRoamScan() {
+    // 邻居报告的信道加上该网络的信道历史，都没有时扫描全部信道
+    uint32_t hash = SsidIndex::HashSsid((const uint8_t*)ssid_.data(), ssid_.size());
+    ScanPlan plan = scan_planner_.PlanFor(&hash, 1);
+    for (size_t i = 0; i < roam_channel_count_; i++) {
+        uint8_t channel = roam_channels_[i];
+        if (ScanPlanner::IsChannel5g(channel)) {
+            int bit = ScanPlanner::Channel5gBit(channel);
+            if (bit > 0 && !(plan.channels_5g & (1u << bit))) {
+                plan.channels_5g |= 1u << bit;
+                plan.channel_count++;
+            }
+        } else if (!(plan.channels_2g & (1u << channel))) {
+            plan.channels_2g |= 1u << channel;
+            plan.channel_count++;
+        }
+    }
+
+    memset(roam_ssid_, 0, sizeof(roam_ssid_));
+    memcpy(roam_ssid_, ssid_.data(), std::min(ssid_.size(), sizeof(roam_ssid_) - 1));
+    wifi_scan_config_t scan_config = {
+        .ssid = roam_ssid_,
+        .bssid = NULL,
+        .channel = 0,
+        .show_hidden = false,
+    };
+    scan_config.scan_type = WIFI_SCAN_TYPE_ACTIVE;
+    if (plan.channel_count > 0) {
+        scan_config.scan_time.active.min = ScanPlanner::kTargetedActiveMinMs;
+        scan_config.scan_time.active.max = ScanPlanner::kTargetedActiveMaxMs;
+        scan_config.channel_bitmap.ghz_2_channels = plan.channels_2g;
+        scan_config.channel_bitmap.ghz_5_channels = plan.channels_5g;
+    }
+    ESP_LOGI(TAG, "Roam scan for %s on %d channel(s)", ssid_.c_str(), plan.channel_count);
+
+    roam_state_ = RoamState::kScanning;
+    roaming_.OnScan();
+    if (esp_wifi_scan_start(&scan_config, false) != ESP_OK) {
+        roam_state_ = RoamState::kIdle;
+        esp_timer_stop(roam_timer_);
+        esp_timer_start_once(roam_timer_, (uint64_t)roaming_.GetConfig().rescan_interval_ms * 1000);
+    }
+}
+
+void WifiStation::HandleRoamScan() {
+    roam_state_ = RoamState::kIdle;
+    if (!IsConnected()) {
+        return;     // 扫描期间已断开，交给正常的重连流程
+    }
+
+    uint32_t hash = SsidIndex::HashSsid((const uint8_t*)ssid_.data(), ssid_.size());
+    int8_t current_rssi = roam_trigger_rssi_;
+    wifi_ap_record_t ap_info;
+    if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
+        current_rssi = ap_info.rssi;
+    }
+
+    RoamSelection selection(current_bssid_, current_rssi);
+    uint32_t now_ms = NowMs();
+    scan_planner_.BeginRound();
+    auto ssids = scan_arena_.Ssids();
+    for (size_t i = 0; i < scan_arena_.size(); i++) {
+        const auto& ap_record = scan_arena_[i];
+        if (ssids[i] != ssid_) {
+            continue;
+        }
+        scan_planner_.RecordSeen(hash, ap_record.primary);
+        selection.Offer(i, ap_record.bssid, ap_record.rssi, blocklist_.IsBlocked(ap_record.bssid, now_ms));
+    }
+
+    current_rssi = selection.current_rssi();
+    int best_index = selection.Best(roaming_);
+    if (best_index < 0) {
+        ESP_LOGI(TAG, "No better AP than current (RSSI %d), check again in %lu ms", current_rssi,
+            (unsigned long)roaming_.GetConfig().rescan_interval_ms);
+        esp_timer_stop(roam_timer_);
+        esp_timer_start_once(roam_timer_, (uint64_t)roaming_.GetConfig().rescan_interval_ms * 1000);
+        return;
+    }
+    const auto& best = scan_arena_[best_index];
+    ESP_LOGI(TAG, "Roam from " MACSTR " (RSSI %d) to " MACSTR " (RSSI %d, channel %d)", MAC2STR(current_bssid_),
+        current_rssi, MAC2STR(best.bssid), best.rssi, best.primary);
+    SwitchToAp(best);
+}
+
+void WifiStation::SwitchToAp(const wifi_ap_record_t& ap_record) {
+    // 保留当前配置（密码、PMF 等），切换失败时恢复
+    if (esp_wifi_get_config(WIFI_IF_STA, &roam_prev_config_) != ESP_OK) {
+        return;
+    }
+    memcpy(roam_prev_bssid_, current_bssid_, 6);
+    wifi_config_t wifi_config = roam_prev_config_;
+    wifi_config.sta.channel = ap_record.primary;
+    memcpy(wifi_config.sta.bssid, ap_record.bssid, 6);
+    wifi_config.sta.bssid_set = true;
+    if (esp_wifi_set_config(WIFI_IF_STA, &wifi_config) != ESP_OK) {
+        return;
+    }
+
+    memcpy(current_bssid_, ap_record.bssid, 6);
+    roam_state_ = RoamState::kSwitching;
+    roam_reconnecting_ = false;
+    roaming_.OnRoamStart(esp_timer_get_time() / 1000);
+    RecordPhase(TimelinePhase::kCandidate, ap_record.primary);
+    if (esp_wifi_disconnect() != ESP_OK) {
+        FinishRoam(false);
+    }
+}
+
+void WifiStation::FinishRoam(bool success) {
+    roam_state_ = RoamState::kIdle;
+    roam_reconnecting_ = false;
+    roaming_.OnRoamDone(success, esp_timer_get_time() / 1000);
+    if (success) {
+        const auto& stats = roaming_.GetStats();
+        ESP_LOGI(TAG, "Roamed in %lu ms (roams: %lu, failures: %lu)", (unsigned long)stats.last_latency_ms,
+            (unsigned long)stats.roams, (unsigned long)stats.failures);
+        return;
+    }
+    esp_wifi_set_config(WIFI_IF_STA, &roam_prev_config_);
+    memcpy(current_bssid_, roam_prev_bssid_, 6);
+}
+
+void WifiStation::AbortRoam() {
+    if (roam_timer_ != nullptr) {
+        esp_timer_stop(roam_timer_);
+    }
+    if (roam_state_ == RoamState::kSwitching) {
+        roaming_.OnRoamDone(false, esp_timer_get_time() / 1000);
+    }
+    // 正在进行的漫游扫描仍会收到扫描完成事件，保留状态让结果被丢弃
+    if (roam_state_ != RoamState::kScanning) {
+        roam_state_ = RoamState::kIdle;
+    }
+    roam_reconnecting_ = false;
+}
+
+int8_t WifiStation::GetRssi() const {
+    LinkState state = link_.Read();
+    return state.connected ? state.rssi : 0;
+}
+
+uint8_t WifiStation::GetChannel() const {
+    LinkState state = link_.Read();
+    return state.connected ? state.channel : 0;
+}
+
+// 以下接口读取站点任务拥有的状态，在站点任务中取副本，投递失败时返回空值
+std::string WifiStation::GetSsid() const {
+    std::string ssid;
+    Call([&] { ssid = ssid_; });
+    return ssid;
+}
+
+std::string WifiStation::GetIpAddress() const {
+    std::string ip_address;
+    Call([&] { ip_address = ip_address_; });
+    return ip_address;
+}
+
+PowerSaveStats WifiStation::GetPowerSaveStats() const {
+    PowerSaveStats stats = {};
+    Call([&] { stats = power_save_stats_; });
+    return stats;
+}
+
+TxPowerStats WifiStation::GetTxPowerStats() const {
+    TxPowerStats stats = {};
+    Call([&] { stats = tx_power_stats_; });
+    return stats;
+}
+
+ConnectCycleReport WifiStation::GetConnectReport() const {
+    ConnectCycleReport report = {};
+    Call([&] { report = connect_budget_.GetReport(); });
+    return report;
+}
+
+ScoreWeights WifiStation::GetScoreWeights() const {
+    ScoreWeights weights = {};
+    Call([&] { weights = scorer_.GetWeights(); });
+    return weights;
+}
+
+size_t WifiStation::GetCandidateScores(ScoreBreakdown* out, size_t max_count) const {
+    size_t count = 0;
+    Call([&] { count = scorer_.GetLastScores(out, max_count); });
+    return count;
+}
+
+size_t WifiStation::GetBlocklist(BlocklistEntry* out, size_t max_count) const {
+    size_t count = 0;
+    Call([&] { count = blocklist_.GetEntries(out, max_count, NowMs()); });
+    return count;
+}
+
+BandScanStats WifiStation::GetScanStats(ScanBand band) const {
+    BandScanStats stats = {};
+    Call([&] { stats = scan_planner_.GetBandStats(band); });
+    return stats;
+}
+
+RoamConfig WifiStation::GetRoamConfig() const {
+    RoamConfig config = {};
+    Call([&] { config = roaming_.GetConfig(); });
+    return config;
+}
+
+RoamStats WifiStation::GetRoamStats() const {
+    RoamStats stats = {};
+    Call([&] { stats = roaming_.GetStats(); });
+    return stats;
+}
+
+void WifiStation::PublishLink() {
+    link_state_.updated_ms = NowMs();
+    link_.Write(link_state_);
+}
+
+bool WifiStation::SampleLink() {
+    wifi_ap_record_t ap_info;
+    if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK) {
+        return false;
+    }
+    link_state_.rssi = ap_info.rssi;
+    link_state_.channel = ap_info.primary;
+    LinkMetrics::GetInstance().OnRssi(ap_info.rssi);
+    memcpy(link_state_.bssid, ap_info.bssid, 6);
+    wifi_phy_mode_t phy_mode;
+    if (esp_wifi_sta_get_negotiated_phymode(&phy_mode) == ESP_OK) {
+        link_state_.phy_mode = phy_mode;
+    }
+    PublishLink();
+    return true;
+}
+
+bool WifiStation::IsConnected() {
+    return xEventGroupGetBits(event_group_) & WIFI_EVENT_CONNECTED;
+}
+
+void WifiStation::SetPowerSaveMode(bool enabled) {
+    Message message = {};
+    message.type = MessageType::kSetPowerSave;
+    message.value = enabled;
+    Post(message);
+}
+
+void WifiStation::SetAutoPowerSave(bool enabled, const PowerSaveConfig& config) {
+    Message message = {};
+    message.type = MessageType::kSetAutoPowerSave;
+    message.power_save.config = config;
+    message.power_save.enabled = enabled;
+    Post(message);
+}
+
+void WifiStation::BeginLowLatency() {
+    Post(MessageType::kLatencyBegin);
+}
+
+void WifiStation::EndLowLatency() {
+    Post(MessageType::kLatencyEnd);
+}
+
+void WifiStation::HoldLowLatency(uint32_t duration_ms) {
+    Message message = {};
+    message.type = MessageType::kLatencyHold;
+    message.value = duration_ms;
+    Post(message);
+}
+
+void WifiStation::ApplyPowerSave(wifi_ps_type_t mode) {
+    if (mode == power_save_mode_) {
+        return;
+    }
+    esp_err_t err = esp_wifi_set_ps(mode);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to set power save mode %d: %s", mode, esp_err_to_name(err));
+        return;
+    }
+    power_save_mode_ = mode;
+}
+
+void WifiStation::ApplyPowerSaveMode(PowerSaveMode mode) {
+    if (!auto_power_save_ || !IsConnected()) {
+        return;     // 低延迟窗口仍然计数，开启或连接后由下一次采样生效
+    }
+    static constexpr wifi_ps_type_t kModes[] = { WIFI_PS_NONE, WIFI_PS_MIN_MODEM, WIFI_PS_MAX_MODEM };
+    wifi_ps_type_t ps = kModes[static_cast<size_t>(mode)];
+    if (ps != power_save_mode_) {
+        ESP_LOGI(TAG, "Power save -> %d", ps);
+    }
+    ApplyPowerSave(ps);
+    power_save_stats_ = power_save_.GetStats(NowMs());
+}
+
+void WifiStation::StartPowerSave() {
+    if (!auto_power_save_ || power_save_timer_ == nullptr) {
+        return;
+    }
+    // 刚连接上通常还有 DHCP、NTP 等流量，从 MIN_MODEM 开始
+    power_save_.Reset(PowerSaveMode::kMinModem, NowMs());
+    traffic_packets_.store(0, std::memory_order_relaxed);
+    ApplyPowerSaveMode(PowerSaveMode::kMinModem);
+    esp_timer_stop(power_save_timer_);
+    esp_timer_start_periodic(power_save_timer_, (uint64_t)POWER_SAVE_SAMPLE_MS * 1000);
+}
+
+void WifiStation::StopPowerSave() {
+    if (power_save_timer_ != nullptr) {
+        esp_timer_stop(power_save_timer_);
+    }
+    if (auto_power_save_) {
+        power_save_stats_ = power_save_.GetStats(NowMs());
+    }
+}
+
+void WifiStation::EnableTrafficEvents() {
+#if CONFIG_ESP_NETIF_REPORT_DATA_TRAFFIC
+    // 收发包事件作为自动省电的流量来源；每个包都会经过事件循环，只在开启自动省电时安装
+    if (instance_tx_rx_ != nullptr) {
+        return;
+    }
+    esp_netif_t* sta_netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    if (sta_netif != nullptr && esp_netif_tx_rx_event_enable(sta_netif) == ESP_OK) {
+        ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT,
+                                                            IP_EVENT_TX_RX,
+                                                            &WifiStation::TrafficEventHandler,
+                                                            this,
+                                                            &instance_tx_rx_));
+    }
+#endif
+}
+
+void WifiStation::DisableTrafficEvents() {
+#if CONFIG_ESP_NETIF_REPORT_DATA_TRAFFIC
+    if (instance_tx_rx_ == nullptr) {
+        return;
+    }
+    ESP_ERROR_CHECK(esp_event_handler_instance_unregister(IP_EVENT, IP_EVENT_TX_RX, instance_tx_rx_));
+    instance_tx_rx_ = nullptr;
+    esp_netif_t* sta_netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    if (sta_netif != nullptr) {
+        esp_netif_tx_rx_event_disable(sta_netif);
+    }
+#endif
+}
+
+void WifiStation::OnPowerSaveTimer() {
+    uint32_t packets = traffic_packets_.exchange(0, std::memory_order_relaxed);
+    ApplyPowerSaveMode(power_save_.Update(NowMs(), packets));
+}
+
+void WifiStation::SetTxPowerControl(bool enabled, const TxPowerConfig& config) {
+    Message message = {};
+    message.type = MessageType::kSetTxPowerControl;
+    message.tx_power.config = config;
+    message.tx_power.enabled = enabled;
+    Post(message);
+}
+
+void WifiStation::ApplyTxPower(int8_t power) {
+    int8_t current = 0;
+    if (esp_wifi_get_max_tx_power(&current) == ESP_OK && current == power) {
+        return;
+    }
+    esp_err_t err = esp_wifi_set_max_tx_power(power);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to set tx power %d: %s", power, esp_err_to_name(err));
+        return;
+    }
+}
+
+void WifiStation::StartTxPowerControl() {
+    if (!tx_power_control_ || tx_power_timer_ == nullptr) {
+        return;
+    }
+    // 每次连接从上限开始逐级下调；没有发送失败来源时停在上限
+    if (!tx_power_.GetConfig().failure_feedback) {
+        ESP_LOGI(TAG, "Tx power control without failure feedback, stay at max power");
+    }
+    tx_power_.Reset(NowMs());
+    tx_failures_.store(0, std::memory_order_relaxed);
+    ApplyTxPower(tx_power_.GetPower());
+    tx_power_stats_ = tx_power_.GetStats(NowMs());
+    esp_timer_stop(tx_power_timer_);
+    esp_timer_start_periodic(tx_power_timer_, (uint64_t)TX_POWER_SAMPLE_MS * 1000);
+}
+
+void WifiStation::OnTxPowerTimer() {
+    if (!tx_power_control_ || !IsConnected()) {
+        return;
+    }
+    int rssi = 0;
+    if (esp_wifi_sta_get_rssi(&rssi) != ESP_OK) {
+        return;
+    }
+    link_state_.rssi = rssi;
+    PublishLink();
+    LinkMetrics::GetInstance().OnRssi(rssi);
+    uint32_t failures = tx_failures_.exchange(0, std::memory_order_relaxed);
+    int8_t previous = tx_power_.GetPower();
+    int8_t power = tx_power_.Update(NowMs(), rssi, failures);
+    if (power != previous) {
+        ESP_LOGI(TAG, "Tx power %d -> %d (rssi %d, tx failures %lu)", previous, power, rssi, (unsigned long)failures);
+        ApplyTxPower(power);
+    }
+    tx_power_stats_ = tx_power_.GetStats(NowMs());
+}
+
+void WifiStation::SetReachabilityCheck(bool enabled, const ReachabilityConfig& config) {
+    Message message = {};
+    message.type = MessageType::kSetReachability;
+    message.reachability.config = config;
+    message.reachability.enabled = enabled;
+    Post(message);
+}
+
+void WifiStation::ResetReachability() {
+    probe_generation_++;
+    probe_failover_ = false;
+    reachability_ = Reachability::kUnknown;
+    if (probe_timer_ != nullptr) {
+        esp_timer_stop(probe_timer_);
+    }
+}
+
+void WifiStation::StartReachabilityProbe() {
+    if (!reachability_check_) {
+        return;
+    }
+    probe_generation_++;
+    reachability_ = Reachability::kProbing;
+    auto callback = [](void* arg, uint32_t generation, Reachability result, uint32_t elapsed_ms) {
+        Message message = {};
+        message.type = MessageType::kProbeDone;
+        message.probe.generation = generation;
+        message.probe.result = result;
+        message.probe.elapsed_ms = elapsed_ms;
+        // 在检查任务中回调，可以等待
+        static_cast<WifiStation*>(arg)->PostEvent(message, pdMS_TO_TICKS(STATION_POST_TIMEOUT_MS));
+    };
+    if (!probe_.Start(reachability_config_, probe_generation_, callback, this)) {
+        // 上一个连接的检查还没结束，稍后重试
+        esp_timer_stop(probe_timer_);
+        esp_timer_start_once(probe_timer_, 1000 * 1000);
+    }
+}
+
+void WifiStation::OnProbeDone(uint32_t generation, Reachability result, uint32_t elapsed_ms) {
+    if (generation != probe_generation_ || !IsConnected()) {
+        return;     // 连接已经变化
+    }
+    reachability_ = result;
+    if (result == Reachability::kReachable) {
+        ESP_LOGI(TAG, "Internet reachable via %s (%lu ms)", ssid_.c_str(), (unsigned long)elapsed_ms);
+        return;
+    }
+
+    ESP_LOGW(TAG, "No internet via %s: %s (%lu ms)", ssid_.c_str(), ReachabilityName(result), (unsigned long)elapsed_ms);
+    uint32_t now_ms = NowMs();
+    demoted_.Demote(HashOf(ssid_.c_str()), now_ms + reachability_config_.demote_ms);
+    scorer_.RecordFailure(current_bssid_, esp_timer_get_time());
+    if (HasFailoverCandidate(HashOf(ssid_.c_str()), now_ms)) {
+        // 断开后重新扫描，降级的网络排在其他保存网络之后
+        ESP_LOGI(TAG, "Fail over from %s", ssid_.c_str());
+        probe_failover_ = true;
+        esp_wifi_disconnect();
+        return;
+    }
+    // 附近没有其他可用的保存网络（或都已降级），断开只会连回来，保持连接并定期重新检查
+    ESP_LOGI(TAG, "No other saved network in range, recheck in %lu ms", (unsigned long)reachability_config_.recheck_ms);
+    esp_timer_stop(probe_timer_);
+    esp_timer_start_once(probe_timer_, (uint64_t)reachability_config_.recheck_ms * 1000);
+}
+
+void WifiStation::RecordSeenSaved(uint32_t ssid_hash) {
+    for (size_t i = 0; i < seen_saved_count_; i++) {
+        if (seen_saved_[i] == ssid_hash) {
+            return;
+        }
+    }
+    if (seen_saved_count_ < std::size(seen_saved_)) {
+        seen_saved_[seen_saved_count_++] = ssid_hash;
+    }
+}
+
+bool WifiStation::HasFailoverCandidate(uint32_t current_hash, uint32_t now_ms) const {
+    for (size_t i = 0; i < seen_saved_count_; i++) {
+        if (seen_saved_[i] != current_hash && !demoted_.IsDemoted(seen_saved_[i], now_ms)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void WifiStation::ApplyListenInterval(wifi_config_t& wifi_config) const {
+    // listen interval 只在关联时协商，MAX_MODEM 下按该间隔唤醒，其他模式不受影响
+    if (auto_power_save_) {
+        wifi_config.sta.listen_interval = power_save_.GetConfig().listen_interval;
+    }
+}
+
+bool WifiStation::ConnectToWifi(const std::string& ssid, const std::string& password) {
+    ESP_LOGI(TAG, "Attempting temporary connection to WiFi: %s", ssid.c_str());
+
+    Message message = {};
+    message.type = MessageType::kConnectTo;
+    if (!CopyCredentials(ssid, password, message.credentials.ssid, sizeof(message.credentials.ssid),
+        message.credentials.password, sizeof(message.credentials.password))) {
+        return false;
+    }
+    // 在投递之前清除连接状态，ConnectToWifiAndWait 不会读到上一次连接的结果
+    xEventGroupClearBits(event_group_, WIFI_EVENT_CONNECTED);
+    return Post(message);
+}
+
+void WifiStation::DoConnectTo(const Credentials& credentials) {
+    // 检查是否已经启动
+    if (state_ == StationState::kIdle) {
+        ESP_LOGE(TAG, "WifiStation not started, call Start() first");
+        return;
+    }
+    
+    // 清除连接状态
+    xEventGroupClearBits(event_group_, WIFI_EVENT_CONNECTED);
+    connect_queue_.clear();
+    reconnect_count_ = 0;
+    esp_timer_stop(fast_connect_timer_);
+    fast_connect_.Cancel();
+    esp_timer_stop(reconnect_timer_);
+    reconnect_backoff_->Reset();
+    AbortRoam();
+    RecordPhase(TimelinePhase::kRequest);
+    
+    // 若正在扫描，先停止扫描，避免与连接流程冲突（STA is connecting, scan are not allowed）
+    esp_err_t stop_scan_ret = esp_wifi_scan_stop();
+    if (stop_scan_ret != ESP_OK && stop_scan_ret != ESP_ERR_WIFI_STATE) {
+        // ESP_ERR_WIFI_STATE 表示当前未在扫描，属于可忽略状态
+        ESP_LOGW(TAG, "Failed to stop wifi scan before connect: %s", esp_err_to_name(stop_scan_ret));
+    }
+
+    // 设置临时连接参数
+    ssid_ = credentials.ssid;
+    password_ = credentials.password;
+    
     if (on_connect_) {
         on_connect_(ssid_);
     }
@@ -343,23 +1834,32 @@ bool WifiStation::ConnectToWifi(const std::string& ssid, const std::string& pass
     // 配置 WiFi 连接参数
     wifi_config_t wifi_config;
     bzero(&wifi_config, sizeof(wifi_config));
-    strcpy((char *)wifi_config.sta.ssid, ssid.c_str());
-    strcpy((char *)wifi_config.sta.password, password.c_str());
+    memcpy(wifi_config.sta.ssid, credentials.ssid, strnlen(credentials.ssid, sizeof(wifi_config.sta.ssid)));
+    memcpy(wifi_config.sta.password, credentials.password, strnlen(credentials.password, sizeof(wifi_config.sta.password)));
     
     // 不设置 BSSID，让系统自动选择最佳信号
     wifi_config.sta.bssid_set = false;
+#if CONFIG_WPA_11KV_SUPPORT
+    wifi_config.sta.rm_enabled = 1;
+    wifi_config.sta.btm_enabled = 1;
+#endif
+    ApplyListenInterval(wifi_config);
     
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
     
-    // 开始连接
+    // 开始连接，新的请求重新开始一轮
+    Transition(StationInput::kConnect);
+    connect_budget_.AbortCycle();
+    connect_budget_.OnAttempt(HashOf(credentials.ssid), NowMs());
+    ApplyCachedLease(ssid_);
+    RecordPhase(TimelinePhase::kConnectStart);
     esp_err_t ret = esp_wifi_connect();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to start WiFi connection: %s", esp_err_to_name(ret));
-        return false;
+        return;
     }
     
-    ESP_LOGI(TAG, "WiFi connection started for: %s", ssid.c_str());
-    return true;
+    ESP_LOGI(TAG, "WiFi connection started for: %s", ssid_.c_str());
 }
 
 bool WifiStation::ConnectToWifiAndWait(const std::string& ssid, const std::string& password, int timeout_ms) {
@@ -381,56 +1881,266 @@ bool WifiStation::ConnectToWifiAndWait(const std::string& ssid, const std::strin
     return connected;
 }
 
-// Static event handler functions
-void WifiStation::WifiEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
-    auto* this_ = static_cast<WifiStation*>(arg);
-    if (event_id == WIFI_EVENT_STA_START) {
-        // 配置扫描参数，显示隐藏的 SSID
-        wifi_scan_config_t scan_config = {
-            .ssid = NULL,
-            .bssid = NULL,
-            .channel = 0,
-            .show_hidden = true,  // 显示隐藏的 WiFi
-        };
-        esp_wifi_scan_start(&scan_config, false);
-        if (this_->on_scan_begin_) {
-            this_->on_scan_begin_();
-        }
-    } else if (event_id == WIFI_EVENT_SCAN_DONE) {
-        this_->HandleScanResult();
-    } else if (event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        xEventGroupClearBits(this_->event_group_, WIFI_EVENT_CONNECTED);
-        if (this_->reconnect_count_ < MAX_RECONNECT_COUNT) {
-            esp_wifi_connect();
-            this_->reconnect_count_++;
-            ESP_LOGI(TAG, "Reconnecting %s (attempt %d / %d)", this_->ssid_.c_str(), this_->reconnect_count_, MAX_RECONNECT_COUNT);
-            return;
+void WifiStation::OnStaStart() {
+    if (state_ != StationState::kStarting) {
+        return;
+    }
+    // 有上次成功连接的记录时直接连接，失败再回退到扫描
+    if (!TryFastConnect()) {
+        StartScan();
+        if (on_scan_begin_) {
+            on_scan_begin_();
         }
+    }
+}
 
-        if (!this_->connect_queue_.empty()) {
-            this_->StartConnect();
+void WifiStation::OnLinkUp(uint8_t channel) {
+    if (!Transition(StationInput::kLinkUp)) {
+        return;
+    }
+    RecordPhase(TimelinePhase::kConnected, channel);
+    link_state_.channel = channel;
+    RequestCachedLease();
+    if (fast_connect_.InProgress()) {
+        esp_timer_stop(fast_connect_timer_);
+        if (fast_connect_.OnAssociated()) {
+            SaveLastApFailures(0);
+        }
+        ESP_LOGI(TAG, "Fast connect associated");
+    }
+}
+
+void WifiStation::OnDisconnected(uint8_t reason) {
+    RecordPhase(TimelinePhase::kDisconnected, reason);
+    bool was_connected = IsConnected();
+    xEventGroupClearBits(event_group_, WIFI_EVENT_CONNECTED);
+    if (!Transition(StationInput::kDisconnected)) {
+        return;     // 停止之后或扫描期间的过期事件
+    }
+    LinkMetrics::GetInstance().OnDisconnected(reason, NowMs());
+    lease_hint_ip_ = 0;
+    esp_timer_stop(link_timer_);
+    if (link_state_.connected) {
+        link_state_.connected = false;
+        PublishLink();
+    }
+    StopPowerSave();
+    bool failover = probe_failover_;
+    ResetReachability();
+    if (tx_power_control_) {
+        esp_timer_stop(tx_power_timer_);
+        if (was_connected && roam_state_ != RoamState::kSwitching) {
+            // 掉线可能是功率降得太低，先回到上限再重连
+            ApplyTxPower(tx_power_.OnLinkLoss(NowMs()));
+            tx_power_stats_ = tx_power_.GetStats(NowMs());
+        }
+    }
+    bool roam_failed = false;
+    if (roam_state_ == RoamState::kSwitching) {
+        if (!roam_reconnecting_) {
+            // 主动断开当前 AP 后立即连接新的 BSSID，不走退避
+            roam_reconnecting_ = true;
+            Reconnect();
             return;
         }
-        
-        ESP_LOGI(TAG, "No more AP to connect, wait for next scan");
-        esp_timer_start_once(this_->timer_handle_, 10 * 1000 * 1000);  // 10 秒（单位是微秒）
-    } else if (event_id == WIFI_EVENT_STA_CONNECTED) {
+        roam_failed = true;
+    } else if (roam_state_ == RoamState::kWaitNeighbor) {
+        AbortRoam();
+    }
+    DisconnectClass cls = ClassifyDisconnect(reason);
+    uint32_t now_ms = NowMs();
+    uint32_t ssid_hash = HashOf(ssid_.c_str());
+    ESP_LOGI(TAG, "Disconnected from %s: %s (%d)", ssid_.c_str(), DisconnectReasonString(reason), reason);
+    if (was_connected) {
+        // 已连接后掉线，开始新的一轮
+        connect_budget_.BeginCycle(now_ms);
+    } else {
+        // 密码错误等确定性失败：本轮不再尝试该 SSID 的任何 BSSID
+        connect_budget_.OnFailure(ssid_hash, IsDefinitiveFailure(cls));
+        // 快速重连的失败多半是记录过期（信道变了）或被我们自己的超时打断，不代表该 BSSID 不好
+        if (!fast_connect_.InProgress()) {
+            // 连接尝试失败，计入该 BSSID 的历史，降低后续排名
+            scorer_.RecordFailure(current_bssid_, esp_timer_get_time());
+            // 跨轮记录：过载、握手超时等失败的 BSSID 在下次扫描中排到最后
+            blocklist_.OnFailure(current_bssid_, cls, now_ms);
+        }
+    }
+    if (roam_failed) {
+        // 新的 BSSID 连接失败：恢复原来的配置，按正常流程重连
+        ESP_LOGW(TAG, "Roam to " MACSTR " failed, fallback to previous AP", MAC2STR(current_bssid_));
+        FinishRoam(false);
+    }
+    if (fast_connect_.InProgress()) {
+        ESP_LOGI(TAG, "Fast connect to %s failed, fallback to scan", ssid_.c_str());
+        AbortFastConnect();
+        return;
+    }
+    if (failover) {
+        // 主动断开没有外网的网络，不重连，直接扫描其他候选
+        StartScan();
+        return;
+    }
+    bool retry = reconnect_count_ < max_reconnect_count_ && connect_budget_.CanAttempt(ssid_hash, now_ms);
+    if (!was_connected && (cls == DisconnectClass::kNotFound || blocklist_.IsBlocked(current_bssid_, now_ms))) {
+        retry = false;  // 该 BSSID 不在附近或已被屏蔽，直接换下一个候选
+    }
+    if (retry) {
+        // 按退避策略延迟重连，避免 AP 重启后大量设备同时发起关联
+        uint32_t delay_ms = reconnect_backoff_->NextDelayMs();
+        esp_timer_stop(reconnect_timer_);
+        esp_timer_start_once(reconnect_timer_, (uint64_t)delay_ms * 1000);
+        reconnect_count_++;
+        ESP_LOGI(TAG, "Reconnecting %s in %lu ms (attempt %d / %d)", ssid_.c_str(),
+            (unsigned long)delay_ms, reconnect_count_, max_reconnect_count_);
+        return;
+    }
+
+    if (StartConnect()) {
+        return;
     }
+    
+    ESP_LOGI(TAG, "No more AP to connect, wait for next scan");
+    ScheduleRescan();
 }
 
-void WifiStation::IpEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
-    auto* this_ = static_cast<WifiStation*>(arg);
-    auto* event = static_cast<ip_event_got_ip_t*>(event_data);
+void WifiStation::OnGotIp(const esp_netif_ip_info_t& ip_info) {
+    if (!Transition(StationInput::kGotIp)) {
+        return;
+    }
+    RecordPhase(TimelinePhase::kGotIp);
 
     char ip_address[16];
-    esp_ip4addr_ntoa(&event->ip_info.ip, ip_address, sizeof(ip_address));
-    this_->ip_address_ = ip_address;
-    ESP_LOGI(TAG, "Got IP: %s", this_->ip_address_.c_str());
+    esp_ip4addr_ntoa(&ip_info.ip, ip_address, sizeof(ip_address));
+    ip_address_ = ip_address;
+    ESP_LOGI(TAG, "Got IP: %s", ip_address_.c_str());
+
+    if (start_time_us_ != 0) {
+        ESP_LOGI(TAG, "Time to IP since start: %lld ms", (esp_timer_get_time() - start_time_us_) / 1000);
+        start_time_us_ = 0;
+    }
+    SaveLastAp();
+    // 不论走的是 INIT-REBOOT 还是完整的 DHCP，都以服务器最终分配的租约更新缓存
+    SaveDhcpLease(ip_info);
+
+    // 链路快照：连接时采样一次，之后由低频定时器和 RSSI 事件更新
+    link_state_.connected = true;
+    link_state_.ip = ip_info.ip.addr;
+    link_state_.connected_since_ms = NowMs();
+    LinkMetrics::GetInstance().OnConnected(link_state_.connected_since_ms);
+    if (SampleLink()) {
+        memcpy(current_bssid_, link_state_.bssid, 6);
+    } else {
+        PublishLink();
+    }
+    esp_timer_stop(link_timer_);
+    esp_timer_start_periodic(link_timer_, (uint64_t)LINK_SAMPLE_MS * 1000);
+    scorer_.RecordSuccess(current_bssid_, esp_timer_get_time());
+    blocklist_.OnSuccess(current_bssid_);
+    if (connect_budget_.InCycle()) {
+        connect_budget_.EndCycle(true, false, NowMs());
+        const auto& report = connect_budget_.GetReport();
+        ESP_LOGI(TAG, "Connected in %lu ms after %u attempt(s), worst so far %lu ms", (unsigned long)report.last_duration_ms,
+            report.last_attempts, (unsigned long)report.worst_duration_ms);
+    }
+    if (roam_state_ == RoamState::kSwitching) {
+        FinishRoam(true);
+    }
     
-    xEventGroupSetBits(this_->event_group_, WIFI_EVENT_CONNECTED);
-    if (this_->on_connected_) {
-        this_->on_connected_(this_->ssid_);
+    xEventGroupSetBits(event_group_, WIFI_EVENT_CONNECTED);
+    if (on_connected_) {
+        on_connected_(ssid_);
+    }
+    connect_queue_.clear();
+    reconnect_count_ = 0;
+    reconnect_backoff_->Reset();
+    rescan_backoff_->Reset();
+    ArmRoaming();
+    StartPowerSave();
+    StartTxPowerControl();
+    StartReachabilityProbe();
+}
+
+void WifiStation::OnFastConnectTimeout() {
+    if (!fast_connect_.OnTimeout()) {
+        return;
+    }
+    ESP_LOGW(TAG, "Fast connect to %s timed out, fallback to scan", fast_connect_.record().ssid);
+    if (esp_wifi_disconnect() != ESP_OK) {
+        AbortFastConnect();
     }
-    this_->connect_queue_.clear();
-    this_->reconnect_count_ = 0;
+}
+
+void WifiStation::OnReconnectTimer() {
+    if (!Transition(StationInput::kTimer)) {
+        return;
+    }
+    // 退避期间可能已超出预算或总时限
+    uint32_t ssid_hash = HashOf(ssid_.c_str());
+    if (connect_budget_.CanAttempt(ssid_hash, NowMs())) {
+        connect_budget_.OnAttempt(ssid_hash, NowMs());
+        Reconnect();
+    } else if (!StartConnect()) {
+        ScheduleRescan();
+    }
+}
+
+void WifiStation::Reconnect() {
+    if (!Transition(StationInput::kConnect)) {
+        return;
+    }
+    ApplyCachedLease(ssid_);
+    RecordPhase(TimelinePhase::kConnectStart);
+    esp_wifi_connect();
+}
+
+// Static event handler functions：只把事件转成消息，处理都在站点任务中进行
+void WifiStation::WifiEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
+    auto* this_ = static_cast<WifiStation*>(arg);
+    Message message = {};
+    switch (event_id) {
+    case WIFI_EVENT_STA_START:
+        message.type = MessageType::kStaStart;
+        break;
+    case WIFI_EVENT_SCAN_DONE:
+        message.type = MessageType::kScanDone;
+        break;
+    case WIFI_EVENT_STA_DISCONNECTED:
+        message.type = MessageType::kDisconnected;
+        message.value = static_cast<wifi_event_sta_disconnected_t*>(event_data)->reason;
+        break;
+    case WIFI_EVENT_STA_CONNECTED:
+        message.type = MessageType::kLinkUp;
+        message.value = static_cast<wifi_event_sta_connected_t*>(event_data)->channel;
+        break;
+    case WIFI_EVENT_STA_BSS_RSSI_LOW:
+        message.type = MessageType::kRssiLow;
+        message.value = static_cast<wifi_event_bss_rssi_low_t*>(event_data)->rssi;
+        break;
+#if CONFIG_WPA_11KV_SUPPORT
+    case WIFI_EVENT_STA_NEIGHBOR_REP: {
+        // 报告本身太大，只把解析出的信道放进消息
+        auto* neighbor = static_cast<wifi_event_neighbor_report_t*>(event_data);
+        message.type = MessageType::kNeighborReport;
+        message.neighbor.count = RoamingPolicy::ParseNeighborChannels(neighbor->report, neighbor->report_len,
+            message.neighbor.channels, sizeof(message.neighbor.channels));
+        break;
+    }
+#endif
+    default:
+        return;
+    }
+    this_->PostEvent(message);
+}
+
+void WifiStation::IpEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
+    auto* this_ = static_cast<WifiStation*>(arg);
+    Message message = {};
+    message.type = MessageType::kGotIp;
+    message.ip_info = static_cast<ip_event_got_ip_t*>(event_data)->ip_info;
+    this_->PostEvent(message);
+}
+
+// 每个收发包一次，只累加计数，不投递消息
+void WifiStation::TrafficEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
+    static_cast<WifiStation*>(arg)->traffic_packets_.fetch_add(1, std::memory_order_relaxed);
 }